@@ -141,6 +141,239 @@ namespace impl
             return r;
         }
     };
+
+    //! Same interface and greet/dispose semantics as `CMakeCacheConcurrent`, but the entries are split across `ShardCount` independent caches by key
+    //! hash, each with its own lock on its own cache line, so threads working on different keys don't contend and lookups only ever take a shared lock.
+    //! Readers still need that shared lock because copying a value out (e.g. grabbing an asset) must not race with a `removeObject` disposing it.
+    //! Lock acquisitions which found their shard busy are counted, see `getContentionStats`. Uncontended ones only touch the shard's lock, unless
+    //! `CountAllLocks` is set to also count the totals, which costs an extra atomic increment on every acquisition.
+    template<typename CacheT, uint32_t ShardCount=16u, typename Hasher=std::hash<std::remove_const_t<typename CacheT::PairType::first_type>>, bool CountAllLocks=false>
+    class CMakeCacheSharded
+    {
+        using BaseCache = CacheT;
+        // the `_impl` typedefs of the cache are protected
+        using K = typename BaseCache::PairType::first_type;
+        using V = typename BaseCache::PairType::second_type;
+        using ImmutableV = std::conditional_t<std::is_pointer_v<V>,const std::remove_pointer_t<V>*,const V>;
+
+        static_assert(ShardCount>0u && (ShardCount&(ShardCount-1u))==0u, "ShardCount must be a Power of Two!");
+
+        struct alignas(64) SShard
+        {
+            template<typename... Args>
+            inline SShard(Args&&... args) : cache(std::forward<Args>(args)...) {}
+
+            mutable system::SReadWriteSpinLock lock;
+            mutable std::atomic_uint64_t readLocks = 0u;
+            mutable std::atomic_uint64_t contendedReadLocks = 0u;
+            mutable std::atomic_uint64_t writeLocks = 0u;
+            mutable std::atomic_uint64_t contendedWriteLocks = 0u;
+            BaseCache cache;
+        };
+
+    public:
+        using MutablePairType = typename BaseCache::MutablePairType;
+        using CachedType = typename BaseCache::CachedType;
+        using KeyType = typename BaseCache::KeyType;
+
+        template<typename... Args>
+        inline CMakeCacheSharded(const Args&... args)
+        {
+            for (uint32_t i=0u; i<ShardCount; i++)
+                new (m_shards+i) SShard(args...);
+        }
+        inline ~CMakeCacheSharded()
+        {
+            for (uint32_t i=0u; i<ShardCount; i++)
+                m_shards[i].~SShard();
+        }
+        CMakeCacheSharded(const CMakeCacheSharded&) = delete;
+        CMakeCacheSharded(CMakeCacheSharded&&) = delete;
+        CMakeCacheSharded& operator=(const CMakeCacheSharded&) = delete;
+        CMakeCacheSharded& operator=(CMakeCacheSharded&&) = delete;
+
+        inline bool insert(const K& _key, const V& _val)
+        {
+            auto& shard = getShard(_key);
+            auto lk = lock_write(shard);
+            return shard.cache.insert(_key, _val);
+        }
+
+        inline bool contains(ImmutableV& _object) const
+        {
+            for (uint32_t i=0u; i<ShardCount; i++)
+            {
+                auto lk = lock_read(m_shards[i]);
+                if (m_shards[i].cache.contains(_object))
+                    return true;
+            }
+            return false;
+        }
+
+        inline size_t getSize() const
+        {
+            size_t r = 0ull;
+            for (uint32_t i=0u; i<ShardCount; i++)
+            {
+                auto lk = lock_read(m_shards[i]);
+                r += m_shards[i].cache.getSize();
+            }
+            return r;
+        }
+
+        inline void clear()
+        {
+            for (uint32_t i=0u; i<ShardCount; i++)
+            {
+                auto lk = lock_write(m_shards[i]);
+                m_shards[i].cache.clear();
+            }
+        }
+
+        //! Returns true if had to insert
+        bool swapObjectValue(const K& _key, const ImmutableV& _obj, const V& _val)
+        {
+            auto& shard = getShard(_key);
+            auto lk = lock_write(shard);
+            return shard.cache.swapObjectValue(_key, _obj, _val);
+        }
+
+        bool getAndStoreKeyRangeOrReserve(const K& _key, size_t& _inOutStorageSize, V* _out, bool* _gotAll)
+        {
+            auto& shard = getShard(_key);
+            auto lk = lock_write(shard);
+            return shard.cache.getAndStoreKeyRangeOrReserve(_key, _inOutStorageSize, _out, _gotAll);
+        }
+
+        inline bool removeObject(const V& _obj, const K& _key)
+        {
+            auto& shard = getShard(_key);
+            auto lk = lock_write(shard);
+            return shard.cache.removeObject(_obj, _key);
+        }
+
+        inline bool findAndStoreRange(const K& _key, size_t& _inOutStorageSize, MutablePairType* _out) const
+        {
+            const auto& shard = getShard(_key);
+            auto lk = lock_read(shard);
+            return shard.cache.findAndStoreRange(_key, _inOutStorageSize, _out);
+        }
+
+        inline bool findAndStoreRange(const K& _key, size_t& _inOutStorageSize, V* _out) const
+        {
+            const auto& shard = getShard(_key);
+            auto lk = lock_read(shard);
+            return shard.cache.findAndStoreRange(_key, _inOutStorageSize, _out);
+        }
+
+        //! Shards get output one after the other, so this is only a consistent snapshot if nothing is writing at the same time
+        inline bool outputAll(size_t& _inOutStorageSize, MutablePairType* _out) const
+        {
+            if (!_out)
+            {
+                _inOutStorageSize = getSize();
+                return false;
+            }
+            const size_t available = _inOutStorageSize;
+            size_t written = 0ull, required = 0ull;
+            for (uint32_t i=0u; i<ShardCount; i++)
+            {
+                auto lk = lock_read(m_shards[i]);
+                size_t count = available-written;
+                required += m_shards[i].cache.getSize();
+                if (count)
+                    m_shards[i].cache.outputAll(count, _out+written);
+                written += count;
+            }
+            _inOutStorageSize = written;
+            return available<=required;
+        }
+
+        //! Moving between shards takes both locks in address order, the value is neither disposed nor greeted (same as moving within a cache)
+        inline bool changeObjectKey(const V& _obj, const K& _key, const K& _newKey)
+        {
+            auto& oldShard = getShard(_key);
+            auto& newShard = getShard(_newKey);
+            if (&oldShard==&newShard)
+            {
+                auto lk = lock_write(oldShard);
+                return oldShard.cache.changeObjectKey(_obj, _key, _newKey);
+            }
+            auto lk0 = lock_write(&oldShard<&newShard ? oldShard:newShard);
+            auto lk1 = lock_write(&oldShard<&newShard ? newShard:oldShard);
+            constexpr bool DoGreetOrDispose = false;
+            if (oldShard.cache.template removeObject<DoGreetOrDispose>(_obj, _key))
+            {
+                newShard.cache.template insert<DoGreetOrDispose>(_newKey, _obj);
+                return true;
+            }
+            return false;
+        }
+
+        struct SContentionStats
+        {
+            // totals stay 0 unless `CountAllLocks`
+            uint64_t readLocks = 0u;
+            uint64_t contendedReadLocks = 0u;
+            uint64_t writeLocks = 0u;
+            uint64_t contendedWriteLocks = 0u;
+        };
+        //! Summed over all shards, the counters are relaxed so only meaningful once the contending threads are done
+        inline SContentionStats getContentionStats() const
+        {
+            SContentionStats stats = {};
+            for (uint32_t i=0u; i<ShardCount; i++)
+            {
+                stats.readLocks += m_shards[i].readLocks.load(std::memory_order_relaxed);
+                stats.contendedReadLocks += m_shards[i].contendedReadLocks.load(std::memory_order_relaxed);
+                stats.writeLocks += m_shards[i].writeLocks.load(std::memory_order_relaxed);
+                stats.contendedWriteLocks += m_shards[i].contendedWriteLocks.load(std::memory_order_relaxed);
+            }
+            return stats;
+        }
+        inline void resetContentionStats()
+        {
+            for (uint32_t i=0u; i<ShardCount; i++)
+            {
+                m_shards[i].readLocks.store(0u, std::memory_order_relaxed);
+                m_shards[i].contendedReadLocks.store(0u, std::memory_order_relaxed);
+                m_shards[i].writeLocks.store(0u, std::memory_order_relaxed);
+                m_shards[i].contendedWriteLocks.store(0u, std::memory_order_relaxed);
+            }
+        }
+
+    private:
+        inline SShard& getShard(const K& _key) { return m_shards[Hasher{}(_key)&(ShardCount-1u)]; }
+        inline const SShard& getShard(const K& _key) const { return m_shards[Hasher{}(_key)&(ShardCount-1u)]; }
+
+        static inline auto lock_read(const SShard& shard)
+        {
+            if constexpr (CountAllLocks)
+                shard.readLocks.fetch_add(1u, std::memory_order_relaxed);
+            if (!shard.lock.try_lock_read())
+            {
+                shard.contendedReadLocks.fetch_add(1u, std::memory_order_relaxed);
+                shard.lock.lock_read();
+            }
+            return system::read_lock_guard<>(shard.lock, std::adopt_lock);
+        }
+        static inline auto lock_write(const SShard& shard)
+        {
+            if constexpr (CountAllLocks)
+                shard.writeLocks.fetch_add(1u, std::memory_order_relaxed);
+            if (!shard.lock.try_lock_write())
+            {
+                shard.contendedWriteLocks.fetch_add(1u, std::memory_order_relaxed);
+                shard.lock.lock_write();
+            }
+            return system::write_lock_guard<>(shard.lock, std::adopt_lock);
+        }
+
+        union
+        {
+            SShard m_shards[ShardCount];
+        };
+    };
 }
 
 template<
@@ -165,6 +398,22 @@ using CConcurrentMultiObjectCache =
         CMultiObjectCache<K, T, ContainerT_T, Alloc>
     >;
 
+template<
+    typename K,
+    typename T,
+    template<typename...> class ContainerT_T = std::vector,
+    uint32_t ShardCount = 16u,
+    bool CountAllLocks = false,
+    typename Alloc = core::allocator<typename impl::key_val_pair_type_for<ContainerT_T, K, T>::type>
+>
+using CShardedConcurrentMultiObjectCache =
+    impl::CMakeCacheSharded<
+        CMultiObjectCache<K, T, ContainerT_T, Alloc>,
+        ShardCount,
+        std::hash<K>,
+        CountAllLocks
+    >;
+
 }}
 
 #endif
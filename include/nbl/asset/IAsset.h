@@ -83,6 +83,7 @@ class IAsset : virtual public core::IReferenceCounted
 			ET_ANIMATION_LIBRARY = 1ull<<8,						//!< asset::ICPUAnimationLibrary
 			ET_PIPELINE_LAYOUT = 1ull<<9,						//!< asset::ICPUPipelineLayout
 			ET_SHADER = 1ull<<10,								//!< asset::IShader
+			ET_MATERIAL_IR = 1ull<<11,							//!< asset::material_compiler3::CTrueIR
 			ET_GEOMETRY = 1ull<<12,								//!< anything inheriting from asset::IGeometry<ICPUBuffer>
 			ET_RENDERPASS = 1ull<<13,							//!< asset::ICPURenderpass
 			ET_FRAMEBUFFER = 1ull<<14,							//!< asset::ICPUFramebuffer
@@ -100,7 +101,7 @@ class IAsset : virtual public core::IReferenceCounted
 
 			ET_TERMINATING_ZERO = 0
 		};
-		constexpr static size_t ET_STANDARD_TYPES_COUNT = 23u;
+		constexpr static size_t ET_STANDARD_TYPES_COUNT = 24u;
 
 		//! Returns a representaion of an Asset type in decimal system
 		/**
@@ -231,6 +232,8 @@ struct to_string_helper<asset::IAsset::E_TYPE>
 					return "ICPUPipelineLayout";
 				case enum_t::ET_SHADER:
 					return "IShader";
+				case enum_t::ET_MATERIAL_IR:
+					return "material_compiler3::CTrueIR";
 				case enum_t::ET_GEOMETRY:
 					return "IGeometry<ICPUBuffer>";
 				case enum_t::ET_RENDERPASS:
@@ -51,10 +51,16 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
         friend std::function<void(SAssetBundle&)> makeAssetDisposeFunc(const IAssetManager* const _mgr);
 
     public:
+        // see `getAssetCacheContentionStats`
+#ifdef NBL_COUNT_ALL_ASSET_CACHE_LOCKS
+        constexpr static inline bool AssetCacheCountsAllLocks = true;
+#else
+        constexpr static inline bool AssetCacheCountsAllLocks = false;
+#endif //NBL_COUNT_ALL_ASSET_CACHE_LOCKS
 #ifdef USE_MAPS_FOR_PATH_BASED_CACHE
-        using AssetCacheType = core::CConcurrentMultiObjectCache<std::string, SAssetBundle, std::multimap>;
+        using AssetCacheType = core::CShardedConcurrentMultiObjectCache<std::string, SAssetBundle, std::multimap, 16u, AssetCacheCountsAllLocks>;
 #else
-        using AssetCacheType = core::CConcurrentMultiObjectCache<std::string, IAssetBundle, std::vector>;
+        using AssetCacheType = core::CShardedConcurrentMultiObjectCache<std::string, IAssetBundle, std::vector, 16u, AssetCacheCountsAllLocks>;
 #endif //USE_MAPS_FOR_PATH_BASED_CACHE
 
     private:
@@ -341,6 +347,23 @@ class NBL_API2 IAssetManager : public core::IReferenceCounted
                     m_assetCache[i]->clear();
         }
 
+        //! Lock statistics summed over the caches of the specified types, for profiling how much parallel loaders contend on them.
+        //! The total lock counts are only gathered when building with `NBL_COUNT_ALL_ASSET_CACHE_LOCKS` defined.
+        AssetCacheType::SContentionStats getAssetCacheContentionStats(const uint64_t& _assetTypeBitFlags = 0xffffffffffffffffull) const
+        {
+            AssetCacheType::SContentionStats retval = {};
+            for (size_t i = 0u; i < IAsset::ET_STANDARD_TYPES_COUNT; ++i)
+            if ((_assetTypeBitFlags>>i) & 1ull)
+            {
+                const auto stats = m_assetCache[i]->getContentionStats();
+                retval.readLocks += stats.readLocks;
+                retval.contendedReadLocks += stats.contendedReadLocks;
+                retval.writeLocks += stats.writeLocks;
+                retval.contendedWriteLocks += stats.contendedWriteLocks;
+            }
+            return retval;
+        }
+
         //! Writing an asset
         /** Compression level is a number between 0 and 1 to signify how much storage we are trading for writing time or quality, this is a non-linear 
 		scale and has different meanings and results with different asset types and writers. */
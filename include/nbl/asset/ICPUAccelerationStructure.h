@@ -270,6 +270,12 @@ class ICPUBottomLevelAccelerationStructure final : public IPreHashed, public IBo
 			m_AABBGeoms = nullptr;
 			m_geometryPrimitiveCount = nullptr;
 		}
+		inline void discardContentBatched_impl(core::refctd_drop_batch& batch) override
+		{
+			batch.push(std::move(m_triangleGeoms));
+			batch.push(std::move(m_AABBGeoms));
+			batch.push(std::move(m_geometryPrimitiveCount));
+		}
 
 	private:
 		// more wasteful than a union but easier on the refcounting
@@ -122,11 +122,12 @@ class ICPUBuffer final : public asset::IBuffer, public IPreHashed
     protected:
         inline void discardContent_impl() override
         {
-            if (m_data)
-                m_mem_resource->deallocate(m_data, m_creationParams.size, m_alignment);
-            m_data = nullptr;
-            m_mem_resource = nullptr;
-            m_creationParams.size = 0ull;
+            releaseContent();
+        }
+        // the memory still gets freed right away, only the reference to the resource is deferred
+        inline void discardContentBatched_impl(core::refctd_drop_batch& batch) override
+        {
+            batch.push(releaseContent());
         }
 
     private:
@@ -140,6 +141,16 @@ class ICPUBuffer final : public asset::IBuffer, public IPreHashed
             discardContent_impl();
         }
 
+        // frees the data and hands back the reference to its memory resource, for the caller to drop right away or batch
+        inline core::smart_refctd_ptr<core::refctd_memory_resource> releaseContent()
+        {
+            if (m_data)
+                m_mem_resource->deallocate(m_data, m_creationParams.size, m_alignment);
+            m_data = nullptr;
+            m_creationParams.size = 0ull;
+            return std::move(m_mem_resource);
+        }
+
         inline void visitDependents_impl(std::function<bool(const IAsset*)> visit) const override {}
 
         void* m_data;
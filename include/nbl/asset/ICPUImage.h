@@ -214,6 +214,10 @@ class NBL_API2 ICPUImage final : public IImage, public IPreHashed
 		{
 			buffer = nullptr;
 		}
+		inline void discardContentBatched_impl(core::refctd_drop_batch& batch) override
+		{
+			batch.push(std::move(buffer));
+		}
 		
 		// TODO: maybe we shouldn't make a single buffer back all regions?
 		core::smart_refctd_ptr<asset::ICPUBuffer>				buffer;
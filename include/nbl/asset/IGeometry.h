@@ -9,6 +9,7 @@
 
 #include "nbl/asset/IAsset.h"
 #include "nbl/asset/format/EFormat.h"
+#include "nbl/asset/format/convertElements.h"
 
 
 namespace nbl::asset
@@ -202,13 +203,19 @@ class IGeometryBase : public virtual core::IReferenceCounted
                 return false;
             }
 
-            //
-            inline uint32_t getStride() const
+            // bytes taken up by a single element, for formatted views it's the format's block
+            inline uint32_t getElementSize() const
             {
                 if (isFormatted())
                     return getFormatClassBlockBytesize(getFormatClass(format));
                 return stride;
             }
+            // distance between consecutive elements, a formatted view can have a larger stride than its element (interleaved attributes)
+            inline uint32_t getStride() const
+            {
+                const uint32_t elementSize = getElementSize();
+                return stride>elementSize ? stride:elementSize;
+            }
 
             //
             template<typename Visitor>
@@ -236,7 +243,7 @@ class IGeometryBase : public virtual core::IReferenceCounted
             SAABBStorage encodedDataRange = {};
             // 0 means no fixed stride, totally variable data inside
             uint32_t stride = 0;
-            // Format takes precedence over stride
+            // Format takes precedence over stride when it comes to the element size, a larger stride only spaces the elements apart
             // Note :If format is UNORM or SNORM, the vertex data is relative to the AABB (range)
             E_FORMAT format = EF_UNKNOWN;
             // tells you which `encodedDataRange` union member to access
@@ -311,7 +318,11 @@ class IGeometry : public std::conditional_t<std::is_same_v<BufferType,ICPUBuffer
                 const auto stride = composed.getStride();
                 if (stride==0)
                     return 0ull;
-                return src.size/stride;
+                // the last element of an interleaved view needn't be followed by a whole stride
+                const auto elementSize = composed.getElementSize();
+                if (src.size<elementSize)
+                    return 0ull;
+                return (src.size-elementSize)/stride+1ull;
             }
             
             //
@@ -387,6 +398,144 @@ class IGeometry : public std::conditional_t<std::is_same_v<BufferType,ICPUBuffer
                 return false;
             }
 
+            // whether `decodeRange`/`encodeRange` can work with `T` tuples for this view's format
+            template<typename T>
+            inline bool isRangeCodable(const uint64_t firstElIx, const uint64_t count, const uint32_t channels) const
+            {
+                if (!composed.isFormatted() || isScaledFormat(composed.format))
+                    return false;
+                if (channels==0u || channels>4u || firstElIx+count>getElementCount())
+                    return false;
+                if constexpr (std::is_same_v<T,float>)
+                    return !isIntegerFormat(composed.format);
+                else
+                    return isIntegerFormat(composed.format) && isSignedFormat(composed.format)==std::is_signed_v<T> &&
+                        getTexelOrBlockBytesize(composed.format)<=sizeof(T)*getFormatChannelCount(composed.format);
+            }
+
+            //! Decodes elements `[firstElIx,firstElIx+count)` with one format dispatch for the whole range, rather than one per `decodeElement`.
+            //! `T` is `float` for floating point and normalized formats, which get mapped through the range the same as in `decodeElement`,
+            //! and `int32_t`/`uint32_t` for SINT/UINT formats of up to 32bit. The first `channels` of each element go to `out[i*channels+c]`
+            //! or to `out[c*soaPitch+i]` when `soaPitch` isn't 0, channels the format doesn't have are 0 (1 for floating point alpha).
+            template<typename T, typename U=BufferType> requires ((std::is_same_v<T,float>||std::is_same_v<T,int32_t>||std::is_same_v<T,uint32_t>) && std::is_same_v<U,BufferType> && std::is_same_v<U,ICPUBuffer>)
+            inline bool decodeRange(const uint64_t firstElIx, const uint64_t count, T* out, const uint32_t channels=4u, const uint64_t soaPitch=0ull) const
+            {
+                if (!isRangeCodable<T>(firstElIx,count,channels) || !out)
+                    return false;
+                if (count==0ull)
+                    return true;
+
+                const auto format = composed.format;
+                const uint32_t stride = composed.getStride();
+                const auto* const src = reinterpret_cast<const uint8_t*>(getPointer<uint64_t>(firstElIx));
+                const auto decoder = getElementDecoder<T>(format);
+                // remap of normalized formats is fetched once for the whole range
+                const bool normalized = isNormalizedFormat(format);
+                float scale[4] = {1.f,1.f,1.f,1.f}, bias[4] = {};
+                if (normalized)
+                {
+                    const auto range = composed.getRange<hlsl::shapes::AABB<4,hlsl::float32_t>>();
+                    for (uint32_t c=0u; c<4u; c++)
+                    {
+                        scale[c] = range.maxVx[c]-range.minVx[c];
+                        bias[c] = range.minVx[c];
+                    }
+                }
+
+                using code_t = std::conditional_t<std::is_same_v<T,float>,hlsl::float64_t,std::conditional_t<std::is_signed_v<T>,int64_t,uint64_t>>;
+                constexpr uint32_t ChunkSize = 256u;
+                T tmp[ChunkSize*4u];
+                for (uint64_t done=0ull; done<count; done+=ChunkSize)
+                {
+                    const uint32_t chunk = static_cast<uint32_t>(core::min<uint64_t>(ChunkSize,count-done));
+                    if (decoder)
+                        decoder(src+done*stride,tmp,chunk);
+                    else
+                    for (uint32_t i=0u; i<chunk; i++)
+                    {
+                        code_t decoded[4] = {0,0,0,std::is_same_v<T,float> ? 1:0};
+                        const void* srcArr[4] = {src+(done+i)*stride,nullptr};
+                        decodePixels<code_t>(format,srcArr,decoded,0,0);
+                        for (uint32_t c=0u; c<4u; c++)
+                            tmp[i*4u+c] = static_cast<T>(decoded[c]);
+                    }
+
+                    for (uint32_t i=0u; i<chunk; i++)
+                    for (uint32_t c=0u; c<channels; c++)
+                    {
+                        T value = tmp[i*4u+c];
+                        if constexpr (std::is_same_v<T,float>)
+                        if (normalized)
+                            value = value*scale[c]+bias[c];
+                        const uint64_t elIx = done+i;
+                        out[soaPitch ? (c*soaPitch+elIx):(elIx*channels+c)] = value;
+                    }
+                }
+                return true;
+            }
+
+            //! Inverse of `decodeRange`, normalized formats get mapped from the view's range back to [0,1] or [-1,1] (clamped),
+            //! channels the format doesn't have are ignored. Doesn't update the range, so values outside of it get clamped.
+            template<typename T, typename U=BufferType> requires ((std::is_same_v<T,float>||std::is_same_v<T,int32_t>||std::is_same_v<T,uint32_t>) && std::is_same_v<U,BufferType> && std::is_same_v<U,ICPUBuffer>)
+            inline bool encodeRange(const uint64_t firstElIx, const uint64_t count, const T* in, const uint32_t channels=4u, const uint64_t soaPitch=0ull)
+            {
+                if (!isRangeCodable<T>(firstElIx,count,channels) || !in)
+                    return false;
+                if (count==0ull)
+                    return true;
+
+                const auto format = composed.format;
+                const uint32_t stride = composed.getStride();
+                auto* const dst = reinterpret_cast<uint8_t*>(getPointer<uint64_t>(firstElIx));
+                const auto encoder = getElementEncoder<T>(format);
+                const bool normalized = isNormalizedFormat(format);
+                float scale[4] = {1.f,1.f,1.f,1.f}, bias[4] = {};
+                if (normalized)
+                {
+                    const auto range = composed.getRange<hlsl::shapes::AABB<4,hlsl::float32_t>>();
+                    for (uint32_t c=0u; c<4u; c++)
+                    {
+                        const float extent = range.maxVx[c]-range.minVx[c];
+                        scale[c] = extent!=0.f ? 1.f/extent:0.f;
+                        bias[c] = -range.minVx[c]*scale[c];
+                    }
+                }
+
+                using code_t = std::conditional_t<std::is_same_v<T,float>,hlsl::float64_t,std::conditional_t<std::is_signed_v<T>,int64_t,uint64_t>>;
+                constexpr uint32_t ChunkSize = 256u;
+                T tmp[ChunkSize*4u];
+                for (uint64_t done=0ull; done<count; done+=ChunkSize)
+                {
+                    const uint32_t chunk = static_cast<uint32_t>(core::min<uint64_t>(ChunkSize,count-done));
+                    for (uint32_t i=0u; i<chunk; i++)
+                    for (uint32_t c=0u; c<4u; c++)
+                    {
+                        const uint64_t elIx = done+i;
+                        T value = T(0);
+                        if (c<channels)
+                        {
+                            value = in[soaPitch ? (c*soaPitch+elIx):(elIx*channels+c)];
+                            if constexpr (std::is_same_v<T,float>)
+                            if (normalized)
+                                value = value*scale[c]+bias[c];
+                        }
+                        tmp[i*4u+c] = value;
+                    }
+
+                    if (encoder)
+                        encoder(dst+done*stride,tmp,chunk);
+                    else
+                    for (uint32_t i=0u; i<chunk; i++)
+                    {
+                        code_t encoded[4];
+                        for (uint32_t c=0u; c<4u; c++)
+                            encoded[c] = static_cast<code_t>(tmp[i*4u+c]);
+                        encodePixels<code_t>(format,dst+(done+i)*stride,encoded);
+                    }
+                }
+                return true;
+            }
+
             //
             inline SDataView clone(uint32_t _depth=~0u) const
             {
@@ -426,6 +575,13 @@ class IGeometry : public std::conditional_t<std::is_same_v<BufferType,ICPUBuffer
                     if (_this)
                         _this->encodeElement<V,Index,BufferType>(elIx,v);
                 }
+                template<typename T>
+                inline bool encodeRange(const uint64_t firstElIx, const uint64_t count, const T* in, const uint32_t channels=4u, const uint64_t soaPitch=0ull)
+                {
+                    if (_this)
+                        return _this->encodeRange<T,BufferType>(firstElIx,count,in,channels,soaPitch);
+                    return false;
+                }
         };
         //
         inline const SDataView& getPositionView() const {return m_positionView;}
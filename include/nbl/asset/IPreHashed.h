@@ -38,9 +38,18 @@ class IPreHashed : public IAsset
 			if (isMutable() && !missingContent())
 				discardContent_impl();
 		}
+		// Same as above but the references the content held get released into `batch` instead of right away
+		inline void discardContent(core::refctd_drop_batch& batch)
+		{
+			if (isMutable() && !missingContent())
+				discardContentBatched_impl(batch);
+		}
 
         static inline void discardDependantsContents(const std::span<IAsset* const> roots)
         {
+            // Discarding can release the last reference to a dependant which is already on the stack, so all releases wait until the
+            // traversal is over, that also lets all references to a shared dependant get dropped with one atomic decrement.
+            core::refctd_drop_batch released;
             core::vector<IAsset*> stack;
             core::unordered_set<IAsset*> alreadyVisited; // whether we have push the node to the stack
             auto push = [&stack,&alreadyVisited](IAsset* node) -> bool
@@ -60,7 +69,7 @@ class IPreHashed : public IAsset
                 // pre order traversal does discard
                 auto* isPrehashed = dynamic_cast<IPreHashed*>(entry);
                 if (isPrehashed)
-                    isPrehashed->discardContent();
+                    isPrehashed->discardContent(released);
             }
         }
         static inline bool anyDependantDiscardedContents(const IAsset* root)
@@ -100,6 +109,8 @@ class IPreHashed : public IAsset
 		virtual inline ~IPreHashed() = default;
 
 		virtual void discardContent_impl() = 0;
+		// override if the content holds references, by default they get released immediately
+		virtual inline void discardContentBatched_impl(core::refctd_drop_batch& batch) {discardContent_impl();}
 
 	private:
 		// The initial value is a hash of an "as if" of a zero-length array
@@ -28,8 +28,11 @@
 #include "nbl/asset/filters/CPaddedCopyImageFilter.h"
 #include "nbl/asset/filters/CConvertFormatImageFilter.h"
 #include "nbl/asset/filters/CSwizzleAndConvertImageFilter.h"
+#include "nbl/asset/filters/CCompressImageFilter.h"
+#include "nbl/asset/filters/CDecompressImageFilter.h"
 #include "nbl/asset/filters/CFlattenRegionsImageFilter.h"
 #include "nbl/asset/filters/CMipMapGenerationImageFilter.h"
+#include "nbl/asset/filters/CStreamingMipMapGenerationImageFilter.h"
 #include "nbl/asset/filters/CSummedAreaTableImageFilter.h"
 
 // acceleration structure
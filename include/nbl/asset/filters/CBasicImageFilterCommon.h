@@ -240,6 +240,44 @@ class CBasicImageFilterCommon
 			executePerBlock(core::execution::seq,image,region,f);
 		}
 
+		// like `executePerBlock` but `f` gets called once per row of blocks with the byte offset of its first block, its position and the row length in blocks
+		template<class ExecutionPolicy, typename F>
+		static inline void executePerBlockRow(ExecutionPolicy&& policy, const ICPUImage* image, const IImage::SBufferCopy& region, F& f)
+		{
+			const auto& subresource = region.imageSubresource;
+
+			const auto& params = image->getCreationParameters();
+			TexelBlockInfo blockInfo(params.format);
+
+			core::vectorSIMDu32 trueOffset;
+			trueOffset.x = region.imageOffset.x;
+			trueOffset.y = region.imageOffset.y;
+			trueOffset.z = region.imageOffset.z;
+			trueOffset = blockInfo.convertTexelsToBlocks(trueOffset);
+			trueOffset.w = subresource.baseArrayLayer;
+			
+			core::vectorSIMDu32 trueExtent;
+			trueExtent.x = region.imageExtent.width;
+			trueExtent.y = region.imageExtent.height;
+			trueExtent.z = region.imageExtent.depth;
+			trueExtent  = blockInfo.convertTexelsToBlocks(trueExtent);
+			trueExtent.w = subresource.layerCount;
+
+			const auto strides = region.getByteStrides(blockInfo);
+
+			auto row = [&f,&region,trueExtent,strides,trueOffset](const std::array<uint32_t,3u>& batchCoord)
+			{
+				const core::vectorSIMDu32 localCoord(0u,batchCoord[0],batchCoord[1],batchCoord[2]);
+				f(region.getByteOffset(localCoord,strides),localCoord+trueOffset,trueExtent.x);
+			};
+
+			constexpr uint32_t batch_dims = 3u;
+			const core::vectorSIMDu32 spaceFillingEnd(0u,0u,0u,trueExtent.w);
+			BlockIterator<batch_dims> begin(trueExtent.pointer+4u-batch_dims);
+			BlockIterator<batch_dims> end(begin.getExtentBatches(),spaceFillingEnd.pointer+4u-batch_dims);
+			std::for_each(std::forward<ExecutionPolicy>(policy),begin,end,row);
+		}
+
 		struct default_region_functor_t
 		{
 			constexpr default_region_functor_t() = default;
@@ -312,6 +350,18 @@ class CBasicImageFilterCommon
 					executePerBlock<ExecutionPolicy,F>(std::forward<ExecutionPolicy>(policy),image,region,f);
 			}
 		}
+		template<class ExecutionPolicy, typename F, typename G>
+		static inline void executePerRegionBlockRow(ExecutionPolicy&& policy,
+													const ICPUImage* image, F& f,
+													std::span<const IImage::SBufferCopy> regions,
+													G& g)
+		{
+			for(auto region : regions)
+			{
+				if (g(region,&region))
+					executePerBlockRow<ExecutionPolicy,F>(std::forward<ExecutionPolicy>(policy),image,region,f);
+			}
+		}
 		template<typename F, typename G>
 		static inline void executePerRegion(const ICPUImage* image, F& f,
 											std::span<const IImage::SBufferCopy> regions,
@@ -0,0 +1,115 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_COMPRESS_IMAGE_FILTER_H_INCLUDED_
+#define _NBL_ASSET_C_COMPRESS_IMAGE_FILTER_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+
+#include "nbl/asset/filters/CMatchedSizeInOutImageFilterCommon.h"
+#include "nbl/asset/utils/CBlockCompressionCodec.h"
+
+namespace nbl::asset
+{
+
+//! Encodes an uncompressed range of `inImage` into a BCn `outImage`
+/*
+	The output image's format picks the codec, `quality` is forwarded to `CBlockCompressionCodec::encodeBlock`.
+	Blocks which stick out of the input range (mip levels not divisible by 4) replicate the edge texels.
+	Every output block is encoded independently, so parallel execution policies scale with the block count.
+
+	@see CBlockCompressionCodec
+	@see CDecompressImageFilter
+*/
+class CCompressImageFilter : public CImageFilter<CCompressImageFilter>, public CMatchedSizeInOutImageFilterCommon
+{
+	public:
+		virtual ~CCompressImageFilter() {}
+
+		class CState : public CMatchedSizeInOutImageFilterCommon::state_type
+		{
+			public:
+				virtual ~CState() {}
+
+				CBlockCompressionCodec::E_QUALITY quality = CBlockCompressionCodec::EQ_NORMAL;
+		};
+		using state_type = CState;
+
+		static inline bool validate(state_type* state)
+		{
+			if (!CMatchedSizeInOutImageFilterCommon::validate(state))
+				return false;
+
+			const auto inFormat = state->inImage->getCreationParameters().format;
+			const auto outFormat = state->outImage->getCreationParameters().format;
+			if (!CBlockCompressionCodec::canEncode(outFormat))
+				return false;
+			// the input gets decoded to floating point
+			if (isBlockCompressionFormat(inFormat) || isPlanarFormat(inFormat) || isIntegerFormat(inFormat) || isDepthOrStencilFormat(inFormat))
+				return false;
+
+			// output range must start on a block boundary
+			const TexelBlockInfo outInfo(outFormat);
+			const core::vectorSIMDu32 outOffset(state->outOffset.x,state->outOffset.y,state->outOffset.z,0u);
+			if ((outInfo.convertTexelsToBlocks(outOffset)*getBlockDimensions(outFormat)!=outOffset).xyzz().any())
+				return false;
+
+			return state->quality<CBlockCompressionCodec::EQ_COUNT;
+		}
+
+		template<class ExecutionPolicy>
+		static inline bool execute(ExecutionPolicy&& policy, state_type* state)
+		{
+			if (!validate(state))
+				return false;
+
+			const auto* const inImg = state->inImage;
+			auto* const outImg = state->outImage;
+			const auto inFormat = inImg->getCreationParameters().format;
+			const auto outFormat = outImg->getCreationParameters().format;
+			const core::vectorSIMDu32 blockDims = getBlockDimensions(outFormat);
+			uint8_t* const outData = reinterpret_cast<uint8_t*>(outImg->getBuffer()->getPointer());
+
+			// last input texel in range, anything past it gets clamped to it
+			const core::vectorSIMDu32 inLimit = state->inOffsetBaseLayer+state->extentLayerCount-core::vectorSIMDu32(1u,1u,1u,1u);
+			auto compressBlock = [&](uint32_t blockArrayOffset, core::vectorSIMDu32 blockPos) -> void
+			{
+				// block position is in blocks, the layer in `w` isn't
+				core::vectorSIMDu32 outTexelPos = blockPos*blockDims;
+				outTexelPos.w = blockPos.w;
+
+				CBlockCompressionCodec::texel_block_t texels;
+				for (uint32_t y=0u; y<4u; y++)
+				for (uint32_t x=0u; x<4u; x++)
+				{
+					// offset difference is unsigned but two's complement wraparound takes care of it
+					core::vectorSIMDu32 inTexelPos = outTexelPos+core::vectorSIMDu32(x,y,0u,0u)-state->outOffsetBaseLayer+state->inOffsetBaseLayer;
+					inTexelPos = core::min<core::vectorSIMDu32>(inTexelPos,inLimit);
+
+					core::vectorSIMDu32 localBlockCoord;
+					const void* srcPix[4] = {inImg->getTexelBlockData(state->inMipLevel,inTexelPos,localBlockCoord),nullptr,nullptr,nullptr};
+					double decoded[4] = {0.0,0.0,0.0,1.0};
+					if (srcPix[0])
+						decodePixelsRuntime(inFormat,srcPix,decoded,localBlockCoord.x,localBlockCoord.y);
+					auto& texel = texels[y*4u+x];
+					for (uint32_t c=0u; c<4u; c++)
+						texel[c] = static_cast<float>(decoded[c]);
+				}
+				CBlockCompressionCodec::encodeBlock(outFormat,texels,outData+blockArrayOffset,state->quality);
+			};
+
+			IImage::SSubresourceLayers subresource = {static_cast<IImage::E_ASPECT_FLAGS>(0u),state->outMipLevel,state->outBaseLayer,state->layerCount};
+			state_type::TexelRange range = {state->outOffset,state->extent};
+			CBasicImageFilterCommon::clip_region_functor_t clip(subresource,range,outFormat);
+			CBasicImageFilterCommon::executePerRegion(std::forward<ExecutionPolicy>(policy),outImg,compressBlock,outImg->getRegions(state->outMipLevel),clip);
+			outImg->setContentHash(IPreHashed::INVALID_HASH);
+			return true;
+		}
+		static inline bool execute(state_type* state)
+		{
+			return execute(core::execution::seq,state);
+		}
+};
+
+} // end namespace nbl::asset
+#endif
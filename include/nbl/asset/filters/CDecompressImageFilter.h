@@ -0,0 +1,110 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_DECOMPRESS_IMAGE_FILTER_H_INCLUDED_
+#define _NBL_ASSET_C_DECOMPRESS_IMAGE_FILTER_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+
+#include <atomic>
+
+#include "nbl/asset/filters/CMatchedSizeInOutImageFilterCommon.h"
+#include "nbl/asset/utils/CBlockCompressionCodec.h"
+
+namespace nbl::asset
+{
+
+//! Decodes a range of a BCn `inImage` into an uncompressed `outImage`
+/*
+	Only the texels of each block which fall into the state's range get written out.
+	Execution fails if any block uses a mode `CBlockCompressionCodec` can't decode, the rest of the range still gets written.
+
+	@see CBlockCompressionCodec
+	@see CCompressImageFilter
+*/
+class CDecompressImageFilter : public CImageFilter<CDecompressImageFilter>, public CMatchedSizeInOutImageFilterCommon
+{
+	public:
+		virtual ~CDecompressImageFilter() {}
+
+		using state_type = CMatchedSizeInOutImageFilterCommon::state_type;
+
+		static inline bool validate(state_type* state)
+		{
+			if (!CMatchedSizeInOutImageFilterCommon::validate(state))
+				return false;
+
+			const auto inFormat = state->inImage->getCreationParameters().format;
+			const auto outFormat = state->outImage->getCreationParameters().format;
+			if (!CBlockCompressionCodec::canDecode(inFormat))
+				return false;
+			if (isBlockCompressionFormat(outFormat) || isPlanarFormat(outFormat) || isIntegerFormat(outFormat) || isDepthOrStencilFormat(outFormat))
+				return false;
+
+			// input range must start on a block boundary
+			const TexelBlockInfo inInfo(inFormat);
+			const core::vectorSIMDu32 inOffset(state->inOffset.x,state->inOffset.y,state->inOffset.z,0u);
+			if ((inInfo.convertTexelsToBlocks(inOffset)*getBlockDimensions(inFormat)!=inOffset).xyzz().any())
+				return false;
+
+			return true;
+		}
+
+		template<class ExecutionPolicy>
+		static inline bool execute(ExecutionPolicy&& policy, state_type* state)
+		{
+			if (!validate(state))
+				return false;
+
+			const auto* const inImg = state->inImage;
+			auto* const outImg = state->outImage;
+			const auto inFormat = inImg->getCreationParameters().format;
+			const auto outFormat = outImg->getCreationParameters().format;
+			const core::vectorSIMDu32 blockDims = getBlockDimensions(inFormat);
+			const uint8_t* const inData = reinterpret_cast<const uint8_t*>(inImg->getBuffer()->getPointer());
+
+			const core::vectorSIMDu32 inLimit = state->inOffsetBaseLayer+state->extentLayerCount;
+			std::atomic_bool success(true);
+			auto decompressBlock = [&](uint32_t blockArrayOffset, core::vectorSIMDu32 blockPos) -> void
+			{
+				CBlockCompressionCodec::texel_block_t texels;
+				if (!CBlockCompressionCodec::decodeBlock(inFormat,inData+blockArrayOffset,texels))
+				{
+					success = false;
+					return;
+				}
+
+				core::vectorSIMDu32 inTexelPos = blockPos*blockDims;
+				inTexelPos.w = blockPos.w;
+				for (uint32_t y=0u; y<4u; y++)
+				for (uint32_t x=0u; x<4u; x++)
+				{
+					const core::vectorSIMDu32 texelPos = inTexelPos+core::vectorSIMDu32(x,y,0u,0u);
+					if ((texelPos<state->inOffsetBaseLayer).any() || (texelPos>=inLimit).any())
+						continue;
+
+					core::vectorSIMDu32 localBlockCoord;
+					void* dstPix = outImg->getTexelBlockData(state->outMipLevel,texelPos-state->inOffsetBaseLayer+state->outOffsetBaseLayer,localBlockCoord);
+					if (!dstPix)
+						continue;
+					const auto& texel = texels[y*4u+x];
+					const double encoded[4] = {texel[0],texel[1],texel[2],texel[3]};
+					encodePixelsRuntime(outFormat,dstPix,encoded);
+				}
+			};
+
+			IImage::SSubresourceLayers subresource = {static_cast<IImage::E_ASPECT_FLAGS>(0u),state->inMipLevel,state->inBaseLayer,state->layerCount};
+			state_type::TexelRange range = {state->inOffset,state->extent};
+			CBasicImageFilterCommon::clip_region_functor_t clip(subresource,range,inFormat);
+			CBasicImageFilterCommon::executePerRegion(std::forward<ExecutionPolicy>(policy),inImg,decompressBlock,inImg->getRegions(state->inMipLevel),clip);
+			outImg->setContentHash(IPreHashed::INVALID_HASH);
+			return success;
+		}
+		static inline bool execute(state_type* state)
+		{
+			return execute(core::execution::seq,state);
+		}
+};
+
+} // end namespace nbl::asset
+#endif
@@ -0,0 +1,546 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_STREAMING_MIP_MAP_GENERATION_IMAGE_FILTER_H_INCLUDED_
+#define _NBL_ASSET_C_STREAMING_MIP_MAP_GENERATION_IMAGE_FILTER_H_INCLUDED_
+
+#include "nbl/core/declarations.h"
+
+#include <functional>
+
+#include "nbl/asset/filters/CMipMapGenerationImageFilter.h"
+
+namespace nbl::asset
+{
+
+// Tiled variant of `CMipMapGenerationImageFilter` for images where the whole mip-chain (or even a single level) won't fit in memory.
+// Every mip level is produced from the previous one in output tiles, each tile being a separate `CBlitImageFilter` pass over the input region
+// the tile maps to. The texels outside a tile's input region which the kernel window touches are read from the previous level, so for levels
+// which downsample by an integer factor along an axis the result is identical to the monolithic filter. When a level's extent does not divide
+// evenly along an axis (NPOT images) the tiles span that whole axis, so the result stays exact at the cost of a larger tile.
+//
+// The levels are streamed along their slowest axis (rows for 1D and 2D images, slices for 3D), pulling rows of a level through the chain
+// only when the next level's tile row needs them. Unless `outImage` is provided, every level only keeps a band of rows around in a staging
+// image it allocates itself: enough for one tile row of the next level plus the kernel support, so the memory is proportional to the level's
+// width times the tile height instead of the level's size. Finished tiles of all levels get reported through `onTileWritten` as they are
+// written, interleaved between the levels, so the texels can be streamed out (virtual texture page bake, file writer, etc.).
+//
+// The first level (`startMipLevel-1`) is read from `inImage` (which may be backed by a memory mapped file through `ICPUBuffer`'s `adopt_memory`
+// creation), or from any other source through `readSource` which gets asked for the rows in order and only as they are needed.
+//
+// Because tiles are filtered independently, global normalizations and the coverage adjustment (`EAS_REFERENCE_OR_COVERAGE`) are not supported.
+// A `ETC_REPEAT` wrap (the default) along the slowest axis reads the other end of the level, so such levels get kept around whole, use any of
+// the clamping or mirroring modes along that axis if you need the memory bounded.
+template<typename Swizzle=VoidSwizzle, typename Dither=IdentityDither, typename Normalization=void, bool Clamp=true, typename BlitUtilities = CBlitUtilities<CChannelIndependentWeightFunction1D<CConvolutionWeightFunction1D<CWeightFunction1D<SKaiserFunction>, CWeightFunction1D<SMitchellFunction<>>>>>>
+class CStreamingMipMapGenerationImageFilter : public CImageFilter<CStreamingMipMapGenerationImageFilter<Swizzle,Dither,Normalization,Clamp,BlitUtilities>>, public CBasicImageFilterCommon
+{
+	public:
+		virtual ~CStreamingMipMapGenerationImageFilter() {}
+
+	private:
+		using state_base_t = typename CBlitImageFilterBase<Swizzle,Dither,Normalization,Clamp>::CStateBase;
+		using pseudo_base_t = CBlitImageFilter<Swizzle,Dither,Normalization,Clamp,BlitUtilities>;
+
+	public:
+		struct STileInfo
+		{
+			// image holding the freshly written texels, unless its the `outImage` its a staging image only holding a band of rows around the tile,
+			// which gets shifted and overwritten as the filter progresses so the texels need to be consumed or copied during the callback
+			const ICPUImage*	image = nullptr;
+			uint32_t			imageMipLevel = 0u;
+			uint32_t			imageBaseLayer = 0u;
+			// where the tile's texels are in `image`
+			VkOffset3D			imageOffset = {0u,0u,0u};
+			// where the tile sits in the logical mip-chain of the source
+			uint32_t			mipLevel = 0u;
+			uint32_t			baseLayer = 0u;
+			uint32_t			layerCount = 0u;
+			VkOffset3D			offset = {0u,0u,0u};
+			VkExtent3D			extent = {0u,0u,0u};
+		};
+		// A range of rows (slices for 3D images) of level `startMipLevel-1` which `readSource` needs to provide
+		struct SSourceRegion
+		{
+			// the extent spans the whole level along all but the slowest axis
+			VkOffset3D			offset = {0u,0u,0u};
+			VkExtent3D			extent = {0u,0u,0u};
+			uint32_t			baseLayer = 0u;
+			uint32_t			layerCount = 0u;
+			// tightly packed texels of the source format, consecutive layers are `layerStride` bytes apart
+			void*				dst = nullptr;
+			size_t				layerStride = 0ull;
+		};
+		class CState : public IImageFilter::IState, public state_base_t
+		{
+			public:
+				virtual ~CState() {}
+
+				uint32_t							baseLayer = 0u;
+				uint32_t							layerCount = 0u;
+				uint32_t							startMipLevel = 1u;
+				uint32_t							endMipLevel = 0u;
+				// only level `startMipLevel-1` needs to be present
+				ICPUImage*							inImage = nullptr;
+				// used instead of `inImage` when its null, `sourceParams` describe the image being read (extent of level 0, format, layers)
+				IImage::SCreationParams				sourceParams = {};
+				// gets called with increasing offsets and never for the same row twice, return false to abort the filter
+				std::function<bool(const SSourceRegion&)>	readSource = nullptr;
+				// optional, needs levels `[startMipLevel,endMipLevel)` and the same format, extent and layers as the source,
+				// if provided the levels get written there whole instead of streamed through staging bands
+				ICPUImage*							outImage = nullptr;
+				// extent of an output tile, input tiles will be this times the downsampling factor (plus the kernel support)
+				VkExtent3D							tileExtent = {256u,256u,1u};
+				// return false to abort the filter
+				std::function<bool(const STileInfo&)>	onTileWritten = nullptr;
+		};
+		using state_type = CState;
+
+		// the largest tile of any level determines the scratch, its allocated once and reused for all tiles
+		static inline uint32_t getRequiredScratchByteSize(const state_type* state)
+		{
+			// the blit only needs an image to know the type when sizing the scratch
+			core::smart_refctd_ptr<ICPUImage> prototype;
+			ICPUImage* typeImage = state->inImage;
+			if (!typeImage)
+			{
+				prototype = ICPUImage::create(state->sourceParams);
+				if (!prototype)
+					return 0u;
+				typeImage = prototype.get();
+			}
+			const auto& params = getSourceParams(state);
+			uint32_t retval = 0u;
+			for (auto outMipLevel=state->startMipLevel; outMipLevel<state->endMipLevel; outMipLevel++)
+			{
+				const auto tiling = computeLevelTiling(state,params,outMipLevel);
+				auto blit = buildBlitState(state,tiling,{0u,0u,0u},tiling.tileExtent,typeImage,0u,state->baseLayer,typeImage,0u,0u);
+				retval = core::max(retval,pseudo_base_t::getRequiredScratchByteSize(&blit));
+			}
+			return retval;
+		}
+
+		static inline bool validate(state_type* state)
+		{
+			if (!state)
+				return false;
+
+			if (auto* const inImage=state->inImage; inImage)
+			{
+				if (state->startMipLevel>inImage->getCreationParameters().mipLevels)
+					return false;
+			}
+			else if (!state->readSource || state->sourceParams.format==EF_UNKNOWN)
+				return false;
+			const auto& inParams = getSourceParams(state);
+
+			if (state->layerCount==0u || state->baseLayer+state->layerCount>inParams.arrayLayers)
+				return false;
+			if (state->startMipLevel==0u || state->startMipLevel>=state->endMipLevel)
+				return false;
+			if (state->endMipLevel>IImage::calculateFullMipPyramidLevelCount(inParams.extent,inParams.type))
+				return false;
+			if (state->tileExtent.width==0u || state->tileExtent.height==0u || state->tileExtent.depth==0u)
+				return false;
+
+			// tiles are filtered independently, anything needing statistics of the whole level can't work
+			if (!std::is_void_v<Normalization> || state->alphaSemantic==IBlitUtilities::EAS_REFERENCE_OR_COVERAGE)
+				return false;
+
+			// TODO: remove this later when we can actually write/encode to block formats
+			if (isBlockCompressionFormat(inParams.format))
+				return false;
+
+			if (auto* const outImage=state->outImage; outImage)
+			{
+				const auto& outParams = outImage->getCreationParameters();
+				if (outParams.format!=inParams.format || outParams.type!=inParams.type)
+					return false;
+				if (outParams.extent.width!=inParams.extent.width || outParams.extent.height!=inParams.extent.height || outParams.extent.depth!=inParams.extent.depth)
+					return false;
+				if (state->endMipLevel>outParams.mipLevels || state->baseLayer+state->layerCount>outParams.arrayLayers)
+					return false;
+			}
+
+			if (!state->scratchMemory || state->scratchMemoryByteSize<getRequiredScratchByteSize(state))
+				return false;
+			return true; // the blits check the kernel and the rest
+		}
+
+		template<class ExecutionPolicy>
+		static inline bool execute(ExecutionPolicy&& policy, state_type* state)
+		{
+			if (!validate(state))
+				return false;
+
+			SStream stream = {.state=state,.params=getSourceParams(state)};
+			stream.axis = stream.params.type==IImage::ET_3D ? 2u:1u;
+			// level `startMipLevel-1+i` lives in `stream.levels[i]` and is produced using `stream.tilings[i-1]`
+			const uint32_t levelCount = state->endMipLevel-state->startMipLevel+1u;
+			stream.levels.resize(levelCount);
+			stream.tilings.reserve(levelCount-1u);
+			for (auto outMipLevel=state->startMipLevel; outMipLevel!=state->endMipLevel; outMipLevel++)
+				stream.tilings.push_back(computeLevelTiling(state,stream.params,outMipLevel));
+			for (uint32_t i=0u; i<levelCount; i++)
+			{
+				auto& level = stream.levels[i];
+				const auto mipLevel = state->startMipLevel-1u+i;
+				level.extent = getLevelExtent(stream.params,mipLevel);
+				level.rows = level.extent[stream.axis];
+				ICPUImage* const wholeImage = i ? state->outImage:state->inImage;
+				if (wholeImage)
+				{
+					level.image = wholeImage;
+					level.mipLevel = mipLevel;
+					level.baseLayer = state->baseLayer;
+					level.capacity = level.rows;
+					// the input image is complete from the start
+					if (!i)
+						level.produced = level.rows;
+					continue;
+				}
+				// consumed either by the next level, or tile row by tile row by us
+				if (i+1u<levelCount)
+				{
+					level.capacity = getBandRows(stream,i+1u);
+					// the source gets read row by row but levels are produced a tile row at a time, so can overshoot what's needed
+					if (i)
+						level.capacity += stream.tilings[i-1u].tileExtent[stream.axis]-1u;
+					level.capacity = core::min(level.capacity,level.rows);
+				}
+				else
+					level.capacity = stream.tilings[i-1u].tileExtent[stream.axis];
+				auto bandExtent = level.extent;
+				bandExtent[stream.axis] = level.capacity;
+				level.staging = createStagingImage(state,stream.params,bandExtent);
+				if (!level.staging)
+					return false;
+				level.image = level.staging.get();
+			}
+
+			// pull the last level through tile row by tile row
+			auto& last = stream.levels.back();
+			const uint32_t lastTileRows = stream.tilings.back().tileExtent[stream.axis];
+			for (uint32_t row=0u; row<last.rows; row+=lastTileRows)
+			if (!ensureRows(policy,stream,levelCount-1u,row,core::min(row+lastTileRows,last.rows),false))
+				return false;
+
+			if (state->outImage)
+				state->outImage->setContentHash(IPreHashed::INVALID_HASH);
+			return true;
+		}
+		static inline bool execute(state_type* state)
+		{
+			return execute(core::execution::seq,state);
+		}
+
+	protected:
+		static inline const IImage::SCreationParams& getSourceParams(const state_type* state)
+		{
+			return state->inImage ? state->inImage->getCreationParameters():state->sourceParams;
+		}
+		// same as `IImage::getMipSize` but without needing an image
+		static inline core::vectorSIMDu32 getLevelExtent(const IImage::SCreationParams& params, const uint32_t level)
+		{
+			return core::max<core::vectorSIMDu32>(
+				core::vectorSIMDu32(params.extent.width,params.extent.height,params.extent.depth)/(0x1u<<level),
+				core::vectorSIMDu32(1u,1u,1u)
+			);
+		}
+
+		struct SLevelTiling
+		{
+			core::vectorSIMDu32	inLevelExtent;
+			core::vectorSIMDu32	outLevelExtent;
+			// integer downsampling factor per axis, 0 if the axis can't be tiled and has to be processed whole
+			uint32_t			ratio[3];
+			// the tile extent actually used for this level
+			core::vectorSIMDu32	tileExtent;
+		};
+		static inline SLevelTiling computeLevelTiling(const state_type* state, const IImage::SCreationParams& params, const uint32_t outMipLevel)
+		{
+			SLevelTiling retval;
+			retval.inLevelExtent = getLevelExtent(params,outMipLevel-1u);
+			retval.outLevelExtent = getLevelExtent(params,outMipLevel);
+			const uint32_t requestedTile[3] = {state->tileExtent.width,state->tileExtent.height,state->tileExtent.depth};
+			for (auto i=0; i<3; i++)
+			{
+				const uint32_t inSize = retval.inLevelExtent[i];
+				const uint32_t outSize = retval.outLevelExtent[i];
+				if (inSize%outSize)
+				{
+					retval.ratio[i] = 0u;
+					retval.tileExtent[i] = outSize;
+				}
+				else
+				{
+					retval.ratio[i] = inSize/outSize;
+					retval.tileExtent[i] = core::min(requestedTile[i],outSize);
+				}
+			}
+			return retval;
+		}
+
+		static inline auto buildBlitState(
+			const state_type* state, const SLevelTiling& tiling, const core::vectorSIMDu32& outTileOffset, const core::vectorSIMDu32& outTileExtent,
+			ICPUImage* srcImage, const uint32_t srcMipLevel, const uint32_t srcBaseLayer, ICPUImage* dstImage, const uint32_t dstMipLevel, const uint32_t dstBaseLayer
+		)
+		{
+			// the kernels get scaled by the ratio of the whole levels, same as the monolithic filter
+			const auto& inLevel = tiling.inLevelExtent;
+			const auto& outLevel = tiling.outLevelExtent;
+			auto convolutionKernels = pseudo_base_t::blit_utils_t::getConvolutionKernels(
+				hlsl::uint32_t3(inLevel.x,inLevel.y,inLevel.z),
+				hlsl::uint32_t3(outLevel.x,outLevel.y,outLevel.z)
+			);
+
+			uint32_t inOffset[3], inExtent[3];
+			for (auto i=0; i<3; i++)
+			{
+				if (tiling.ratio[i])
+				{
+					inOffset[i] = outTileOffset[i]*tiling.ratio[i];
+					inExtent[i] = outTileExtent[i]*tiling.ratio[i];
+				}
+				else
+				{
+					assert(outTileOffset[i]==0u && outTileExtent[i]==outLevel[i]);
+					inOffset[i] = 0u;
+					inExtent[i] = inLevel[i];
+				}
+			}
+
+			typename pseudo_base_t::state_type blit(std::move(convolutionKernels));
+			blit.inOffsetBaseLayer = hlsl::uint32_t4(inOffset[0],inOffset[1],inOffset[2],srcBaseLayer);
+			blit.inExtentLayerCount = hlsl::uint32_t4(inExtent[0],inExtent[1],inExtent[2],state->layerCount);
+			blit.outOffsetBaseLayer = hlsl::uint32_t4(outTileOffset.x,outTileOffset.y,outTileOffset.z,dstBaseLayer);
+			blit.outExtentLayerCount = hlsl::uint32_t4(outTileExtent.x,outTileExtent.y,outTileExtent.z,state->layerCount);
+			blit.inMipLevel = srcMipLevel;
+			blit.outMipLevel = dstMipLevel;
+			blit.inImage = srcImage;
+			blit.outImage = dstImage;
+			static_cast<state_base_t&>(blit) = *static_cast<const state_base_t*>(state);
+			return blit;
+		}
+
+		struct SLevel
+		{
+			// the image the level gets read from and written to, the staging only holds rows `[base,base+capacity)` of the level
+			ICPUImage*							image = nullptr;
+			core::smart_refctd_ptr<ICPUImage>	staging = nullptr;
+			uint32_t							mipLevel = 0u;
+			uint32_t							baseLayer = 0u;
+			core::vectorSIMDu32					extent;
+			// along the streaming axis
+			uint32_t							rows = 0u;
+			uint32_t							capacity = 0u;
+			uint32_t							base = 0u;
+			// rows `[0,produced)` have been written
+			uint32_t							produced = 0u;
+		};
+		struct SStream
+		{
+			const state_type*			state;
+			IImage::SCreationParams		params;
+			uint32_t					axis = 1u;
+			core::vector<SLevelTiling>	tilings = {};
+			core::vector<SLevel>		levels = {};
+		};
+		struct SInputRows
+		{
+			// clamped to the level
+			uint32_t	begin;
+			uint32_t	end;
+			// whether the kernel reads past the end of the level
+			bool		pastEnd;
+		};
+		// the rows of level `i-1` which producing rows `[rowOffset,rowOffset+rowExtent)` of level `i` reads or covers, unclamped
+		static inline std::pair<int64_t,int64_t> getUnclampedInputRows(const SStream& stream, const uint32_t i, const uint32_t rowOffset, const uint32_t rowExtent)
+		{
+			const auto& tiling = stream.tilings[i-1u];
+			const auto axis = stream.axis;
+			if (stream.params.type==IImage::ET_1D)
+				return {0ll,1ll};
+			// `REPEAT` wraps around to the other end of the level
+			if (!tiling.ratio[axis] || stream.state->axisWraps[axis]==ISampler::E_TEXTURE_CLAMP::ETC_REPEAT)
+				return {0ll,static_cast<int64_t>(tiling.inLevelExtent[axis])};
+
+			core::vectorSIMDu32 tileOffset(0u,0u,0u), tileExtent = tiling.outLevelExtent;
+			tileOffset[axis] = rowOffset;
+			tileExtent[axis] = rowExtent;
+			const auto blit = buildBlitState(stream.state,tiling,tileOffset,tileExtent,nullptr,0u,0u,nullptr,0u,0u);
+			// exactly what the blit does to find the input window of the first output texel
+			const float halfTexelOffset = static_cast<float>(double(blit.inExtentLayerCount[axis])/double(blit.outExtentLayerCount[axis]))*0.5f;
+			const int32_t windowMinCoord = axis==2u ? std::get<2>(blit.kernels).getWindowMinCoord(halfTexelOffset):std::get<1>(blit.kernels).getWindowMinCoord(halfTexelOffset);
+			const int32_t windowSize = pseudo_base_t::blit_utils_t::getWindowSize(stream.params.type,blit.kernels)[axis];
+			const int64_t inBegin = blit.inOffsetBaseLayer[axis];
+			const int64_t inEnd = inBegin+blit.inExtentLayerCount[axis];
+			const int64_t windowBegin = inBegin+windowMinCoord;
+			// a kernel narrower than the downsampling factor skips rows, they still need to be produced (and reported) in order
+			return {core::min(windowBegin,inBegin),core::max(windowBegin+blit.inExtentLayerCount[axis]+windowSize,inEnd)};
+		}
+		static inline SInputRows getInputRows(const SStream& stream, const uint32_t i, const uint32_t rowOffset, const uint32_t rowExtent)
+		{
+			const auto [begin,end] = getUnclampedInputRows(stream,i,rowOffset,rowExtent);
+			const int64_t inRows = stream.levels[i-1u].rows;
+			return {static_cast<uint32_t>(core::max<int64_t>(begin,0ll)),static_cast<uint32_t>(core::min<int64_t>(end,inRows)),end>inRows};
+		}
+		// how many rows of level `i-1` does a whole tile row of level `i` need
+		static inline uint32_t getBandRows(const SStream& stream, const uint32_t i)
+		{
+			const auto [begin,end] = getUnclampedInputRows(stream,i,0u,stream.tilings[i-1u].tileExtent[stream.axis]);
+			return static_cast<uint32_t>(core::min<int64_t>(end-begin,stream.levels[i-1u].rows));
+		}
+
+		// makes rows `[begin,end)` of level `i` available in its image, dropping the rows before `begin` from staging bands
+		template<class ExecutionPolicy>
+		static inline bool ensureRows(ExecutionPolicy&& policy, SStream& stream, const uint32_t i, const uint32_t begin, const uint32_t end, const bool pastEnd)
+		{
+			auto& level = stream.levels[i];
+			if (level.staging)
+			{
+				// a band holding the whole level never moves, otherwise the kernel reading past the end of the level needs the last row at the end
+				// of the band, so that the wrapping or clamping the blit does against the image extent matches what it would do on the whole level
+				uint32_t newBase = begin;
+				if (level.capacity==level.rows)
+					newBase = 0u;
+				else if (pastEnd)
+					newBase = level.rows-level.capacity;
+				assert(newBase<=begin && end-newBase<=level.capacity && begin<=level.produced);
+				if (newBase!=level.base && level.produced>begin)
+				{
+					assert(begin>=level.base);
+					const size_t rowSize = getRowSize(stream,level);
+					auto* const data = reinterpret_cast<uint8_t*>(level.staging->getBuffer()->getPointer());
+					for (uint32_t layer=0u; layer<stream.state->layerCount; layer++)
+					{
+						auto* const layerData = data+rowSize*level.capacity*layer;
+						memmove(layerData+rowSize*(begin-newBase),layerData+rowSize*(begin-level.base),rowSize*(level.produced-begin));
+					}
+				}
+				level.base = newBase;
+			}
+
+			while (level.produced<end)
+			{
+				if (i)
+				{
+					if (!produceRows(policy,stream,i,level.produced))
+						return false;
+					continue;
+				}
+				// only the first level can be read from a source
+				const size_t rowSize = getRowSize(stream,level);
+				SSourceRegion region = {};
+				core::vectorSIMDu32 offset(0u,0u,0u), extent = level.extent;
+				offset[stream.axis] = level.produced;
+				extent[stream.axis] = end-level.produced;
+				region.offset = {static_cast<int32_t>(offset.x),static_cast<int32_t>(offset.y),static_cast<int32_t>(offset.z)};
+				region.extent = {extent.x,extent.y,extent.z};
+				region.baseLayer = stream.state->baseLayer;
+				region.layerCount = stream.state->layerCount;
+				region.dst = reinterpret_cast<uint8_t*>(level.staging->getBuffer()->getPointer())+rowSize*(level.produced-level.base);
+				region.layerStride = rowSize*level.capacity;
+				if (!stream.state->readSource(region))
+					return false;
+				level.produced = end;
+			}
+			return true;
+		}
+		// writes the tile row starting at `rowOffset` of level `i`
+		template<class ExecutionPolicy>
+		static inline bool produceRows(ExecutionPolicy&& policy, SStream& stream, const uint32_t i, const uint32_t rowOffset)
+		{
+			const auto* const state = stream.state;
+			const auto axis = stream.axis;
+			const auto& tiling = stream.tilings[i-1u];
+			auto& src = stream.levels[i-1u];
+			auto& dst = stream.levels[i];
+			const uint32_t rowExtent = core::min(tiling.tileExtent[axis],dst.rows-rowOffset);
+
+			const auto inputRows = getInputRows(stream,i,rowOffset,rowExtent);
+			if (!ensureRows(policy,stream,i-1u,inputRows.begin,inputRows.end,inputRows.pastEnd))
+				return false;
+
+			core::vectorSIMDu32 begin(0u,0u,0u), end = tiling.outLevelExtent, step = tiling.tileExtent;
+			begin[axis] = rowOffset;
+			end[axis] = rowOffset+rowExtent;
+			step[axis] = rowExtent;
+			for (uint32_t z=begin.z; z<end.z; z+=step.z)
+			for (uint32_t y=begin.y; y<end.y; y+=step.y)
+			for (uint32_t x=begin.x; x<end.x; x+=step.x)
+			{
+				const core::vectorSIMDu32 tileOffset(x,y,z);
+				const core::vectorSIMDu32 tileExtent = core::min<core::vectorSIMDu32>(step,end-tileOffset);
+				auto blit = buildBlitState(state,tiling,tileOffset,tileExtent,src.image,src.mipLevel,src.baseLayer,dst.image,dst.mipLevel,dst.baseLayer);
+				// bands only hold some rows
+				blit.inOffsetBaseLayer[axis] -= src.base;
+				blit.outOffsetBaseLayer[axis] -= dst.base;
+				if (!blit.recomputeScaledKernelPhasedLUT())
+					return false;
+				if (!pseudo_base_t::template execute<ExecutionPolicy>(std::forward<ExecutionPolicy>(policy),&blit))
+					return false;
+
+				if (state->onTileWritten)
+				{
+					STileInfo info;
+					info.image = dst.image;
+					info.imageMipLevel = dst.mipLevel;
+					info.imageBaseLayer = dst.baseLayer;
+					info.imageOffset = {static_cast<int32_t>(blit.outOffsetBaseLayer.x),static_cast<int32_t>(blit.outOffsetBaseLayer.y),static_cast<int32_t>(blit.outOffsetBaseLayer.z)};
+					info.mipLevel = state->startMipLevel-1u+i;
+					info.baseLayer = state->baseLayer;
+					info.layerCount = state->layerCount;
+					info.offset = {static_cast<int32_t>(x),static_cast<int32_t>(y),static_cast<int32_t>(z)};
+					info.extent = {tileExtent.x,tileExtent.y,tileExtent.z};
+					if (!state->onTileWritten(info))
+						return false;
+				}
+			}
+			dst.produced = rowOffset+rowExtent;
+			return true;
+		}
+
+		// bytes between consecutive rows (slices for 3D) of a level in its staging band
+		static inline size_t getRowSize(const SStream& stream, const SLevel& level)
+		{
+			size_t retval = getTexelOrBlockBytesize(stream.params.format)*level.extent.x;
+			if (stream.axis==2u)
+				retval *= level.extent.y;
+			return retval;
+		}
+
+		static inline core::smart_refctd_ptr<ICPUImage> createStagingImage(const state_type* state, const IImage::SCreationParams& sourceParams, const core::vectorSIMDu32& extent)
+		{
+			auto params = sourceParams;
+			params.flags = IImage::ECF_NONE;
+			params.extent = {extent.x,extent.y,extent.z};
+			params.mipLevels = 1u;
+			params.arrayLayers = state->layerCount;
+			auto image = ICPUImage::create(std::move(params));
+			if (!image)
+				return nullptr;
+
+			const auto texelBlockSize = getTexelOrBlockBytesize(image->getCreationParameters().format);
+			auto buffer = ICPUBuffer::create({static_cast<size_t>(texelBlockSize)*extent.x*extent.y*extent.z*state->layerCount});
+			if (!buffer)
+				return nullptr;
+
+			IImage::SBufferCopy region = {};
+			region.bufferOffset = 0u;
+			region.bufferRowLength = extent.x;
+			region.bufferImageHeight = extent.y;
+			region.imageSubresource.aspectMask = IImage::EAF_COLOR_BIT;
+			region.imageSubresource.mipLevel = 0u;
+			region.imageSubresource.baseArrayLayer = 0u;
+			region.imageSubresource.layerCount = state->layerCount;
+			region.imageOffset = {0u,0u,0u};
+			region.imageExtent = {extent.x,extent.y,extent.z};
+			if (!image->setBufferAndRegions(std::move(buffer),core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(1ull,region)))
+				return nullptr;
+			return image;
+		}
+};
+
+} // end namespace nbl::asset
+
+#endif
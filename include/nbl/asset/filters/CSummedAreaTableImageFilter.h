@@ -9,6 +9,7 @@
 
 #include <type_traits>
 #include <functional>
+#include <numeric>
 
 #include "nbl/asset/filters/CMatchedSizeInOutImageFilterCommon.h"
 #include "CConvertFormatImageFilter.h"
@@ -22,22 +23,43 @@ template<bool ExclusiveMode>
 class CSummedAreaTableImageFilterBase
 {
 	public:
+		//! the table is computed with a blocked scan, lines get split into tiles of this many texels which are scanned independently
+		static inline constexpr uint32_t ScanTileSize = 256u;
+		//! when scanning along Y or Z this many neighbouring lines are processed together, so memory gets walked contiguously
+		static inline constexpr uint32_t ScanLineBatch = 64u;
+
 		class CSummStateBase
 		{
 			public:
+				enum E_ACCUMULATION : uint8_t
+				{
+					EA_FLOAT64 = 0,				//!< double precision scratch and sums
+					EA_FLOAT32,					//!< single precision scratch and sums, halves the scratch memory at the cost of precision on large images
+					EA_FLOAT32_COMPENSATED		//!< single precision scratch with Kahan compensated sums, gets close to `EA_FLOAT64` results
+				};
 
 				static inline constexpr size_t decodeTypeByteSize = sizeof(double);
 				uint8_t*	scratchMemory = nullptr;										//!< memory covering all regions used for temporary filling within computation of sum values
 				size_t	scratchMemoryByteSize = {};											//!< required byte size for entire scratch memory
 				bool normalizeImageByTotalSATValues = false;								//!< after sum performation division will be performed for the entire image by the max sum values in (maxX, 0, z) depending on input image - needed for UNORM and SNORM
 				uint8_t axesToSum = 0u;														//!< which axes you want to sum; X: bit0, Y: bit1, Z: bit2 // TODO: make ALL_AXES the default and make sure examples using it work as expected.
+				E_ACCUMULATION accumulation = EA_FLOAT64;									//!< precision of the accumulation, ignored for integer formats which always sum in 64bit integers
 
-				static inline size_t getRequiredScratchByteSize(const ICPUImage* inputImage, asset::VkExtent3D extent)
+				static inline size_t getRequiredScratchByteSize(const ICPUImage* inputImage, asset::VkExtent3D extent, const E_ACCUMULATION accumulation=EA_FLOAT64)
 				{
 					const auto& inputCreationParams = inputImage->getCreationParameters();
 					const auto channels = asset::getFormatChannelCount(inputCreationParams.format);
+					const size_t accumulationByteSize = accumulation==EA_FLOAT64 || asset::isIntegerFormat(inputCreationParams.format) ? decodeTypeByteSize:sizeof(float);
 
-					size_t retval = extent.width * extent.height * extent.depth * channels * decodeTypeByteSize;
+					const size_t texelCount = size_t(extent.width) * extent.height * extent.depth;
+					size_t retval = texelCount * channels * accumulationByteSize;
+
+					// plus the tile totals of the blocked scan, for whichever axis needs the most
+					size_t maxTileTotals = 0ull;
+					for (const uint32_t lineLength : {extent.width,extent.height,extent.depth})
+					if (lineLength)
+						maxTileTotals = core::max<size_t>(maxTileTotals,(texelCount/lineLength)*((lineLength+ScanTileSize-1u)/ScanTileSize));
+					retval += maxTileTotals * channels * accumulationByteSize;
 					
 					return retval;
 				}
@@ -52,7 +74,126 @@ class CSummedAreaTableImageFilterBase
 			if (!state)
 				return false;
 
-			return true;
+			return state->accumulation<=CSummStateBase::EA_FLOAT32_COMPENSATED;
+		}
+
+		template<bool CompensatedSum, typename T>
+		static inline void accumulate(T& sum, T& compensation, const T value)
+		{
+			if constexpr (CompensatedSum)
+			{
+				const T y = value-compensation;
+				const T t = sum+y;
+				compensation = (t-sum)-y;
+				sum = t;
+			}
+			else
+				sum += value;
+		}
+
+		//! Inclusive prefix sum of a tightly packed `extent` sized scratch along `axis`
+		/*
+			First every tile of `ScanTileSize` texels of every line gets scanned on its own and its total recorded,
+			then the tile totals of each line get an exclusive scan, and finally the totals get added to all texels
+			of their tiles. All three passes are independent per tile or line, so they run under `policy`.
+		*/
+		template<bool CompensatedSum, class ExecutionPolicy, typename accumulation_t>
+		static inline void scanAxis(ExecutionPolicy&& policy, accumulation_t* scratch, accumulation_t* tileTotals, const uint32_t channels, const core::vectorSIMDu32& extent, const uint32_t axis)
+		{
+			const uint32_t lineLength = extent[axis];
+			if (lineLength<2u)
+				return;
+
+			const size_t texelStrides[3] = {1ull,extent.x,size_t(extent.x)*extent.y};
+			const size_t axisStride = texelStrides[axis]*channels;
+			// the other two axes enumerate the lines, the first of them is the one batched over
+			const uint32_t lineAxes[2] = {axis==0u ? 1u:0u,axis==2u ? 1u:2u};
+			const uint32_t batchSize = axis ? core::min(ScanLineBatch,extent[lineAxes[0]]):1u;
+			const uint32_t batchesPerRow = (extent[lineAxes[0]]+batchSize-1u)/batchSize;
+			const uint32_t batchCount = batchesPerRow*extent[lineAxes[1]];
+			const uint32_t lineCount = extent[lineAxes[0]]*extent[lineAxes[1]];
+			const uint32_t tileCount = (lineLength+ScanTileSize-1u)/ScanTileSize;
+
+			auto getLine = [&](const uint32_t a, const uint32_t b) -> accumulation_t*
+			{
+				return scratch+(a*texelStrides[lineAxes[0]]+b*texelStrides[lineAxes[1]])*channels;
+			};
+			auto getTileTotal = [&](const uint32_t line, const uint32_t tile) -> accumulation_t*
+			{
+				return tileTotals+(size_t(line)*tileCount+tile)*channels;
+			};
+
+			struct SJob
+			{
+				uint32_t b, aBegin, aEnd;
+				uint32_t tile;
+			};
+			auto getJob = [&](const uint32_t job) -> SJob
+			{
+				const uint32_t batch = job/tileCount;
+				const uint32_t aBegin = (batch%batchesPerRow)*batchSize;
+				return {batch/batchesPerRow,aBegin,core::min(aBegin+batchSize,extent[lineAxes[0]]),job%tileCount};
+			};
+
+			core::vector<uint32_t> jobs(batchCount*tileCount);
+			std::iota(jobs.begin(),jobs.end(),0u);
+			std::for_each(policy,jobs.begin(),jobs.end(),[&](const uint32_t jobIx) -> void
+			{
+				const SJob job = getJob(jobIx);
+				const uint32_t end = core::min((job.tile+1u)*ScanTileSize,lineLength);
+
+				accumulation_t sums[ScanLineBatch][4] = {};
+				accumulation_t compensations[ScanLineBatch][4] = {};
+				for (uint32_t i=job.tile*ScanTileSize; i<end; i++)
+				for (uint32_t a=job.aBegin; a<job.aEnd; a++)
+				{
+					accumulation_t* texel = getLine(a,job.b)+i*axisStride;
+					for (uint32_t c=0u; c<channels; c++)
+					{
+						accumulate<CompensatedSum>(sums[a-job.aBegin][c],compensations[a-job.aBegin][c],texel[c]);
+						texel[c] = sums[a-job.aBegin][c];
+					}
+				}
+				for (uint32_t a=job.aBegin; a<job.aEnd; a++)
+					std::copy_n(sums[a-job.aBegin],channels,getTileTotal(job.b*extent[lineAxes[0]]+a,job.tile));
+			});
+
+			if (tileCount<2u)
+				return;
+
+			core::vector<uint32_t> lines(lineCount);
+			std::iota(lines.begin(),lines.end(),0u);
+			std::for_each(policy,lines.begin(),lines.end(),[&](const uint32_t line) -> void
+			{
+				accumulation_t sums[4] = {};
+				accumulation_t compensations[4] = {};
+				for (uint32_t tile=0u; tile<tileCount; tile++)
+				{
+					accumulation_t* total = getTileTotal(line,tile);
+					for (uint32_t c=0u; c<channels; c++)
+					{
+						const accumulation_t tileTotal = total[c];
+						total[c] = sums[c];
+						accumulate<CompensatedSum>(sums[c],compensations[c],tileTotal);
+					}
+				}
+			});
+
+			std::for_each(policy,jobs.begin(),jobs.end(),[&](const uint32_t jobIx) -> void
+			{
+				const SJob job = getJob(jobIx);
+				if (job.tile==0u)
+					return;
+				const uint32_t end = core::min((job.tile+1u)*ScanTileSize,lineLength);
+				for (uint32_t i=job.tile*ScanTileSize; i<end; i++)
+				for (uint32_t a=job.aBegin; a<job.aEnd; a++)
+				{
+					const accumulation_t* offset = getTileTotal(job.b*extent[lineAxes[0]]+a,job.tile);
+					accumulation_t* texel = getLine(a,job.b)+i*axisStride;
+					for (uint32_t c=0u; c<channels; c++)
+						texel[c] += offset[c];
+				}
+			});
 		}
 };
 
@@ -94,7 +235,7 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 			const auto inFormat = inParams.format;
 			const auto outFormat = outParams.format;
 
-			if (state->scratchMemoryByteSize < state_type::getRequiredScratchByteSize(state->inImage, state->extent))
+			if (state->scratchMemoryByteSize < state_type::getRequiredScratchByteSize(state->inImage, state->extent, state->accumulation))
 				return false;
 			
 			if (state->axesToSum == 0u)
@@ -115,11 +256,19 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 			if (!validate(state))
 				return false;
 
+			using base_t = CSummedAreaTableImageFilterBase<ExclusiveMode>;
 			auto checkFormat = state->inImage->getCreationParameters().format;
 			if (isIntegerFormat(checkFormat))
-				return executeInterprated(std::forward<ExecutionPolicy>(policy), state, reinterpret_cast<uint64_t*>(state->scratchMemory));
-			else
-				return executeInterprated(std::forward<ExecutionPolicy>(policy), state, reinterpret_cast<double*>(state->scratchMemory));
+				return executeInterprated<false,uint64_t>(std::forward<ExecutionPolicy>(policy), state, reinterpret_cast<uint64_t*>(state->scratchMemory));
+			switch (state->accumulation)
+			{
+				case base_t::CSummStateBase::EA_FLOAT32:
+					return executeInterprated<false,double>(std::forward<ExecutionPolicy>(policy), state, reinterpret_cast<float*>(state->scratchMemory));
+				case base_t::CSummStateBase::EA_FLOAT32_COMPENSATED:
+					return executeInterprated<true,double>(std::forward<ExecutionPolicy>(policy), state, reinterpret_cast<float*>(state->scratchMemory));
+				default:
+					return executeInterprated<false,double>(std::forward<ExecutionPolicy>(policy), state, reinterpret_cast<double*>(state->scratchMemory));
+			}
 		}	
 		static inline bool execute(state_type* state)
 		{
@@ -128,15 +277,13 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 
 	private:
 
-		template<class ExecutionPolicy, typename decodeType> //!< double or uint64_t
-		static inline bool executeInterprated(ExecutionPolicy&& policy, state_type* state, decodeType* scratchMemory)
+		template<bool CompensatedSum, typename decodeType, class ExecutionPolicy, typename accumulationType> //!< decodeType is double or uint64_t, accumulationType is the same or float
+		static inline bool executeInterprated(ExecutionPolicy&& policy, state_type* state, accumulationType* scratchMemory)
 		{
+			using base_t = CSummedAreaTableImageFilterBase<ExclusiveMode>;
 			const asset::E_FORMAT inFormat = state->inImage->getCreationParameters().format;
 			const asset::E_FORMAT outFormat = state->outImage->getCreationParameters().format;
-			const auto inTexelByteSize = asset::getTexelOrBlockBytesize(inFormat);
-			const auto outTexelByteSize = asset::getTexelOrBlockBytesize(outFormat);
 			const auto currentChannelCount = asset::getFormatChannelCount(inFormat);
-			const auto arrayLayers = state->inImage->getCreationParameters().arrayLayers;
 			static constexpr auto maxChannels = 4u;
 
 			#ifdef _NBL_DEBUG
@@ -145,31 +292,33 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 
 			const core::vector3du32_SIMD scratchByteStrides = [&]()
 			{
-				const core::vectorSIMDu32 trueExtent = state->extentLayerCount;
-
-				switch (currentChannelCount)
+				constexpr asset::E_FORMAT scratchFormats[2][maxChannels] =
 				{
-					case 1:
-					{
-						return TexelBlockInfo(asset::E_FORMAT::EF_R64_SFLOAT).convert3DTexelStridesTo1DByteStrides(trueExtent);
-					}
-
-					case 2:
-					{
-						return TexelBlockInfo(asset::E_FORMAT::EF_R64G64_SFLOAT).convert3DTexelStridesTo1DByteStrides(trueExtent);
-					}
-
-					case 3:
-					{
-						return TexelBlockInfo(asset::E_FORMAT::EF_R64G64B64_SFLOAT).convert3DTexelStridesTo1DByteStrides(trueExtent);
-					}
-					case 4:
-					{
-						return TexelBlockInfo(asset::E_FORMAT::EF_R64G64B64A64_SFLOAT).convert3DTexelStridesTo1DByteStrides(trueExtent);
-					}
-				}
+					{asset::EF_R32_SFLOAT,asset::EF_R32G32_SFLOAT,asset::EF_R32G32B32_SFLOAT,asset::EF_R32G32B32A32_SFLOAT},
+					{asset::EF_R64_SFLOAT,asset::EF_R64G64_SFLOAT,asset::EF_R64G64B64_SFLOAT,asset::EF_R64G64B64A64_SFLOAT}
+				};
+				const core::vectorSIMDu32 trueExtent = state->extentLayerCount;
+				return TexelBlockInfo(scratchFormats[sizeof(accumulationType)==sizeof(double)][currentChannelCount-1u]).convert3DTexelStridesTo1DByteStrides(trueExtent);
 			}();
 			const auto scratchTexelByteSize = scratchByteStrides[0];
+			// tile totals of the blocked scan live right after the texels
+			accumulationType* const tileTotals = reinterpret_cast<accumulationType*>(reinterpret_cast<uint8_t*>(scratchMemory) + scratchByteStrides[3]);
+
+			auto getScratchPixel = [&](const core::vector3du32_SIMD& localCoord) -> accumulationType*
+			{
+				const size_t scratchOffset = asset::IImage::SBufferCopy::getLocalByteOffset(core::vector3du32_SIMD(localCoord.x, localCoord.y, localCoord.z, 0), scratchByteStrides);
+				return reinterpret_cast<accumulationType*>(reinterpret_cast<uint8_t*>(scratchMemory) + scratchOffset);
+			};
+			// runs `f` for every scratch row, in parallel
+			core::vector<uint32_t> rows(state->extent.height * state->extent.depth);
+			std::iota(rows.begin(), rows.end(), 0u);
+			auto executePerRow = [&](auto&& f) -> void
+			{
+				std::for_each(policy, rows.begin(), rows.end(), [&](const uint32_t row) -> void
+				{
+					f(row, getScratchPixel(core::vector3du32_SIMD(0u, row % state->extent.height, row / state->extent.height)));
+				});
+			};
 
 			const auto&& [copyInBaseLayer, copyOutBaseLayer, copyLayerCount] = std::make_tuple(state->inBaseLayer, state->outBaseLayer, state->layerCount);
 			state->layerCount = 1u;
@@ -184,8 +333,8 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 
 			for (uint16_t w = 0u; w < copyLayerCount; ++w) // this could be parallelized
 			{
-				std::array<decodeType, maxChannels> minDecodeValues = {};
-				std::array<decodeType, maxChannels> maxDecodeValues = {};
+				std::array<accumulationType, maxChannels> minDecodeValues = {};
+				std::array<accumulationType, maxChannels> maxDecodeValues = {};
 
 				{
 					const uint8_t* inData = reinterpret_cast<const uint8_t*>(state->inImage->getBuffer()->getPointer());
@@ -202,6 +351,13 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 					const core::vectorSIMDu32 limit(1, is2DAndBelow, is3DAndBelow);
 					const core::vectorSIMDu32 movingExclusiveVector = limit, movingOnYZorXZorXYCheckingVector = limit;
 
+					auto storeDecoded = [&](const core::vector3du32_SIMD& localCoord, const decodeType* decodeBuffer) -> void
+					{
+						accumulationType* scratchPixel = getScratchPixel(localCoord);
+						for (auto i = 0; i < currentChannelCount; ++i)
+							scratchPixel[i] = static_cast<accumulationType>(decodeBuffer[i]);
+					};
+
 					auto decode = [&](uint32_t readBlockArrayOffset, core::vectorSIMDu32 readBlockPos) -> void
 					{
 						core::vectorSIMDu32 localOutPos = readBlockPos * blockDims - core::vectorSIMDu32(state->inOffset.x, state->inOffset.y, state->inOffset.z);
@@ -222,8 +378,7 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 									for (auto blockX = 0u; blockX < blockDims.x; blockX++)
 									{
 										asset::decodePixelsRuntime(inFormat, inSourcePixels, decodeBuffer, blockX, blockY);
-										const size_t movedOffset = asset::IImage::SBufferCopy::getLocalByteOffset(core::vector3du32_SIMD(movedLocalOutPos.x + blockX, movedLocalOutPos.y + blockY, movedLocalOutPos.z), scratchByteStrides);
-										memcpy(reinterpret_cast<uint8_t*>(scratchMemory) + movedOffset, decodeBuffer, scratchTexelByteSize);
+										storeDecoded(core::vector3du32_SIMD(movedLocalOutPos.x + blockX, movedLocalOutPos.y + blockY, movedLocalOutPos.z), decodeBuffer);
 									}
 							}
 						}
@@ -234,8 +389,7 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 								for (auto blockX = 0u; blockX < blockDims.x; blockX++)
 								{
 									asset::decodePixelsRuntime(inFormat, inSourcePixels, decodeBuffer, blockX, blockY);
-									const size_t offset = asset::IImage::SBufferCopy::getLocalByteOffset(core::vector3du32_SIMD(localOutPos.x + blockX, localOutPos.y + blockY, localOutPos.z), scratchByteStrides);
-									memcpy(reinterpret_cast<uint8_t*>(scratchMemory) + offset, decodeBuffer, scratchTexelByteSize);
+									storeDecoded(core::vector3du32_SIMD(localOutPos.x + blockX, localOutPos.y + blockY, localOutPos.z), decodeBuffer);
 								}
 						}
 					};
@@ -249,138 +403,61 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 
 					if constexpr (ExclusiveMode)
 					{
-						core::vector3du32_SIMD localCoord;
-						for (auto& z = localCoord[2] = 0u; z < state->extent.depth; ++z) // TODO: parallelize
-							for (auto& y = localCoord[1] = 0u; y < state->extent.height; ++y)
-								for (auto& x = localCoord[0] = 0u; x < state->extent.width; ++x)
-								{
-									auto resetSATMemory = [&](const core::vector3du32_SIMD& position)
-									{
-										const size_t offset = asset::IImage::SBufferCopy::getLocalByteOffset(position, scratchByteStrides);
-										memset(reinterpret_cast<uint8_t*>(scratchMemory) + offset, 0, scratchTexelByteSize);
-									};
-
-									const auto doesItMoveOnYZorXZorXY = (localCoord < movingOnYZorXZorXYCheckingVector);
-									if (doesItMoveOnYZorXZorXY.any())
-										resetSATMemory(localCoord);
-								}
+						executePerRow([&](const uint32_t row, accumulationType* rowScratch) -> void
+						{
+							const core::vectorSIMDu32 rowCoord(0u, row % state->extent.height, row / state->extent.height);
+							// whole row is on the bottom or back plane
+							if ((rowCoord < movingOnYZorXZorXYCheckingVector).yzzz().any())
+								memset(rowScratch, 0, scratchTexelByteSize * state->extent.width);
+							else
+								memset(rowScratch, 0, scratchTexelByteSize);
+						});
 					}
 				}
 
 				{
-					auto getScratchPixel = [&](core::vector4di32_SIMD readBlockPos) -> decodeType*
-					{
-						const size_t scratchOffset = asset::IImage::SBufferCopy::getLocalByteOffset(core::vector3du32_SIMD(readBlockPos.x, readBlockPos.y, readBlockPos.z, 0), scratchByteStrides);
-						return reinterpret_cast<decodeType*>(reinterpret_cast<uint8_t*>(scratchMemory) + scratchOffset);
-					};
+					// summing each selected axis separately gives the same table as inclusion-exclusion over the neighbours
+					for (uint32_t axis = 0u; axis < 3u; ++axis)
+					if ((state->axesToSum >> axis) & 0x1u)
+						base_t::template scanAxis<CompensatedSum>(policy, scratchMemory, tileTotals, currentChannelCount, state->extentLayerCount, axis);
 
-					auto sum = [&](core::vectorSIMDi32 readBlockPos) -> void
+					bool normalized = asset::isNormalizedFormat(inFormat);
+					if (state->normalizeImageByTotalSATValues || normalized)
 					{
-						decodeType* current = getScratchPixel(readBlockPos);
-
-						auto areAxisSafe = [&]()
-						{
-							const auto position = core::vectorSIMDi32(0u, 0u, 0u, 0u);
-
-							const bool shouldSumX = (state->axesToSum >> 0) & 0x1u;
-							const bool shouldSumY = (state->axesToSum >> 1) & 0x1u;
-							const bool shouldSumZ = (state->axesToSum >> 2) & 0x1u;
-
-							return core::vector4du32_SIMD
-							(
-								(readBlockPos.x > position.x) && (shouldSumX),
-								(readBlockPos.y > position.y) && (shouldSumY),
-								(readBlockPos.z > position.z) && (shouldSumZ),
-								(readBlockPos.w > position.w)
-							);
-						};
-
-						auto addScratchPixelToCurrentOne = [&](const decodeType* values)
+						core::vector<std::array<accumulationType, maxChannels * 2u>> rowMinMax(rows.size());
+						executePerRow([&](const uint32_t row, const accumulationType* rowScratch) -> void
 						{
-							for (auto i = 0; i < currentChannelCount; ++i)
-								current[i] += values[i];
-						};
-						
-						auto substractScratchPixelFromCurrentOne = [&](const decodeType* values)
-						{
-							for (auto i = 0; i < currentChannelCount; ++i)
-								current[i] -= values[i];
-						};
-
-						const auto axisSafe = areAxisSafe();
-
-						if (axisSafe.z)
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 0, 1, 0)));					// add box x<=current_x && y<=current_y && z<current_z
-						if (axisSafe.y)
-						{
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 1, 0, 0)));					// add box x<=current_x && y<current_y && z<=current_z
-							if (axisSafe.z)
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(0, 1, 1, 0)));		// remove overlap box x<=current_x && y<current_y && z<current_z
-						}
-
-						/*
-							Now I have the sum of all layers below me in the bound x<=current_x && y<=current_y && z<current_z and the current pixel.
-							Time to add the missing top layer pixels.
-						*/
-
-						if (axisSafe.x)
-						{
-							addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 0, 0, 0)));					 // add box x<current_x && y<=current_y && z<=current_z
-							if (axisSafe.z)
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 0, 1, 0)));		 // remove overlap box x<current_x && y<=current_y && z<current_z
-							if (axisSafe.y)
+							auto& minMax = rowMinMax[row];
+							std::fill(minMax.begin(), minMax.end(), accumulationType(0));
+							for (uint32_t x = 0u; x < state->extent.width; ++x, rowScratch += currentChannelCount)
+							for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
 							{
-								substractScratchPixelFromCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 1, 0, 0)));		 // remove future overlap box x<current_x && y<current_y && z<=current_z
-								if (axisSafe.z)
-									addScratchPixelToCurrentOne(getScratchPixel(readBlockPos - core::vectorSIMDi32(1, 1, 1, 0)));			 // add box x<current_x && y<current_y && z<current_z
+								minMax[channel] = core::min(minMax[channel], rowScratch[channel]);
+								minMax[maxChannels + channel] = core::max(minMax[maxChannels + channel], rowScratch[channel]);
 							}
+						});
+						for (const auto& minMax : rowMinMax)
+						for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
+						{
+							minDecodeValues[channel] = core::min(minDecodeValues[channel], minMax[channel]);
+							maxDecodeValues[channel] = core::max(maxDecodeValues[channel], minMax[maxChannels + channel]);
 						}
 
-						std::for_each(current, current + currentChannelCount,
-							[&](const decodeType& itrValue)
+						const bool isSignedFormat = asset::isSignedFormat(inFormat);
+						executePerRow([&](const uint32_t row, accumulationType* entryScratchAdress) -> void
+						{
+							for (uint32_t x = 0u; x < state->extent.width; ++x, entryScratchAdress += currentChannelCount)
 							{
-								uint8_t offset = &itrValue - current;
-
-								if (maxDecodeValues[offset] < itrValue)
-									maxDecodeValues[offset] = itrValue;
-
-								if (minDecodeValues[offset] > itrValue)
-									minDecodeValues[offset] = itrValue;
+								if(isSignedFormat)
+									for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
+										entryScratchAdress[channel] = (2.0 * entryScratchAdress[channel] - maxDecodeValues[channel] - minDecodeValues[channel]) / (maxDecodeValues[channel] - minDecodeValues[channel]);
+								else
+									for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
+										entryScratchAdress[channel] = (entryScratchAdress[channel] - minDecodeValues[channel]) / (maxDecodeValues[channel] - minDecodeValues[channel]);
 							}
-						);
-					};
-
-					{
-						core::vector3du32_SIMD localCoord;
-						for (auto& z = localCoord[2] = 0u; z < state->extent.depth; ++z)  // TODO: parallelize (will be tough!)
-							for (auto& y = localCoord[1] = 0u; y < state->extent.height; ++y)
-								for (auto& x = localCoord[0] = 0u; x < state->extent.width; ++x)
-									sum(core::vectorSIMDu32(x, y, z));
+						});
 					}
 
-					auto normalizeScratch = [&](bool isSignedFormat)
-					{
-						core::vector3du32_SIMD localCoord;
-							for (auto& z = localCoord[2] = 0u; z < state->extent.depth; ++z) // TODO: parallelize
-								for (auto& y = localCoord[1] = 0u; y < state->extent.height; ++y)
-									for (auto& x = localCoord[0] = 0u; x < state->extent.width; ++x)
-									{
-										const size_t scratchOffset = asset::IImage::SBufferCopy::getLocalByteOffset(localCoord, scratchByteStrides);
-										decodeType* entryScratchAdress = reinterpret_cast<decodeType*>(reinterpret_cast<uint8_t*>(scratchMemory) + scratchOffset);
-
-										if(isSignedFormat)
-											for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
-												entryScratchAdress[channel] = (2.0 * entryScratchAdress[channel] - maxDecodeValues[channel] - minDecodeValues[channel]) / (maxDecodeValues[channel] - minDecodeValues[channel]);
-										else
-											for (uint8_t channel = 0; channel < currentChannelCount; ++channel)
-												entryScratchAdress[channel] = (entryScratchAdress[channel] - minDecodeValues[channel]) / (maxDecodeValues[channel] - minDecodeValues[channel]);
-									}
-					};
-
-					bool normalized = asset::isNormalizedFormat(inFormat);
-					if (state->normalizeImageByTotalSATValues || normalized)
-						normalizeScratch(asset::isSignedFormat(inFormat));
-
 					{
 						uint8_t* outData = reinterpret_cast<uint8_t*>(state->outImage->getBuffer()->getPointer());
 
@@ -390,8 +467,16 @@ class CSummedAreaTableImageFilter : public CMatchedSizeInOutImageFilterCommon, p
 							auto localOutPos = readBlockPos - core::vectorSIMDu32(state->outOffset.x, state->outOffset.y, state->outOffset.z, readBlockPos.w); // force 0 on .w compoment to obtain valid offset
 							uint8_t* outDataAdress = outData + writeBlockArrayOffset;
 
-							const size_t offset = asset::IImage::SBufferCopy::getLocalByteOffset(localOutPos, scratchByteStrides);
-							asset::encodePixelsRuntime(outFormat, outDataAdress, reinterpret_cast<uint8_t*>(scratchMemory) + offset); // overrrides texels, so region-overlapping case is fine
+							const accumulationType* scratchPixel = getScratchPixel(localOutPos);
+							if constexpr (std::is_same_v<accumulationType, decodeType>)
+								asset::encodePixelsRuntime(outFormat, outDataAdress, scratchPixel); // overrrides texels, so region-overlapping case is fine
+							else
+							{
+								decodeType encodeBuffer[maxChannels] = {};
+								for (auto i = 0; i < currentChannelCount; ++i)
+									encodeBuffer[i] = scratchPixel[i];
+								asset::encodePixelsRuntime(outFormat, outDataAdress, encodeBuffer);
+							}
 						};
 
 						IImage::SSubresourceLayers subresource = { static_cast<IImage::E_ASPECT_FLAGS>(0u), state->outMipLevel, state->outBaseLayer, 1 };
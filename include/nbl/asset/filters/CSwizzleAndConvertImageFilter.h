@@ -12,6 +12,7 @@
 #include "nbl/asset/filters/CSwizzleableAndDitherableFilterBase.h"
 #include "nbl/asset/ICPUImageView.h"
 #include "nbl/asset/format/convertColor.h"
+#include "nbl/asset/format/convertRows.h"
 
 
 namespace nbl::asset
@@ -20,6 +21,44 @@ namespace nbl::asset
 namespace impl
 {
 
+// pulls the component mapping for `getRowConverter` kernels out of swizzles where its known, `out` is left `nullptr` for identity
+template<typename Swizzle>
+inline bool getRowConversionSwizzle(const Swizzle& swizzle, uint8_t (&storage)[SwizzleBase::MaxChannels], const uint8_t*& out)
+{
+	out = nullptr;
+	if constexpr (std::is_same_v<Swizzle,VoidSwizzle>)
+		return true;
+	else if constexpr (std::is_same_v<Swizzle,DefaultSwizzle>)
+	{
+		bool identity = true;
+		for (uint8_t i=0u; i<SwizzleBase::MaxChannels; i++)
+		{
+			const auto mapping = (&swizzle.swizzle.r)[i];
+			switch (mapping)
+			{
+				case ICPUImageView::SComponentMapping::ES_IDENTITY:
+					storage[i] = i;
+					break;
+				case ICPUImageView::SComponentMapping::ES_ZERO:
+					storage[i] = 4u;
+					break;
+				case ICPUImageView::SComponentMapping::ES_ONE:
+					storage[i] = 5u;
+					break;
+				default:
+					storage[i] = mapping-ICPUImageView::SComponentMapping::ES_R;
+					break;
+			}
+			identity = identity && storage[i]==i;
+		}
+		if (!identity)
+			out = storage;
+		return true;
+	}
+	else
+		return false;
+}
+
 template<typename Swizzle, typename Dither, typename Normalization, bool Clamp>
 class CSwizzleAndConvertImageFilterBase : public CSwizzleableAndDitherableFilterBase<Swizzle,Dither,Normalization,Clamp>, public CMatchedSizeInOutImageFilterCommon
 {
@@ -199,6 +238,31 @@ class CSwizzleAndConvertImageFilter<EF_UNKNOWN,EF_UNKNOWN,Swizzle,Dither,Normali
 				assert(blockDims.z==1u);
 				assert(blockDims.w==1u);
 			#endif
+
+			// hot format pairs get converted a row at a time by a kernel looked up once, instead of going through the format switches for every texel
+			if constexpr (std::is_same_v<Dither,IdentityDither> && std::is_void_v<Normalization>)
+			{
+				uint8_t swizzleStorage[SwizzleBase::MaxChannels];
+				const uint8_t* swizzle;
+				const auto converter = getRowConverter(inFormat,outFormat);
+				if (converter && impl::getRowConversionSwizzle<Swizzle>(*state,swizzleStorage,swizzle))
+				{
+					state->outImage->setContentHash(IPreHashed::INVALID_HASH);
+					auto perOutputRegion = [policy,converter,swizzle](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
+					{
+						// all formats with row kernels have 1x1 blocks
+						auto convert = [&commonExecuteData,converter,swizzle](uint32_t readBlockArrayOffset, core::vectorSIMDu32 readBlockPos, uint32_t rowLength)
+						{
+							const auto localOutPos = readBlockPos+commonExecuteData.offsetDifferenceInTexels;
+							uint8_t* dstPix = commonExecuteData.outData+commonExecuteData.oit->getByteOffset(localOutPos,commonExecuteData.outByteStrides);
+							converter(commonExecuteData.inData+readBlockArrayOffset,dstPix,rowLength,swizzle,Clamp);
+						};
+						CBasicImageFilterCommon::executePerRegionBlockRow(policy,commonExecuteData.inImg,convert,commonExecuteData.inRegions,clip);
+						return true;
+					};
+					return CMatchedSizeInOutImageFilterCommon::commonExecute(state,perOutputRegion);
+				}
+			}
 			base_t::template normalizationPrepass<EF_UNKNOWN,ExecutionPolicy,double,double>(inFormat,policy,state,blockDims);
 			auto perOutputRegion = [policy,&blockDims,inFormat,outFormat,outChannelsAmount,&state](const CMatchedSizeInOutImageFilterCommon::CommonExecuteData& commonExecuteData, CBasicImageFilterCommon::clip_region_functor_t& clip) -> bool
 			{
@@ -0,0 +1,393 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_CONVERT_ELEMENTS_H_INCLUDED_
+#define _NBL_ASSET_CONVERT_ELEMENTS_H_INCLUDED_
+
+#include <algorithm>
+#include <cstring>
+
+#include "nbl/asset/format/EFormat.h"
+#include "nbl/asset/format/convertRows.h"
+
+namespace nbl::asset
+{
+
+//! Batched decode/encode of contiguous formatted elements (vertex attributes, indices, etc.) to and from 4-wide tuples
+/*
+	Meant for `IGeometry::SDataView::decodeRange`/`encodeRange`, look the kernel up once per range and call it on chunks.
+	Decoders write `_count` tuples of `T[4]`, channels missing from the format are (0,0,0,1) for floats and (0,0,0,0) for integers.
+	Encoders read `_count` tuples of `T[4]` and ignore the channels the format doesn't have.
+
+	`T=float` covers floating point and normalized formats (which decode the same as `decodePixels`), `T=int32_t`/`uint32_t`
+	cover the 8, 16 and 32bit SINT/UINT formats. Normalized encodes clamp and round to nearest, which the per-element
+	`encodePixels` doesn't do (it truncates).
+
+	The hot vertex formats (R32G32B32_SFLOAT, R16G16_UNORM/SNORM, A2B10G10R10_UNORM/SNORM and the 8bit UNORM/SNORM ones)
+	have SSE4 kernels, everything else listed gets a scalar loop the compiler can vectorize.
+*/
+template<typename T>
+using element_decoder_t = void(*)(const void* _src, T* _out, uint32_t _count);
+template<typename T>
+using element_encoder_t = void(*)(void* _dst, const T* _in, uint32_t _count);
+
+namespace impl
+{
+
+template<E_FORMAT fmt, typename T>
+struct element_format_traits
+{
+	static inline constexpr bool Supported = false;
+};
+
+template<uint32_t ChannelCount>
+struct element_format_float32
+{
+	static inline constexpr bool Supported = true;
+
+	static inline void decode(const void* _src, float* _out, const uint32_t _count)
+	{
+		const auto* src = reinterpret_cast<const float*>(_src);
+		uint32_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		if constexpr (ChannelCount==3u)
+		{
+			// the unaligned 4-wide load reads one float past the element, so the last one stays scalar
+			const __m128 defaults = _mm_setr_ps(0.f,0.f,0.f,1.f);
+			for (; i+1u<_count; i++)
+				_mm_storeu_ps(_out+i*4u,_mm_blend_ps(_mm_loadu_ps(src+i*3u),defaults,0x8));
+		}
+#endif
+		for (; i<_count; i++)
+		{
+			float* const out = _out+i*4u;
+			out[0] = out[1] = out[2] = 0.f;
+			out[3] = 1.f;
+			std::copy_n(src+i*ChannelCount,ChannelCount,out);
+		}
+	}
+	static inline void encode(void* _dst, const float* _in, const uint32_t _count)
+	{
+		auto* dst = reinterpret_cast<float*>(_dst);
+		if constexpr (ChannelCount==4u)
+			memcpy(dst,_in,sizeof(float)*4u*_count);
+		else
+		for (uint32_t i=0u; i<_count; i++)
+			std::copy_n(_in+i*4u,ChannelCount,dst+i*ChannelCount);
+	}
+};
+template<> struct element_format_traits<EF_R32_SFLOAT,float> : element_format_float32<1u> {};
+template<> struct element_format_traits<EF_R32G32_SFLOAT,float> : element_format_float32<2u> {};
+template<> struct element_format_traits<EF_R32G32B32_SFLOAT,float> : element_format_float32<3u> {};
+template<> struct element_format_traits<EF_R32G32B32A32_SFLOAT,float> : element_format_float32<4u> {};
+
+template<uint32_t ChannelCount>
+struct element_format_float16
+{
+	static inline constexpr bool Supported = true;
+	static inline constexpr uint32_t MaxChunk = 64u;
+
+	static inline void decode(const void* _src, float* _out, const uint32_t _count)
+	{
+		for (uint32_t done=0u; done<_count; done+=MaxChunk)
+		{
+			const uint32_t count = core::min(MaxChunk,_count-done);
+			float tmp[MaxChunk*ChannelCount];
+			halfToFloat(reinterpret_cast<const uint16_t*>(_src)+done*ChannelCount,tmp,count*ChannelCount);
+			element_format_float32<ChannelCount>::decode(tmp,_out+done*4u,count);
+		}
+	}
+	static inline void encode(void* _dst, const float* _in, const uint32_t _count)
+	{
+		for (uint32_t done=0u; done<_count; done+=MaxChunk)
+		{
+			const uint32_t count = core::min(MaxChunk,_count-done);
+			float tmp[MaxChunk*ChannelCount];
+			element_format_float32<ChannelCount>::encode(tmp,_in+done*4u,count);
+			floatToHalf(tmp,reinterpret_cast<uint16_t*>(_dst)+done*ChannelCount,count*ChannelCount);
+		}
+	}
+};
+template<> struct element_format_traits<EF_R16_SFLOAT,float> : element_format_float16<1u> {};
+template<> struct element_format_traits<EF_R16G16_SFLOAT,float> : element_format_float16<2u> {};
+template<> struct element_format_traits<EF_R16G16B16_SFLOAT,float> : element_format_float16<3u> {};
+template<> struct element_format_traits<EF_R16G16B16A16_SFLOAT,float> : element_format_float16<4u> {};
+
+// 8 and 16bit UNORM/SNORM, `BGR` swaps the first and third channel
+template<typename StorageT, uint32_t ChannelCount, bool BGR=false>
+struct element_format_norm
+{
+	static inline constexpr bool Supported = true;
+	static inline constexpr bool Signed = std::is_signed_v<StorageT>;
+	static inline constexpr float MaxValue = static_cast<float>(std::numeric_limits<StorageT>::max());
+
+	static inline uint32_t channel(const uint32_t c) {return BGR&&c<3u ? 2u-c:c;}
+
+	static inline void decode(const void* _src, float* _out, const uint32_t _count)
+	{
+		const auto* src = reinterpret_cast<const StorageT*>(_src);
+		uint32_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		if constexpr (!BGR && sizeof(StorageT)*ChannelCount<=4u)
+		{
+			const __m128 defaults = _mm_setr_ps(0.f,0.f,0.f,1.f);
+			const __m128 scale = _mm_set1_ps(MaxValue);
+			constexpr int DefaultsMask = (0xf<<ChannelCount)&0xf;
+			for (; i<_count; i++)
+			{
+				uint32_t packed = 0u;
+				memcpy(&packed,src+i*ChannelCount,sizeof(StorageT)*ChannelCount);
+				const __m128i raw = _mm_cvtsi32_si128(packed);
+				__m128i widened;
+				if constexpr (sizeof(StorageT)==1u)
+					widened = Signed ? _mm_cvtepi8_epi32(raw):_mm_cvtepu8_epi32(raw);
+				else
+					widened = Signed ? _mm_cvtepi16_epi32(raw):_mm_cvtepu16_epi32(raw);
+				// division instead of reciprocal multiply so results match the double precision decode rounded to float
+				const __m128 decoded = _mm_div_ps(_mm_cvtepi32_ps(widened),scale);
+				_mm_storeu_ps(_out+i*4u,_mm_blend_ps(decoded,defaults,DefaultsMask));
+			}
+		}
+#endif
+		for (; i<_count; i++)
+		{
+			float* const out = _out+i*4u;
+			out[0] = out[1] = out[2] = 0.f;
+			out[3] = 1.f;
+			for (uint32_t c=0u; c<ChannelCount; c++)
+				out[channel(c)] = static_cast<float>(src[i*ChannelCount+c]/static_cast<double>(MaxValue));
+		}
+	}
+	static inline void encode(void* _dst, const float* _in, const uint32_t _count)
+	{
+		auto* dst = reinterpret_cast<StorageT*>(_dst);
+		constexpr float MinValue = Signed ? -1.f:0.f;
+		uint32_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		if constexpr (!BGR && sizeof(StorageT)*ChannelCount<=4u)
+		{
+			const __m128 lo = _mm_set1_ps(MinValue);
+			const __m128 hi = _mm_set1_ps(1.f);
+			const __m128 scale = _mm_set1_ps(MaxValue);
+			for (; i<_count; i++)
+			{
+				// max/min order makes NaN encode as the minimum, rounding is to nearest even
+				const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(_in+i*4u),lo),hi);
+				const __m128i rounded = _mm_cvtps_epi32(_mm_mul_ps(clamped,scale));
+				__m128i packed;
+				if constexpr (sizeof(StorageT)==1u)
+				{
+					const __m128i words = _mm_packs_epi32(rounded,rounded);
+					packed = Signed ? _mm_packs_epi16(words,words):_mm_packus_epi16(words,words);
+				}
+				else
+					packed = Signed ? _mm_packs_epi32(rounded,rounded):_mm_packus_epi32(rounded,rounded);
+				const uint32_t bits = _mm_cvtsi128_si32(packed);
+				memcpy(dst+i*ChannelCount,&bits,sizeof(StorageT)*ChannelCount);
+			}
+		}
+#endif
+		for (; i<_count; i++)
+		for (uint32_t c=0u; c<ChannelCount; c++)
+		{
+			const float value = _in[i*4u+channel(c)];
+			const float clamped = value>MinValue ? (value<1.f ? value:1.f):MinValue;
+			dst[i*ChannelCount+c] = static_cast<StorageT>(std::nearbyint(clamped*MaxValue));
+		}
+	}
+};
+template<> struct element_format_traits<EF_R8_UNORM,float> : element_format_norm<uint8_t,1u> {};
+template<> struct element_format_traits<EF_R8G8_UNORM,float> : element_format_norm<uint8_t,2u> {};
+template<> struct element_format_traits<EF_R8G8B8_UNORM,float> : element_format_norm<uint8_t,3u> {};
+template<> struct element_format_traits<EF_R8G8B8A8_UNORM,float> : element_format_norm<uint8_t,4u> {};
+template<> struct element_format_traits<EF_B8G8R8A8_UNORM,float> : element_format_norm<uint8_t,4u,true> {};
+template<> struct element_format_traits<EF_R8_SNORM,float> : element_format_norm<int8_t,1u> {};
+template<> struct element_format_traits<EF_R8G8_SNORM,float> : element_format_norm<int8_t,2u> {};
+template<> struct element_format_traits<EF_R8G8B8_SNORM,float> : element_format_norm<int8_t,3u> {};
+template<> struct element_format_traits<EF_R8G8B8A8_SNORM,float> : element_format_norm<int8_t,4u> {};
+template<> struct element_format_traits<EF_R16_UNORM,float> : element_format_norm<uint16_t,1u> {};
+template<> struct element_format_traits<EF_R16G16_UNORM,float> : element_format_norm<uint16_t,2u> {};
+template<> struct element_format_traits<EF_R16G16B16_UNORM,float> : element_format_norm<uint16_t,3u> {};
+template<> struct element_format_traits<EF_R16G16B16A16_UNORM,float> : element_format_norm<uint16_t,4u> {};
+template<> struct element_format_traits<EF_R16_SNORM,float> : element_format_norm<int16_t,1u> {};
+template<> struct element_format_traits<EF_R16G16_SNORM,float> : element_format_norm<int16_t,2u> {};
+template<> struct element_format_traits<EF_R16G16B16_SNORM,float> : element_format_norm<int16_t,3u> {};
+template<> struct element_format_traits<EF_R16G16B16A16_SNORM,float> : element_format_norm<int16_t,4u> {};
+
+// R in the low bits, 2bit alpha in the top ones
+template<bool Signed>
+struct element_format_a2b10g10r10
+{
+	static inline constexpr bool Supported = true;
+
+	static inline void decode(const void* _src, float* _out, const uint32_t _count)
+	{
+		const auto* src = reinterpret_cast<const uint32_t*>(_src);
+		uint32_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		const __m128 scale = Signed ? _mm_setr_ps(511.f,511.f,511.f,1.f):_mm_setr_ps(1023.f,1023.f,1023.f,3.f);
+		for (; i<_count; i++)
+		{
+			const uint32_t pix = src[i];
+			__m128i fields;
+			if constexpr (Signed) // move every field to the top of its lane and arithmetic-shift it back down
+				fields = _mm_srai_epi32(_mm_setr_epi32(pix<<22u,pix<<12u,pix<<2u,int32_t(pix)>>8),22);
+			else
+				fields = _mm_and_si128(_mm_setr_epi32(pix,pix>>10u,pix>>20u,pix>>30u),_mm_setr_epi32(0x3ff,0x3ff,0x3ff,0x3));
+			_mm_storeu_ps(_out+i*4u,_mm_div_ps(_mm_cvtepi32_ps(fields),scale));
+		}
+#endif
+		for (; i<_count; i++)
+		{
+			const uint32_t pix = src[i];
+			float* const out = _out+i*4u;
+			for (uint32_t c=0u; c<3u; c++)
+			{
+				if constexpr (Signed)
+					out[c] = static_cast<float>((int32_t(pix<<(22u-10u*c))>>22)/511.);
+				else
+					out[c] = static_cast<float>(((pix>>(10u*c))&0x3ffu)/1023.);
+			}
+			out[3] = Signed ? static_cast<float>(int32_t(pix)>>30):static_cast<float>((pix>>30u)/3.);
+		}
+	}
+	static inline void encode(void* _dst, const float* _in, const uint32_t _count)
+	{
+		auto* dst = reinterpret_cast<uint32_t*>(_dst);
+		constexpr float MinValue = Signed ? -1.f:0.f;
+		constexpr float Scale[4] = {Signed ? 511.f:1023.f,Signed ? 511.f:1023.f,Signed ? 511.f:1023.f,Signed ? 1.f:3.f};
+		uint32_t i = 0u;
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+		const __m128 lo = _mm_set1_ps(MinValue);
+		const __m128 hi = _mm_set1_ps(1.f);
+		const __m128 scale = _mm_loadu_ps(Scale);
+		const __m128i mask = _mm_setr_epi32(0x3ff,0x3ff,0x3ff,0x3);
+		for (; i<_count; i++)
+		{
+			const __m128 clamped = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(_in+i*4u),lo),hi);
+			const __m128i fields = _mm_and_si128(_mm_cvtps_epi32(_mm_mul_ps(clamped,scale)),mask);
+			dst[i] = uint32_t(_mm_cvtsi128_si32(fields))|(uint32_t(_mm_extract_epi32(fields,1))<<10u)|
+				(uint32_t(_mm_extract_epi32(fields,2))<<20u)|(uint32_t(_mm_extract_epi32(fields,3))<<30u);
+		}
+#endif
+		for (; i<_count; i++)
+		{
+			uint32_t pix = 0u;
+			for (uint32_t c=0u; c<4u; c++)
+			{
+				const float value = _in[i*4u+c];
+				const float clamped = value>MinValue ? (value<1.f ? value:1.f):MinValue;
+				const uint32_t field = static_cast<uint32_t>(static_cast<int32_t>(std::nearbyint(clamped*Scale[c])));
+				pix |= (field&(c<3u ? 0x3ffu:0x3u))<<(10u*c);
+			}
+			dst[i] = pix;
+		}
+	}
+};
+template<> struct element_format_traits<EF_A2B10G10R10_UNORM_PACK32,float> : element_format_a2b10g10r10<false> {};
+template<> struct element_format_traits<EF_A2B10G10R10_SNORM_PACK32,float> : element_format_a2b10g10r10<true> {};
+
+// plain integer formats, no conversion other than widening and narrowing
+template<typename StorageT, uint32_t ChannelCount, typename T>
+struct element_format_int
+{
+	static inline constexpr bool Supported = true;
+
+	static inline void decode(const void* _src, T* _out, const uint32_t _count)
+	{
+		const auto* src = reinterpret_cast<const StorageT*>(_src);
+		for (uint32_t i=0u; i<_count; i++)
+		for (uint32_t c=0u; c<4u; c++)
+			_out[i*4u+c] = c<ChannelCount ? static_cast<T>(src[i*ChannelCount+c]):T(0);
+	}
+	static inline void encode(void* _dst, const T* _in, const uint32_t _count)
+	{
+		auto* dst = reinterpret_cast<StorageT*>(_dst);
+		for (uint32_t i=0u; i<_count; i++)
+		for (uint32_t c=0u; c<ChannelCount; c++)
+			dst[i*ChannelCount+c] = static_cast<StorageT>(_in[i*4u+c]);
+	}
+};
+#define NBL_ELEMENT_FORMAT_INT(BITS) \
+template<> struct element_format_traits<EF_R##BITS##_UINT,uint32_t> : element_format_int<uint##BITS##_t,1u,uint32_t> {}; \
+template<> struct element_format_traits<EF_R##BITS##G##BITS##_UINT,uint32_t> : element_format_int<uint##BITS##_t,2u,uint32_t> {}; \
+template<> struct element_format_traits<EF_R##BITS##G##BITS##B##BITS##_UINT,uint32_t> : element_format_int<uint##BITS##_t,3u,uint32_t> {}; \
+template<> struct element_format_traits<EF_R##BITS##G##BITS##B##BITS##A##BITS##_UINT,uint32_t> : element_format_int<uint##BITS##_t,4u,uint32_t> {}; \
+template<> struct element_format_traits<EF_R##BITS##_SINT,int32_t> : element_format_int<int##BITS##_t,1u,int32_t> {}; \
+template<> struct element_format_traits<EF_R##BITS##G##BITS##_SINT,int32_t> : element_format_int<int##BITS##_t,2u,int32_t> {}; \
+template<> struct element_format_traits<EF_R##BITS##G##BITS##B##BITS##_SINT,int32_t> : element_format_int<int##BITS##_t,3u,int32_t> {}; \
+template<> struct element_format_traits<EF_R##BITS##G##BITS##B##BITS##A##BITS##_SINT,int32_t> : element_format_int<int##BITS##_t,4u,int32_t> {};
+NBL_ELEMENT_FORMAT_INT(8)
+NBL_ELEMENT_FORMAT_INT(16)
+NBL_ELEMENT_FORMAT_INT(32)
+#undef NBL_ELEMENT_FORMAT_INT
+
+template<typename T, E_FORMAT... Formats>
+struct element_converter_table
+{
+	static inline constexpr E_FORMAT formats[sizeof...(Formats)] = {Formats...};
+
+	template<E_FORMAT fmt>
+	static inline constexpr element_decoder_t<T> decoder()
+	{
+		if constexpr (element_format_traits<fmt,T>::Supported)
+			return &element_format_traits<fmt,T>::decode;
+		else
+			return nullptr;
+	}
+	template<E_FORMAT fmt>
+	static inline constexpr element_encoder_t<T> encoder()
+	{
+		if constexpr (element_format_traits<fmt,T>::Supported)
+			return &element_format_traits<fmt,T>::encode;
+		else
+			return nullptr;
+	}
+	static inline constexpr element_decoder_t<T> decoders[sizeof...(Formats)] = {decoder<Formats>()...};
+	static inline constexpr element_encoder_t<T> encoders[sizeof...(Formats)] = {encoder<Formats>()...};
+
+	static inline int32_t find(const E_FORMAT format)
+	{
+		const auto it = std::find(std::begin(formats),std::end(formats),format);
+		return it!=std::end(formats) ? std::distance(std::begin(formats),it):-1;
+	}
+};
+
+template<typename T>
+using default_element_converter_table_t = element_converter_table<T,
+	EF_R32_SFLOAT,EF_R32G32_SFLOAT,EF_R32G32B32_SFLOAT,EF_R32G32B32A32_SFLOAT,
+	EF_R16_SFLOAT,EF_R16G16_SFLOAT,EF_R16G16B16_SFLOAT,EF_R16G16B16A16_SFLOAT,
+	EF_R8_UNORM,EF_R8G8_UNORM,EF_R8G8B8_UNORM,EF_R8G8B8A8_UNORM,EF_B8G8R8A8_UNORM,
+	EF_R8_SNORM,EF_R8G8_SNORM,EF_R8G8B8_SNORM,EF_R8G8B8A8_SNORM,
+	EF_R16_UNORM,EF_R16G16_UNORM,EF_R16G16B16_UNORM,EF_R16G16B16A16_UNORM,
+	EF_R16_SNORM,EF_R16G16_SNORM,EF_R16G16B16_SNORM,EF_R16G16B16A16_SNORM,
+	EF_A2B10G10R10_UNORM_PACK32,EF_A2B10G10R10_SNORM_PACK32,
+	EF_R8_UINT,EF_R8G8_UINT,EF_R8G8B8_UINT,EF_R8G8B8A8_UINT,
+	EF_R16_UINT,EF_R16G16_UINT,EF_R16G16B16_UINT,EF_R16G16B16A16_UINT,
+	EF_R32_UINT,EF_R32G32_UINT,EF_R32G32B32_UINT,EF_R32G32B32A32_UINT,
+	EF_R8_SINT,EF_R8G8_SINT,EF_R8G8B8_SINT,EF_R8G8B8A8_SINT,
+	EF_R16_SINT,EF_R16G16_SINT,EF_R16G16B16_SINT,EF_R16G16B16A16_SINT,
+	EF_R32_SINT,EF_R32G32_SINT,EF_R32G32B32_SINT,EF_R32G32B32A32_SINT
+>;
+}
+
+//! Returns `nullptr` if there's no specialized kernel for the format and output type, then you need to fall back to `decodePixels`
+template<typename T> requires (std::is_same_v<T,float> || std::is_same_v<T,int32_t> || std::is_same_v<T,uint32_t>)
+inline element_decoder_t<T> getElementDecoder(const E_FORMAT format)
+{
+	using table_t = impl::default_element_converter_table_t<T>;
+	const int32_t ix = table_t::find(format);
+	return ix<0 ? nullptr:table_t::decoders[ix];
+}
+//! Returns `nullptr` if there's no specialized kernel for the format and input type, then you need to fall back to `encodePixels`
+template<typename T> requires (std::is_same_v<T,float> || std::is_same_v<T,int32_t> || std::is_same_v<T,uint32_t>)
+inline element_encoder_t<T> getElementEncoder(const E_FORMAT format)
+{
+	using table_t = impl::default_element_converter_table_t<T>;
+	const int32_t ix = table_t::find(format);
+	return ix<0 ? nullptr:table_t::encoders[ix];
+}
+
+}
+
+#endif
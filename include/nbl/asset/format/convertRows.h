@@ -0,0 +1,349 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_CONVERT_ROWS_H_INCLUDED_
+#define _NBL_ASSET_CONVERT_ROWS_H_INCLUDED_
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+// MSVC never defines `__F16C__`, but its `/arch:AVX2` allows F16C too (every AVX2 capable CPU has it), elsewhere `-mavx2` doesn't imply `-mf16c`
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define _NBL_CONVERT_ROWS_F16C_
+#include <immintrin.h>
+#endif
+
+#include "nbl/asset/format/EFormat.h"
+#include "decodePixels.h"
+#include "encodePixels.h"
+
+namespace nbl::asset
+{
+
+//! Converts a contiguous run of `_texelCount` texels, for the hot format pairs of the runtime `CSwizzleAndConvertImageFilter`.
+/*
+	Unlike `convertColor` which goes through `decodePixelsRuntime`/`encodePixelsRuntime` and 64bit intermediates for every texel,
+	the kernels are specialized for every (inFormat,outFormat) pair at compile time and work on chunks of float32 RGBA,
+	so you're meant to look the function up once per region/row with `getRowConverter`.
+
+	The intermediate precision is enough to represent all supported formats exactly, and the encodes replicate the rounding
+	of the `encodePixels` (UNORM truncation is done in double, sRGB goes through exact per-value thresholds) so results match
+	the per-texel path, up to the double rounding when encoding to half floats.
+
+	`_swizzle` is `nullptr` for identity, otherwise each entry is the source channel (0-3), 4 for constant 0 or 5 for constant 1.
+	Channels missing from the input format decode as (0,0,0,1).
+*/
+using row_converter_t = void(*)(const void* _src, void* _dst, uint32_t _texelCount, const uint8_t* _swizzle, bool _clamp);
+
+namespace impl
+{
+
+struct SRowConversionLUTs
+{
+	SRowConversionLUTs()
+	{
+		for (uint32_t k=0u; k<256u; k++)
+		{
+			unorm8ToFloat[k] = static_cast<float>(k/255.);
+			srgb8ToFloat[k] = static_cast<float>(core::srgb2lin(k/255.));
+		}
+		// find the smallest float which `encodePixels` would turn into each sRGB value, then encoding becomes a binary search
+		auto reference = [](const float x) -> uint32_t {return static_cast<uint32_t>(core::lin2srgb(static_cast<double>(x))*255.);};
+		floatToSRGB8Threshold[0] = -std::numeric_limits<float>::infinity();
+		for (uint32_t k=1u; k<256u; k++)
+		{
+			float t = static_cast<float>(core::srgb2lin(k/255.));
+			while (reference(t)>=k)
+				t = std::nextafter(t,0.f);
+			while (reference(t)<k)
+				t = std::nextafter(t,2.f);
+			floatToSRGB8Threshold[k] = t;
+		}
+	}
+
+	static inline const SRowConversionLUTs& get()
+	{
+		static const SRowConversionLUTs luts;
+		return luts;
+	}
+
+	inline uint8_t encodeSRGB(const float x) const
+	{
+		// branchless search for the last threshold not greater than `x`, NaN ends up as 0
+		uint32_t k = 0u;
+		for (uint32_t step=128u; step; step>>=1u)
+			k += floatToSRGB8Threshold[k+step]<=x ? step:0u;
+		return static_cast<uint8_t>(k);
+	}
+
+	float unorm8ToFloat[256];
+	float srgb8ToFloat[256];
+	float floatToSRGB8Threshold[256];
+};
+
+inline void halfToFloat(const void* _src, float* _dst, const uint32_t _count)
+{
+	const auto* src = reinterpret_cast<const uint16_t*>(_src);
+	uint32_t i = 0u;
+#ifdef _NBL_CONVERT_ROWS_F16C_
+	for (; i+8u<=_count; i+=8u)
+		_mm256_storeu_ps(_dst+i,_mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src+i))));
+#endif
+	for (; i<_count; i++)
+	{
+		hlsl::float16_t h;
+		memcpy(&h,src+i,sizeof(uint16_t));
+		_dst[i] = static_cast<float>(h);
+	}
+}
+inline void floatToHalf(const float* _src, void* _dst, const uint32_t _count)
+{
+	auto* dst = reinterpret_cast<uint16_t*>(_dst);
+	uint32_t i = 0u;
+#ifdef _NBL_CONVERT_ROWS_F16C_
+	for (; i+8u<=_count; i+=8u)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst+i),_mm256_cvtps_ph(_mm256_loadu_ps(_src+i),_MM_FROUND_TO_NEAREST_INT));
+#endif
+	for (; i<_count; i++)
+	{
+		const auto h = static_cast<hlsl::float16_t>(_src[i]);
+		memcpy(dst+i,&h,sizeof(uint16_t));
+	}
+}
+
+inline float clampUNORM(const float x)
+{
+	// written so that NaN becomes 0
+	return x>0.f ? (x<1.f ? x:1.f):0.f;
+}
+
+// every specialization decodes `_count` texels into RGBA float32 and encodes them back
+template<E_FORMAT fmt>
+struct row_format_traits
+{
+	static inline constexpr bool Supported = false;
+};
+
+template<uint32_t ChannelCount, bool BGR, bool SRGB>
+struct row_format_8bit
+{
+	static inline constexpr bool Supported = true;
+
+	static inline uint32_t channel(const uint32_t c) {return BGR&&c<3u ? 2u-c:c;}
+
+	static inline void decode(const void* _src, float* _rgba, const uint32_t _count)
+	{
+		const auto& luts = SRowConversionLUTs::get();
+		const auto* src = reinterpret_cast<const uint8_t*>(_src);
+		for (uint32_t i=0u; i<_count; i++,src+=ChannelCount,_rgba+=4u)
+		{
+			_rgba[0] = _rgba[1] = _rgba[2] = 0.f;
+			_rgba[3] = 1.f;
+			for (uint32_t c=0u; c<ChannelCount; c++)
+				_rgba[channel(c)] = (SRGB&&c<3u ? luts.srgb8ToFloat:luts.unorm8ToFloat)[src[c]];
+		}
+	}
+	static inline void encode(void* _dst, const float* _rgba, const uint32_t _count, const bool _clamp)
+	{
+		const auto& luts = SRowConversionLUTs::get();
+		auto* dst = reinterpret_cast<uint8_t*>(_dst);
+		for (uint32_t i=0u; i<_count; i++,dst+=ChannelCount,_rgba+=4u)
+		for (uint32_t c=0u; c<ChannelCount; c++)
+		{
+			const float value = _rgba[channel(c)];
+			if (SRGB && c<3u)
+				dst[c] = luts.encodeSRGB(value);
+			else // UNORM always needs the clamp, the per-texel path has UB outside [0,1]
+				dst[c] = static_cast<uint8_t>(static_cast<double>(clampUNORM(value))*255.);
+		}
+	}
+};
+template<> struct row_format_traits<EF_R8_UNORM> : row_format_8bit<1u,false,false> {};
+template<> struct row_format_traits<EF_R8G8_UNORM> : row_format_8bit<2u,false,false> {};
+template<> struct row_format_traits<EF_R8G8B8_UNORM> : row_format_8bit<3u,false,false> {};
+template<> struct row_format_traits<EF_R8G8B8A8_UNORM> : row_format_8bit<4u,false,false> {};
+template<> struct row_format_traits<EF_B8G8R8A8_UNORM> : row_format_8bit<4u,true,false> {};
+template<> struct row_format_traits<EF_R8G8B8_SRGB> : row_format_8bit<3u,false,true> {};
+template<> struct row_format_traits<EF_R8G8B8A8_SRGB> : row_format_8bit<4u,false,true> {};
+template<> struct row_format_traits<EF_B8G8R8A8_SRGB> : row_format_8bit<4u,true,true> {};
+
+template<uint32_t ChannelCount, bool Half>
+struct row_format_float
+{
+	static inline constexpr bool Supported = true;
+	static inline constexpr uint32_t MaxChunk = 64u;
+
+	static inline void decode(const void* _src, float* _rgba, const uint32_t _count)
+	{
+		assert(_count<=MaxChunk);
+		if constexpr (ChannelCount==4u)
+		{
+			if constexpr (Half)
+				halfToFloat(_src,_rgba,_count*4u);
+			else
+				memcpy(_rgba,_src,sizeof(float)*4u*_count);
+			return;
+		}
+		float tmp[MaxChunk*ChannelCount];
+		const float* src = reinterpret_cast<const float*>(_src);
+		if constexpr (Half)
+		{
+			halfToFloat(_src,tmp,_count*ChannelCount);
+			src = tmp;
+		}
+		for (uint32_t i=0u; i<_count; i++,src+=ChannelCount,_rgba+=4u)
+		{
+			_rgba[0] = _rgba[1] = _rgba[2] = 0.f;
+			_rgba[3] = 1.f;
+			std::copy_n(src,ChannelCount,_rgba);
+		}
+	}
+	static inline void encode(void* _dst, const float* _rgba, const uint32_t _count, const bool _clamp)
+	{
+		assert(_count<=MaxChunk);
+		constexpr float MaxValue = Half ? 65504.f:std::numeric_limits<float>::max();
+		float tmp[MaxChunk*ChannelCount];
+		float* dst = Half ? tmp:reinterpret_cast<float*>(_dst);
+		for (uint32_t i=0u; i<_count; i++,_rgba+=4u)
+		for (uint32_t c=0u; c<ChannelCount; c++)
+		{
+			const float value = _rgba[c];
+			dst[i*ChannelCount+c] = _clamp ? core::clamp(value,-MaxValue,MaxValue):value;
+		}
+		if constexpr (Half)
+			floatToHalf(tmp,_dst,_count*ChannelCount);
+	}
+};
+template<> struct row_format_traits<EF_R16_SFLOAT> : row_format_float<1u,true> {};
+template<> struct row_format_traits<EF_R16G16_SFLOAT> : row_format_float<2u,true> {};
+template<> struct row_format_traits<EF_R16G16B16_SFLOAT> : row_format_float<3u,true> {};
+template<> struct row_format_traits<EF_R16G16B16A16_SFLOAT> : row_format_float<4u,true> {};
+template<> struct row_format_traits<EF_R32_SFLOAT> : row_format_float<1u,false> {};
+template<> struct row_format_traits<EF_R32G32_SFLOAT> : row_format_float<2u,false> {};
+template<> struct row_format_traits<EF_R32G32B32_SFLOAT> : row_format_float<3u,false> {};
+template<> struct row_format_traits<EF_R32G32B32A32_SFLOAT> : row_format_float<4u,false> {};
+
+template<>
+struct row_format_traits<EF_A2B10G10R10_UNORM_PACK32>
+{
+	static inline constexpr bool Supported = true;
+
+	static inline void decode(const void* _src, float* _rgba, const uint32_t _count)
+	{
+		const auto* src = reinterpret_cast<const uint32_t*>(_src);
+		for (uint32_t i=0u; i<_count; i++,_rgba+=4u)
+		{
+			const uint32_t pix = src[i];
+			for (uint32_t c=0u; c<3u; c++)
+				_rgba[c] = static_cast<float>(((pix>>(10u*c))&0x3ffu)/1023.);
+			_rgba[3] = static_cast<float>((pix>>30u)/3.);
+		}
+	}
+	static inline void encode(void* _dst, const float* _rgba, const uint32_t _count, const bool _clamp)
+	{
+		auto* dst = reinterpret_cast<uint32_t*>(_dst);
+		for (uint32_t i=0u; i<_count; i++,_rgba+=4u)
+		{
+			uint32_t pix = static_cast<uint32_t>(static_cast<double>(clampUNORM(_rgba[3]))*3.)<<30u;
+			for (uint32_t c=0u; c<3u; c++)
+				pix |= static_cast<uint32_t>(static_cast<double>(clampUNORM(_rgba[c]))*1023.)<<(10u*c);
+			dst[i] = pix;
+		}
+	}
+};
+
+template<>
+struct row_format_traits<EF_E5B9G9R9_UFLOAT_PACK32>
+{
+	static inline constexpr bool Supported = true;
+
+	static inline void decode(const void* _src, float* _rgba, const uint32_t _count)
+	{
+		const auto* src = reinterpret_cast<const uint32_t*>(_src);
+		for (uint32_t i=0u; i<_count; i++,_rgba+=4u)
+		{
+			decodeRGB9E5<float>(src[i],_rgba);
+			_rgba[3] = 1.f;
+		}
+	}
+	static inline void encode(void* _dst, const float* _rgba, const uint32_t _count, const bool _clamp)
+	{
+		// format is unsigned and bounded, the encode always clamps
+		auto* dst = reinterpret_cast<uint32_t*>(_dst);
+		for (uint32_t i=0u; i<_count; i++,_rgba+=4u)
+		{
+			const double rgb[3] = {_rgba[0],_rgba[1],_rgba[2]};
+			dst[i] = encodeRGB9E5<double>(rgb);
+		}
+	}
+};
+
+template<E_FORMAT inFormat, E_FORMAT outFormat>
+inline void convertRow(const void* _src, void* _dst, uint32_t _texelCount, const uint8_t* _swizzle, bool _clamp)
+{
+	using in_traits = row_format_traits<inFormat>;
+	using out_traits = row_format_traits<outFormat>;
+	constexpr uint32_t ChunkSize = 64u;
+	constexpr uint32_t InBytes = getTexelOrBlockBytesize<inFormat>();
+	constexpr uint32_t OutBytes = getTexelOrBlockBytesize<outFormat>();
+
+	const auto* src = reinterpret_cast<const uint8_t*>(_src);
+	auto* dst = reinterpret_cast<uint8_t*>(_dst);
+	float rgba[ChunkSize*4u];
+	for (uint32_t done=0u; done<_texelCount; done+=ChunkSize)
+	{
+		const uint32_t count = core::min(ChunkSize,_texelCount-done);
+		in_traits::decode(src+done*InBytes,rgba,count);
+		if (_swizzle)
+		for (uint32_t i=0u; i<count; i++)
+		{
+			float* const texel = rgba+i*4u;
+			const float in[6] = {texel[0],texel[1],texel[2],texel[3],0.f,1.f};
+			for (uint32_t c=0u; c<4u; c++)
+				texel[c] = in[_swizzle[c]];
+		}
+		out_traits::encode(dst+done*OutBytes,rgba,count,_clamp);
+	}
+}
+
+template<E_FORMAT... Formats>
+struct row_converter_table
+{
+	static inline constexpr E_FORMAT formats[sizeof...(Formats)] = {Formats...};
+
+	template<E_FORMAT inFormat>
+	static inline constexpr std::array<row_converter_t,sizeof...(Formats)> row = {&convertRow<inFormat,Formats>...};
+	static inline constexpr std::array<std::array<row_converter_t,sizeof...(Formats)>,sizeof...(Formats)> table = {row<Formats>...};
+
+	static inline row_converter_t get(const E_FORMAT inFormat, const E_FORMAT outFormat)
+	{
+		const auto inIt = std::find(std::begin(formats),std::end(formats),inFormat);
+		const auto outIt = std::find(std::begin(formats),std::end(formats),outFormat);
+		if (inIt==std::end(formats) || outIt==std::end(formats))
+			return nullptr;
+		return table[std::distance(std::begin(formats),inIt)][std::distance(std::begin(formats),outIt)];
+	}
+};
+
+using default_row_converter_table_t = row_converter_table<
+	EF_R8_UNORM,EF_R8G8_UNORM,EF_R8G8B8_UNORM,EF_R8G8B8A8_UNORM,EF_B8G8R8A8_UNORM,
+	EF_R8G8B8_SRGB,EF_R8G8B8A8_SRGB,EF_B8G8R8A8_SRGB,
+	EF_R16_SFLOAT,EF_R16G16_SFLOAT,EF_R16G16B16_SFLOAT,EF_R16G16B16A16_SFLOAT,
+	EF_R32_SFLOAT,EF_R32G32_SFLOAT,EF_R32G32B32_SFLOAT,EF_R32G32B32A32_SFLOAT,
+	EF_A2B10G10R10_UNORM_PACK32,EF_E5B9G9R9_UFLOAT_PACK32
+>;
+
+}
+
+//! Returns `nullptr` if there's no specialized kernel for the pair, then you need to fall back to `convertColor`
+inline row_converter_t getRowConverter(const E_FORMAT inFormat, const E_FORMAT outFormat)
+{
+	return impl::default_row_converter_table_t::get(inFormat,outFormat);
+}
+
+}
+
+#undef _NBL_CONVERT_ROWS_F16C_
+
+#endif
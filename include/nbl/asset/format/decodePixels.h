@@ -7,6 +7,7 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <cmath>
 
 #include "nbl/core/declarations.h"
 #include "nbl/asset/format/EFormat.h"
@@ -1130,20 +1131,22 @@ namespace asset
         impl::decodef64<double, 4u>(_pix[0], _output);
     }
 
+    namespace impl
+    {
+        // shared exponent has no implicit leading 1, value is `mantissa*2^(exp-bias-mantissaBits)`
+        template<typename T>
+        inline void decodeRGB9E5(const uint32_t _pix, T* _output)
+        {
+            const int32_t exp = static_cast<int32_t>(_pix >> 27) - 15 - 9;
+            for (uint32_t i = 0u; i < 3u; ++i)
+                _output[i] = std::ldexp(static_cast<T>((_pix >> (9*i)) & 0x1ffu), exp);
+        }
+    }
     template<>
     inline void decodePixels<asset::EF_E5B9G9R9_UFLOAT_PACK32, double>(const void* _pix[4], double* _output, uint32_t _blockX, uint32_t _blockY)
     {
         const uint32_t& pix = reinterpret_cast<const uint32_t*>(_pix[0])[0];
-
-        uint64_t exp = static_cast<uint64_t>(pix >> 27) + (1023ull - 15ull);
-        exp <<= 52;
-        for (uint32_t i = 0u; i < 3u; ++i)
-        {
-            uint64_t out = 0u;
-            out |= uint64_t((pix >> (9*i)) & 0x1ffu) << (52-9);
-            out |= exp;
-            memcpy(_output+i, &out, 8);
-        }
+        impl::decodeRGB9E5<double>(pix, _output);
     }
 
     // Block Compression formats
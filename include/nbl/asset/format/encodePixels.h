@@ -7,6 +7,7 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <cmath>
 
 #include "nbl/core/declarations.h"
 #include "nbl/asset/format/EFormat.h"
@@ -2476,29 +2477,48 @@ namespace asset
         impl::encodef64<double, 4u>(_pix, _input);
     }
 
+    namespace impl
+    {
+        // as per the `EXT_texture_shared_exponent` spec, the largest channel picks the exponent and all mantissas get rounded to nearest
+        template<typename T>
+        inline uint32_t encodeRGB9E5(const T* _input)
+        {
+            constexpr int32_t MantissaBits = 9;
+            constexpr int32_t ExpBias = 15;
+            constexpr T MaxValue = static_cast<T>(0x1ff) / static_cast<T>(0x200) * static_cast<T>(0x1u << 16);
+
+            T rgb[3];
+            for (uint32_t i = 0u; i < 3u; ++i) // written so NaN becomes 0
+                rgb[i] = _input[i] > static_cast<T>(0) ? (_input[i] < MaxValue ? _input[i] : MaxValue) : static_cast<T>(0);
+            const T maxRGB = std::max<T>(std::max<T>(rgb[0], rgb[1]), rgb[2]);
+
+            int32_t exp = -ExpBias - 1;
+            if (maxRGB > static_cast<T>(0))
+            {
+                int32_t frexpExp;
+                std::frexp(maxRGB, &frexpExp);
+                exp = std::max<int32_t>(exp, frexpExp - 1);
+            }
+            exp += 1 + ExpBias;
+
+            T scale = std::ldexp(static_cast<T>(1), ExpBias + MantissaBits - exp);
+            if (static_cast<uint32_t>(std::floor(maxRGB * scale + static_cast<T>(0.5))) == (0x1u << MantissaBits))
+            {
+                exp++;
+                scale *= static_cast<T>(0.5);
+            }
+
+            uint32_t pix = static_cast<uint32_t>(exp) << 27;
+            for (uint32_t i = 0u; i < 3u; ++i)
+                pix |= static_cast<uint32_t>(std::floor(rgb[i] * scale + static_cast<T>(0.5))) << (9*i);
+            return pix;
+        }
+    }
     template<>
     inline void encodePixels<asset::EF_E5B9G9R9_UFLOAT_PACK32, double>(void* _pix, const double* _input)
     {
         uint32_t& pix = reinterpret_cast<uint32_t*>(_pix)[0];
-        pix = 0u;
-        uint32_t exp;
-        {
-            uint64_t inp;
-            memcpy(&inp, _input, 8);
-            inp >>= 52;
-            inp &= 0x7ffull;
-            inp -= (1023ull - 15ull);
-            // TODO: this is wrong, need to get maximum exponent across all 3 input values
-            exp = (static_cast<uint32_t>(inp) << 27);
-        }
-        for (uint32_t i = 0u; i < 3u; ++i)
-        {
-            uint64_t inp;
-            memcpy(&inp, _input+i, 8);
-            uint32_t m = (inp >> (52-9)) & 0x1ffu;
-            pix |= (m << (9*i));
-        }
-        pix |= exp;
+        pix = impl::encodeRGB9E5<double>(_input);
     }
 	
     template<typename T>
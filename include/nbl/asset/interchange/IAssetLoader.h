@@ -111,7 +111,9 @@ class NBL_API2 IAssetLoader : public virtual core::IReferenceCounted
 				cacheFlags(rhs.cacheFlags),
 				loaderFlags(rhs.loaderFlags),
 				logger(rhs.logger),
-				workingDirectory(rhs.workingDirectory)
+				workingDirectory(rhs.workingDirectory),
+				baseMipLevel(rhs.baseMipLevel),
+				mipLevelCount(rhs.mipLevelCount)
 			{
 			}
 
@@ -121,6 +123,10 @@ class NBL_API2 IAssetLoader : public virtual core::IReferenceCounted
 			E_LOADER_PARAMETER_FLAGS loaderFlags;				//!< Flags having an impact on extraordinary tasks during loading process
 			std::filesystem::path workingDirectory = "";
 			system::logger_opt_ptr logger;
+			//! Image loaders which can seek to individual mip levels (i.e. KTX2) only decode levels [baseMipLevel,baseMipLevel+mipLevelCount),
+			//! `baseMipLevel` becomes mip level 0 of the loaded image. Partial chains are cached under the file name suffixed with the mip range.
+			uint32_t baseMipLevel = 0u;
+			uint32_t mipLevelCount = ~0u;
 		};
 
 		//! Struct for keeping the state of the current loadoperation for safe threading
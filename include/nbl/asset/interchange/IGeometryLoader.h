@@ -93,6 +93,31 @@ class IGeometryLoader : public IAssetLoader
 			}
 			return {};
 		}
+		// Buffer over `size` bytes of the file starting at `offsetInFile`, adopts the memory of mapped files unless `copy` is set or the range is
+		// past the end of the file. Copies only get the bytes which are in the file, the rest is zeroed so the contents hash the same every time.
+		static inline core::smart_refctd_ptr<ICPUBuffer> createBuffer(core::smart_refctd_ptr<system::IFile>&& file, const size_t offsetInFile, const size_t size, const bool copy=false)
+		{
+			const size_t fileSize = file->getSize();
+			if (offsetInFile>fileSize)
+				return nullptr;
+			const size_t available = fileSize-offsetInFile;
+			if (auto* const basePtr=reinterpret_cast<const uint8_t*>(file->getMappedPointer()); basePtr && !copy && size<=available)
+			{
+				auto resource = core::make_smart_refctd_ptr<CFileMemoryResource>(std::move(file));
+				auto* const data = basePtr+offsetInFile;
+				return ICPUBuffer::create({{size},const_cast<uint8_t*>(data),std::move(resource),0x1ull<<hlsl::findLSB(ptrdiff_t(data))},core::adopt_memory);
+			}
+			auto buffer = ICPUBuffer::create({{size}});
+			if (!buffer)
+				return nullptr;
+			const size_t readSize = core::min(size,available);
+			std::fill_n(reinterpret_cast<uint8_t*>(buffer->getPointer())+readSize,size-readSize,uint8_t(0));
+			system::IFile::success_t success;
+			file->read(success,buffer->getPointer(),offsetInFile,readSize);
+			if (success)
+				return buffer;
+			return nullptr;
+		}
 
 	private:
 };
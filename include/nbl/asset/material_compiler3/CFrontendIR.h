@@ -710,6 +710,9 @@ class CFrontendIR final : public CNodePool
 			CTrueIR* ir;
 			CTrueIR::SMaterialHandle* result;
 			system::logger_opt_ptr logger;
+			// Canonicalize contiguous ranges of materials on worker threads into their own IR pools, then merge them into `ir` in the order of
+			// `rootNodes`, so the handles assigned in `ir` don't depend on scheduling. The logger needs to be thread safe.
+			bool parallel = false;
 		};
 		// returns the number of materials successfully converted
 		inline uint32_t addMaterials(const SAddMaterialsArgs args) const
@@ -720,6 +723,8 @@ class CFrontendIR final : public CNodePool
 				args.logger.log("Invalid Arguments to `CTrueIR::addMaterials`",system::ILogger::ELL_ERROR);
 				return retval;
 			}
+			if (args.parallel)
+				return addMaterialsParallel(args);
 			SAdd2IRSession session = {args};
 			auto outIt = args.result;
 			for (const auto& rootH : args.rootNodes)
@@ -774,6 +779,8 @@ class CFrontendIR final : public CNodePool
 
 	protected:
 		using CNodePool::CNodePool;
+
+		NBL_API2 uint32_t addMaterialsParallel(const SAddMaterialsArgs& args) const;
 		
 		struct SAdd2IRSession final
 		{
@@ -16,7 +16,7 @@ namespace nbl::asset::material_compiler3
 {
 
 // Class to manage all nodes' backing and hand them out as `uint32_t` handles
-class CNodePool : public core::IReferenceCounted
+class CNodePool : public virtual core::IReferenceCounted
 {
 		struct Config
 		{
@@ -59,6 +59,52 @@ class CNodePool : public core::IReferenceCounted
 		template<typename T> requires std::is_base_of_v<INode,std::remove_const_t<T>>
 		using typed_pointer_type = obj_pool_type::template typed_pointer_type<T>;
 
+		// Objects restored from serialized pool memory get constructed in place by a constructor taking this tag, the bytes which were in the slot
+		// get copied aside beforehand and the constructor picks its members' values out of that copy by their offset from the start of the object.
+		struct SRestoreTag
+		{
+			inline const uint8_t* imageOf(const void* member) const {return image+(reinterpret_cast<const uint8_t*>(member)-storage);}
+			// whether a member lies within the slot
+			inline bool fits(const void* member, const size_t bytes) const
+			{
+				const auto offset = reinterpret_cast<const uint8_t*>(member)-storage;
+				return offset>=0 && size_t(offset)+bytes<=size;
+			}
+
+			// only for trivially copyable members, the ones holding anything else need special handling
+			template<typename T>
+			inline T read(const void* member) const
+			{
+				static_assert(std::is_trivially_copyable_v<T>);
+				T retval = {};
+				if (fits(member,sizeof(T)))
+					memcpy(&retval,imageOf(member),sizeof(T));
+				else
+					fail();
+				return retval;
+			}
+			template<typename T>
+			inline T operator()(const T& member) const {return read<T>(&member);}
+			// for trailing data of variable sized objects
+			inline void copy(void* dst, const size_t bytes) const
+			{
+				if (fits(dst,bytes))
+					memcpy(dst,imageOf(dst),bytes);
+				else
+					fail();
+			}
+
+			inline void fail() const {valid = false;}
+
+			// where the object is getting constructed
+			const uint8_t* storage;
+			// copy of the slot's contents, same size as the slot
+			const uint8_t* image;
+			size_t size;
+			// constructors can't fail, so they flag bad contents here and get destroyed after
+			mutable bool valid = true;
+		};
+
 		// Debug Info node
 		class CDebugInfo : public obj_pool_type::IVariableSize, public INode
 		{
@@ -86,6 +132,10 @@ class CNodePool : public core::IReferenceCounted
 						memcpy(out,view.data(),m_size);
 					out[m_size-1] = 0;
 				}
+				inline CDebugInfo(const SRestoreTag& tag) : m_size(restoredSize(tag))
+				{
+					tag.copy(this+1,m_size);
+				}
 
 				inline const std::span<const uint8_t> data() const
 				{
@@ -93,6 +143,16 @@ class CNodePool : public core::IReferenceCounted
 				}
 
 			protected:
+				// the size must leave the trailing data within the slot
+				inline uint32_t restoredSize(const SRestoreTag& tag) const
+				{
+					const auto size = tag.read<uint32_t>(&m_size);
+					if (calc_size(nullptr,size)<=tag.size)
+						return size;
+					tag.fail();
+					return 0;
+				}
+
 				const uint32_t m_size;
 		};
 		// copy the debug nodes between pools
@@ -6,6 +6,7 @@
 
 
 #include "nbl/system/ILogger.h"
+#include "nbl/system/IFile.h"
 #include "nbl/system/to_string.h"
 
 #include "nbl/asset/material_compiler3/CNodePool.h"
@@ -17,7 +18,7 @@ namespace nbl::asset::material_compiler3
 
 // You make the Materials with a classical expression IR, one Root Node per material's interface layer, but here they're in "Accumulator Form"
 // They appear "flipped upside down", its expected our backends will evaluate contributors first, and then bother with the attenuators. 
-class CTrueIR : public CNodePool // TODO: turn into an asset!
+class CTrueIR : public CNodePool, public IAsset
 {
 	    using block_allocator_type = CNodePool::obj_pool_type::block_allocator_type;
 		template<typename T>
@@ -197,6 +198,53 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 			hlsl::float32_t2x2 reference = hlsl::float32_t2x2(0,0,0,0);
 		};
 
+		// Nodes restored from serialized pool memory get constructed by a constructor taking this, parameters' image views need resolving
+		struct SRestoreTag : CNodePool::SRestoreTag
+		{
+			using CNodePool::SRestoreTag::operator();
+			inline SParameter operator()(const SParameter& member) const
+			{
+				// same layout as `SParameter` but the view slot holds whatever bits `resolveView` turns back into a reference
+				struct SParameterImage
+				{
+					float scale;
+					uint16_t viewChannel : 2;
+					uint16_t linearMagnification : 1;
+					hlsl::TextureClamp wrapU : 3;
+					hlsl::TextureClamp wrapV : 3;
+					hlsl::TextureClamp wrapW : 3;
+					uint16_t borderColor : 3;
+					uint8_t padding[2];
+					uintptr_t view;
+				};
+				static_assert(sizeof(SParameterImage)==sizeof(SParameter) && alignof(SParameterImage)==alignof(SParameter));
+				const auto image = read<SParameterImage>(&member);
+				SParameter retval = {
+					.scale = image.scale,
+					.viewChannel = image.viewChannel,
+					.linearMagnification = image.linearMagnification,
+					.wrapU = image.wrapU,
+					.wrapV = image.wrapV,
+					.wrapW = image.wrapW,
+					.borderColor = image.borderColor
+				};
+				std::copy_n(image.padding,sizeof(image.padding),retval.padding);
+				if (!(*resolveView)(image.view,retval.view))
+					fail();
+				return retval;
+			}
+			// `count` can be larger than `Count` for the variable sized parameter sets
+			template<uint8_t Count>
+			inline void parameters(SParameterSet<Count>& dst, const uint8_t count=Count) const
+			{
+				dst.uvTransform = operator()(dst.uvTransform);
+				for (uint8_t i=0; i<count; i++)
+					dst.params[i] = operator()(dst.params[i]);
+			}
+
+			const std::function<bool(uintptr_t,core::smart_refctd_ptr<const ICPUImageView>&)>* resolveView = nullptr;
+		};
+
 		// basic "built-in" nodes
 		class INode : public CNodePool::INode
 		{
@@ -219,22 +267,130 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				};
 				virtual EFinalType getFinalType() const = 0;
 
-				const auto& getHash() const {return hash;}
+				// Feeds the same node state to either a Blake3 hasher or a cheap 64-bit hash, so every node has one `computeHash_impl` for both.
+				// The cheap hash may skip some of the state (it only has to be equal for nodes with equal Blake3 hashes), collisions get resolved by Blake3.
+				class SHasher final
+				{
+					public:
+						// null `blake3` makes it compute just the 64-bit pre-hash
+						inline SHasher(core::blake3_hasher* blake3) : m_blake3(blake3) {}
+
+						template<typename T>
+						inline SHasher& operator<<(const T& input)
+						{
+							if (m_blake3)
+								*m_blake3 << input;
+							else
+								preHash(input);
+							return *this;
+						}
+
+						// children need to be hashed already, their Blake3 hash gets computed on demand
+						inline bool child(const obj_pool_type& pool, const _typed_pointer_type<const INode> handle)
+						{
+							const auto* const node = pool.deref(handle);
+							if (!node || !node->isHashed())
+								return false;
+							if (m_blake3)
+								*m_blake3 << node->getHash(pool);
+							else
+								mix(node->getPreHash());
+							return true;
+						}
+						inline void nullChild()
+						{
+							if (m_blake3)
+								*m_blake3 << core::blake3_hash_t::EmptyInput();
+							else
+								mix(0x6a09e667f3bcc908ull);
+						}
+
+						// zero is reserved for "not hashed"
+						inline uint64_t getPreHash() const {return m_preHash ? m_preHash:1ull;}
+
+					private:
+						inline void mix(const uint64_t word)
+						{
+							m_preHash = (m_preHash^word)*0x9e3779b97f4a7c15ull;
+							m_preHash ^= m_preHash>>29;
+						}
+						template<typename T>
+						inline void preHash(const T& input)
+						{
+							static_assert(std::is_trivially_copyable_v<T>);
+							const auto* in = reinterpret_cast<const uint8_t*>(&input);
+							size_t bytes = sizeof(T);
+							for (; bytes>=sizeof(uint64_t); bytes-=sizeof(uint64_t), in+=sizeof(uint64_t))
+							{
+								uint64_t word;
+								std::memcpy(&word,in,sizeof(word));
+								mix(word);
+							}
+							if (bytes)
+							{
+								uint64_t word = uint64_t(bytes)<<56;
+								std::memcpy(&word,in,bytes);
+								mix(word);
+							}
+						}
+						// only the scale and view, the rest of the sampling state is left to Blake3
+						inline void preHash(const SParameter& param)
+						{
+							preHash(param.scale);
+							mix(reinterpret_cast<uint64_t>(param.view.get()));
+						}
+						template<uint8_t Count>
+						inline void preHash(const SParameterSet<Count>& input)
+						{
+							for (uint8_t i=0; i<Count; i++)
+								preHash(input.params[i]);
+						}
+						inline void preHash(const SBasicNDFParams& input) {preHash(static_cast<const SParameterSet<4>&>(input));}
+
+						core::blake3_hasher* m_blake3;
+						uint64_t m_preHash = 0xcbf29ce484222325ull;
+				};
 
-				// only call once the nodes underneath are linked up (because it doesn't call recursively), returning empty hash means error/invalid node
+				// only call once the nodes underneath are hashed (because it doesn't call recursively), returning empty hash means error/invalid node
 				inline core::blake3_hash_t computeHash(const obj_pool_type& pool) const
 				{
-					core::blake3_hasher hasher = {};
+					core::blake3_hasher blake3 = {};
+					SHasher hasher(&blake3);
 					// always put the node type into the hash
 					hasher << static_cast<uint8_t>(getFinalType());
 					if (!computeHash_impl(pool,hasher))
  						return core::blake3_hash_t::EmptyInput();
-					return hasher.operator core::blake3_hash_t();
+					return blake3.operator core::blake3_hash_t();
+				}
+				// same requirements and validation as `computeHash` but a lot cheaper, zero means error/invalid node
+				inline uint64_t computePreHash(const obj_pool_type& pool) const
+				{
+					SHasher hasher(nullptr);
+					hasher << static_cast<uint8_t>(getFinalType());
+					if (!computeHash_impl(pool,hasher))
+						return 0ull;
+					return hasher.getPreHash();
+				}
+				// Validates the node and hashes it, only the pre-hash gets computed, the Blake3 hash gets computed lazily by `getHash` when needed.
+				inline bool recomputePreHash(const obj_pool_type& pool)
+				{
+					preHash = computePreHash(pool);
+					hash = core::blake3_hash_t::EmptyInput();
+					return isHashed();
 				}
 				inline bool recomputeHash(const obj_pool_type& pool)
 				{
-					hash = computeHash(pool);
-					return hash!=core::blake3_hash_t::EmptyInput();
+					return recomputePreHash(pool) && getHash(pool)!=core::blake3_hash_t::EmptyInput();
+				}
+				// hashed nodes are final
+				inline bool isHashed() const {return preHash;}
+				inline uint64_t getPreHash() const {return preHash;}
+				// empty if the node isn't hashed
+				inline const core::blake3_hash_t& getHash(const obj_pool_type& pool) const
+				{
+					if (isHashed() && hash==core::blake3_hash_t::EmptyInput())
+						hash = computeHash(pool);
+					return hash;
 				}
 
 				virtual _typed_pointer_type<INode> copy(CTrueIR* ir) const = 0;
@@ -264,34 +420,47 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 					return getChildName_impl(ix);
 				}
 
+				// the only references to anything outside the pool are the image views in the parameters
+				inline std::span<SParameter> getParameters() {return getParameters_impl();}
+				inline std::span<const SParameter> getParameters() const {return const_cast<INode*>(this)->getParameters_impl();}
+
 				//
 				virtual inline void printDot(std::ostringstream& sstr, const core::string& selfID) const {}
 				virtual inline core::string getLabelSuffix() const {return "";}
 
 			protected:
+				inline INode() = default;
+				// the hashes get restored too, so the unique nodes stay unique
+				inline INode(const SRestoreTag& tag)
+				{
+					hash = tag(hash);
+					preHash = tag(preHash);
+				}
+
 				// child managment
 				virtual inline _typed_pointer_type<const INode> getChildHandle_impl(const uint8_t ix) const { assert(false); return {}; }
 				virtual inline void setChild_impl(const obj_pool_type& pool, const uint8_t ix, _typed_pointer_type<const INode> newChild) { assert(false); }
 
 				virtual inline std::string_view getChildName_impl(const uint8_t ix) const {return "";}
 
-				virtual bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const = 0;
+				virtual inline std::span<SParameter> getParameters_impl() {return {};}
+
+				virtual bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const = 0;
 #define HASH_REQUIREDS_HASH(HANDLE) { \
-					if (const auto hash=pool.deref(HANDLE)->getHash(); hash==core::blake3_hash_t::EmptyInput()) \
+					if (!hasher.child(pool,HANDLE)) \
 						return false; \
-					else \
-						hasher << hash; \
 				}
-#define HASH_OPTIONALS_HASH(HANDLE) if (HANDLE) {HASH_REQUIREDS_HASH(HANDLE);} else {hasher << core::blake3_hash_t::EmptyInput();}
+#define HASH_OPTIONALS_HASH(HANDLE) if (HANDLE) {HASH_REQUIREDS_HASH(HANDLE);} else {hasher.nullChild();}
 
 #define COPY_DEFAULT_IMPL inline _typed_pointer_type<INode> copy(CTrueIR* ir) const override final \
 				{ \
 					return CNodePool::copyNode<std::remove_const_t<std::remove_pointer_t<decltype(this)> > >(this,ir); \
 				}
 
-				// Each node is final and immutable, has a precomputed hash for the whole subtree beneath it.
+				// Each node is final and immutable once hashed, has a precomputed pre-hash for the whole subtree beneath it and a lazily computed Blake3 hash.
 				// Debug info does not form part of the hash, so can get wildly replaced.
-				core::blake3_hash_t hash = core::blake3_hash_t::EmptyInput();
+				mutable core::blake3_hash_t hash = core::blake3_hash_t::EmptyInput();
+				uint64_t preHash = 0ull;
 		};
 		//
 		template<typename T> requires std::is_base_of_v<INode,std::remove_const_t<T>>
@@ -302,11 +471,20 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		{
 			public:
 				virtual bool isEmitter() const = 0;
+
+			protected:
+				using INode::INode;
 		};
 		// this is for a term in a mul or add expression
 		class IFactor : public INode
 		{
 			protected:
+				inline IFactor() = default;
+				inline IFactor(const SRestoreTag& tag) : INode(tag)
+				{
+					padding = tag(padding);
+				}
+
 				uint64_t padding = 0;
 		};
 #define TYPE_NAME_STR(NAME) "nbl::asset::material_compiler3::CTrueIR::"#NAME
@@ -344,6 +522,20 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 					padding = std::bit_cast<uint64_t>(state);
 					std::uninitialized_default_construct_n(child,state.childCount);
 				}
+				inline CFactorCombiner(const SRestoreTag& tag) : IFactor(tag)
+				{
+					auto state = getState();
+					// the children must fit within the slot
+					if (state.childCount==0 || calc_size(state)>tag.size)
+					{
+						tag.fail();
+						state.childCount = 0;
+						padding = std::bit_cast<uint64_t>(state);
+					}
+					std::uninitialized_default_construct_n(child,state.childCount);
+					for (uint8_t c=0; c<state.childCount; c++)
+						child[c] = tag(child[c]);
+				}
 
 				//
 				inline SState getState() const {return std::bit_cast<SState>(padding);}
@@ -369,7 +561,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				inline core::string getLabelSuffix() const override {return getState().type==Type::Mul ? "\\nMUL":"\\nADD";}
 
 			protected:
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					if (getState().childCount==0)
 						return false;
@@ -395,8 +587,13 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 					const auto copyH = pool.emplace<std::remove_const_t<std::remove_pointer_t<decltype(this)> > >(getState());
 					// default copy doesn't call copy on the children, references are copied by value (this is not a deep copy!)
 					if (auto* const copy=pool.deref(copyH); copyH)
-					for (uint64_t c=0; c<getState().childCount; c++) 
-						copy->child[c] = child[c];
+					{
+						for (uint64_t c=0; c<getState().childCount; c++) 
+							copy->child[c] = child[c];
+						// same as `copyNode`, the hashes come along
+						copy->hash = hash;
+						copy->preHash = preHash;
+					}
 					return copyH;
 				}
 
@@ -405,7 +602,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		// Note that this is not a root node, its a flipped leaf!
 		class CWeightedContributor final : public obj_pool_type::INonTrivial, public INode
 		{
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					if (!contributor)
 						return false;
@@ -423,6 +620,13 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				inline const std::string_view getTypeName() const override {return TYPE_NAME_STR(CWeightedContributor);}
 				inline std::string_view getChildName_impl(const uint8_t ix) const override final { return ix ? "factor" : "contributor"; }
 
+				inline CWeightedContributor() = default;
+				inline CWeightedContributor(const SRestoreTag& tag) : INode(tag)
+				{
+					contributor = tag(contributor);
+					factor = tag(factor);
+				}
+
 
 				typed_pointer_type<const IContributor> contributor = {};
 				// if null then assumed to be 1
@@ -461,7 +665,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				// Also BxDFs and Emitters (which only hold IES profiles) are monochromatic so accumulating their contribution first uses least registers.
 				// Fresnel, Beer extinction and other analytic modifiers never produce 0s so should be evaluated last.
 				// Function factors which have to be evaluated via composition go even later, but within their dimension category.
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					if (product)
 					{
@@ -481,6 +685,13 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				inline const std::string_view getTypeName() const override {return TYPE_NAME_STR(CContributorSum);}
 				inline std::string_view getChildName_impl(const uint8_t ix) const override final { return ix ? "rest" : "product"; }
 
+				inline CContributorSum() = default;
+				inline CContributorSum(const SRestoreTag& tag) : INode(tag)
+				{
+					product = tag(product);
+					rest = tag(rest);
+				}
+
 				// the product is ...
 				typed_pointer_type<const CWeightedContributor> product = {};
 				// the rest node is ...
@@ -509,7 +720,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		// Corellated layering is a far far far TODO, all it means that certain convolutions don't happen - certain BxDFs don't layer over each other (tricky to express in AST and IR)
 		class CCorellatedTransmission final : public obj_pool_type::INonTrivial, public INode
 		{
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					// invalid combo, null btdf prevents you crossing over to the next layer and hitting current from below
 					// also if there's no btdf it makes no sense to have a `next` sibling.
@@ -545,6 +756,13 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 
 				// you can set the children later
 				inline CCorellatedTransmission() = default;
+				inline CCorellatedTransmission(const SRestoreTag& tag) : INode(tag)
+				{
+					btdf = tag(btdf);
+					brdfBottom = tag(brdfBottom);
+					coated = tag(coated);
+					next = tag(next);
+				}
 
 				// Obligatory if you don't want transmission then don't put a valid handle in `COrientedLayer::firstTransmission`
 				// Also shouldn't contain `CDeltaTransmission` in the BTDF unless `coated` is null (TODO a check for that)
@@ -594,7 +812,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		// The oriented layer is a layer with already all the Etas reciprocated, etc.
 		class COrientedLayer final : public obj_pool_type::INonTrivial, public INode
 		{
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					HASH_OPTIONALS_HASH(brdfTop);
 					HASH_OPTIONALS_HASH(firstTransmission);
@@ -610,6 +828,11 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 
 				// you can set the children later
 				inline COrientedLayer() = default;
+				inline COrientedLayer(const SRestoreTag& tag) : INode(tag)
+				{
+					brdfTop = tag(brdfTop);
+					firstTransmission = tag(firstTransmission);
+				}
 
 				// These are same as the frontend's except that all the etas are oriented and reciprocated
 				typed_pointer_type<const CContributorSum> brdfTop = {};
@@ -641,6 +864,9 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				inline bool isScalar() const {return getSpectralBins()==1;}
 
 				virtual uint8_t getSpectralBins() const = 0;
+
+			protected:
+				using IFactor::IFactor;
 		};
 		//
 		class ISpectralVariable
@@ -766,6 +992,23 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				inline CSpectralVariable(const uint8_t knotCount) : OtherBase() {ISpectralVariable::init(knotCount);}
 				inline CSpectralVariable(const ISpectralVariable& other) : OtherBase() {ISpectralVariable::init(other);}
 				inline CSpectralVariable(const uint8_t knotCount, const ISpectralVariable& other) : OtherBase() {ISpectralVariable::init(knotCount,other);}
+				inline CSpectralVariable(const SRestoreTag& tag) : OtherBase(tag)
+				{
+					// the knot count lives in the first parameter's padding, find where that is without an object
+					const SParameterSet<1> probe = {};
+					const auto knotCountOffset = reinterpret_cast<const uint8_t*>(probe.params[0].padding+1)-reinterpret_cast<const uint8_t*>(&probe);
+					auto knotCount = tag.read<uint8_t>(reinterpret_cast<const uint8_t*>(pWonky())+knotCountOffset);
+					// the knots must fit within the slot
+					if (knotCount==0 || calc_size(knotCount)>tag.size)
+					{
+						tag.fail();
+						knotCount = 1;
+					}
+					ISpectralVariable::init(knotCount);
+					tag.parameters(*pWonky(),knotCount);
+					// don't let a bad count through, the destructor relies on it
+					pWonky()->params[0].padding[1] = knotCount;
+				}
 				
 				//
 				inline _typed_pointer_type<this_t> copy(obj_pool_type& pool) const
@@ -792,11 +1035,15 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				
 				// TODO: improve the token pasting here
 				inline const std::string_view getTypeName() const override final {return TYPE_NAME_STR(CSpectralVariable<SpectralBins>);}
+
+			private:
+				// to destroy the nodes which failed restoring
+				friend class CTrueIR;
 		};
 		//
 		class ISpectralVariableFactor : public ISpectralVariable, public IFactorLeaf
 		{
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override final
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override final
 				{
 					const auto count = getKnotCount();
 					hasher << count;
@@ -843,9 +1090,22 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				NBL_API2 void printDot(std::ostringstream& sstr, const core::string& selfID) const override final;
 
 		    protected:
+				inline ISpectralVariableFactor() = default;
+				inline ISpectralVariableFactor(const SRestoreTag& tag) : IFactorLeaf(tag) {}
+
+				inline std::span<SParameter> getParameters_impl() override final {return {pWonky()->params,getKnotCount()};}
+
 				inline _typed_pointer_type<INode> copy(CTrueIR* ir) const override final
 				{
-					return static_cast<const CSpectralVariableFactor*>(this)->copy(ir->getObjectPool());
+					auto& pool = ir->getObjectPool();
+					const auto copyH = static_cast<const CSpectralVariableFactor*>(this)->copy(pool);
+					// same as `copyNode`, the hashes come along
+					if (auto* const copy=pool.deref(copyH); copy)
+					{
+						copy->hash = hash;
+						copy->preHash = preHash;
+					}
+					return copyH;
 				}
 		};
 		using CSpectralVariableFactor = CSpectralVariable<ISpectralVariableFactor>;
@@ -853,7 +1113,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		// Unit Radiance emitter modulated by an IES profile
 		class CEmitter final : public obj_pool_type::INonTrivial, public IContributor
 		{
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					hasher << profileTransform;
 					if (profile.view)
@@ -884,6 +1144,11 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 
 				// you can set the members later
 				inline CEmitter() = default;
+				inline CEmitter(const SRestoreTag& tag) : IContributor(tag)
+				{
+					profile = tag(profile);
+					profileTransform = tag(profileTransform);
+				}
 
 				// This can be anything like an IES profile, if invalid, there's no directionality to the emission
 				// `profile.scale` can still be used to influence the light strength without influencing NEE light picking probabilities
@@ -898,6 +1163,8 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				NBL_API2 void printDot(std::ostringstream& sstr, const core::string& selfID) const override final;
 
 		    protected:
+				inline std::span<SParameter> getParameters_impl() override final {return {&profile,1};}
+
 			    COPY_DEFAULT_IMPL
 		};
 
@@ -942,11 +1209,14 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		{
 			public:
 				inline bool isEmitter() const override {return false;}
+
+			protected:
+				using IContributor::IContributor;
 		};
 		class CDeltaTransmission final : public obj_pool_type::INonTrivial, public IBxDF
 		{
 				// nothing to do
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override {return true;}
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override {return true;}
 
 			public:
 				inline EFinalType getFinalType() const override {return EFinalType::CDeltaTransmission;}
@@ -956,6 +1226,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				inline const std::string_view getTypeName() const override {return TYPE_NAME_STR(CDeltaTransmission);}
 
 				inline CDeltaTransmission() = default;
+				inline CDeltaTransmission(const SRestoreTag& tag) : IBxDF(tag) {}
 
 		    protected:
 			    COPY_DEFAULT_IMPL
@@ -963,7 +1234,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		class IBxDFWithNDF : public IBxDF
 		{
 			protected:
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					hasher << ndfParams;
 					return true;
@@ -976,11 +1247,21 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				}
 
 				SBasicNDFParams ndfParams = {};
+
+			protected:
+				inline IBxDFWithNDF() = default;
+				inline IBxDFWithNDF(const SRestoreTag& tag) : IBxDF(tag)
+				{
+					tag.parameters(ndfParams);
+					ndfParams.reference = tag(ndfParams.reference);
+				}
+
+				inline std::span<SParameter> getParameters_impl() override final {return ndfParams.params;}
 		};
 		class COrenNayar final : public obj_pool_type::INonTrivial, public IBxDFWithNDF
 		{
 			public:
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					if (ndfParams.getDistribution()!=SBasicNDFParams::EDistribution::Invalid)
 						return false;
@@ -995,13 +1276,14 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				inline const std::string_view getTypeName() const override {return TYPE_NAME_STR(COrenNayar);}
 
 				inline COrenNayar() = default;
+				inline COrenNayar(const SRestoreTag& tag) : IBxDFWithNDF(tag) {}
 
 		    protected:
 			    COPY_DEFAULT_IMPL
 		};
 		class CCookTorrance final : public obj_pool_type::INonTrivial, public IBxDFWithNDF
 		{
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					if (ndfParams.getDistribution()>SBasicNDFParams::EDistribution::Beckmann)
 						return false;
@@ -1034,6 +1316,10 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				}
 
 				inline CCookTorrance() = default;
+				inline CCookTorrance(const SRestoreTag& tag) : IBxDFWithNDF(tag)
+				{
+					orientedRealEta = tag(orientedRealEta);
+				}
 
 				//
 				inline bool isEtaReciprocal() const {return ndfParams.params[2].padding[0];}
@@ -1067,19 +1353,29 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				}
 
 				//
-				inline core::string getLabelSuffix() const override {return "\\nscalar = "+core::string(scalar ? "true":"false");}
+				inline core::string getLabelSuffix() const override {return "\\nscalar = "+core::string(flags.scalar ? "true":"false");}
 
 				//
-				inline uint8_t getSpectralBins() const override {return scalar ? 1:3;}
+				inline uint8_t getSpectralBins() const override {return flags.scalar ? 1:3;}
 
-				uint64_t scalar : 1 = true;
-				uint64_t padding : 63 = 0;
+				// kept together so they can be restored as a whole
+				struct SFlags
+				{
+					uint64_t scalar : 1 = true;
+					uint64_t padding : 63 = 0;
+				} flags = {};
 
 			protected:
+				inline IFunctionNode() = default;
+				inline IFunctionNode(const SRestoreTag& tag) : IFactorLeaf(tag)
+				{
+					flags = tag(flags);
+				}
+
 				virtual uint8_t getChildCount_impl() const = 0;
-				inline void computeHash_common(const obj_pool_type& pool, core::blake3_hasher& hasher) const
+				inline void computeHash_common(const obj_pool_type& pool, SHasher& hasher) const
 				{
-					hasher << scalar;
+					hasher << flags.scalar;
 				}
 		};
 		// Effective transparency = exp2(log2(perpTransmittance)*thickness/dot(refract(V,X,eta),X)) = exp2(log2(perpTransmittance)*thickness*inversesqrt(1.f+(LdotX-1)*rcpEta))
@@ -1087,7 +1383,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		// Note: its allowed to apply Beer directly on BRDF as well as BTDF to simulate foggy extinction on the top layer
 		class CBeer final : public IFunctionNode
 		{
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					computeHash_common(pool,hasher);
 					HASH_REQUIREDS_HASH(perpTransmittance);
@@ -1104,6 +1400,13 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 
 				inline std::string_view getChildName_impl(const uint8_t ix) const override final {return ix ? "Thickness":"Perpendicular\\nTransmittance";}
 
+				inline CBeer() = default;
+				inline CBeer(const SRestoreTag& tag) : IFunctionNode(tag)
+				{
+					perpTransmittance = tag(perpTransmittance);
+					thickness = tag(thickness);
+				}
+
 				// cannot be null, otherwise no point being there as term will multiply to 0
 				typed_pointer_type<const IFactor> perpTransmittance = {};
 				// cannot be null, otherwise its always exp2(0) and term will always be 1
@@ -1128,7 +1431,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		};
 		class CFresnel final : public IFunctionNode
 		{
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					computeHash_common(pool,hasher);
 					hasher << getReciprocateEtas();
@@ -1158,8 +1461,15 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 					return IFunctionNode::getLabelSuffix()+"\\nReciprocateEta = "+(getReciprocateEtas() ? "true" : "false");
 				}
 
-				inline bool getReciprocateEtas() const {return padding;}
-				inline void setReciprocateEtas(const bool value) {padding = value;}
+				inline bool getReciprocateEtas() const {return flags.padding;}
+				inline void setReciprocateEtas(const bool value) {flags.padding = value;}
+
+				inline CFresnel() = default;
+				inline CFresnel(const SRestoreTag& tag) : IFunctionNode(tag)
+				{
+					orientedRealEta = tag(orientedRealEta);
+					orientedImagEta = tag(orientedImagEta);
+				}
 
 				// cannot be null or a constant of 1 while imaginary is null
 				typed_pointer_type<const IFactor> orientedRealEta = {};
@@ -1185,7 +1495,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		};
 		class CThinInfiniteScatterCorrection final : public IFunctionNode
 		{
-				inline bool computeHash_impl(const obj_pool_type& pool, core::blake3_hasher& hasher) const override
+				inline bool computeHash_impl(const obj_pool_type& pool, SHasher& hasher) const override
 				{
 					computeHash_common(pool,hasher);
 					HASH_REQUIREDS_HASH(reflectanceTop);
@@ -1206,6 +1516,14 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 
 				inline std::string_view getChildName_impl(const uint8_t ix) const override final {return ix ? (ix>1 ? "reflectanceBottom":"extinction"):"reflectanceTop";}
 
+				inline CThinInfiniteScatterCorrection() = default;
+				inline CThinInfiniteScatterCorrection(const SRestoreTag& tag) : IFunctionNode(tag)
+				{
+					reflectanceTop = tag(reflectanceTop);
+					extinction = tag(extinction);
+					reflectanceBottom = tag(reflectanceBottom);
+				}
+
 				// cannot be null otherwise no point being there
 				typed_pointer_type<const IFactor> reflectanceTop = {};
 				// optional, if null then treated as E=1.0
@@ -1266,22 +1584,48 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 		};
 		const SBasicNodes& getBasicNodes() const {return m_basicNodes;}
 		
-		//
+		//! Hash-consing, nodes are final and immutable once hashed so equal subtrees only need to exist once in the pool.
+		// Returns the handle of an already cached node equal to `origH` if there is one, otherwise caches `origH` and returns it.
+		// The node at `origH` is left alone either way, use `intern` or `create` if you don't keep the original handle around.
 		template<typename T> requires (!std::is_const_v<T> && std::is_base_of_v<INode,T>)
 		inline typed_pointer_type<const T> hashNCache(const typed_pointer_type<T> origH)
 		{
 			auto* const orig = getObjectPool().deref(origH);
 			if (orig)
-			if (orig->getHash()!=core::blake3_hash_t::EmptyInput() || orig->recomputeHash(getObjectPool()))
+			if (orig->isHashed() || orig->recomputePreHash(getObjectPool()))
 			{
-				auto& slot = m_uniqueNodes[orig->getHash()];
-				if (slot) // not dynamic cast because the type was part of the hash!
-					return CNodePool::obj_pool_type::block_allocator_type::_static_cast<const T>(slot);
-				slot = origH;
+				// not dynamic cast because the type was part of the hash!
+				if (const auto found=findUnique(orig); found)
+					return CNodePool::obj_pool_type::block_allocator_type::_static_cast<const T>(found);
+				insertUnique(orig,origH);
 				return origH;
 			}
 			return {};
 		}
+		// Same as `hashNCache` but the node at `origH` gets deleted when an equal one already exists, so `origH` must not be referenced anywhere.
+		template<typename T> requires (!std::is_const_v<T> && std::is_base_of_v<INode,T>)
+		inline typed_pointer_type<const T> intern(const typed_pointer_type<T> origH)
+		{
+			const auto uniqueH = hashNCache(origH);
+			if (uniqueH && uniqueH!=typed_pointer_type<const T>(origH))
+				getObjectPool()._delete(origH);
+			return uniqueH;
+		}
+		// Makes the node, lets `init` fill it in (children must already be unique) and interns it. Returns null and cleans up if `init` returns false.
+		template<typename T, typename Init, typename... Args> requires (!std::is_const_v<T> && std::is_base_of_v<INode,T> && std::is_invocable_r_v<bool,Init,T*>)
+		inline typed_pointer_type<const T> create(Init&& init, Args&&... args)
+		{
+			auto& pool = getObjectPool();
+			const auto h = pool.template emplace<T>(std::forward<Args>(args)...);
+			if (auto* const node=pool.deref(h); node)
+			{
+				if (init(node))
+				if (const auto uniqueH=intern(h); uniqueH)
+					return uniqueH;
+				pool._delete(h);
+			}
+			return {};
+		}
 
 		// Each material comes down to this, this is the only struct we don't de-duplicate
 		struct SMaterial
@@ -1354,6 +1698,22 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 			m_materials = {SMaterial{.debugInfo=getObjectPool().emplace<CNodePool::CDebugInfo>("CTrueIR's BlackHole Material")}};
 		}
 
+		//! IAsset
+		constexpr static inline auto AssetType = ET_MATERIAL_IR;
+		inline E_TYPE getAssetType() const override {return AssetType;}
+		// image views are immutable, so the clone keeps referencing them regardless of `_depth`
+		NBL_API2 core::smart_refctd_ptr<IAsset> clone(uint32_t _depth=~0u) const override;
+		inline bool valid() const override {return !m_materials.empty();}
+
+		//! Serialization, handles are position independent so the pool's memory gets stored block by block as-is and on load every node gets
+		//! constructed over its slot by its `SRestoreTag` constructor, which reads the members back from a copy of the slot. Texture references get written as indices into `outViews`, the views are dependants which you need to persist
+		//! yourself and pass back to `load` in the same order. Node layouts are stored verbatim, so only the same build can load a file back,
+		//! treat these as caches of compiled material libraries and not as an interchange format.
+		NBL_API2 bool save(system::IFile* file, core::vector<core::smart_refctd_ptr<const ICPUImageView>>& outViews) const;
+		// The block size of `params` gets overriden by the one from the file. Fails unless every handle in the file (material roots, children,
+		// unique nodes) points at an object of the right type which the file holds.
+		NBL_API2 static core::smart_refctd_ptr<CTrueIR> load(system::IFile* file, const std::span<const core::smart_refctd_ptr<const ICPUImageView>> views, creation_params_type&& params={});
+
 		//! Utitilies for copying from other IR into ours while optimizing
 		// This one doesn't touch your coated nodes, but only the first coating
 		inline bool rewriteSingleLayer(typed_pointer_type<const COrientedLayer>& singleLayer, SMaterial::SMetadata& metadata, CTrueIR* srcIR)
@@ -1372,24 +1732,31 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 			if (material.front.root)
 			{
 				session.changeMetadata(&material.front.metadata);
-				session.rewrite(material.front.root);
+				if (!session.rewrite(material.front.root))
+					return false;
 			}
 			if (material.back.root)
 			{
 				session.changeMetadata(&material.back.metadata);
-				session.rewrite(material.back.root);
+				if (!session.rewrite(material.back.root))
+					return false;
 			}
 			if (material.debugInfo && srcIR!=this)
 			{
-				// TODO: copy the debug info across into new pool
-				assert(false);
-				material = {};
-				return false;
+				material.debugInfo = copyDebugInfo(material.debugInfo,srcIR);
+				if (!material.debugInfo)
+					return false;
 			}
 			return true;
 		}
 
-		uint32_t deepCopy(typed_pointer_type<INode>* out, const std::span<const typed_pointer_type<const INode>> orig, const CTrueIR* srcIR=nullptr);
+		inline uint32_t deepCopy(typed_pointer_type<INode>* out, const std::span<const typed_pointer_type<const INode>> orig, const CTrueIR* srcIR=nullptr)
+		{
+			core::unordered_map<typed_pointer_type<const INode>,typed_pointer_type<INode>> substitutions;
+			return deepCopy(out,orig,srcIR,substitutions);
+		}
+		// Nodes already in `substitutions` don't get copied or explored, they get replaced by what they map to. Afterwards it maps every node reached to its copy.
+		uint32_t deepCopy(typed_pointer_type<INode>* out, const std::span<const typed_pointer_type<const INode>> orig, const CTrueIR* srcIR, core::unordered_map<typed_pointer_type<const INode>,typed_pointer_type<INode>>& substitutions);
 		
 		// TODO: Optimization passes on the IR
 		// It is the backend's job to handle:
@@ -1502,6 +1869,9 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 				NBL_API2 bool rewriteSingleLayer(typed_pointer_type<const COrientedLayer>& oriented);
 
 			private:
+				// brings the subgraph of a layer from another IR over into `args.dst`, interned
+				bool copyAcross(typed_pointer_type<const COrientedLayer>& oriented);
+
 				template <typename T, typename... FuncArgs>
 				inline typed_pointer_type<T> emplace(FuncArgs&&... args)
 				{
@@ -1513,6 +1883,8 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 
 				SRewriteArgs args;
 				core::vector<typed_pointer_type<INode>> createdNodes;
+				// source IR nodes already copied across to their unique copies, shared by every layer the session rewrites
+				core::unordered_map<typed_pointer_type<const INode>,typed_pointer_type<const INode>> copies;
 				bool success = true;
 		};
 
@@ -1524,7 +1896,7 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 			core::string retval = getNodeID(handle);
 			retval += " [label=\"";
 			retval += node->getTypeName();
-			retval += "\\n" + system::to_string(node->getHash());
+			retval += "\\n" + system::to_string(node->getHash(getObjectPool()));
 			retval += node->getLabelSuffix();
 			retval += "\"]";
 			return retval;
@@ -1532,9 +1904,53 @@ class CTrueIR : public CNodePool // TODO: turn into an asset!
 
 		NBL_API2 CTrueIR(creation_params_type&& params);
 
+		void visitDependents_impl(std::function<bool(const IAsset*)> visit) const override;
+
+		// allocations which aren't `INode` have this type
+		constexpr static inline uint8_t DebugInfoType = 0xffu;
+		// fails on allocations of unknown types
+		bool gatherAllocations(core::vector<obj_pool_type::SAllocation>& outAllocations, core::vector<uint8_t>& outTypes) const;
+		// replaces the whole contents of the IR
+		struct SRestoreArgs
+		{
+			std::span<const obj_pool_type::block_image_type> blocks;
+			std::span<const obj_pool_type::SAllocation> allocations;
+			// `EFinalType` or `DebugInfoType` of every allocation
+			std::span<const uint8_t> types;
+			std::span<const uint32_t> uniqueNodes;
+			std::span<const SMaterial> materials;
+			// turns the bits left in the view slot of a restored parameter back into a reference
+			std::function<bool(uintptr_t,core::smart_refctd_ptr<const ICPUImageView>&)> resolveView;
+		};
+		bool restore(const SRestoreArgs& args);
+
+		// The unique node table is keyed by the nodes' cheap 64-bit pre-hash, Blake3 hashes only get computed (and kept in the nodes) to confirm a
+		// pre-hash match. On a pre-hash collision we probe the next key. Entries are never erased one by one (only `reset` clears the table)
+		// so the first free key ends a probe sequence.
+		inline typed_pointer_type<const INode> findUnique(const INode* node) const
+		{
+			const auto& pool = getObjectPool();
+			for (auto key=node->getPreHash(); true; key++)
+			{
+				const auto found = m_uniqueNodes.find(key);
+				if (found==m_uniqueNodes.end())
+					return {};
+				const auto* const other = pool.deref(found->second);
+				if (other==node || other->getPreHash()==node->getPreHash() && other->getHash(pool)==node->getHash(pool))
+					return found->second;
+			}
+		}
+		inline void insertUnique(const INode* node, const typed_pointer_type<const INode> h)
+		{
+			auto key = node->getPreHash();
+			while (m_uniqueNodes.find(key)!=m_uniqueNodes.end())
+				key++;
+			m_uniqueNodes[key] = h;
+		}
+
 		core::vector<SMaterial> m_materials;
-		// TODO: either we put the typeid in the hash, or we have a type of hashmap per type
-		core::unordered_map<core::blake3_hash_t,typed_pointer_type<const INode>> m_uniqueNodes;
+		// the type is part of the node hash, so one table for all types
+		core::unordered_map<uint64_t,typed_pointer_type<const INode>> m_uniqueNodes;
 		friend struct SBasicNodes;
 		const SBasicNodes m_basicNodes;
 };
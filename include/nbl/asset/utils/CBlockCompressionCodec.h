@@ -0,0 +1,54 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_BLOCK_COMPRESSION_CODEC_H_INCLUDED_
+#define _NBL_ASSET_C_BLOCK_COMPRESSION_CODEC_H_INCLUDED_
+
+#include "nbl/asset/format/EFormat.h"
+
+namespace nbl::asset
+{
+
+//! CPU encoder and decoder for single 4x4 BCn blocks.
+/*
+	Texels are always exchanged as 16 linear RGBA floats in row-major block order, missing channels are ignored on encode
+	and returned as (0,0,0,1) on decode. For `*_SRGB` formats the codec does the sRGB transfer function itself.
+
+	Encoding covers every BCn format, but only with the modes that cover the common case well:
+	- BC1 uses 4-colour mode, punch-through 3-colour mode for texels with alpha below one half (RGBA only)
+	- BC4/BC5 use the 8-value mode, `EQ_HIGH` additionally tries the 6-value mode with explicit extremes
+	- BC6H only emits mode 11 (single subset, 10-bit direct endpoints)
+	- BC7 only emits mode 6 (single subset RGBA, 7-bit endpoints with p-bits, 4-bit indices)
+	Decoding is complete, every mode of BC6H (all 14) and BC7 (all 8) is handled including the partitioned ones,
+	so blocks produced by any external encoder can be read back. Reserved modes decode to black as the spec demands.
+*/
+class NBL_API2 CBlockCompressionCodec
+{
+	public:
+		CBlockCompressionCodec() = delete;
+		~CBlockCompressionCodec() = delete;
+
+		enum E_QUALITY : uint8_t
+		{
+			//! bounding box endpoints, no refinement
+			EQ_FAST = 0,
+			//! principal axis endpoints with a couple of least-squares refinement passes
+			EQ_NORMAL,
+			//! more refinement passes and exhaustive search over alternative block modes/p-bits
+			EQ_HIGH,
+			EQ_COUNT
+		};
+
+		using texel_block_t = float[16][4];
+
+		static bool canEncode(const E_FORMAT format);
+		static bool canDecode(const E_FORMAT format) {return canEncode(format);}
+
+		//! `outBlock` must point to `getTexelOrBlockBytesize(format)` bytes
+		static bool encodeBlock(const E_FORMAT format, const texel_block_t& texels, void* outBlock, const E_QUALITY quality=EQ_NORMAL);
+		//! returns false for unsupported formats
+		static bool decodeBlock(const E_FORMAT format, const void* block, texel_block_t& outTexels);
+};
+
+}
+#endif
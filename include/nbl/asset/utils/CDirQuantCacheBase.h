@@ -9,6 +9,9 @@
 #include <iostream>
 #include <limits>
 #include <cmath>
+#include <array>
+#include <cstddef>
+#include <shared_mutex>
 
 #include "gtl/phmap_dump.hpp"
 
@@ -262,10 +265,20 @@ class CDirQuantCacheBase : public virtual core::IReferenceCounted, public impl::
 		template<E_FORMAT CacheFormat>
 		using cache_type_t = typename cache_type<CacheFormat>::type;
 
+		// every format's cache is split into this many independently locked maps, so parallel quantization passes can share one cache
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t ShardCount = 64u;
+
 		template<E_FORMAT CacheFormat>
 		inline void insertIntoCache(const Key& key, const value_type_t<CacheFormat>& value)
 		{
-			std::get<cache_type_t<CacheFormat>>(cache).insert(std::make_pair(key,value));		
+			std::get<CShardedCache<CacheFormat>>(cache).insert(key,value);
+		}
+
+		//! Entries in the memory mapped table (if any) come first, then the ones inserted since.
+		template<E_FORMAT CacheFormat>
+		inline bool findInCache(const Key& key, value_type_t<CacheFormat>& value) const
+		{
+			return std::get<CShardedCache<CacheFormat>>(cache).find(key,value);
 		}
 
 		//!
@@ -276,19 +289,18 @@ class CDirQuantCacheBase : public virtual core::IReferenceCounted, public impl::
 			if (!validateSerializedCache<CacheFormat>(buffer))
 				return false;
 
-			auto& particularCache = std::get<cache_type_t<CacheFormat>>(cache);
-			cache_type_t<CacheFormat> backup;
-
-			if (!replaceCurrentContents)
-				backup.swap(particularCache);
-			
+			cache_type_t<CacheFormat> loaded;
 			CBufferPhmapInputArchive buffWrap(buffer);
-			bool loadingSuccess = particularCache.phmap_load(buffWrap);
-
-			if (!replaceCurrentContents || !loadingSuccess)
-				particularCache.merge(std::move(backup));
+			if (!loaded.phmap_load(buffWrap))
+				return false;
 
-			return loadingSuccess;
+			// loaded entries take precedence over the current ones
+			auto& particularCache = std::get<CShardedCache<CacheFormat>>(cache);
+			if (replaceCurrentContents)
+				particularCache.clear();
+			for (const auto& entry : loaded)
+				particularCache.insert(entry.first,entry.second,true);
+			return true;
 		}
 
 		//!
@@ -327,14 +339,12 @@ class CDirQuantCacheBase : public virtual core::IReferenceCounted, public impl::
 		template<E_FORMAT CacheFormat>
 		inline bool saveCacheToBuffer(SBufferRange<ICPUBuffer>& buffer)
 		{
-			const uint64_t bufferSize = buffer.buffer.get()->getSize();
-			const uint64_t offset = buffer.offset;
-
-			if (bufferSize+offset>getSerializedCacheSizeInBytes<CacheFormat>())
+			const auto gathered = std::get<CShardedCache<CacheFormat>>(cache).gather();
+			if (buffer.offset+getSerializedCacheSizeInBytes_impl<CacheFormat>(gathered.capacity())>buffer.buffer.get()->getSize())
 				return false;
 
 			CBufferPhmapOutputArchive buffWrap(buffer);
-			return std::get<cache_type_t<CacheFormat>>(cache).phmap_dump(buffWrap);
+			return gathered.phmap_dump(buffWrap);
 		}
 
 		//!
@@ -349,7 +359,8 @@ class CDirQuantCacheBase : public virtual core::IReferenceCounted, public impl::
 			bufferRange.size = getSerializedCacheSizeInBytes<CacheFormat>();
 			bufferRange.buffer = asset::ICPUBuffer::create({ bufferRange.size });
 		
-			saveCacheToBuffer<CacheFormat>(bufferRange);
+			if (!saveCacheToBuffer<CacheFormat>(bufferRange))
+				return false;
 
 			system::IFile::success_t succ;
 			file->write(succ,bufferRange.buffer->getPointer(), 0, bufferRange.buffer->getSize());
@@ -371,11 +382,259 @@ class CDirQuantCacheBase : public virtual core::IReferenceCounted, public impl::
 		template<E_FORMAT CacheFormat>
 		inline size_t getSerializedCacheSizeInBytes()
 		{
-			return getSerializedCacheSizeInBytes_impl<CacheFormat>(std::get<cache_type_t<CacheFormat>>(cache).capacity());
+			return getSerializedCacheSizeInBytes_impl<CacheFormat>(std::get<CShardedCache<CacheFormat>>(cache).gather().capacity());
+		}
+
+		//! Writes all entries (mapped and in-memory) as an open addressing table which `mapCacheFromFile` can use in place without deserializing.
+		//! The table depends on `Hash` being deterministic across runs and on the in-memory layout of `Key`, so it's only meant to be read back
+		//! by builds of the same architecture.
+		template<E_FORMAT CacheFormat>
+		inline bool saveMappableCacheToFile(system::IFile* file)
+		{
+			if (!file)
+				return false;
+			using slot_t = typename CShardedCache<CacheFormat>::SMappedSlot;
+
+			const auto gathered = std::get<CShardedCache<CacheFormat>>(cache).gather();
+			// keep the load factor at or below a half so probe sequences stay short
+			uint64_t slotCount = 16ull;
+			while (slotCount<gathered.size()*2ull)
+				slotCount <<= 1ull;
+
+			SMappedHeader header = {};
+			header.format = CacheFormat;
+			header.slotSize = sizeof(slot_t);
+			header.slotCount = slotCount;
+			header.entryCount = gathered.size();
+			// zeroed bytes rather than slot objects, so padding and the keys of empty slots don't write uninitialized memory to the file
+			core::vector<uint8_t> slots(sizeof(slot_t)*slotCount,0u);
+			core::vector<bool> occupied(slotCount,false);
+			for (const auto& entry : gathered)
+			{
+				for (uint64_t slotIx=CShardedCache<CacheFormat>::getMappedSlot(entry.first,slotCount); true; slotIx=(slotIx+1ull)&(slotCount-1ull))
+				if (!occupied[slotIx])
+				{
+					slot_t::store(slots.data()+slotIx*sizeof(slot_t),entry.first,entry.second);
+					occupied[slotIx] = true;
+					break;
+				}
+			}
+
+			system::IFile::success_t succ;
+			file->write(succ,&header,0,sizeof(header));
+			if (!succ)
+				return false;
+			system::IFile::success_t slotSucc;
+			file->write(slotSucc,slots.data(),sizeof(header),sizeof(slot_t)*slotCount);
+			return bool(slotSucc);
+		}
+
+		//!
+		template<E_FORMAT CacheFormat>
+		inline bool saveMappableCacheToFile(nbl::system::ISystem* system, const system::path& path)
+		{
+			system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+			system->createFile(future, path, nbl::system::IFile::ECF_WRITE);
+			if (auto file=future.acquire())
+				return saveMappableCacheToFile<CacheFormat>(file->get());
+			return false;
+		}
+
+		//! Uses a table written by `saveMappableCacheToFile` as a read-only base layer of the cache, which gets looked up without any locks.
+		//! New entries go into the in-memory shards on top of it, the previously mapped table (if any) gets replaced but in-memory entries stay.
+		//! Files which can't be mapped get read into memory whole, which still skips rebuilding the hash table.
+		template<E_FORMAT CacheFormat>
+		inline bool mapCacheFromFile(core::smart_refctd_ptr<system::IFile>&& file)
+		{
+			if (!file || file->getSize()<sizeof(SMappedHeader))
+				return false;
+			using slot_t = typename CShardedCache<CacheFormat>::SMappedSlot;
+
+			const system::IFile* constFile = file.get();
+			const auto* data = reinterpret_cast<const uint8_t*>(constFile->getMappedPointer());
+			core::smart_refctd_ptr<ICPUBuffer> contents;
+			if (!data)
+			{
+				contents = ICPUBuffer::create({ file->getSize() });
+				system::IFile::success_t succ;
+				file->read(succ,contents->getPointer(),0,file->getSize());
+				if (!succ)
+					return false;
+				data = reinterpret_cast<const uint8_t*>(contents->getPointer());
+			}
+
+			SMappedHeader header;
+			memcpy(&header,data,sizeof(header));
+			const SMappedHeader expected = {};
+			if (header.magic!=expected.magic || header.version!=expected.version || header.format!=CacheFormat || header.slotSize!=sizeof(slot_t))
+				return false;
+			if (header.slotCount==0ull || (header.slotCount&(header.slotCount-1ull)) || header.entryCount>=header.slotCount)
+				return false;
+			if (file->getSize()<sizeof(SMappedHeader)+header.slotCount*sizeof(slot_t))
+				return false;
+
+			std::get<CShardedCache<CacheFormat>>(cache).setMapped(std::move(file),std::move(contents),data+sizeof(SMappedHeader),header.slotCount);
+			return true;
+		}
+
+		//!
+		template<E_FORMAT CacheFormat>
+		inline bool mapCacheFromFile(nbl::system::ISystem* system, const system::path& path)
+		{
+			system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+			system->createFile(future,path,core::bitflag(system::IFileBase::ECF_READ)|system::IFileBase::ECF_MAPPABLE);
+			if (auto file=future.acquire())
+				return mapCacheFromFile<CacheFormat>(std::move(*file));
+			return false;
 		}
 
 	protected:
-		std::tuple<cache_type_t<Formats>...> cache;
+		struct SMappedHeader
+		{
+			uint32_t magic = 0x4E445143u; // "NDQC"
+			uint32_t version = 1u;
+			uint32_t format = EF_UNKNOWN;
+			uint32_t slotSize = 0u;
+			uint64_t slotCount = 0ull;
+			uint64_t entryCount = 0ull;
+		};
+
+		template<E_FORMAT CacheFormat>
+		class CShardedCache
+		{
+			public:
+				using value_t = value_type_t<CacheFormat>;
+				static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<value_t>, "Mapped tables get used in place");
+				struct SMappedSlot
+				{
+					// keys aren't default constructible
+					SMappedSlot() : occupied(0u) {}
+
+					// field by field into zero initialized storage, so the bytes of the slot are fully deterministic
+					static inline void store(uint8_t* dst, const Key& key, const value_t& value)
+					{
+						const uint32_t isOccupied = 1u;
+						memcpy(dst+offsetof(SMappedSlot,key),&key,sizeof(Key));
+						memcpy(dst+offsetof(SMappedSlot,value),&value,sizeof(value_t));
+						memcpy(dst+offsetof(SMappedSlot,occupied),&isOccupied,sizeof(isOccupied));
+					}
+
+					union
+					{
+						Key key;
+					};
+					value_t value;
+					uint32_t occupied;
+				};
+
+				static inline size_t hash(const Key& key) {return Hash()(key);}
+				static inline uint32_t getShard(const size_t hashVal) {return uint32_t((hashVal^(hashVal>>32ull))&(ShardCount-1u));}
+				static inline uint64_t getMappedSlot(const Key& key, const uint64_t slotCount)
+				{
+					// the hashes multiply by large primes, so the high bits are the well mixed ones
+					const uint64_t hashVal = hash(key);
+					return ((hashVal>>32ull)^(hashVal*0x9E3779B97F4A7C15ull))&(slotCount-1ull);
+				}
+
+				// the in-memory entries are the newer ones (inserts with `overwrite` included), so they get searched before the mapped base
+				inline bool find(const Key& key, value_t& value) const
+				{
+					{
+						const auto& shard = m_shards[getShard(hash(key))];
+						std::shared_lock lock(shard.mutex);
+						auto found = shard.map.find(key);
+						if (found!=shard.map.end())
+						{
+							value = found->second;
+							return true;
+						}
+					}
+					if (m_mappedSlots)
+					{
+						// a corrupt table could be completely full, so never probe more than all the slots
+						const auto* slots = reinterpret_cast<const SMappedSlot*>(m_mappedSlots);
+						uint64_t slotIx = getMappedSlot(key,m_mappedSlotCount);
+						for (uint64_t probe=0ull; probe<m_mappedSlotCount; probe++,slotIx=(slotIx+1ull)&(m_mappedSlotCount-1ull))
+						{
+							SMappedSlot slot;
+							memcpy(&slot,slots+slotIx,sizeof(slot));
+							if (!slot.occupied)
+								break;
+							if (slot.key==key)
+							{
+								value = slot.value;
+								return true;
+							}
+						}
+					}
+					return false;
+				}
+				inline void insert(const Key& key, const value_t& value, const bool overwrite=false)
+				{
+					auto& shard = m_shards[getShard(hash(key))];
+					std::unique_lock lock(shard.mutex);
+					if (overwrite)
+						shard.map.insert_or_assign(key,value);
+					else
+						shard.map.insert(std::make_pair(key,value));
+				}
+				inline void clear()
+				{
+					for (auto& shard : m_shards)
+					{
+						std::unique_lock lock(shard.mutex);
+						shard.map.clear();
+					}
+					setMapped(nullptr,nullptr,nullptr,0ull);
+				}
+				// snapshot of every entry in a single map, for serialization
+				inline cache_type_t<CacheFormat> gather() const
+				{
+					cache_type_t<CacheFormat> retval;
+					if (m_mappedSlots)
+					{
+						const auto* slots = reinterpret_cast<const SMappedSlot*>(m_mappedSlots);
+						for (uint64_t slotIx=0ull; slotIx<m_mappedSlotCount; slotIx++)
+						{
+							SMappedSlot slot;
+							memcpy(&slot,slots+slotIx,sizeof(slot));
+							if (slot.occupied)
+								retval.insert(std::make_pair(slot.key,slot.value));
+						}
+					}
+					for (const auto& shard : m_shards)
+					{
+						std::shared_lock lock(shard.mutex);
+						// same precedence as `find`, in-memory entries shadow the mapped ones
+						for (const auto& entry : shard.map)
+							retval.insert_or_assign(entry.first,entry.second);
+					}
+					return retval;
+				}
+				// not thread-safe with concurrent lookups
+				inline void setMapped(core::smart_refctd_ptr<system::IFile>&& file, core::smart_refctd_ptr<ICPUBuffer>&& contents, const uint8_t* slots, const uint64_t slotCount)
+				{
+					m_mappedFile = std::move(file);
+					m_mappedContents = std::move(contents);
+					m_mappedSlots = slots;
+					m_mappedSlotCount = slotCount;
+				}
+
+			private:
+				struct alignas(64) SShard
+				{
+					mutable std::shared_mutex mutex;
+					cache_type_t<CacheFormat> map;
+				};
+				std::array<SShard,ShardCount> m_shards;
+				// either the file stays mapped or its contents got read into a buffer
+				core::smart_refctd_ptr<system::IFile> m_mappedFile = nullptr;
+				core::smart_refctd_ptr<ICPUBuffer> m_mappedContents = nullptr;
+				const uint8_t* m_mappedSlots = nullptr;
+				uint64_t m_mappedSlotCount = 0ull;
+		};
+
+		std::tuple<CShardedCache<Formats>...> cache;
 		
 		template<uint32_t dimensions, E_FORMAT CacheFormat>
 		value_type_t<CacheFormat> quantize(const hlsl::vector<hlsl::float32_t, dimensions>& value)
@@ -406,12 +665,9 @@ class CDirQuantCacheBase : public virtual core::IReferenceCounted, public impl::
 
 			constexpr auto quantizationBits = quantization_bits_v<CacheFormat>;
 			value_type_t<CacheFormat> quantized;
+			// two threads missing on the same key at once both compute the same fit, the first insert wins
 			{
-				auto& particularCache = std::get<cache_type_t<CacheFormat>>(cache);
-				auto found = particularCache.find(key);
-				if (found != particularCache.end() && (found->first == key))
-					quantized = found->second;
-				else
+				if (!findInCache<CacheFormat>(key,quantized))
 				{
 					const auto fit = findBestFit<dimensions,quantizationBits>(absValue);
 
@@ -544,7 +800,7 @@ class CDirQuantCacheBase : public virtual core::IReferenceCounted, public impl::
 			if (buffer.size-sizeof(size_t)*2ull<getSerializedCacheSizeInBytes_impl<CacheFormat>(capacity))
 				return false;
 
-			return false;
+			return true;
 		}
 };
 
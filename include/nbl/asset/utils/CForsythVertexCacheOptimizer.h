@@ -25,7 +25,7 @@
 #ifndef __NBL_ASSET_FORSYTH_VERTEX_CACHE_OPTIMIZER_H_INCLUDED__
 #define __NBL_ASSET_FORSYTH_VERTEX_CACHE_OPTIMIZER_H_INCLUDED__
 
-#include "nbl/core/decl/Types.h"
+#include "nbl/asset/ICPUPolygonGeometry.h"
 
 #include <cstdint>
 #include <cstring>
@@ -33,52 +33,29 @@
 namespace nbl::asset
 {
 
-class NBL_FORCE_EBO CForsythVertexCacheOptimizer
+class NBL_API2 CForsythVertexCacheOptimizer
 {
-	struct VertData
-	{
-		int32_t cachePosition;
-		float score;
-		uint32_t numReferences;
-		uint32_t numUnaddedReferences;
-		int32_t *triIndex;
-
-		VertData() : cachePosition(-1), score(0.0f), numReferences(0), numUnaddedReferences(0), triIndex(NULL) {}
-		~VertData() { if (triIndex != NULL) delete[] triIndex; triIndex = NULL; }
-	};
+public:
+	// the score tables and the cache simulation are fixed size arrays
+	static inline constexpr uint32_t MaxCacheSize = 32u;
 
-	struct TriData
+	struct SParams
 	{
-		bool isInList;
-		float score;
-		uint32_t vertIdx[3];
-
-		TriData() : isInList(false), score(0.0f) { memset(vertIdx, 0, sizeof(vertIdx)); }
+		// size of the modelled LRU cache, at least 4 and at most `MaxCacheSize`
+		uint32_t cacheSize = 16u;
+		// triangles of the index buffer get split into runs of this many which get optimized independently and in parallel,
+		// costs a few cache misses at every run boundary, 0 optimizes the whole index buffer at once
+		uint32_t chunkTriangleCount = 0u;
 	};
 
-	class LRUCacheModel
+	struct SStatistics
 	{
-		struct LRUCacheEntry
-		{
-			LRUCacheEntry *next;
-			uint32_t vIdx;
-			VertData *vData;
-
-			LRUCacheEntry() : next(NULL), vIdx(0), vData(NULL) {}
-		};
-
-		LRUCacheEntry *mCacheHead;
-
-	public:
-		LRUCacheModel() : mCacheHead(NULL) {}
-		~LRUCacheModel();
-		void enforceSize(const size_t maxSize, core::vector<uint32_t> &outTrisToUpdate);
-		void useVertex(const uint32_t vIdx, VertData *vData);
-		int32_t getCachePosition(const uint32_t vIdx);
+		// Average Cache Miss Ratio, transformed vertices per triangle, 0.5 is the ideal for large regular grids, 3 is the worst
+		float acmr = 0.f;
+		// Average Transformed to Vertex Ratio, transformed vertices per referenced vertex, 1 is the ideal
+		float atvr = 0.f;
 	};
 
-
-public:
 	/**
 	 This method will look at the index buffer for a triangle list, and generate
 	 a new index buffer which is optimized using Tom Forsyth's paper:
@@ -91,10 +68,32 @@ public:
 
 	 @note Both 'indices' and 'outIndices' can point to the same memory.*/
 	template<typename IdxT> // IdxT is uint16_t or uint32_t
-	void optimizeTriangleOrdering(const size_t _numVerts, const size_t _numIndices, const IdxT* _indices, IdxT* _outIndices) const;
+	void optimizeTriangleOrdering(const size_t _numVerts, const size_t _numIndices, const IdxT* _indices, IdxT* _outIndices) const
+	{
+		optimizeTriangleOrdering(_numVerts,_numIndices,_indices,_outIndices,SParams{});
+	}
+	template<typename IdxT>
+	void optimizeTriangleOrdering(const size_t _numVerts, const size_t _numIndices, const IdxT* _indices, IdxT* _outIndices, const SParams& _params) const;
+
+	/**
+	 Renumbers the vertices in order of first use by the (already cache optimized) index buffer so vertex fetches walk memory linearly.
+	 @param   outRemap Gets 'numVerts' elements, the new index of every old vertex or ~0u for vertices no index references
+	 @return           Number of referenced vertices, the new indices are all below it*/
+	template<typename IdxT>
+	static uint32_t optimizeVertexFetch(const size_t _numVerts, const size_t _numIndices, IdxT* _indices, uint32_t* _outRemap);
+
+	// simulates a FIFO cache like post transform caches of real hardware, rather than the LRU the optimizer scores with
+	template<typename IdxT>
+	static SStatistics analyze(const size_t _numVerts, const size_t _numIndices, const IdxT* _indices, const uint32_t _cacheSize=16u);
+
+	//! Triangle order optimization followed by the vertex fetch reorder, every vertex attribute view gets remapped into new buffers
+	//! (views interleaved in one buffer stay interleaved) and the index view becomes a 16 or 32 bit triangle list.
+	//! Returns nullptr if the geometry isn't made of triangles or a vertex view has fewer elements than the position view.
+	static core::smart_refctd_ptr<ICPUPolygonGeometry> createOptimized(const ICPUPolygonGeometry* geo, const SParams& params={}, SStatistics* outBefore=nullptr, SStatistics* outAfter=nullptr, const bool recomputeHash=true);
 
 private:
-	static float score(const VertData &vertexData);
+	// runs Forsyth's algorithm on a chunk with its vertices numbered densely from 0
+	static void optimizeChunk(const uint32_t* indices, const uint32_t triangleCount, const uint32_t vertexCount, const uint32_t cacheSize, uint32_t* outIndices);
 };
 
 }
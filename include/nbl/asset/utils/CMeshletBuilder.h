@@ -0,0 +1,79 @@
+// Copyright (C) 2018-2025 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_MESHLET_BUILDER_H_INCLUDED_
+#define _NBL_ASSET_C_MESHLET_BUILDER_H_INCLUDED_
+
+
+#include "nbl/asset/ICPUPolygonGeometry.h"
+#include "nbl/asset/ICPUGeometryCollection.h"
+
+
+namespace nbl::asset
+{
+// Partitions triangle geometries into meshlets (clusters) for task/mesh shader and cluster culling renderers.
+// The greedy growth is similar to zeux's meshoptimizer (https://github.com/zeux/meshoptimizer): the next triangle is picked among the ones
+// adjacent to the meshlet, preferring the ones which need the fewest new vertices and close off vertices with no remaining triangles, while
+// staying spatially compact. When nothing adjacent is left the meshlet continues from the next free triangle in Morton order of centroids.
+class NBL_API2 CMeshletBuilder
+{
+		// private, undefined constructor
+		CMeshletBuilder() = delete;
+
+	public:
+		using SDataView = ICPUPolygonGeometry::SDataView;
+
+		struct SParams
+		{
+			inline bool valid() const
+			{
+				return maxVertices>=3u && maxVertices<=256u && maxTriangles>0u && spatialWeight>=0.f && coneWeight>=0.f;
+			}
+
+			// local indices are 8bit, so at most 256
+			uint32_t maxVertices = 64u;
+			uint32_t maxTriangles = 124u;
+			// how much distance from the meshlet's center (relative to its radius) costs compared to needing a new vertex
+			float spatialWeight = 0.5f;
+			// how much deviating from the meshlet's average normal costs, makes for tighter normal cones at the expense of vertex reuse
+			float coneWeight = 0.f;
+		};
+
+		// layout of an element of `SResult::meshlets`
+		struct SMeshlet
+		{
+			// first element in `SResult::vertexIndices`
+			uint32_t vertexOffset;
+			// first element in `SResult::localIndices`
+			uint32_t triangleOffset;
+			uint32_t vertexCount;
+			uint32_t triangleCount;
+		};
+
+		struct SResult
+		{
+			inline operator bool() const {return bool(meshlets);}
+
+			// `SMeshlet` per element, `EF_R32G32B32A32_UINT`
+			SDataView meshlets = {};
+			// geometry vertex index per meshlet vertex, `EF_R32_UINT`
+			SDataView vertexIndices = {};
+			// one triangle per element, three 8bit indices into the meshlet's vertices packed as `i0|(i1<<8)|(i2<<16)`, `EF_R32_UINT`
+			SDataView localIndices = {};
+			// center and radius per meshlet, `EF_R32G32B32A32_SFLOAT`
+			SDataView boundingSpheres = {};
+			// normal cone axis and cutoff per meshlet, `EF_R32G32B32A32_SFLOAT`, the meshlet is backfacing and can be culled when
+			// `dot(normalize(coneApex-cameraPosition),axis)>=cutoff`, cutoff of 1 means the cone is too wide to ever cull
+			SDataView normalCones = {};
+			// apex of the normal cone per meshlet, `EF_R32G32B32_SFLOAT`
+			SDataView coneApices = {};
+		};
+
+		//! Works with any indexing callback of degree 3 (lists, strips, fans), returns an invalid result if the geometry isn't one.
+		static SResult build(const ICPUPolygonGeometry* geometry, const SParams& params={});
+		//! Builds the geometries of the collection in parallel, the result for geometries which aren't triangle polygon geometries is invalid.
+		static core::vector<SResult> build(const ICPUGeometryCollection* collection, const SParams& params={});
+};
+
+}
+#endif
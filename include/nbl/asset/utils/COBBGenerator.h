@@ -6,12 +6,15 @@
 #ifndef _NBL_ASSET_C_OBB_GENERATOR_H_INCLUDED_
 #define _NBL_ASSET_C_OBB_GENERATOR_H_INCLUDED_
 
+#include "nbl/asset/ICPUPolygonGeometry.h"
 #include "nbl/builtin/hlsl/shapes/obb.hlsl"
 
+#include <span>
+
 namespace nbl::asset
 {
 
-class COBBGenerator
+class NBL_API2 COBBGenerator
 {
   private:
     template<typename T, size_t CountV>
@@ -41,6 +44,35 @@ class COBBGenerator
 
     };
   public:
+    enum class EMethod : uint8_t
+    {
+      // DiTO-14 of the templated `compute` below, a handful of passes over the points, usually within a few percent of the optimal box
+      Approximate,
+      // Approximation of the minimum volume box: rotating calipers over the projection of the hull along every hull face normal, keeps the
+      // smallest volume box (also comparing against `Approximate`). Optimal only among the boxes with a face flush against a hull face, the
+      // true minimum can instead have two faces each touching a hull edge (O'Rourke's edge pair search, which isn't done), though the face
+      // flush box is usually within a few percent of it. Costs about O(hull faces * hull vertices) on top of the hull.
+      MinVolumeFaceFlush
+    };
+    struct SParams
+    {
+      float epsilon = 1.525e-5f;
+      EMethod method = EMethod::Approximate;
+      // fit on the convex hull vertices only (always done for `MinVolumeFaceFlush`), hulls of large point sets get merged from hulls of chunks built in parallel
+      bool useHull = true;
+    };
+
+    //! Point sets which are coplanar or have fewer than 4 points skip the hull and get fitted directly.
+    static hlsl::shapes::OBB<> compute(std::span<const hlsl::float32_t3> points, const SParams& params);
+    //! Every point set is independent, the sets get processed in parallel.
+    static core::vector<hlsl::shapes::OBB<>> compute(std::span<const std::span<const hlsl::float32_t3>> pointSets, const SParams& params);
+    //! One OBB per joint around the positions of the vertices with a non-zero weight for it, ready for `ICPUPolygonGeometry::setJointOBBView`.
+    //! Joints with no vertices weighted to them get a degenerate box at the origin.
+    static core::vector<hlsl::shapes::OBB<>> computeJointOBBs(const ICPUPolygonGeometry* geometry, const SParams& params);
+
+    //! Quickhull, large point sets get split into chunks whose hulls are built in parallel and then merged. Returns false and outputs nothing
+    //! when the points are coplanar (within `epsilon`) or fewer than 4. Triangles index `outVertices` and wind counter-clockwise seen from outside.
+    static bool computeConvexHull(std::span<const hlsl::float32_t3> points, const float epsilon, core::vector<hlsl::float32_t3>& outVertices, core::vector<uint32_t>* outTriangles=nullptr);
 
     template <typename FetchVertexFn> 
       requires (std::same_as<std::invoke_result_t<FetchVertexFn, size_t>, hlsl::float32_t3>)
@@ -286,7 +318,7 @@ class COBBGenerator
           return Result{ tMinProj, tMaxProj, tMinVert, tMaxVert };
         };
 
-      static auto findUpperLowerTetraPoints = [epsilon](
+      auto findUpperLowerTetraPoints = [epsilon](
         const hlsl::float32_t3& n,
         const VertexCollection& vertices,
         const hlsl::float32_t3& p0)
@@ -344,7 +376,7 @@ class COBBGenerator
         };
 
 
-      static auto findBaseTriangle = [epsilon](const ExtremalVertices& extremalVertices, const VertexCollection& vertices)-> LargeBaseTriangle
+      auto findBaseTriangle = [epsilon](const ExtremalVertices& extremalVertices, const VertexCollection& vertices)-> LargeBaseTriangle
         {
           std::array<hlsl::float32_t3, 3> baseTriangleVertices = {}; // p0, p1, p2
           Edges edges;
@@ -392,7 +424,7 @@ class COBBGenerator
           };
         };
 
-      auto findImprovedObbAxesFromUpperAndLowerTetrasOfBaseTriangle = [](const VertexCollection& vertices,
+      auto findImprovedObbAxesFromUpperAndLowerTetrasOfBaseTriangle = [&](const VertexCollection& vertices,
         const LargeBaseTriangle& baseTriangle,
         Axes& bestAxes, hlsl::float32_t& bestVal)
         {
@@ -453,7 +485,7 @@ class COBBGenerator
           return buildObbFromAxesAndLocalMinMax(axes, localMin, localMax);
         };
 
-      static auto computeLineAlignedObb = [epsilon](const hlsl::float32_t3& u, const VertexCollection& vertices)
+      auto computeLineAlignedObb = [epsilon](const hlsl::float32_t3& u, const VertexCollection& vertices)
       {
         // Given u, build any orthonormal base u, v, w 
 
@@ -25,18 +25,27 @@ class NBL_API2 CPolygonGeometryManipulator
 		{
 			if (!geo)
 				return;
-			CGeometryManipulator::recomputeContentHash(geo->getPositionView());
-			CGeometryManipulator::recomputeContentHash(geo->getIndexView());
-			CGeometryManipulator::recomputeContentHash(geo->getNormalView());
+			// interleaved views share a buffer, no point hashing it more than once
+			core::vector<const ICPUBuffer*> hashed;
+			auto recomputeContentHash = [&hashed](const IGeometry<ICPUBuffer>::SDataView& view)->void
+			{
+				if (!view || std::find(hashed.begin(),hashed.end(),view.src.buffer.get())!=hashed.end())
+					return;
+				hashed.push_back(view.src.buffer.get());
+				CGeometryManipulator::recomputeContentHash(view);
+			};
+			recomputeContentHash(geo->getPositionView());
+			recomputeContentHash(geo->getIndexView());
+			recomputeContentHash(geo->getNormalView());
 			for (const auto& view : *geo->getJointWeightViews())
 			{
-				CGeometryManipulator::recomputeContentHash(view.indices);
-				CGeometryManipulator::recomputeContentHash(view.weights);
+				recomputeContentHash(view.indices);
+				recomputeContentHash(view.weights);
 			}
 			if (auto pView=geo->getJointOBBView(); pView)
-				CGeometryManipulator::recomputeContentHash(*pView);
+				recomputeContentHash(*pView);
 			for (const auto& view : *geo->getAuxAttributeViews())
-				CGeometryManipulator::recomputeContentHash(view);
+				recomputeContentHash(view);
 		}
 
 		//
@@ -228,17 +237,45 @@ class NBL_API2 CPolygonGeometryManipulator
 
 		static core::smart_refctd_ptr<ICPUPolygonGeometry> createUnweldedList(const ICPUPolygonGeometry* inGeo, const bool reverse=false, const bool recomputeHash=true);
 
+		struct SQuantizationParams
+		{
+			// largest allowed error of a position component, relative to the largest extent of the positions' AABB
+			float positionError = 1.f/16384.f;
+			// largest allowed `1-cos` of the angle between an original and a quantized normal, same as `EEM_ANGLES`
+			float normalError = 1.5e-4f;
+			// same as `positionError`, for floating point aux attributes (usually UVs) relative to their own AABB
+			float auxAttributeError = 1.f/16384.f;
+			// shared by all the parallel batches, a temporary one gets used when not set
+			CQuantNormalCache* normalCache = nullptr;
+		};
+		//! Rewrites floating point position, normal and aux attribute views (32bit or wider channels) into the smallest format within the error bounds,
+		//! other views and the ones no smaller format can represent well enough stay shared with the input.
+		//! Positions and aux attributes become 8 or 16bit UNORM relative to their AABB, which becomes the view's `F32` range, normals get the best fit
+		//! `EF_A2B10G10R10_SNORM_PACK32` or 16bit quantization of `CQuantNormalCache`. 3 channel data is always stored in 4 channel formats
+		//! (`EF_R8G8B8A8_UNORM`, `EF_R16G16B16A16_UNORM`, `EF_R16G16B16A16_SNORM`). Returns nullptr if there's no position view.
+		static core::smart_refctd_ptr<ICPUPolygonGeometry> createQuantized(const ICPUPolygonGeometry* inGeo, const SQuantizationParams& params={}, const bool recomputeHash=true);
+
 		using SSNGVertexData = CSmoothNormalGenerator::VertexData;
 		using SSNGVxCmpFunction = CSmoothNormalGenerator::VxCmpFunction;
-		// NOTE: Requires unwelded mesh on input, TODO make it resillient against that (only unweld normals temporarily, maybe even avoid position unweld)
-		static core::smart_refctd_ptr<ICPUPolygonGeometry> createSmoothVertexNormal(const ICPUPolygonGeometry* inbuffer, const bool enableWelding=false, float epsilon=1.525e-5f,
-			SSNGVxCmpFunction vxcmp=[](const SSNGVertexData& v0, const SSNGVertexData& v1, const ICPUPolygonGeometry* buffer) 
-			{ 
+		struct SSNGDefaultVxCmp
+		{
+			inline bool operator()(const SSNGVertexData& v0, const SSNGVertexData& v1, const ICPUPolygonGeometry* buffer) const
+			{
 				constexpr float cosOf45Deg = 0.70710678118f;
 				return hlsl::dot(v0.weightedNormal,v1.weightedNormal)*hlsl::rsqrt(hlsl::dot(v0.weightedNormal,v0.weightedNormal)*hlsl::dot(v1.weightedNormal,v1.weightedNormal)) > cosOf45Deg;
-			},
-			const bool recomputeHash = true
-		);
+			}
+		};
+		// NOTE: Requires unwelded mesh on input, TODO make it resillient against that (only unweld normals temporarily, maybe even avoid position unweld)
+		// `vxcmp` can be any (thread-safe) callable, including a `SSNGVxCmpFunction`, but a lambda or functor gets inlined into the neighbour search
+		template<typename VxCmp=SSNGDefaultVxCmp> requires std::is_invocable_r_v<bool,const VxCmp&,const SSNGVertexData&,const SSNGVertexData&,const ICPUPolygonGeometry*>
+		static inline core::smart_refctd_ptr<ICPUPolygonGeometry> createSmoothVertexNormal(const ICPUPolygonGeometry* inPolygon, const bool enableWelding=false, float epsilon=1.525e-5f,
+			const VxCmp& vxcmp={}, const bool recomputeHash=true)
+		{
+			if (!canCreateSmoothVertexNormal(inPolygon))
+				return nullptr;
+			auto result = CSmoothNormalGenerator::calculateNormals(inPolygon,epsilon,vxcmp,false);
+			return finalizeSmoothVertexNormal(std::move(result),enableWelding,epsilon,recomputeHash);
+		}
 		
 
 		//! Comparison methods
@@ -731,6 +768,10 @@ class NBL_API2 CPolygonGeometryManipulator
 			}
 		}
 #endif
+
+	private:
+		static bool canCreateSmoothVertexNormal(const ICPUPolygonGeometry* inPolygon);
+		static core::smart_refctd_ptr<ICPUPolygonGeometry> finalizeSmoothVertexNormal(CSmoothNormalGenerator::Result&& result, const bool enableWelding, const float epsilon, const bool recomputeHash);
 };
 
 #if 0
@@ -0,0 +1,62 @@
+// Copyright (C) 2018-2025 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_QUADRIC_SIMPLIFIER_H_INCLUDED_
+#define _NBL_ASSET_C_QUADRIC_SIMPLIFIER_H_INCLUDED_
+
+
+#include "nbl/asset/ICPUPolygonGeometry.h"
+#include "nbl/asset/ICPUGeometryCollection.h"
+
+
+namespace nbl::asset
+{
+// Quadric error metric edge collapse simplification (Garland & Heckbert 1998, "Simplifying Surfaces with Color and Texture using Quadric Error Metrics")
+// The quadrics live in position+attribute space, so collapses which would smear normals or UVs across a discontinuity cost extra.
+// Edges only ever collapse onto one of their vertices, so no new vertices are made and every simplified geometry can keep referencing the
+// vertex buffers of the input (after optional welding), only the index view differs.
+// Vertices sharing a position with a differently attributed vertex (UV/normal seams) never get collapsed away so seams can't crack,
+// border vertices can only slide along the border unless `lockBorders` pins them completely.
+class NBL_API2 CQuadricSimplifier
+{
+		// private, undefined constructor
+		CQuadricSimplifier() = delete;
+
+	public:
+		struct SParams
+		{
+			// stop once the index count is at or below this
+			uint32_t targetIndexCount = 0u;
+			// stop before the error of a collapse exceeds this, error is the area weighted RMS distance relative to the largest extent of the geometry's AABB
+			float targetError = 1e-2f;
+			// weights of the attributes in the quadrics, relative to positions normalized by the extent
+			float normalWeight = 0.5f;
+			// applies to the first few channels of aux attribute views (usually UVs), integer formats are ignored
+			float auxAttributeWeight = 1.f;
+			// border vertices don't move at all
+			bool lockBorders = false;
+			// weld with `CVertexWelder` first, so vertices duplicated needlessly don't get treated as seams
+			bool weld = true;
+			float weldEpsilon = 1.525e-5f;
+		};
+		//! Returns nullptr if the geometry isn't made of triangles or has no usable position view.
+		static core::smart_refctd_ptr<ICPUPolygonGeometry> simplify(const ICPUPolygonGeometry* geometry, const SParams& params, float* outError=nullptr);
+
+		struct SLODChainParams
+		{
+			// `targetIndexCount` is ignored, every level's is derived from `levelRatio`
+			SParams base = {};
+			// including the full detail level
+			uint32_t maxLevels = 4u;
+			// target index count of a level relative to the previous one
+			float levelRatio = 0.5f;
+		};
+		//! Level 0 is the (welded) input, every next level continues simplifying the previous one, so the chain costs about as much as the
+		//! coarsest level alone. All levels share the vertex buffers, the chain ends early when a level can't be reduced within `targetError`.
+		static core::vector<core::smart_refctd_ptr<ICPUPolygonGeometry>> createLODChain(const ICPUPolygonGeometry* geometry, const SLODChainParams& params);
+		//! One chain per geometry of the collection, computed in parallel. Chains of geometries which aren't triangle polygon geometries are empty.
+		static core::vector<core::vector<core::smart_refctd_ptr<ICPUPolygonGeometry>>> createLODChains(const ICPUGeometryCollection* collection, const SLODChainParams& params);
+};
+
+}
+#endif
@@ -2,15 +2,22 @@
 #define _NBL_ASSET_C_VERTEX_HASH_MAP_H_INCLUDED_
 
 #include "nbl/core/declarations.h"
+#include "nbl/core/execution.h"
+
+#include <span>
+#include <thread>
 
 namespace nbl::asset
 {
 
+template <typename T>
+concept HashGridPosition = std::same_as<std::remove_cvref_t<T>, hlsl::float32_t3> || std::same_as<std::remove_cvref_t<T>, hlsl::float64_t3>;
+
 template <typename T>
 concept HashGridVertexData = requires(T obj, T const cobj, uint32_t hash) {
 		{ cobj.getHash() } -> std::same_as<uint32_t>;
 		{ obj.setHash(hash) } -> std::same_as<void>;
-		{ cobj.getPosition() } -> std::same_as<hlsl::float32_t3>;
+		{ cobj.getPosition() } -> HashGridPosition;
 };
 
 template <typename Fn, typename T>
@@ -20,13 +27,23 @@ concept HashGridIteratorFn = HashGridVertexData<T> && requires(Fn && fn, T const
 	{ std::invoke(std::forward<Fn>(fn), cobj) } -> std::same_as<bool>;
 };
 
-// TODO: implement a class template that take position type(either float32_t3 or float64_t3 as template argument
+template <typename Fn, typename T>
+concept HashGridBulkIteratorFn = HashGridVertexData<T> && requires(Fn && fn, size_t queryIx, T const cobj)
+{
+	// return whether hash grid should continue the iteration for the query
+	{ std::invoke(std::forward<Fn>(fn), queryIx, cobj) } -> std::same_as<bool>;
+};
+
+// The position type (`float32_t3` or `float64_t3`) is whatever `VertexData::getPosition` returns, the cell math happens in its precision.
+// Baking hashes the vertices in parallel and sorts them by cell hash with `core::ParallelRadixSorter`.
 template <HashGridVertexData VertexData>
 class CVertexHashGrid
 {
 public:
 
 	using vertex_data_t = VertexData;
+	using position_t = std::remove_cvref_t<decltype(std::declval<const VertexData&>().getPosition())>;
+	using scalar_t = std::conditional_t<std::is_same_v<position_t, hlsl::float64_t3>, hlsl::float64_t, hlsl::float32_t>;
 	using collection_t = core::vector<VertexData>;
 	struct BucketBounds
 	{
@@ -34,32 +51,61 @@ public:
 		collection_t::const_iterator end;
 	};
 
-	inline CVertexHashGrid(float cellSize, uint32_t hashTableMaxSizeLog2, size_t vertexCountReserve = 8192) :
+	inline CVertexHashGrid(scalar_t cellSize, uint32_t hashTableMaxSizeLog2, size_t vertexCountReserve = 8192) :
 		m_cellSize(cellSize),
-		m_hashTableMaxSize(1llu << hashTableMaxSizeLog2),
-		m_sorter(createSorter(vertexCountReserve))
+		m_hashTableMaxSizeLog2(core::min(hashTableMaxSizeLog2, 32u))
 	{
 		m_vertices.reserve(vertexCountReserve);
 	}
 
-	//inserts vertex into hash table
+	//inserts vertex into hash table, its hash only gets computed in `bake`
 	inline void add(VertexData&& vertex)
 	{
-		vertex.setHash(hash(vertex));
 		m_vertices.push_back(std::move(vertex));
+		m_bucketOffsets.clear();
 	}
 
 	inline void bake()
 	{
-		auto scratchBuffer = collection_t(m_vertices.size());
-
-		auto finalSortedOutput = std::visit( [&](auto& sorter)
+		const size_t vertexCount = m_vertices.size();
+		const size_t chunkCount = core::max<size_t>(core::min<size_t>(vertexCount / MinVerticesPerChunk, std::thread::hardware_concurrency()), 1ull);
+		const size_t chunkSize = (vertexCount + chunkCount - 1ull) / chunkCount;
+		core::vector<size_t> chunks(chunkCount);
+		std::iota(chunks.begin(), chunks.end(), 0ull);
+		auto forEachChunk = [&](auto&& fn) -> void
 		{
-			return sorter(m_vertices.data(), scratchBuffer.data(), m_vertices.size(), KeyAccessor());
-		}, m_sorter );
+			core::for_each(core::execution::par_unseq, chunks.begin(), chunks.end(), [&](const size_t chunk) -> void
+			{
+				const size_t begin = chunk * chunkSize;
+				fn(chunk, begin, core::min(begin + chunkSize, vertexCount));
+			});
+		};
 
-		if (finalSortedOutput != m_vertices.data())
-			m_vertices = std::move(scratchBuffer);
+		forEachChunk([&](const size_t, const size_t begin, const size_t end) -> void
+		{
+			for (size_t i = begin; i < end; i++)
+				m_vertices[i].setHash(hash(m_vertices[i]));
+		});
+
+		// passes over the unused top bits of the hash get skipped by the sorter
+		collection_t scratch(vertexCount);
+		if (core::ParallelRadixSorter<32u,RadixBits>()(m_vertices.data(), scratch.data(), vertexCount, SHashKeyAccessor()) != m_vertices.data())
+			m_vertices = std::move(scratch);
+
+		// skip list over the top bits of the hash, narrows down the binary search of a bucket lookup
+		const uint32_t skipListBits = core::min(m_hashTableMaxSizeLog2, SkipListMaxBits);
+		m_skipListShift = m_hashTableMaxSizeLog2 - skipListBits;
+		m_bucketOffsets.resize((0x1ull << skipListBits) + 1ull);
+		core::vector<uint32_t> skipListEntries(m_bucketOffsets.size());
+		std::iota(skipListEntries.begin(), skipListEntries.end(), 0u);
+		core::for_each(core::execution::par_unseq, skipListEntries.begin(), skipListEntries.end(), [&](const uint32_t entry) -> void
+		{
+			const uint64_t firstHash = uint64_t(entry) << m_skipListShift;
+			m_bucketOffsets[entry] = std::lower_bound(m_vertices.begin(), m_vertices.end(), firstHash, [](const VertexData& vertex, const uint64_t hash)
+				{
+					return vertex.getHash() < hash;
+				}) - m_vertices.begin();
+		});
 	}
 
 	inline const collection_t& vertices() const { return m_vertices; }
@@ -67,7 +113,7 @@ public:
 	inline uint32_t getVertexCount() const { return m_vertices.size(); }
 
 	template <HashGridIteratorFn<VertexData> Fn>
-	inline void forEachBroadphaseNeighborCandidates(const hlsl::float32_t3& position, Fn&& fn) const
+	inline void forEachBroadphaseNeighborCandidates(const position_t& position, Fn&& fn) const
 	{
 		std::array<uint32_t, 8> neighboringCells;
 		const auto cellCount = getNeighboringCellHashes(neighboringCells.data(), position);
@@ -84,16 +130,46 @@ public:
 			}
 		}
 	}
+	// lets single precision callers (e.g. the vertex welder) query a double precision grid
+	template <HashGridIteratorFn<VertexData> Fn> requires (!std::is_same_v<position_t, hlsl::float32_t3>)
+	inline void forEachBroadphaseNeighborCandidates(const hlsl::float32_t3& position, Fn&& fn) const
+	{
+		forEachBroadphaseNeighborCandidates(position_t(position), std::forward<Fn>(fn));
+	}
+
+	//! Runs `fn(queryIx,candidate)` over the broadphase candidates of every `positions[queryIx]`, the queries get processed in parallel batches,
+	//! so `fn` will be called concurrently for different `queryIx` and should write its results into preallocated per-query slots.
+	template <HashGridBulkIteratorFn<VertexData> Fn>
+	inline void forEachBroadphaseNeighborCandidatesBulk(const std::span<const position_t> positions, Fn&& fn) const
+	{
+		core::vector<size_t> batches((positions.size() + QueryBatchSize - 1ull) / QueryBatchSize);
+		std::iota(batches.begin(), batches.end(), 0ull);
+		core::for_each(core::execution::par, batches.begin(), batches.end(), [&](const size_t batch) -> void
+		{
+			const size_t end = core::min((batch + 1ull) * QueryBatchSize, positions.size());
+			for (size_t queryIx = batch * QueryBatchSize; queryIx < end; queryIx++)
+				forEachBroadphaseNeighborCandidates(positions[queryIx], [&](const vertex_data_t& candidate) -> bool
+				{
+					return std::invoke(fn, queryIx, candidate);
+				});
+		});
+	}
 
 private:
-	struct KeyAccessor
+	static constexpr inline uint8_t RadixBits = 11u;
+	// below this many vertices per thread, hashing them in parallel isn't worth it
+	static constexpr inline size_t MinVerticesPerChunk = 0x1ull << 16ull;
+	static constexpr inline uint32_t SkipListMaxBits = 16u;
+	static constexpr inline size_t QueryBatchSize = 1024ull;
+
+	struct SHashKeyAccessor
 	{
-		constexpr static inline size_t key_bit_count = 32ull;
+		static constexpr inline size_t key_bit_count = 32ull;
 
 		template<auto bit_offset, auto radix_mask>
-		inline decltype(radix_mask) operator()(const VertexData& item) const
+		inline decltype(radix_mask) operator()(const VertexData& vertex) const
 		{
-			return static_cast<decltype(radix_mask)>(item.getHash() >> static_cast<uint32_t>(bit_offset)) & radix_mask;
+			return static_cast<decltype(radix_mask)>(vertex.getHash() >> bit_offset) & radix_mask;
 		}
 	};
 
@@ -101,40 +177,36 @@ private:
 	static constexpr inline uint32_t primeNumber2 = 19349663;
 	static constexpr inline uint32_t primeNumber3 = 83492791;
 
-	using sorter_t = std::variant<
-		core::RadixLsbSorter<KeyAccessor::key_bit_count, uint16_t>,
-		core::RadixLsbSorter<KeyAccessor::key_bit_count, uint32_t>,
-		core::RadixLsbSorter<KeyAccessor::key_bit_count, size_t>>;
-	sorter_t m_sorter;
-
-	inline static sorter_t createSorter(size_t vertexCount)
+	collection_t m_vertices;
+	// `m_bucketOffsets[i]` is the first vertex whose hash has top bits `>=i`
+	core::vector<size_t> m_bucketOffsets;
+	scalar_t m_cellSize;
+	uint32_t m_hashTableMaxSizeLog2;
+	uint32_t m_skipListShift = 0u;
+
+	// going through a signed 64bit integer keeps negative cells well defined and adjacent to their positive neighbours
+	static inline hlsl::uint32_t3 toCellCoord(const position_t& cell)
 	{
-		if (vertexCount < (0x1ull << 16ull))
-			return core::RadixLsbSorter<KeyAccessor::key_bit_count, uint16_t>();
-		if (vertexCount < (0x1ull << 32ull))
-			return core::RadixLsbSorter<KeyAccessor::key_bit_count, uint32_t>();
-		return core::RadixLsbSorter<KeyAccessor::key_bit_count, size_t>();
+		return hlsl::uint32_t3(
+			static_cast<uint32_t>(static_cast<int64_t>(cell.x)),
+			static_cast<uint32_t>(static_cast<int64_t>(cell.y)),
+			static_cast<uint32_t>(static_cast<int64_t>(cell.z)));
 	}
 
-	collection_t m_vertices;
-	const uint32_t m_hashTableMaxSize;
-	const float m_cellSize;
-
 	inline uint32_t hash(const VertexData& vertex) const
 	{
-		const hlsl::float32_t3 position = floor(vertex.getPosition() / m_cellSize);
-		const auto position_uint32 = hlsl::uint32_t3(position.x, position.y, position.z);
-		return hash(position_uint32);
+		return hash(toCellCoord(floor(vertex.getPosition() / m_cellSize)));
 	}
 
 	inline uint32_t hash(const hlsl::uint32_t3& position) const
 	{
+		const uint32_t mask = static_cast<uint32_t>((0x1ull << m_hashTableMaxSizeLog2) - 1ull);
 		return	((position.x * primeNumber1) ^
 			(position.y * primeNumber2) ^
-			(position.z * primeNumber3))& (m_hashTableMaxSize - 1);
+			(position.z * primeNumber3)) & mask;
 	}
 
-	inline uint8_t getNeighboringCellHashes(uint32_t* outNeighbors, hlsl::float32_t3 position) const
+	inline uint8_t getNeighboringCellHashes(uint32_t* outNeighbors, const position_t& position) const
 	{
 		// We substract the coordinate by 0.5 since the cellSize is expected to be twice the epsilon. This is to snap the vertex into the cell that contain the most bottom left cell that could collide with of our vertex.
 		// -------          -------
@@ -149,8 +221,7 @@ private:
 		// Contrary to x, y is still snapped into its original cell. It means the most bottom left cell that collide with y is its own cell.
 		// The above scheme is to reduce the number of cell candidates that we need to check for collision, from 9 cell to 4 cell in 2d, or from 27 cells to 8 cells in 3d.
 		// both 0.x and -0.x would be converted to 0 if we directly casting the position to unsigned integer. Causing the 0 to be crowded then the rest of the cells. So we use floor here to spread the vertex more uniformly.
-		hlsl::float32_t3 cellfloatcoord = floor(position / m_cellSize - hlsl::float32_t3(0.5));
-		hlsl::uint32_t3 baseCoord = hlsl::uint32_t3(static_cast<uint32_t>(cellfloatcoord.x), static_cast<uint32_t>(cellfloatcoord.y), static_cast<uint32_t>(cellfloatcoord.z));
+		const hlsl::uint32_t3 baseCoord = toCellCoord(floor(position / m_cellSize - position_t(0.5)));
 
 		uint8_t neighborCount = 0;
 
@@ -179,15 +250,17 @@ private:
 
 	inline BucketBounds getBucketBoundsByHash(uint32_t hash) const
 	{
-		const auto skipListBound = std::visit([&](auto& sorter)
-		{
-			auto hashBound = sorter.getMostSignificantRadixBound(hash);
-			return std::pair<collection_t::const_iterator, collection_t::const_iterator>(m_vertices.begin() + hashBound.first, m_vertices.begin() + hashBound.second);
-		}, m_sorter);
+		//not baked yet
+		if (m_bucketOffsets.empty())
+			return { m_vertices.end(), m_vertices.end() };
+
+		const uint32_t skipListEntry = hash >> m_skipListShift;
+		const auto skipListBegin = m_vertices.begin() + m_bucketOffsets[skipListEntry];
+		const auto skipListEnd = m_vertices.begin() + m_bucketOffsets[skipListEntry + 1];
 
 		auto begin = std::lower_bound(
-			skipListBound.first, 
-			skipListBound.second, 
+			skipListBegin, 
+			skipListEnd, 
 			hash,
 			[](const VertexData& vertex, uint32_t hash)
 			{
@@ -195,24 +268,18 @@ private:
 			});
 
 		auto end = std::upper_bound(
-			skipListBound.first, 
-			skipListBound.second, 
+			begin, 
+			skipListEnd, 
 			hash, 
 			[](uint32_t hash, const VertexData& vertex)
 			{
 				return hash < vertex.getHash();
 			});
 
-		const auto beginIx = begin - m_vertices.begin();
-		const auto endIx = end - m_vertices.begin();
 		//bucket missing
 		if (begin == end)
 			return { m_vertices.end(), m_vertices.end() };
 
-		//bucket missing
-		if (begin->hash != hash)
-			return { m_vertices.end(), m_vertices.end() };
-
 		return { begin, end };
 	}
 };
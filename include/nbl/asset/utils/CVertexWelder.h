@@ -5,6 +5,10 @@
 #define _NBL_ASSET_C_POLYGON_VERTEX_WELDER_H_INCLUDED_
 
 #include "nbl/asset/utils/CPolygonGeometryManipulator.h"
+#include "nbl/core/execution.h"
+
+#include <numeric>
+#include <span>
 
 namespace nbl::asset
 {
@@ -17,6 +21,13 @@ concept VertexWelderAccelerationStructure = requires(T const cobj, hlsl::float32
     { cobj.forEachBroadphaseNeighborCandidates(position, fn) } -> std::same_as<void>;
 };
 
+// Acceleration structures which can look up the candidates of many positions at once, in parallel
+template <typename T>
+concept VertexWelderBulkAccelerationStructure = VertexWelderAccelerationStructure<T> && requires(T const cobj, std::span<const typename T::position_t> positions, std::function<bool(size_t, const typename T::vertex_data_t&)> fn)
+{
+    { cobj.forEachBroadphaseNeighborCandidatesBulk(positions, fn) } -> std::same_as<void>;
+};
+
 class CVertexWelder
 {    
     public:
@@ -231,38 +242,86 @@ class CVertexWelder
               core::vector<uint32_t> remappedVertexIndexes(vertexCount);
 
               uint32_t maxRemappedIndex = 0;
+              // `candidates` are the vertex's broadphase candidates with indices not greater than its own, in the order the broadphase visited them,
               // iterate by index, so that we always use the smallest index when multiple vertexes can be welded together
-              for (uint32_t index = 0; index < vertexCount; index++)
+              auto resolve = [&](const uint32_t index, const std::span<const uint32_t> candidates) -> void
               {
-                hlsl::float32_t3 position;
-                positionView.decodeElement<hlsl::float32_t3>(index, position);
                 auto remappedVertexIndex = INVALID_INDEX;
-                as.forEachBroadphaseNeighborCandidates(position, [&](const typename AccelStructureT::vertex_data_t& candidate) {
-                  const auto neighborRemappedIndex = remappedVertexIndexes[candidate.index];
+                for (const auto candidateIndex : candidates)
+                {
                   // make sure we can only map higher indices to lower indices to disallow loops
-                  if (candidate.index<index)
+                  if (candidateIndex<index)
                   {
-                     auto neighborRemappedIndex = remappedVertexIndexes[candidate.index];
+                     const auto neighborRemappedIndex = remappedVertexIndexes[candidateIndex];
                      if (neighborRemappedIndex == INVALID_INDEX)
-                        return true;
+                        continue;
                      // the link should only be 1 step away (vertices should only remap to vertices that aren't getting remapped)
                      if (neighborRemappedIndex != remappedVertexIndexes[neighborRemappedIndex])
-                        return true;
+                        continue;
 
                      if (shouldWeldFn(polygon, index, neighborRemappedIndex))
                      {
                         remappedVertexIndex = neighborRemappedIndex;
-                        return false;
+                        break;
                      }
                   }
-                  else if (index==candidate.index)
+                  else
                   {
                      remappedVertexIndex = index;
                      maxRemappedIndex = index;
                   }
+                }
+                remappedVertexIndexes[index] = remappedVertexIndex;
+              };
+
+              if constexpr (VertexWelderBulkAccelerationStructure<AccelStructureT>)
+              {
+                // finding the candidates doesn't depend on the remapping, so it runs in parallel and only resolving them goes in index order
+                using position_t = typename AccelStructureT::position_t;
+                core::vector<uint32_t> vertexIndices(vertexCount);
+                std::iota(vertexIndices.begin(), vertexIndices.end(), 0u);
+                core::vector<position_t> positions(vertexCount);
+                core::for_each(core::execution::par_unseq, vertexIndices.begin(), vertexIndices.end(), [&](const uint32_t index) -> void
+                {
+                  positionView.decodeElement<position_t>(index, positions[index]);
+                });
+
+                // count first, then fill the preallocated per-vertex ranges, every query only ever touches its own slots
+                core::vector<size_t> candidateOffsets(vertexCount+1ull, 0ull);
+                as.forEachBroadphaseNeighborCandidatesBulk(positions, [&](const size_t index, const typename AccelStructureT::vertex_data_t& candidate) -> bool
+                {
+                  if (candidate.index<=index)
+                    candidateOffsets[index+1ull]++;
                   return true;
                 });
-                remappedVertexIndexes[index] = remappedVertexIndex;
+                std::inclusive_scan(candidateOffsets.begin(), candidateOffsets.end(), candidateOffsets.begin());
+                core::vector<uint32_t> candidates(candidateOffsets.back());
+                core::vector<size_t> candidateCursors(candidateOffsets.begin(), candidateOffsets.end()-1);
+                as.forEachBroadphaseNeighborCandidatesBulk(positions, [&](const size_t index, const typename AccelStructureT::vertex_data_t& candidate) -> bool
+                {
+                  if (candidate.index<=index)
+                    candidates[candidateCursors[index]++] = candidate.index;
+                  return true;
+                });
+
+                for (uint32_t index = 0; index < vertexCount; index++)
+                  resolve(index, std::span<const uint32_t>(candidates.data()+candidateOffsets[index], candidates.data()+candidateOffsets[index+1u]));
+              }
+              else
+              {
+                core::vector<uint32_t> candidates;
+                for (uint32_t index = 0; index < vertexCount; index++)
+                {
+                  hlsl::float32_t3 position;
+                  positionView.decodeElement<hlsl::float32_t3>(index, position);
+                  candidates.clear();
+                  as.forEachBroadphaseNeighborCandidates(position, [&](const typename AccelStructureT::vertex_data_t& candidate) -> bool {
+                    if (candidate.index<=index)
+                      candidates.push_back(candidate.index);
+                    return true;
+                  });
+                  resolve(index, candidates);
+                }
               }
 
               const auto& indexView = outPolygon->getIndexView();
@@ -106,6 +106,25 @@ class NBL_FORCE_EBO IReferenceCounted : public Interface, public AllocationOverr
 			return false;
 		}
 
+		//! Grabs the object `count` times with a single atomic operation.
+		inline uint32_t grab(const uint32_t count) const { return ReferenceCounter.fetch_add(count); }
+
+		//! Drops `count` references with a single atomic operation, this is how `refctd_drop_batch` coalesces its releases.
+		/** \return True, if the object was deleted. */
+		inline bool drop(const uint32_t count) const
+		{
+			auto ctrVal = ReferenceCounter.fetch_sub(count);
+			// someone is doing bad reference counting.
+			_NBL_DEBUG_BREAK_IF(ctrVal < count)
+			if (ctrVal==count)
+			{
+				delete this;
+				return true;
+			}
+
+			return false;
+		}
+
 		//! Get the reference count, due to threading it might be slightly outdated.
 		/** \return Recent value of the reference counter. */
 		inline int32_t getReferenceCount() const
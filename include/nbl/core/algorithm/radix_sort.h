@@ -9,8 +9,11 @@
 #include <bitset>
 #include <cstdint>
 #include <numeric>
+#include <thread>
 
 #include "nbl/macros.h"
+#include "nbl/core/decl/Types.h"
+#include "nbl/core/execution.h"
 
 namespace nbl
 {
@@ -49,6 +52,21 @@ constexpr int8_t find_msb(const T& a_variable)
     return -1;
 }
 
+// sorts indices by the keys they point at
+template<typename KeyIt, class KeyAccessor>
+struct IndirectKeyAccessor
+{
+	_NBL_STATIC_INLINE_CONSTEXPR size_t key_bit_count = KeyAccessor::key_bit_count;
+
+	template<auto bit_offset, auto radix_mask, typename IndexT>
+	inline decltype(radix_mask) operator()(const IndexT& index) const
+	{
+		return comp.template operator()<bit_offset,radix_mask>(keys[index]);
+	}
+
+	KeyIt keys;
+	const KeyAccessor& comp;
+};
 
 }
 
@@ -109,6 +127,238 @@ struct RadixLsbSorter
 		alignas(sizeof(histogram_t)) histogram_t m_histogram[histogram_size];
 };
 
+//! Parallel stable LSB radix sort with the same `KeyAccessor` interface as `RadixLsbSorter`.
+//! Threads own contiguous chunks of the range, one read pass counts the digits of all passes into per chunk histograms so passes where every
+//! key has the same digit get skipped. The first pass which runs reuses those counts, later ones recount their chunk after the permutation.
+//! Scatters go through per digit write-combining buffers which get flushed a cache line at a time, instead of touching a line per element.
+//! Keys needing more than `msb_first_pass_threshold` passes get a single pass over the most significant digit instead, after which every bucket
+//! gets LSB sorted on its own (buckets in parallel) while it's still in cache.
+template<size_t key_bit_count, uint8_t radix_bits=8u>
+class ParallelRadixSorter
+{
+	public:
+		constexpr static inline size_t histogram_size = 0x1ull<<radix_bits;
+		constexpr static inline uint16_t radix_mask = static_cast<uint16_t>(histogram_size-1ull);
+		constexpr static inline size_t pass_count = (key_bit_count-1ull)/size_t(radix_bits)+1ull;
+		// below this many elements per thread, the extra histograms cost more than they save
+		constexpr static inline size_t min_elements_per_chunk = 0x1ull<<15ull;
+		constexpr static inline size_t msb_first_pass_threshold = 4ull;
+		// MSB buckets smaller than this get a comparison sort instead of their own radix passes
+		constexpr static inline size_t min_bucket_radix_size = 256ull;
+		constexpr static inline size_t cache_line_size = 64ull;
+
+		//! Unlike `RadixLsbSorter` the return value is always where the sorted range ended up, either `input` or `output`
+		template<class RandomIt, class KeyAccessor>
+		inline RandomIt operator()(RandomIt input, RandomIt output, const size_t rangeSize, const KeyAccessor& comp) const
+		{
+			if (rangeSize<2ull)
+				return input;
+			core::vector<size_t> histograms;
+			SRange range = makeRange(rangeSize,histograms);
+			count(input,range,comp);
+			if constexpr (pass_count>msb_first_pass_threshold)
+			{
+				if (!range.trivial[pass_count-1ull])
+					return msbFirst(input,output,range,comp);
+			}
+			return lsbPass<0ull,pass_count>(input,output,range,comp,false);
+		}
+
+	private:
+		struct SRange
+		{
+			inline size_t* histogram(const size_t chunk, const size_t pass_ix) const {return histograms+(chunk*pass_count+pass_ix)*histogram_size;}
+
+			// histograms of a pass get turned into the scatter offsets, digit-major and chunk-minor so every chunk writes its own disjoint slots
+			inline void exclusiveScan(const size_t pass_ix) const
+			{
+				size_t sum = 0ull;
+				for (size_t digit=0ull; digit<histogram_size; digit++)
+				for (size_t chunk=0ull; chunk<chunkCount; chunk++)
+				{
+					auto& bucket = histogram(chunk,pass_ix)[digit];
+					const size_t count = bucket;
+					bucket = sum;
+					sum += count;
+				}
+			}
+
+			template<typename F>
+			inline void forEachChunk(F&& fn) const
+			{
+				if (chunkCount>1ull)
+				{
+					core::vector<size_t> chunks(chunkCount);
+					std::iota(chunks.begin(),chunks.end(),0ull);
+					core::for_each(core::execution::par,chunks.begin(),chunks.end(),[&](const size_t chunk)->void
+					{
+						const size_t begin = chunk*chunkSize;
+						fn(chunk,begin,std::min(begin+chunkSize,size));
+					});
+				}
+				else
+					fn(0ull,0ull,size);
+			}
+
+			size_t* histograms;
+			size_t chunkCount;
+			size_t chunkSize;
+			size_t size;
+			std::array<bool,pass_count> trivial;
+		};
+		static inline SRange makeRange(const size_t size, core::vector<size_t>& histograms)
+		{
+			const size_t chunkCount = std::max<size_t>(std::min<size_t>(size/min_elements_per_chunk,std::thread::hardware_concurrency()),1ull);
+			histograms.resize(chunkCount*pass_count*histogram_size);
+			return {.histograms=histograms.data(),.chunkCount=chunkCount,.chunkSize=(size+chunkCount-1ull)/chunkCount,.size=size};
+		}
+
+		template<size_t pass_ix, typename T, class KeyAccessor>
+		static inline uint16_t digit(const T& item, const KeyAccessor& comp)
+		{
+			return comp.template operator()<size_t(radix_bits)*pass_ix,radix_mask>(item);
+		}
+
+		template<class RandomIt, class KeyAccessor>
+		static inline void count(RandomIt input, SRange& range, const KeyAccessor& comp)
+		{
+			range.forEachChunk([&](const size_t chunk, const size_t begin, const size_t end)->void
+			{
+				size_t* const histogram = range.histogram(chunk,0ull);
+				std::fill_n(histogram,pass_count*histogram_size,0ull);
+				for (size_t i=begin; i<end; i++)
+				{
+					const auto& item = input[i];
+					[&]<size_t... PassIx>(std::index_sequence<PassIx...>)->void
+					{
+						(histogram[PassIx*histogram_size+digit<PassIx>(item,comp)]++,...);
+					}(std::make_index_sequence<pass_count>());
+				}
+			});
+			// a pass is trivial if the first digit present holds all the keys
+			for (size_t pass_ix=0ull; pass_ix<pass_count; pass_ix++)
+			for (size_t digit=0ull; digit<histogram_size; digit++)
+			{
+				size_t total = 0ull;
+				for (size_t chunk=0ull; chunk<range.chunkCount; chunk++)
+					total += range.histogram(chunk,pass_ix)[digit];
+				if (total)
+				{
+					range.trivial[pass_ix] = total==range.size;
+					break;
+				}
+			}
+		}
+
+		template<size_t pass_ix, class RandomIt, class KeyAccessor>
+		static inline void scatter(RandomIt input, RandomIt output, const size_t begin, const size_t end, size_t* const offsets, const KeyAccessor& comp)
+		{
+			using value_t = typename std::iterator_traits<RandomIt>::value_type;
+			constexpr size_t buffered = cache_line_size/sizeof(value_t);
+			if constexpr (buffered>1ull && std::is_default_constructible_v<value_t>)
+			{
+				core::vector<value_t> buffers(histogram_size*buffered);
+				core::vector<uint8_t> fill(histogram_size,0u);
+				for (size_t i=begin; i<end; i++)
+				{
+					const auto d = digit<pass_ix>(input[i],comp);
+					value_t* const buffer = buffers.data()+d*buffered;
+					buffer[fill[d]++] = std::move(input[i]);
+					if (fill[d]==buffered)
+					{
+						std::move(buffer,buffer+buffered,output+offsets[d]);
+						offsets[d] += buffered;
+						fill[d] = 0u;
+					}
+				}
+				for (size_t d=0ull; d<histogram_size; d++)
+				{
+					value_t* const buffer = buffers.data()+d*buffered;
+					std::move(buffer,buffer+fill[d],output+offsets[d]);
+					offsets[d] += fill[d];
+				}
+			}
+			else for (size_t i=begin; i<end; i++)
+				output[offsets[digit<pass_ix>(input[i],comp)]++] = std::move(input[i]);
+		}
+
+		template<size_t pass_ix, size_t pass_end, class RandomIt, class KeyAccessor>
+		static inline RandomIt lsbPass(RandomIt input, RandomIt output, SRange& range, const KeyAccessor& comp, bool permuted)
+		{
+			if (!range.trivial[pass_ix])
+			{
+				if (permuted)
+				{
+					range.forEachChunk([&](const size_t chunk, const size_t begin, const size_t end)->void
+					{
+						size_t* const histogram = range.histogram(chunk,pass_ix);
+						std::fill_n(histogram,histogram_size,0ull);
+						for (size_t i=begin; i<end; i++)
+							histogram[digit<pass_ix>(input[i],comp)]++;
+					});
+				}
+				range.exclusiveScan(pass_ix);
+				range.forEachChunk([&](const size_t chunk, const size_t begin, const size_t end)->void
+				{
+					scatter<pass_ix>(input,output,begin,end,range.histogram(chunk,pass_ix),comp);
+				});
+				std::swap(input,output);
+				permuted = true;
+			}
+			if constexpr (pass_ix+1ull<pass_end)
+				return lsbPass<pass_ix+1ull,pass_end>(input,output,range,comp,permuted);
+			else
+				return input;
+		}
+
+		template<class RandomIt, class KeyAccessor>
+		static inline RandomIt msbFirst(RandomIt input, RandomIt output, SRange& range, const KeyAccessor& comp)
+		{
+			constexpr size_t top_pass = pass_count-1ull;
+			// bucket bounds need to be taken before the scan turns the counts into offsets
+			core::vector<size_t> bucketOffsets(histogram_size+1ull,0ull);
+			for (size_t chunk=0ull; chunk<range.chunkCount; chunk++)
+			for (size_t d=0ull; d<histogram_size; d++)
+				bucketOffsets[d+1ull] += range.histogram(chunk,top_pass)[d];
+			std::partial_sum(bucketOffsets.begin(),bucketOffsets.end(),bucketOffsets.begin());
+			range.exclusiveScan(top_pass);
+			range.forEachChunk([&](const size_t chunk, const size_t begin, const size_t end)->void
+			{
+				scatter<top_pass>(input,output,begin,end,range.histogram(chunk,top_pass),comp);
+			});
+
+			core::vector<size_t> buckets(histogram_size);
+			std::iota(buckets.begin(),buckets.end(),0ull);
+			core::for_each(core::execution::par,buckets.begin(),buckets.end(),[&](const size_t bucket)->void
+			{
+				const size_t begin = bucketOffsets[bucket];
+				const size_t size = bucketOffsets[bucket+1ull]-begin;
+				if (size<2ull)
+					return;
+				if (size<min_bucket_radix_size)
+				{
+					std::stable_sort(output+begin,output+begin+size,[&comp](const auto& lhs, const auto& rhs)->bool
+					{
+						return [&]<size_t... PassIx>(std::index_sequence<PassIx...>)->bool
+						{
+							int32_t order = 0;
+							((order = order ? order:(int32_t(digit<pass_count-2ull-PassIx>(lhs,comp))-int32_t(digit<pass_count-2ull-PassIx>(rhs,comp)))),...);
+							return order<0;
+						}(std::make_index_sequence<pass_count-1ull>());
+					});
+					return;
+				}
+				core::vector<size_t> histograms;
+				SRange bucketRange = makeRange(size,histograms);
+				count(output+begin,bucketRange,comp);
+				const RandomIt sorted = lsbPass<0ull,top_pass>(output+begin,input+begin,bucketRange,comp,false);
+				if (sorted!=output+begin)
+					std::move(sorted,sorted+size,output+begin);
+			});
+			return output;
+		}
+};
+
 template<class RandomIt, class KeyAccessor>
 inline RandomIt radix_sort(RandomIt input, RandomIt scratch, const size_t rangeSize, const KeyAccessor& comp)
 {
@@ -126,7 +376,55 @@ inline RandomIt radix_sort(RandomIt input, RandomIt scratch, const size_t rangeS
 template<class RandomIt>
 inline RandomIt radix_sort(RandomIt input, RandomIt scratch, const size_t rangeSize)
 {
-	return radix_sort<RandomIt>(input,scratch,rangeSize,impl::KeyAdaptor<decltype(*input)>());
+	return radix_sort<RandomIt>(input,scratch,rangeSize,impl::KeyAdaptor<std::remove_cvref_t<decltype(*input)>>());
+}
+
+//! Same as `radix_sort` but with `ParallelRadixSorter`, returns wherever the sorted range ended up
+template<class RandomIt, class KeyAccessor>
+inline RandomIt parallel_radix_sort(RandomIt input, RandomIt scratch, const size_t rangeSize, const KeyAccessor& comp)
+{
+	return ParallelRadixSorter<KeyAccessor::key_bit_count>()(input,scratch,rangeSize,comp);
+}
+template<class RandomIt>
+inline RandomIt parallel_radix_sort(RandomIt input, RandomIt scratch, const size_t rangeSize)
+{
+	return parallel_radix_sort(input,scratch,rangeSize,impl::KeyAdaptor<std::remove_cvref_t<decltype(*input)>>());
+}
+
+//! Fills `indices` with the permutation which stably sorts `keys` and sorts it, `keys` stay untouched.
+//! Returns either `indices` or `scratch`, whichever holds the sorted permutation.
+template<class KeyIt, class IndexIt, class KeyAccessor>
+inline IndexIt parallel_radix_sort_indices(KeyIt keys, IndexIt indices, IndexIt scratch, const size_t rangeSize, const KeyAccessor& comp)
+{
+	using index_t = typename std::iterator_traits<IndexIt>::value_type;
+	std::iota(indices,indices+rangeSize,index_t(0));
+	return parallel_radix_sort(indices,scratch,rangeSize,impl::IndirectKeyAccessor<KeyIt,KeyAccessor>{.keys=keys,.comp=comp});
+}
+template<class KeyIt, class IndexIt>
+inline IndexIt parallel_radix_sort_indices(KeyIt keys, IndexIt indices, IndexIt scratch, const size_t rangeSize)
+{
+	return parallel_radix_sort_indices(keys,indices,scratch,rangeSize,impl::KeyAdaptor<std::remove_cvref_t<decltype(*keys)>>());
+}
+
+//! Stably sorts `keys` and applies the same permutation to `values`, sorts indices first so keys and values only get moved once
+template<class KeyIt, class ValueIt, class KeyAccessor>
+inline void parallel_radix_sort_by_key(KeyIt keys, ValueIt values, const size_t rangeSize, const KeyAccessor& comp)
+{
+	core::vector<size_t> indices(rangeSize*2ull);
+	const auto permutation = parallel_radix_sort_indices(keys,indices.begin(),indices.begin()+rangeSize,rangeSize,comp);
+	auto gather = [&]<class It>(It range)->void
+	{
+		core::vector<typename std::iterator_traits<It>::value_type> sorted(rangeSize);
+		core::transform(core::execution::par_unseq,permutation,permutation+rangeSize,sorted.begin(),[range](const size_t index){return std::move(range[index]);});
+		core::move(core::execution::par_unseq,sorted.begin(),sorted.end(),range);
+	};
+	gather(keys);
+	gather(values);
+}
+template<class KeyIt, class ValueIt>
+inline void parallel_radix_sort_by_key(KeyIt keys, ValueIt values, const size_t rangeSize)
+{
+	parallel_radix_sort_by_key(keys,values,rangeSize,impl::KeyAdaptor<std::remove_cvref_t<decltype(*keys)>>());
 }
 
 }
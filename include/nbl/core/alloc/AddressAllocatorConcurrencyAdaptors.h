@@ -20,7 +20,11 @@ class AddressAllocatorBasicConcurrencyAdaptor : private AddressAllocator
         static_assert(std::is_standard_layout<RecursiveLockable>::value,"Lock class is not standard layout");
         RecursiveLockable lock;
 
+    protected:
+        // the unlocked allocator, for derived adaptors which need to hand it to e.g. the resizing constructors
         AddressAllocator& getBaseRef() {return reinterpret_cast<AddressAllocator&>(*this);}
+        const AddressAllocator& getBaseRef() const {return reinterpret_cast<const AddressAllocator&>(*this);}
+
     public:
         _NBL_DECLARE_ADDRESS_ALLOCATOR_TYPEDEFS(typename AddressAllocator::size_type);
         using extra_ctor_param_types = typename AddressAllocator::extra_ctor_param_types;
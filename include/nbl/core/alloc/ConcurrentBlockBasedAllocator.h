@@ -0,0 +1,355 @@
+// Copyright (C) 2018-2026 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_CONCURRENT_BLOCK_BASED_ALLOCATOR_H_INCLUDED_
+#define _NBL_CORE_CONCURRENT_BLOCK_BASED_ALLOCATOR_H_INCLUDED_
+
+
+#include "nbl/core/alloc/SimpleBlockBasedAllocator.h"
+#include "nbl/core/alloc/LockFreePoolAddressAllocator.h"
+#include "nbl/core/alloc/LockFreeLinearAddressAllocator.h"
+
+#include <atomic>
+#include <thread>
+
+
+namespace nbl::core
+{
+
+// Address Allocators which can be used from many threads at once without any external synchronization
+template<class AddressAllocator>
+concept LockFreeAddressAllocator = requires
+{
+    requires AddressAllocator::isLockFree;
+};
+
+//! Same interface and handles as `SimpleBlockBasedAllocator`, but `allocate`, `deallocate` and `deref` can be called from many threads at once.
+//! Blocks are published in a fixed capacity array and their allocators are lock-free, so only creating a new block takes a lock.
+//! With pointers, deallocation finds the block in a fixed capacity address-sorted array, lookups which overlap a block's insertion retry.
+//! In exchange blocks are never freed until `reset` (which together with the destructor needs external synchronization), because
+//! another thread might be in the middle of allocating from a block the moment it becomes empty.
+template<class AddressAllocator, typename HandleValue=void*>
+class ConcurrentBlockBasedAllocator final : protected BlockBasedAllocatorBase<AddressAllocator>
+{
+        // not a constraint so that the type can be named (e.g. in a `std::conditional_t`) without being usable
+        static_assert(LockFreeAddressAllocator<AddressAllocator>,"The blocks' Address Allocator needs to be lock-free!");
+
+        using base_t = BlockBasedAllocatorBase<AddressAllocator>;
+        using this_t = ConcurrentBlockBasedAllocator<AddressAllocator,HandleValue>;
+        using block_t = typename base_t::Block;
+        // we hand out the exact same handles
+        using st_type = SimpleBlockBasedAllocator<AddressAllocator,HandleValue>;
+
+        constexpr static inline bool UsesHandles = !std::is_pointer_v<HandleValue>;
+
+    public:
+        using handle_value_type = HandleValue;
+        using addr_alloc_traits = typename base_t::addr_alloc_traits;
+        using extra_params_type = typename base_t::extra_params_type;
+        using size_type = typename base_t::size_type;
+
+        template<typename T>
+        using typed_pointer_type = typename st_type::template typed_pointer_type<T>;
+
+        template<typename T, typename P>
+        static inline auto _const_cast(const P p) {return st_type::template _const_cast<T>(p);}
+        template<typename T, typename P>
+        static inline auto _reinterpret_cast(const P p) {return st_type::template _reinterpret_cast<T>(p);}
+        template<typename T, typename P>
+        static inline auto _static_cast(const P p) {return st_type::template _static_cast<T>(p);}
+
+        // same as `SimpleBlockBasedAllocator` so the two can be swapped, `maxBlocks` if present caps the number of blocks (default for pointers)
+        using SCreationParams = typename st_type::SCreationParams;
+        inline ConcurrentBlockBasedAllocator(SCreationParams&& params) : base_t(std::move(params.composed)), m_maxBlocks(getMaxBlocks(params)),
+            m_blocks(std::make_unique<std::atomic<block_t*>[]>(m_maxBlocks)), m_blockSizeLog2(hlsl::findMSB<size_type>(base_t::getBlockCreationParams().blockSize))
+        {
+            if constexpr (!UsesHandles)
+                m_sortedBlocks = std::make_unique<std::atomic<block_t*>[]>(m_maxBlocks);
+            assert(base_t::m_initBlockCount<=m_maxBlocks);
+            if constexpr (UsesHandles)
+                assert(hlsl::findMSB(m_maxBlocks-1u)+m_blockSizeLog2<sizeof(HandleValue)*8u);
+            for (auto i=0u; i<base_t::m_initBlockCount; i++)
+                publishBlock(base_t::createBlock());
+        }
+        inline ~ConcurrentBlockBasedAllocator()
+        {
+            const uint32_t count = m_blockCount.load(std::memory_order_acquire);
+            for (uint32_t i=0u; i<count; i++)
+                base_t::deleteBlock(m_blocks[i].load(std::memory_order_relaxed));
+        }
+
+        //
+        template<typename T> requires (!std::is_const_v<T>)
+        inline T* deref(typed_pointer_type<T> p)
+        {
+            if constexpr (UsesHandles)
+            {
+                if (p)
+                    return reinterpret_cast<T*>(std::launder(getBlock(p)->data(base_t::m_blockCreationParams)+getOffsetInBlock(p)));
+                return nullptr;
+            }
+            else
+                return p;
+        }
+        template<typename T>
+        inline const T* deref(typed_pointer_type<T> p) const
+        {
+            if constexpr (UsesHandles)
+            {
+                using mut_t = std::remove_const_t<T>;
+                typed_pointer_type<mut_t> m = {}; m.value = p.value;
+                return const_cast<this_t*>(this)->template deref<mut_t>(m);
+            }
+            else
+                return p;
+        }
+        template<typename T, typename U> requires (UsesHandles && std::is_const_v<T> == std::is_const_v<U>)
+        inline typed_pointer_type<T> _dynamic_cast(typed_pointer_type<U> h) const
+        {
+            typed_pointer_type<T> retval;
+            retval.value = h.value;
+            if (h)
+            {
+                const auto* const pU = deref<const U>(h);
+                const T* pT = dynamic_cast<const T*>(pU);
+                if (!pT)
+                    return {};
+                retval.value += ptrdiff_t(pT) - ptrdiff_t(pU);
+            }
+            return retval;
+        }
+
+        //! deallocates everything, Not thread-safe
+        inline void reset()
+        {
+            const uint32_t count = m_blockCount.load(std::memory_order_acquire);
+            const uint32_t kept = std::min<uint32_t>(count,base_t::m_initBlockCount);
+            for (uint32_t i=0u; i<count; i++)
+            {
+                block_t* block = m_blocks[i].load(std::memory_order_relaxed);
+                if (i<kept)
+                    block->getAllocator().reset();
+                else
+                {
+                    base_t::deleteBlock(block);
+                    m_blocks[i].store(nullptr,std::memory_order_relaxed);
+                }
+            }
+            m_blockCount.store(kept,std::memory_order_release);
+            for (auto& hint : m_hints)
+                hint.block.store(0u,std::memory_order_relaxed);
+            if constexpr (!UsesHandles)
+            {
+                core::vector<block_t*> sorted(kept);
+                for (uint32_t i=0u; i<kept; i++)
+                    sorted[i] = m_blocks[i].load(std::memory_order_relaxed);
+                std::sort(sorted.begin(),sorted.end());
+                for (uint32_t i=0u; i<kept; i++)
+                    m_sortedBlocks[i].store(sorted[i],std::memory_order_relaxed);
+                m_sortedBlockCount.store(kept,std::memory_order_release);
+            }
+        }
+
+        //
+        inline typed_pointer_type<void> allocate(const size_type bytes, const size_type alignment) noexcept
+        {
+            constexpr auto invalid_address = AddressAllocator::invalid_address;
+            // every thread starts looking in the block it last allocated from, so that threads spread out over the blocks
+            auto& hint = m_hints[std::hash<std::thread::id>()(std::this_thread::get_id())&(HintCount-1u)].block;
+            for (uint32_t count=m_blockCount.load(std::memory_order_acquire); true;)
+            {
+                const uint32_t first = count ? (hint.load(std::memory_order_relaxed)%count):0u;
+                for (uint32_t i=0u; i<count; i++)
+                {
+                    const uint32_t id = first+i<count ? (first+i):(first+i-count);
+                    block_t* const block = m_blocks[id].load(std::memory_order_acquire);
+                    if (const auto addr=block->alloc(bytes,alignment); addr!=invalid_address)
+                    {
+                        if (id!=first)
+                            hint.store(id,std::memory_order_relaxed);
+                        return makeHandle(id,block,addr);
+                    }
+                }
+                std::lock_guard<std::mutex> guard(m_growLock);
+                // someone else could have already made a new block while we were searching
+                if (const uint32_t newCount=m_blockCount.load(std::memory_order_acquire); newCount!=count)
+                {
+                    count = newCount;
+                    continue;
+                }
+                if (count==m_maxBlocks)
+                    return {};
+                block_t* block = base_t::createBlock();
+                if (const auto addr=block->alloc(bytes,alignment); addr!=invalid_address)
+                {
+                    publishBlock(block);
+                    hint.store(count,std::memory_order_relaxed);
+                    return makeHandle(count,block,addr);
+                }
+                base_t::deleteBlock(block);
+                return {};
+            }
+        }
+        inline void deallocate(const typed_pointer_type<void> h, const size_type bytes) noexcept
+        {
+            if constexpr (UsesHandles)
+                getBlock(h)->free(getOffsetInBlock(h),bytes);
+            else
+            {
+                block_t* const block = findBlock(h);
+                uint8_t* const blockData = block->data(base_t::m_blockCreationParams);
+                assert(blockData<=h && h<blockData+base_t::m_blockCreationParams.blockSize);
+                block->free(reinterpret_cast<uint8_t*>(h)-blockData,bytes);
+            }
+        }
+
+        //! Serialization, same as `SimpleBlockBasedAllocator::restoreBlocks` but the blocks need a `LockFreeLinearAddressAllocator`.
+        //! Block IDs are indices into the published blocks, so restoring creates every block up to the largest ID (the ones without an image stay empty).
+        //! `visitBlocks` and `restoreBlocks` need external synchronization, `isAllocated` is only exact when nothing is allocating from the block.
+        constexpr static inline bool HasLinearBlocks = std::is_same_v<AddressAllocator,LockFreeLinearAddressAllocator<size_type>>;
+        using block_image_type = SAllocatorBlockImage<HandleValue,size_type>;
+        using base_t::getBlockCreationParams;
+        template<typename F> requires (UsesHandles && HasLinearBlocks)
+        inline void visitBlocks(F&& visit) const
+        {
+            const uint32_t count = m_blockCount.load(std::memory_order_acquire);
+            for (uint32_t id=0u; id<count; id++)
+            {
+                const block_t* const block = m_blocks[id].load(std::memory_order_relaxed);
+                visit(block_image_type{.id=static_cast<HandleValue>(id),.size=addr_alloc_traits::get_allocated_size(block->getAllocator()),.data=block->data(base_t::m_blockCreationParams)});
+            }
+        }
+        // Deallocates everything and recreates the blocks with their old IDs and contents, no constructors get run. Leaves the allocator reset on failure.
+        inline bool restoreBlocks(const std::span<const block_image_type> images) requires (UsesHandles && HasLinearBlocks)
+        {
+            reset();
+            HandleValue maxID = 0;
+            for (const auto& image : images)
+            {
+                if (image.size>base_t::m_blockCreationParams.blockSize || image.size && !image.data || image.id>=m_maxBlocks)
+                    return false;
+                maxID = std::max<HandleValue>(maxID,image.id);
+            }
+            if (!images.empty())
+            for (auto id=m_blockCount.load(std::memory_order_relaxed); id<=maxID; id++)
+                publishBlock(base_t::createBlock());
+            for (const auto& image : images)
+            {
+                if (!image.size)
+                    continue;
+                block_t* const block = m_blocks[image.id].load(std::memory_order_relaxed);
+                // fresh block, so a linear allocation lands at the start, anything else means a duplicate image
+                if (block->alloc(image.size,1)!=0u)
+                {
+                    reset();
+                    return false;
+                }
+                memcpy(block->data(base_t::m_blockCreationParams),image.data,image.size);
+            }
+            return true;
+        }
+        // whether `[h,h+bytes)` lies within the allocated part of a block, for validating restored handles
+        inline bool isAllocated(const typed_pointer_type<const void> h, const size_type bytes) const requires (UsesHandles && HasLinearBlocks)
+        {
+            if (!h || (h.value>>m_blockSizeLog2)>=m_blockCount.load(std::memory_order_acquire))
+                return false;
+            return getOffsetInBlock(h)+bytes<=addr_alloc_traits::get_allocated_size(getBlock(h)->getAllocator());
+        }
+
+    private:
+        static inline uint32_t getMaxBlocks(const SCreationParams& params)
+        {
+            if constexpr (requires {params.maxBlocks;})
+                return params.maxBlocks;
+            else
+                return 0x1u<<13;
+        }
+
+        inline typed_pointer_type<void> makeHandle(const uint32_t id, block_t* const block, const size_type addr) const
+        {
+            if constexpr (UsesHandles)
+                return {{{.value=static_cast<HandleValue>((HandleValue(id)<<m_blockSizeLog2)|addr)}}};
+            else
+                return block->data(base_t::m_blockCreationParams)+addr;
+        }
+        inline HandleValue getOffsetInBlock(const typed_pointer_type<const void> h) const requires UsesHandles {return h.value&((HandleValue(1)<<m_blockSizeLog2)-1);}
+        inline block_t* getBlock(const typed_pointer_type<const void> h) const requires UsesHandles
+        {
+            return m_blocks[h.value>>m_blockSizeLog2].load(std::memory_order_acquire);
+        }
+
+        //! needs `m_growLock` held, or the allocator to not be shared yet
+        inline void publishBlock(block_t* const block)
+        {
+            const uint32_t id = m_blockCount.load(std::memory_order_relaxed);
+            m_blocks[id].store(block,std::memory_order_release);
+            // pointers need the blocks sorted by address to find theirs, the new one gets inserted in place and lookups which overlap that retry
+            if constexpr (!UsesHandles)
+            {
+                const uint32_t version = m_sortedBlocksVersion.load(std::memory_order_relaxed);
+                m_sortedBlocksVersion.store(version+1u,std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                uint32_t i = m_sortedBlockCount.load(std::memory_order_relaxed);
+                for (; i && m_sortedBlocks[i-1u].load(std::memory_order_relaxed)>block; i--)
+                    m_sortedBlocks[i].store(m_sortedBlocks[i-1u].load(std::memory_order_relaxed),std::memory_order_relaxed);
+                m_sortedBlocks[i].store(block,std::memory_order_relaxed);
+                m_sortedBlockCount.store(m_sortedBlockCount.load(std::memory_order_relaxed)+1u,std::memory_order_relaxed);
+                m_sortedBlocksVersion.store(version+2u,std::memory_order_release);
+            }
+            m_blockCount.store(id+1u,std::memory_order_release);
+        }
+        //! the block containing a pointer, binary search over the sorted blocks which gets retried if a block got published in the meantime
+        inline block_t* findBlock(const void* const p) const requires (!UsesHandles)
+        {
+            while (true)
+            {
+                const uint32_t version = m_sortedBlocksVersion.load(std::memory_order_acquire);
+                if (version&0x1u)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                const uint32_t count = m_sortedBlockCount.load(std::memory_order_relaxed);
+                // pointer can be in the block, but will be past the (block start is in the block), so look for the last block starting before it
+                uint32_t begin = 0u;
+                for (uint32_t len=count; len;)
+                {
+                    const uint32_t half = len>>1u;
+                    if (m_sortedBlocks[begin+half].load(std::memory_order_relaxed)<=p)
+                    {
+                        begin += half+1u;
+                        len -= half+1u;
+                    }
+                    else
+                        len = half;
+                }
+                block_t* const block = begin ? m_sortedBlocks[begin-1u].load(std::memory_order_relaxed):nullptr;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sortedBlocksVersion.load(std::memory_order_relaxed)!=version)
+                    continue;
+                assert(block);
+                return block;
+            }
+        }
+
+        constexpr static inline uint32_t HintCount = 16u;
+        struct alignas(64) SHint
+        {
+            std::atomic<uint32_t> block = 0u;
+        };
+
+        const uint32_t m_maxBlocks;
+        std::unique_ptr<std::atomic<block_t*>[]> m_blocks;
+        std::atomic<uint32_t> m_blockCount = 0u;
+        const uint8_t m_blockSizeLog2;
+        SHint m_hints[HintCount];
+        std::mutex m_growLock;
+        // only used with pointers, the blocks sorted by address and a sequence number which is odd while a block is getting inserted
+        std::unique_ptr<std::atomic<block_t*>[]> m_sortedBlocks;
+        std::atomic<uint32_t> m_sortedBlockCount = 0u;
+        std::atomic<uint32_t> m_sortedBlocksVersion = 0u;
+};
+// no aliases
+
+}
+#endif
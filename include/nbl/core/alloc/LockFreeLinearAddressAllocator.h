@@ -0,0 +1,135 @@
+// Copyright (C) 2018-2026 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_LOCK_FREE_LINEAR_ADDRESS_ALLOCATOR_H_INCLUDED_
+#define _NBL_CORE_LOCK_FREE_LINEAR_ADDRESS_ALLOCATOR_H_INCLUDED_
+
+
+#include "nbl/core/alloc/AddressAllocatorBase.h"
+
+#include <atomic>
+
+
+namespace nbl::core
+{
+
+//! Same semantics as `LinearAddressAllocator`, but `alloc_addr` can be called from any number of threads at once, the cursor gets bumped with a CAS.
+//! Everything else (construction, resizing, `reset`, moves) needs external synchronization like any other address allocator.
+template<typename _size_type>
+class LockFreeLinearAddressAllocator : public AddressAllocatorBase<LockFreeLinearAddressAllocator<_size_type>,_size_type>
+{
+        using Base = AddressAllocatorBase<LockFreeLinearAddressAllocator<_size_type>,_size_type>;
+    public:
+        _NBL_DECLARE_ADDRESS_ALLOCATOR_TYPEDEFS(_size_type);
+
+        static constexpr inline bool isLockFree = true;
+
+        inline LockFreeLinearAddressAllocator() noexcept : bufferSize(invalid_address), cursor(invalid_address) {}
+        virtual ~LockFreeLinearAddressAllocator() {}
+
+        using extra_ctor_param_types = type_list<>;
+        inline LockFreeLinearAddressAllocator(void* reservedSpc, _size_type addressOffsetToApply, _size_type alignOffsetNeeded, _size_type maxAllocatableAlignment, size_type bufSz) noexcept :
+            Base(reservedSpc,addressOffsetToApply,alignOffsetNeeded,maxAllocatableAlignment), bufferSize(bufSz-Base::alignOffset), cursor(0u) {}
+
+        //! When resizing we require that the copying of data buffer has already been handled by the user of the address allocator
+        template<typename... Args>
+        inline LockFreeLinearAddressAllocator(_size_type newBuffSz, LockFreeLinearAddressAllocator&& other, Args&&... args) :
+            Base(std::move(other),std::forward<Args>(args)...), bufferSize(newBuffSz-Base::alignOffset), cursor(other.cursor.exchange(invalid_address,std::memory_order_relaxed))
+        {
+            other.bufferSize = invalid_address;
+        }
+        template<typename... Args>
+        inline LockFreeLinearAddressAllocator(_size_type newBuffSz, const LockFreeLinearAddressAllocator& other, Args&&... args) :
+            Base(other,std::forward<Args>(args)...), bufferSize(newBuffSz-Base::alignOffset), cursor(other.cursor.load(std::memory_order_relaxed)) {}
+
+        inline LockFreeLinearAddressAllocator& operator=(LockFreeLinearAddressAllocator&& other)
+        {
+            Base::operator=(std::move(other));
+            std::swap(bufferSize,other.bufferSize);
+            cursor.store(other.cursor.exchange(cursor.load(std::memory_order_relaxed),std::memory_order_relaxed),std::memory_order_relaxed);
+            return *this;
+        }
+
+        //! non-PoT alignments cannot be guaranteed after a resize or move of the backing buffer
+        inline size_type    alloc_addr(size_type bytes, size_type alignment, size_type hint=0ull) noexcept
+        {
+            if (bytes==0 || alignment>Base::maxRequestableAlignment)
+                return invalid_address;
+
+            // relaxed is enough, handing out the address doesn't publish anything
+            size_type oldCursor = cursor.load(std::memory_order_relaxed);
+            size_type result;
+            do
+            {
+                result = core::roundUp(oldCursor,alignment);
+                const size_type newCursor = result+bytes;
+                if (newCursor>bufferSize || newCursor<oldCursor) // the extra OR checks for wraparound
+                    return invalid_address;
+                if (cursor.compare_exchange_weak(oldCursor,newCursor,std::memory_order_relaxed))
+                    break;
+            } while (true);
+            return result+Base::combinedOffset;
+        }
+
+        // free is a No-OP, only reset can actually reclaim memory
+        inline void         free_addr(size_type addr, size_type bytes) noexcept
+        {
+            return;
+        }
+
+        // reset cursor to `c` allocation units
+        inline void         reset(size_type c = 0)
+        {
+            cursor.store(c,std::memory_order_relaxed);
+        }
+
+        //! Conservative estimate, max_size() gives largest size we are sure to be able to allocate
+        inline size_type    max_size() const noexcept
+        {
+            auto worstCursor = roundUp(get_allocated_size(),Base::maxRequestableAlignment);
+            if (worstCursor<bufferSize)
+                return bufferSize-worstCursor;
+            return 0u;
+        }
+
+        //! Most allocators do not support e.g. 1-byte allocations
+        inline size_type    min_size() const noexcept
+        {
+            return 1u;
+        }
+
+        inline size_type        safe_shrink_size(size_type sizeBound, size_type newBuffAlignmentWeCanGuarantee=1u) const noexcept
+        {
+            size_type retval = get_allocated_size();
+            return Base::safe_shrink_size(std::max(retval,sizeBound),newBuffAlignmentWeCanGuarantee);
+        }
+
+        template<typename... Args>
+        static inline size_type reserved_size(const Args&... args) noexcept
+        {
+            return 0u;
+        }
+
+        // total allocatable size, align offset is not allocatable so it's not included
+        inline size_type        get_free_size() const noexcept
+        {
+            return bufferSize-get_allocated_size();
+        }
+        //! only exact when no other thread is allocating
+        inline size_type        get_allocated_size() const noexcept
+        {
+            return cursor.load(std::memory_order_relaxed);
+        }
+        // total size is the metric that includes the align offset
+        inline size_type        get_total_size() const noexcept
+        {
+            return bufferSize+Base::alignOffset;
+        }
+
+    protected:
+        size_type bufferSize;
+        std::atomic<size_type> cursor;
+};
+
+}
+#endif
@@ -0,0 +1,458 @@
+// Copyright (C) 2018-2026 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_LOCK_FREE_POOL_ADDRESS_ALLOCATOR_H_INCLUDED_
+#define _NBL_CORE_LOCK_FREE_POOL_ADDRESS_ALLOCATOR_H_INCLUDED_
+
+
+#include "BuildConfigOptions.h"
+
+#include "nbl/core/alloc/AddressAllocatorBase.h"
+
+#include <atomic>
+#include <thread>
+
+
+namespace nbl::core
+{
+
+//! Same semantics as `PoolAddressAllocator`, but `alloc_addr`, `free_addr` and the `multi_` variants can be called from any number of threads at once.
+//! The free blocks form a Treiber stack linked by block index through the reserved space, the head packs the index of the top block with a tag
+//! that gets bumped on every successful exchange so a stale head can never be swapped in (ABA). To keep threads off the head's cacheline
+//! every thread (by hash of its id) gets a magazine of block indices which it refills and spills in batches, a batch costs a single CAS.
+//! Threads which collide on a busy magazine go straight to the stack instead of waiting, only once the stack ran dry does an allocation wait for
+//! busy magazines, so it never fails while another thread's magazine still holds free blocks.
+//! Everything else (construction, resizing, `reset`, `safe_shrink_size`, moves) needs external synchronization like any other address allocator.
+template<typename _size_type, uint32_t MagazineCount=16u, uint32_t MagazineSize=32u>
+class LockFreePoolAddressAllocator : public AddressAllocatorBase<LockFreePoolAddressAllocator<_size_type,MagazineCount,MagazineSize>,_size_type>
+{
+        static_assert(core::isPoT(MagazineCount),"MagazineCount must be a Power of Two!");
+        static_assert(MagazineSize>=2u,"Magazines need to be able to hold a refill and a spill!");
+
+    private:
+        using base_t = AddressAllocatorBase<LockFreePoolAddressAllocator<_size_type,MagazineCount,MagazineSize>,_size_type>;
+
+        // blocks are linked by 32bit index no matter the `size_type`, so the head can be packed together with its ABA tag
+        static constexpr inline uint32_t InvalidIndex = ~0u;
+
+    public:
+        _NBL_DECLARE_ADDRESS_ALLOCATOR_TYPEDEFS(_size_type);
+
+        static constexpr inline bool supportsNullBuffer = true;
+        static constexpr inline bool isLockFree = true;
+
+        inline LockFreePoolAddressAllocator() : blockCount(0u), blockSize(1u) {}
+        virtual ~LockFreePoolAddressAllocator() {}
+
+        using extra_ctor_param_types = type_list<size_type/*Block Size*/>;
+        inline LockFreePoolAddressAllocator(void* reservedSpc, _size_type addressOffsetToApply, _size_type alignOffsetNeeded, _size_type maxAllocatableAlignment, size_type bufSz, size_type blockSz) noexcept :
+            base_t(reservedSpc,addressOffsetToApply,alignOffsetNeeded,maxAllocatableAlignment), blockCount((bufSz-alignOffsetNeeded)/blockSz), blockSize(blockSz)
+        {
+            assert(blockCount<InvalidIndex);
+            reset();
+        }
+
+        //! When resizing we require that the copying of data buffer has already been handled by the user of the address allocator
+        template<typename... Args>
+        inline LockFreePoolAddressAllocator(_size_type newBuffSz, LockFreePoolAddressAllocator&& other, Args&&... args) noexcept :
+            base_t(other,std::forward<Args>(args)...), blockCount((newBuffSz-base_t::alignOffset)/other.blockSize), blockSize(other.blockSize)
+        {
+            copyState(other,newBuffSz);
+
+            other.invalidate();
+        }
+        template<typename... Args>
+        inline LockFreePoolAddressAllocator(_size_type newBuffSz, const LockFreePoolAddressAllocator& other, Args&&... args) noexcept :
+            base_t(other,std::forward<Args>(args)...), blockCount((newBuffSz-base_t::alignOffset)/other.blockSize), blockSize(other.blockSize)
+        {
+            copyState(other,newBuffSz);
+        }
+
+        inline LockFreePoolAddressAllocator& operator=(LockFreePoolAddressAllocator&& other)
+        {
+            base_t::operator=(std::move(other));
+            blockCount = other.blockCount;
+            blockSize = other.blockSize;
+            m_stack.head.store(other.m_stack.head.load(std::memory_order_relaxed),std::memory_order_relaxed);
+            m_stack.size.store(other.m_stack.size.load(std::memory_order_relaxed),std::memory_order_relaxed);
+            for (uint32_t i=0u; i<MagazineCount; i++)
+            {
+                const uint32_t count = other.m_magazines[i].count.load(std::memory_order_relaxed);
+                std::copy_n(other.m_magazines[i].entries,count,m_magazines[i].entries);
+                m_magazines[i].count.store(count,std::memory_order_relaxed);
+            }
+            other.invalidateLocal();
+            return *this;
+        }
+
+
+        inline size_type        alloc_addr(size_type bytes, size_type alignment, size_type hint=0ull) noexcept
+        {
+            size_type retval = invalid_address;
+            multi_alloc_addr(1u,&retval,&bytes,alignment);
+            return retval;
+        }
+
+        inline void             free_addr(size_type addr, size_type bytes) noexcept
+        {
+            multi_free_addr(1u,&addr,&bytes);
+        }
+
+        //! Warning `outAddresses` needs to be primed with `invalid_address` values, otherwise no allocation happens for elements not equal to `invalid_address`
+        inline void             multi_alloc_addr(uint32_t count, size_type* outAddresses, const size_type* bytes, const size_type* alignment, const size_type* hint=nullptr) noexcept
+        {
+            multi_alloc_addr_impl(count,outAddresses,bytes,[alignment](const uint32_t i)->size_type{return alignment[i];});
+        }
+        inline void             multi_alloc_addr(uint32_t count, size_type* outAddresses, const size_type* bytes, const size_type alignment, const size_type* hint=nullptr) noexcept
+        {
+            multi_alloc_addr_impl(count,outAddresses,bytes,[alignment](const uint32_t)->size_type{return alignment;});
+        }
+
+        inline void             multi_free_addr(uint32_t count, const size_type* addr, const size_type* bytes) noexcept
+        {
+            SMagazine* const magazine = tryLockMagazine();
+            for (uint32_t i=0u; i<count; i++)
+            {
+                if (addr[i]==invalid_address)
+                    continue;
+                #ifdef _NBL_DEBUG
+                    assert(addr[i]>=base_t::combinedOffset && (addr[i]-base_t::combinedOffset)%blockSize==0);
+                #endif // _NBL_DEBUG
+                const uint32_t index = static_cast<uint32_t>(addressToBlockID(addr[i]));
+                if (!magazine)
+                {
+                    push(&index,1u);
+                    continue;
+                }
+                uint32_t fill = magazine->count.load(std::memory_order_relaxed);
+                if (fill==MagazineSize)
+                {
+                    // spill the oldest half in one go, the most recently freed blocks are the most likely to be in cache
+                    constexpr uint32_t SpillCount = MagazineSize/2u;
+                    push(magazine->entries,SpillCount);
+                    std::copy(magazine->entries+SpillCount,magazine->entries+MagazineSize,magazine->entries);
+                    fill -= SpillCount;
+                }
+                magazine->entries[fill++] = index;
+                magazine->count.store(fill,std::memory_order_relaxed);
+            }
+            if (magazine)
+                magazine->lock.clear(std::memory_order_release);
+        }
+
+        //! Not thread-safe
+        inline void             reset()
+        {
+            auto* const links = getLinks();
+            for (uint32_t i=0u; i<blockCount; i++)
+                std::construct_at(links+i,i+1u!=blockCount ? (i+1u):InvalidIndex);
+            m_stack.head.store(blockCount ? 0ull:uint64_t(InvalidIndex),std::memory_order_relaxed);
+            m_stack.size.store(blockCount,std::memory_order_relaxed);
+            for (auto& magazine : m_magazines)
+                magazine.count.store(0u,std::memory_order_relaxed);
+        }
+
+        //! conservative estimate, does not account for space lost to alignment
+        inline size_type        max_size() const noexcept
+        {
+            return blockSize;
+        }
+
+        //! Most allocators do not support e.g. 1-byte allocations
+        inline size_type        min_size() const noexcept
+        {
+            return blockSize;
+        }
+
+        //! Not thread-safe
+        inline size_type        safe_shrink_size(size_type sizeBound, size_type newBuffAlignmentWeCanGuarantee=1u) noexcept
+        {
+            const size_type capacity = get_total_size()-base_t::alignOffset;
+            if (sizeBound<capacity)
+            {
+                // the second half of the reserved space is scratch for exactly this
+                uint32_t* const freeList = reinterpret_cast<uint32_t*>(getLinks()+blockCount);
+                uint32_t freeCount = 0u;
+                forEachFree(*this,[&](const uint32_t index)->void{freeList[freeCount++]=index;});
+                if (freeCount==0u)
+                    sizeBound = capacity;
+                else
+                {
+                    sizeBound = std::max(sizeBound,get_allocated_size());
+                    std::sort(freeList,freeList+freeCount);
+                    uint32_t i=0u;
+                    for (uint32_t endIndex=blockCount-1u; i<freeCount && freeList[freeCount-1u-i]==endIndex; i++,endIndex--) {}
+                    sizeBound = std::max(sizeBound,size_type(blockCount-i)*blockSize);
+                }
+            }
+            return base_t::safe_shrink_size(sizeBound,newBuffAlignmentWeCanGuarantee);
+        }
+
+
+        static inline size_type reserved_size(size_type maxAlignment, size_type bufSz, size_type blockSz) noexcept
+        {
+            size_type maxBlockCount = bufSz/blockSz;
+            return maxBlockCount*sizeof(uint32_t)*size_type(2u);
+        }
+        static inline size_type reserved_size(const LockFreePoolAddressAllocator& other, size_type bufSz) noexcept
+        {
+            return reserved_size(other.maxRequestableAlignment,bufSz,other.blockSize);
+        }
+
+        //! only exact when no other thread is allocating or freeing
+        inline size_type        get_free_size() const noexcept
+        {
+            size_type freeCount = m_stack.size.load(std::memory_order_relaxed);
+            for (const auto& magazine : m_magazines)
+                freeCount += magazine.count.load(std::memory_order_relaxed);
+            return std::min(freeCount,blockCount)*blockSize;
+        }
+        inline size_type        get_allocated_size() const noexcept
+        {
+            return blockCount*blockSize-get_free_size();
+        }
+        inline size_type        get_total_size() const noexcept
+        {
+            return blockCount*blockSize+base_t::alignOffset;
+        }
+
+
+
+        inline size_type addressToBlockID(size_type addr) const noexcept
+        {
+            return (addr-base_t::combinedOffset)/blockSize;
+        }
+
+    protected:
+        struct alignas(64) SMagazine
+        {
+            std::atomic_flag lock = ATOMIC_FLAG_INIT;
+            // only ever modified with the lock held, atomic only so that `get_free_size` can peek
+            std::atomic<uint32_t> count = 0u;
+            uint32_t entries[MagazineSize];
+        };
+        struct alignas(64) SStack
+        {
+            // low 32 bits are the index of the top block, high 32 bits are the ABA tag
+            std::atomic<uint64_t> head = uint64_t(InvalidIndex);
+            // never less than the actual number of blocks in the stack
+            std::atomic<size_type> size = 0u;
+        };
+
+        inline std::atomic<uint32_t>* getLinks() {return reinterpret_cast<std::atomic<uint32_t>*>(base_t::reservedSpace);}
+        inline const std::atomic<uint32_t>* getLinks() const {return reinterpret_cast<const std::atomic<uint32_t>*>(base_t::reservedSpace);}
+
+        inline SMagazine* tryLockMagazine() noexcept
+        {
+            SMagazine& magazine = m_magazines[std::hash<std::thread::id>()(std::this_thread::get_id())&(MagazineCount-1u)];
+            if (magazine.lock.test_and_set(std::memory_order_acquire))
+                return nullptr;
+            return &magazine;
+        }
+
+        //! pops up to `maxCount` blocks with a single CAS, returns how many
+        inline uint32_t pop(uint32_t* out, const uint32_t maxCount) noexcept
+        {
+            const auto* const links = getLinks();
+            uint64_t head = m_stack.head.load(std::memory_order_acquire);
+            while (true)
+            {
+                // links of blocks which got popped by someone else in the meantime may be garbage, but the tag won't match so the CAS will fail
+                uint32_t index = static_cast<uint32_t>(head);
+                uint32_t count = 0u;
+                for (; count<maxCount && index!=InvalidIndex; count++)
+                {
+                    out[count] = index;
+                    index = links[index].load(std::memory_order_relaxed);
+                }
+                if (count==0u)
+                    return 0u;
+                const uint64_t newHead = (((head>>32ull)+1ull)<<32ull)|index;
+                if (m_stack.head.compare_exchange_weak(head,newHead,std::memory_order_acquire,std::memory_order_acquire))
+                {
+                    m_stack.size.fetch_sub(count,std::memory_order_relaxed);
+                    return count;
+                }
+            }
+        }
+        //! pushes the blocks as one chain with a single CAS
+        inline void push(const uint32_t* indices, const uint32_t count) noexcept
+        {
+            auto* const links = getLinks();
+            for (uint32_t i=1u; i<count; i++)
+                links[indices[i-1u]].store(indices[i],std::memory_order_relaxed);
+            m_stack.size.fetch_add(count,std::memory_order_relaxed);
+            uint64_t head = m_stack.head.load(std::memory_order_relaxed);
+            uint64_t newHead;
+            do
+            {
+                links[indices[count-1u]].store(static_cast<uint32_t>(head),std::memory_order_relaxed);
+                newHead = (((head>>32ull)+1ull)<<32ull)|indices[0];
+            } while (!m_stack.head.compare_exchange_weak(head,newHead,std::memory_order_release,std::memory_order_relaxed));
+        }
+
+        template<typename AlignmentGetter>
+        inline void multi_alloc_addr_impl(uint32_t count, size_type* outAddresses, const size_type* bytes, AlignmentGetter&& getAlignment) noexcept
+        {
+            SMagazine* magazine = tryLockMagazine();
+            for (uint32_t i=0u; i<count; i++)
+            {
+                if (outAddresses[i]!=invalid_address)
+                    continue;
+                const size_type alignment = getAlignment(i);
+                if ((blockSize%alignment)!=0u || bytes[i]==0u || bytes[i]>blockSize)
+                    continue;
+
+                uint32_t index = InvalidIndex;
+                if (magazine)
+                {
+                    uint32_t fill = magazine->count.load(std::memory_order_relaxed);
+                    if (fill==0u)
+                        fill = pop(magazine->entries,MagazineSize/2u);
+                    if (fill)
+                        index = magazine->entries[--fill];
+                    magazine->count.store(fill,std::memory_order_relaxed);
+                }
+                else
+                    pop(&index,1u);
+                // stack ran dry, the free blocks might be sitting in other threads' magazines, which can't be waited on while holding our own
+                if (index==InvalidIndex)
+                {
+                    if (magazine)
+                    {
+                        magazine->lock.clear(std::memory_order_release);
+                        magazine = nullptr;
+                    }
+                    index = steal();
+                }
+                if (index==InvalidIndex)
+                    break;
+                outAddresses[i] = size_type(index)*blockSize+base_t::combinedOffset;
+            }
+            if (magazine)
+                magazine->lock.clear(std::memory_order_release);
+        }
+        //! Rescans the magazines until one yields a block or all of them have been seen idle and empty, busy ones might be mid refill or spill.
+        //! The caller mustn't hold a magazine, otherwise two threads stealing at once could wait on each other forever.
+        inline uint32_t steal() noexcept
+        {
+            while (true)
+            {
+                bool settled = true;
+                for (auto& magazine : m_magazines)
+                {
+                    // the lock gets checked first, an idle magazine's count is final
+                    if (!magazine.lock.test(std::memory_order_acquire) && magazine.count.load(std::memory_order_relaxed)==0u)
+                        continue;
+                    if (magazine.lock.test_and_set(std::memory_order_acquire))
+                    {
+                        settled = false;
+                        continue;
+                    }
+                    uint32_t index = InvalidIndex;
+                    if (uint32_t fill=magazine.count.load(std::memory_order_relaxed); fill)
+                    {
+                        index = magazine.entries[--fill];
+                        magazine.count.store(fill,std::memory_order_relaxed);
+                    }
+                    magazine.lock.clear(std::memory_order_release);
+                    if (index!=InvalidIndex)
+                        return index;
+                }
+                // the busy ones might have spilled in the meantime
+                uint32_t index = InvalidIndex;
+                if (pop(&index,1u))
+                    return index;
+                if (settled)
+                    return InvalidIndex;
+                std::this_thread::yield();
+            }
+        }
+
+        //! Not thread-safe, calls `f` with every free block index from the magazines and stack of `alloc`
+        template<typename F>
+        static inline void forEachFree(const LockFreePoolAddressAllocator& alloc, F&& f) noexcept
+        {
+            for (const auto& magazine : alloc.m_magazines)
+            {
+                const uint32_t fill = magazine.count.load(std::memory_order_relaxed);
+                std::for_each_n(magazine.entries,fill,f);
+            }
+            const auto* const links = alloc.getLinks();
+            for (uint32_t index=static_cast<uint32_t>(alloc.m_stack.head.load(std::memory_order_relaxed)); index!=InvalidIndex; index=links[index].load(std::memory_order_relaxed))
+                f(index);
+        }
+
+        inline void copyState(const LockFreePoolAddressAllocator& other, _size_type newBuffSz)
+        {
+            #ifdef _NBL_DEBUG
+                assert(base_t::checkResize(newBuffSz,base_t::alignOffset));
+            #endif // _NBL_DEBUG
+            assert(blockCount<InvalidIndex);
+
+            for (auto& magazine : m_magazines)
+                magazine.count.store(0u,std::memory_order_relaxed);
+            auto* const links = getLinks();
+            for (uint32_t i=0u; i<blockCount; i++)
+                std::construct_at(links+i,InvalidIndex);
+            // rebuild a single stack out of everything free, new blocks go to the bottom of the stack same as in `PoolAddressAllocator`
+            uint32_t head = InvalidIndex;
+            uint32_t tail = InvalidIndex;
+            size_type freeCount = 0u;
+            auto append = [&](const uint32_t index)->void
+            {
+                // check in case of shrink
+                if (index>=blockCount)
+                    return;
+                if (tail!=InvalidIndex)
+                    links[tail].store(index,std::memory_order_relaxed);
+                else
+                    head = index;
+                tail = index;
+                freeCount++;
+            };
+            forEachFree(other,append);
+            for (uint32_t index=other.blockCount; index<blockCount; index++)
+                append(index);
+            if (tail!=InvalidIndex)
+                links[tail].store(InvalidIndex,std::memory_order_relaxed);
+            m_stack.head.store(head,std::memory_order_relaxed);
+            m_stack.size.store(freeCount,std::memory_order_relaxed);
+        }
+
+        /**
+        * @brief Invalidates only fields from this class extension
+        */
+        void invalidateLocal()
+        {
+            blockCount = invalid_address;
+            blockSize = invalid_address;
+            m_stack.head.store(uint64_t(InvalidIndex),std::memory_order_relaxed);
+            m_stack.size.store(0u,std::memory_order_relaxed);
+            for (auto& magazine : m_magazines)
+                magazine.count.store(0u,std::memory_order_relaxed);
+        }
+
+        /**
+        * @brief Invalidates all fields
+        */
+        void invalidate()
+        {
+            base_t::invalidate();
+            invalidateLocal();
+        }
+
+        size_type   blockCount;
+        size_type   blockSize;
+        SStack      m_stack;
+        SMagazine   m_magazines[MagazineCount];
+};
+
+// aliases, no MT adaptor needed
+template<typename size_type>
+using LockFreePoolAddressAllocatorST = LockFreePoolAddressAllocator<size_type>;
+template<typename size_type>
+using LockFreePoolAddressAllocatorMT = LockFreePoolAddressAllocator<size_type>;
+
+}
+#endif
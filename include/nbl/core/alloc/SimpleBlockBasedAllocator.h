@@ -14,6 +14,7 @@
 
 #include <memory>
 #include <mutex>
+#include <span>
 
 
 namespace nbl::core
@@ -193,6 +194,15 @@ class BlockBasedAllocatorBase
 template<class AddressAllocator, typename HandleValue>
 class SimpleBlockBasedAllocator;
 
+// The allocated part of a block, for serialization
+template<typename HandleValue, typename size_type>
+struct SAllocatorBlockImage
+{
+	HandleValue id;
+	size_type size;
+	const uint8_t* data;
+};
+
 //! void* makes it a regular allocator, but one needs to perform a binary search for the block in a map of live blocks when deallocating
 //! We could try to allocate the blocks with alignments so massive that we could take the pointer MSB directly, but unsure about OS guarantees
 template<class AddressAllocator>
@@ -472,6 +482,72 @@ class SimpleBlockBasedAllocator<AddressAllocator,HandleValue> final : protected
 			}
 		}
 
+		//! Serialization, with a linear address allocator all of a block's allocations lie within `[0,size)` and handles are just block IDs
+		//! and offsets, so restoring the blocks under their old IDs keeps every handle into them valid without any fixups.
+		constexpr static inline bool HasLinearBlocks = std::is_same_v<AddressAllocator,LinearAddressAllocator<size_type>>;
+		using SBlockImage = SAllocatorBlockImage<HandleValue,size_type>;
+		using base_t::getBlockCreationParams;
+		template<typename F> requires HasLinearBlocks
+		inline void visitBlocks(F&& visit) const
+		{
+			for (const auto& entry : m_blocks)
+				visit(SBlockImage{.id=entry.first,.size=addr_alloc_traits::get_allocated_size(entry.second->getAllocator()),.data=entry.second->data(base_t::m_blockCreationParams)});
+		}
+		// Deallocates everything and recreates the blocks with their old IDs and contents, no constructors get run. Leaves the allocator reset on failure.
+		inline bool restoreBlocks(const std::span<const SBlockImage> images) requires HasLinearBlocks
+		{
+			reset();
+			HandleValue maxID = 0;
+			for (const auto& image : images)
+			{
+				if (image.size>base_t::m_blockCreationParams.blockSize || image.size && !image.data)
+					return false;
+				maxID = std::max<HandleValue>(maxID,image.id);
+			}
+			// a freshly reset pool allocator hands out the IDs in increasing order, so take all of them up to the largest we need
+			core::vector<block_id_t> unused;
+			for (auto id=HandleValue(m_blocks.size()); id<=maxID; id++)
+			{
+				const auto newID = m_blockIndexAlloc.alloc_addr(1,1);
+				unused.push_back(newID);
+				if (newID!=id)
+				{
+					reset();
+					return false;
+				}
+			}
+			for (const auto& image : images)
+			{
+				auto found = m_blocks.find(image.id);
+				if (found==m_blocks.end())
+					found = m_blocks.insert({image.id,base_t::createBlock()}).first;
+				if (image.size)
+				{
+					// fresh block, so a linear allocation lands at the start, anything else means a duplicate image
+					if (found->second->alloc(image.size,1)!=0u)
+					{
+						reset();
+						return false;
+					}
+					memcpy(found->second->data(base_t::m_blockCreationParams),image.data,image.size);
+				}
+			}
+			for (const auto id : unused)
+			if (m_blocks.find(id)==m_blocks.end())
+				m_blockIndexAlloc.free_addr(id,1);
+			return true;
+		}
+		// whether `[h,h+bytes)` lies within the allocated part of a block, for validating restored handles
+		inline bool isAllocated(const typed_pointer_type<const void> h, const size_type bytes) const requires HasLinearBlocks
+		{
+			if (!h)
+				return false;
+			const auto found = m_blocks.find(getBlockIndex(h));
+			if (found==m_blocks.end())
+				return false;
+			return getOffsetInBlock(h)+bytes<=addr_alloc_traits::get_allocated_size(found->second->getAllocator());
+		}
+
     private:
 		inline HandleValue getOffsetInBlock(const typed_pointer_type<const void> h) const {return h.value&m_loAddrMask;}
 		inline block_t* getBlock(const typed_pointer_type<const void> h) {return m_blocks.find(getBlockIndex(h))->second;}
@@ -542,6 +618,29 @@ class SimpleBlockBasedAllocatorMT final
 			m_lock.unlock();
 		}
 
+		//
+		using block_image_type = SAllocatorBlockImage<typename Composed::handle_value_type,size_type>;
+		inline auto getBlockCreationParams() const {return m_composed.getBlockCreationParams();}
+		template<typename F>
+		inline void visitBlocks(F&& visit) const
+		{
+			auto& lock = const_cast<RecursiveLockable&>(m_lock);
+			lock.lock();
+			m_composed.visitBlocks(std::forward<F>(visit));
+			lock.unlock();
+		}
+		inline bool restoreBlocks(const std::span<const block_image_type> images)
+		{
+			m_lock.lock();
+			const bool retval = m_composed.restoreBlocks(images);
+			m_lock.unlock();
+			return retval;
+		}
+		inline bool isAllocated(const typed_pointer_type<const void> h, const size_type bytes) const
+		{
+			return m_composed.isAllocated(h,bytes);
+		}
+
 		//! Extra == Use WITH EXTREME CAUTION
 		inline RecursiveLockable& get_lock() noexcept
 		{
@@ -0,0 +1,605 @@
+// Copyright (C) 2018-2026 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_CORE_TLSF_ADDRESS_ALLOCATOR_H_INCLUDED_
+#define _NBL_CORE_TLSF_ADDRESS_ALLOCATOR_H_INCLUDED_
+
+
+#include "BuildConfigOptions.h"
+
+#include "nbl/core/alloc/AddressAllocatorBase.h"
+
+#include <atomic>
+#include <thread>
+
+
+namespace nbl::core
+{
+
+//! Two Level Segregated Fit (Masmano et al. 2004), O(1) allocation and free with fragmentation from size class rounding bounded by `1/SecondLevelCount`.
+//! Free lists are indexed by a power of two (first level) and a linear subdivision of it (second level), non-empty lists are tracked in bitmaps so
+//! finding a list with a large enough block is two bit scans. Free blocks always get coalesced with their free neighbours on `free_addr`.
+//! Like all our address allocators it never touches the memory it hands out, the boundary tags and free list links live in the reserved space,
+//! one entry per granule of `minBlockSz` bytes (which needs to be a Power of Two).
+template<typename _size_type>
+class TLSFAddressAllocator : public AddressAllocatorBase<TLSFAddressAllocator<_size_type>,_size_type>
+{
+    private:
+        using Base = AddressAllocatorBase<TLSFAddressAllocator<_size_type>,_size_type>;
+
+    public:
+        _NBL_DECLARE_ADDRESS_ALLOCATOR_TYPEDEFS(_size_type);
+
+        static constexpr inline bool supportsNullBuffer = true;
+
+        static constexpr inline uint32_t SecondLevelLog2 = 4u;
+        static constexpr inline uint32_t SecondLevelCount = 0x1u<<SecondLevelLog2;
+
+        inline TLSFAddressAllocator() noexcept : bufferSize(invalid_address), freeSize(invalid_address), granuleCount(invalid_address), granuleLog2(invalid_address), firstLevelCount(0u) {}
+
+        virtual ~TLSFAddressAllocator() {}
+
+        using extra_ctor_param_types = type_list<size_type/*Minimum Block Size*/>;
+        // `reservedSpc` cannot be nullptr, get the exact amount of memory needed from the `reserved_size` method below.
+        inline TLSFAddressAllocator(void* reservedSpc, size_type addressOffsetToApply, size_type alignOffsetNeeded, size_type maxAllocatableAlignment, size_type bufSz, size_type minBlockSz) noexcept :
+            Base(reservedSpc,addressOffsetToApply,alignOffsetNeeded,maxAllocatableAlignment)
+        {
+            assert(core::isPoT(minBlockSz) && bufSz>=Base::alignOffset+minBlockSz);
+            init(bufSz-Base::alignOffset,hlsl::findMSB(minBlockSz));
+            reset();
+        }
+
+        //! When resizing we require that the copying of data buffer has already been handled by the user of the address allocator
+        template<typename... Args>
+        inline TLSFAddressAllocator(size_type newBuffSz, const TLSFAddressAllocator& other, void* newReservedSpc, Args&&... args) noexcept :
+            Base(other,newReservedSpc,std::forward<Args>(args)...)
+        {
+            init(newBuffSz-Base::alignOffset,other.granuleLog2);
+            copyState(other);
+        }
+        template<typename... Args>
+        inline TLSFAddressAllocator(size_type newBuffSz, TLSFAddressAllocator&& other, void* newReservedSpc, Args&&... args) noexcept :
+            Base(other,newReservedSpc,std::forward<Args>(args)...)
+        {
+            init(newBuffSz-Base::alignOffset,other.granuleLog2);
+            copyState(other);
+            other.invalidate();
+        }
+
+        inline TLSFAddressAllocator& operator=(TLSFAddressAllocator&& other)
+        {
+            Base::operator=(std::move(other));
+            bufferSize = other.bufferSize;
+            freeSize = other.freeSize;
+            granuleCount = other.granuleCount;
+            granuleLog2 = other.granuleLog2;
+            firstLevelCount = other.firstLevelCount;
+            firstLevelBitmap = other.firstLevelBitmap;
+            std::copy_n(other.secondLevelBitmaps,MaxFirstLevels,secondLevelBitmaps);
+            other.invalidateLocal();
+            return *this;
+        }
+
+        //! `hint` is ignored, non-PoT alignments are not supported
+        inline size_type        alloc_addr(size_type bytes, size_type alignment, size_type hint=0ull) noexcept
+        {
+            if (alignment>Base::maxRequestableAlignment || bytes==0u || bytes>bufferSize)
+                return invalid_address;
+
+            const size_type count = toGranules(bytes);
+            // alignments above a granule are satisfied by trimming the front of the block we find, so it needs to fit the worst case
+            const size_type alignGranules = alignment>>granuleLog2;
+            const size_type search = count+(alignGranules>1u ? (alignGranules-1u):0u);
+            if (search>granuleCount)
+                return invalid_address;
+            const size_type start = findFreeBlock(search);
+            if (start==invalid_address)
+                return invalid_address;
+            const size_type blockCount = getGranule(start).tag&~FreeBit;
+            removeFreeBlock(start,blockCount);
+
+            size_type allocStart = start;
+            if (alignGranules>1u)
+                allocStart = (start+alignGranules-1u)&~(alignGranules-1u);
+            // the neighbours of a free block are never free, so the leftovers don't need coalescing
+            if (allocStart!=start)
+                insertFreeBlock(start,allocStart-start);
+            const size_type end = start+blockCount;
+            if (allocStart+count!=end)
+                insertFreeBlock(allocStart+count,end-allocStart-count);
+            writeTags(allocStart,count,0u);
+
+            return (allocStart<<granuleLog2)+Base::combinedOffset;
+        }
+
+        inline void             free_addr(size_type addr, size_type bytes) noexcept
+        {
+            if (bytes==0u)
+                return;
+            size_type count = toGranules(bytes);
+#ifdef _NBL_DEBUG
+            // address must have had combinedOffset already applied to it, and allocation must not be outside the buffer
+            assert(addr>=Base::combinedOffset && ((addr-Base::combinedOffset)&((size_type(1u)<<granuleLog2)-1u))==0u);
+#endif // _NBL_DEBUG
+            size_type start = (addr-Base::combinedOffset)>>granuleLog2;
+#ifdef _NBL_DEBUG
+            // wrong size passed or a double free
+            assert(start+count<=granuleCount && getGranule(start).tag==count);
+#endif // _NBL_DEBUG
+            const size_type end = start+count;
+            if (end<granuleCount)
+            {
+                const size_type rightTag = getGranule(end).tag;
+                if (rightTag&FreeBit)
+                {
+                    removeFreeBlock(end,rightTag&~FreeBit);
+                    count += rightTag&~FreeBit;
+                }
+            }
+            if (start)
+            {
+                const size_type leftTag = getGranule(start-1u).tag;
+                if (leftTag&FreeBit)
+                {
+                    start -= leftTag&~FreeBit;
+                    removeFreeBlock(start,leftTag&~FreeBit);
+                    count += leftTag&~FreeBit;
+                }
+            }
+            insertFreeBlock(start,count);
+        }
+
+        inline void             reset()
+        {
+            clearFreeLists();
+            if (granuleCount)
+                insertFreeBlock(0u,granuleCount);
+        }
+
+        //! Conservative estimate, max_size() gives largest size we are sure to be able to allocate
+        inline size_type        max_size() const noexcept
+        {
+            if (!firstLevelBitmap)
+                return 0u;
+            const uint32_t fl = hlsl::findMSB(firstLevelBitmap);
+            const uint32_t sl = hlsl::findMSB(secondLevelBitmaps[fl]);
+            // smallest block the biggest non-empty list could have
+            size_type retval = fl ? (size_type(SecondLevelCount|sl)<<(fl-1u)):size_type(sl);
+            const size_type alignGranules = Base::maxRequestableAlignment>>granuleLog2;
+            if (alignGranules>1u)
+                retval = retval>=alignGranules ? (retval-alignGranules+1u):0u;
+            return retval<<granuleLog2;
+        }
+
+        //! Most allocators do not support e.g. 1-byte allocations
+        inline size_type        min_size() const noexcept
+        {
+            return size_type(1u)<<granuleLog2;
+        }
+
+        inline size_type        safe_shrink_size(size_type sizeBound, size_type newBuffAlignmentWeCanGuarantee=1u) const noexcept
+        {
+            size_type retval = bufferSize;
+            if (sizeBound>=retval)
+                return Base::safe_shrink_size(sizeBound,newBuffAlignmentWeCanGuarantee);
+
+            // free blocks are always coalesced, so only the last one can end the buffer
+            if (granuleCount)
+            {
+                const size_type lastTag = getGranule(granuleCount-1u).tag;
+                if (lastTag&FreeBit)
+                    retval = (granuleCount-(lastTag&~FreeBit))<<granuleLog2;
+            }
+            return Base::safe_shrink_size(std::max(retval,sizeBound),newBuffAlignmentWeCanGuarantee);
+        }
+
+
+        static inline size_type reserved_size(size_type maxAlignment, size_type bufSz, size_type minBlockSz) noexcept
+        {
+            const size_type maxGranules = bufSz/minBlockSz;
+            return computeFirstLevelCount(maxGranules)*SecondLevelCount*sizeof(size_type)+maxGranules*sizeof(SGranule);
+        }
+        static inline size_type reserved_size(size_type bufSz, const TLSFAddressAllocator<_size_type>& other) noexcept
+        {
+            return reserved_size(other.maxRequestableAlignment,bufSz,other.min_size());
+        }
+
+        inline size_type        get_free_size() const noexcept
+        {
+            return freeSize;
+        }
+        inline size_type        get_allocated_size() const noexcept
+        {
+            return (granuleCount<<granuleLog2)-freeSize;
+        }
+        inline size_type        get_total_size() const noexcept
+        {
+            return bufferSize+Base::alignOffset;
+        }
+
+    protected:
+        // boundary tag of the block starting or ending at the granule, free list links only mean something at the start of a free block
+        struct SGranule
+        {
+            size_type tag;
+            size_type prevFree;
+            size_type nextFree;
+        };
+        static constexpr inline size_type FreeBit = size_type(1u)<<(sizeof(size_type)*8u-1u);
+        static constexpr inline uint32_t MaxFirstLevels = sizeof(size_type)*8u;
+
+        static inline uint32_t computeFirstLevelCount(const size_type granules) noexcept
+        {
+            return granules<SecondLevelCount ? 1u:(hlsl::findMSB(granules)-SecondLevelLog2+2u);
+        }
+        // sizes below `SecondLevelCount` granules get one list each, above that every power of two gets split into `SecondLevelCount` lists
+        static inline void mapping(const size_type granules, uint32_t& fl, uint32_t& sl) noexcept
+        {
+            if (granules<SecondLevelCount)
+            {
+                fl = 0u;
+                sl = static_cast<uint32_t>(granules);
+                return;
+            }
+            const uint32_t msb = hlsl::findMSB(granules);
+            fl = msb-SecondLevelLog2+1u;
+            sl = static_cast<uint32_t>(granules>>(msb-SecondLevelLog2))^SecondLevelCount;
+        }
+
+        //! returns the first granule of a free block of at least `granules`, or `invalid_address`
+        inline size_type findFreeBlock(const size_type granules) noexcept
+        {
+            uint32_t fl, sl;
+            // round up to the next size class, so that any block in the list we end up in is large enough
+            const size_type rounded = granules<SecondLevelCount ? granules:(granules+(size_type(1u)<<(hlsl::findMSB(granules)-SecondLevelLog2))-1u);
+            mapping(rounded,fl,sl);
+            uint32_t slMap = fl<firstLevelCount ? (secondLevelBitmaps[fl]&(~0u<<sl)):0u;
+            if (!slMap)
+            {
+                const uint64_t flMap = fl+1u<MaxFirstLevels ? (firstLevelBitmap&(~0ull<<(fl+1u))):0ull;
+                if (!flMap)
+                {
+                    // nothing in the larger classes, but the first block in the list of our own size class might still fit
+                    mapping(granules,fl,sl);
+                    const size_type head = getHead(fl,sl);
+                    if (head!=invalid_address && (getGranule(head).tag&~FreeBit)>=granules)
+                        return head;
+                    return invalid_address;
+                }
+                fl = hlsl::findLSB(flMap);
+                slMap = secondLevelBitmaps[fl];
+            }
+            return getHead(fl,hlsl::findLSB(slMap));
+        }
+
+        inline size_type toGranules(const size_type bytes) const noexcept {return ((bytes-1u)>>granuleLog2)+1u;}
+
+        inline size_type& getHead(const uint32_t fl, const uint32_t sl) {return reinterpret_cast<size_type*>(Base::reservedSpace)[fl*SecondLevelCount+sl];}
+        inline SGranule& getGranule(const size_type ix)
+        {
+            return reinterpret_cast<SGranule*>(reinterpret_cast<size_type*>(Base::reservedSpace)+firstLevelCount*SecondLevelCount)[ix];
+        }
+        inline const SGranule& getGranule(const size_type ix) const
+        {
+            return reinterpret_cast<const SGranule*>(reinterpret_cast<const size_type*>(Base::reservedSpace)+firstLevelCount*SecondLevelCount)[ix];
+        }
+
+        inline void init(const size_type bufSz, const size_type _granuleLog2) noexcept
+        {
+            bufferSize = bufSz;
+            granuleLog2 = _granuleLog2;
+            granuleCount = bufferSize>>granuleLog2;
+            firstLevelCount = computeFirstLevelCount(granuleCount);
+            assert(firstLevelCount<=MaxFirstLevels && granuleCount<FreeBit);
+        }
+
+        inline void clearFreeLists() noexcept
+        {
+            freeSize = 0u;
+            firstLevelBitmap = 0ull;
+            std::fill_n(secondLevelBitmaps,MaxFirstLevels,0u);
+            std::fill_n(&getHead(0u,0u),firstLevelCount*SecondLevelCount,invalid_address);
+        }
+
+        inline void writeTags(const size_type start, const size_type count, const size_type freeBit) noexcept
+        {
+            getGranule(start).tag = count|freeBit;
+            getGranule(start+count-1u).tag = count|freeBit;
+        }
+
+        inline void insertFreeBlock(const size_type start, const size_type count) noexcept
+        {
+            writeTags(start,count,FreeBit);
+            uint32_t fl, sl;
+            mapping(count,fl,sl);
+            auto& head = getHead(fl,sl);
+            auto& granule = getGranule(start);
+            granule.prevFree = invalid_address;
+            granule.nextFree = head;
+            if (head!=invalid_address)
+                getGranule(head).prevFree = start;
+            head = start;
+            firstLevelBitmap |= 0x1ull<<fl;
+            secondLevelBitmaps[fl] |= 0x1u<<sl;
+            freeSize += count<<granuleLog2;
+        }
+
+        inline void removeFreeBlock(const size_type start, const size_type count) noexcept
+        {
+            uint32_t fl, sl;
+            mapping(count,fl,sl);
+            const auto& granule = getGranule(start);
+            if (granule.nextFree!=invalid_address)
+                getGranule(granule.nextFree).prevFree = granule.prevFree;
+            if (granule.prevFree!=invalid_address)
+                getGranule(granule.prevFree).nextFree = granule.nextFree;
+            else
+            {
+                getHead(fl,sl) = granule.nextFree;
+                if (granule.nextFree==invalid_address)
+                {
+                    secondLevelBitmaps[fl] &= ~(0x1u<<sl);
+                    if (!secondLevelBitmaps[fl])
+                        firstLevelBitmap &= ~(0x1ull<<fl);
+                }
+            }
+            freeSize -= count<<granuleLog2;
+        }
+
+        //! Walks the blocks of `other` via their boundary tags, blocks past the end of a shrunk buffer have to be free
+        inline void copyState(const TLSFAddressAllocator& other) noexcept
+        {
+            clearFreeLists();
+            size_type lastFreeEnd = invalid_address;
+            size_type lastFreeStart = invalid_address;
+            for (size_type start=0u; start<other.granuleCount && start<granuleCount;)
+            {
+                const size_type tag = other.getGranule(start).tag;
+                const size_type count = tag&~FreeBit;
+                if (tag&FreeBit)
+                {
+                    lastFreeStart = start;
+                    lastFreeEnd = std::min(start+count,granuleCount);
+                    insertFreeBlock(start,lastFreeEnd-start);
+                }
+                else
+                {
+                    assert(start+count<=granuleCount);
+                    writeTags(start,count,0u);
+                }
+                start += count;
+            }
+            if (granuleCount>other.granuleCount)
+            {
+                size_type start = other.granuleCount;
+                if (lastFreeEnd==other.granuleCount)
+                {
+                    removeFreeBlock(lastFreeStart,lastFreeEnd-lastFreeStart);
+                    start = lastFreeStart;
+                }
+                insertFreeBlock(start,granuleCount-start);
+            }
+        }
+
+        inline void invalidateLocal()
+        {
+            bufferSize = invalid_address;
+            freeSize = invalid_address;
+            granuleCount = invalid_address;
+            granuleLog2 = invalid_address;
+            firstLevelCount = 0u;
+        }
+        inline void invalidate()
+        {
+            Base::invalidate();
+            invalidateLocal();
+        }
+
+        size_type   bufferSize;
+        size_type   freeSize;
+        size_type   granuleCount;
+        size_type   granuleLog2;
+        uint32_t    firstLevelCount;
+        uint64_t    firstLevelBitmap = 0ull;
+        uint32_t    secondLevelBitmaps[MaxFirstLevels] = {};
+};
+
+}
+
+#include "nbl/core/alloc/AddressAllocatorConcurrencyAdaptors.h"
+
+namespace nbl::core
+{
+// aliases
+template<typename size_type>
+using TLSFAddressAllocatorST = TLSFAddressAllocator<size_type>;
+
+//! Thread-safe TLSF with a per-thread caching front end. Small blocks freed by a thread get parked in that thread's cache slot and are handed
+//! straight back to its next allocations of the same granule count (if the alignment fits) without taking the allocator's lock.
+//! Slots are picked by hashing the thread id, threads which collide on a slot fall back to the locked allocator instead of waiting.
+//! Parked blocks count as allocated and don't coalesce, `flush_thread_caches` gives them back and `reset` forgets them.
+template<typename size_type, class RecursiveLockable, uint32_t SlotCount=16u>
+class TLSFAddressAllocatorMT : public AddressAllocatorBasicConcurrencyAdaptor<TLSFAddressAllocator<size_type>,RecursiveLockable>
+{
+        using Base = AddressAllocatorBasicConcurrencyAdaptor<TLSFAddressAllocator<size_type>,RecursiveLockable>;
+        static_assert(core::isPoT(SlotCount),"SlotCount must be a Power of Two!");
+
+    public:
+        // every block size up to this many granules has its own bin in every slot
+        static constexpr inline uint32_t CachedMaxGranules = 8u;
+        static constexpr inline uint32_t CacheBinDepth = 16u;
+
+        using Base::Base;
+        using Base::invalid_address;
+
+        //! Resizing only carries over the allocator's own state, the blocks parked in `other`'s slots get freed into the new allocator.
+        //! As with any other resize, nothing may be using `other` at the same time.
+        template<typename... Args>
+        inline TLSFAddressAllocatorMT(size_type newBuffSz, const TLSFAddressAllocatorMT& other, void* newReservedSpc, Args&&... args) noexcept :
+            Base(newBuffSz,other.getBaseRef(),newReservedSpc,std::forward<Args>(args)...)
+        {
+            const size_type oldOffset = other.getBaseRef().get_combined_offset();
+            const size_type newOffset = Base::getBaseRef().get_combined_offset();
+            const size_type granule = getGranuleSize();
+            for (const auto& slot : other.m_slots)
+            for (uint32_t g=0u; g<CachedMaxGranules; g++)
+            {
+                size_type addr[CacheBinDepth];
+                size_type bytes[CacheBinDepth];
+                for (uint8_t i=0u; i<slot.fill[g]; i++)
+                    addr[i] = slot.bins[g][i]-oldOffset+newOffset;
+                std::fill_n(bytes,slot.fill[g],size_type(g+1u)*granule);
+                Base::multi_free_addr(slot.fill[g],addr,bytes);
+            }
+        }
+        //! The moved from allocator gets its slots flushed before its state is taken
+        template<typename... Args>
+        inline TLSFAddressAllocatorMT(size_type newBuffSz, TLSFAddressAllocatorMT&& other, void* newReservedSpc, Args&&... args) noexcept :
+            Base(newBuffSz,std::move(other.flushedBaseRef()),newReservedSpc,std::forward<Args>(args)...) {}
+
+        inline void         multi_alloc_addr(uint32_t count, size_type* outAddresses, const size_type* bytes, const size_type* alignment, const size_type* hint=nullptr) noexcept
+        {
+            if (!allocFromCache(count,outAddresses,bytes,[alignment](const uint32_t i)->size_type{return alignment[i];}))
+                Base::multi_alloc_addr(count,outAddresses,bytes,alignment,hint);
+        }
+        inline void         multi_alloc_addr(uint32_t count, size_type* outAddresses, const size_type* bytes, const size_type alignment, const size_type* hint=nullptr) noexcept
+        {
+            if (!allocFromCache(count,outAddresses,bytes,[alignment](const uint32_t i)->size_type{return alignment;}))
+                Base::multi_alloc_addr(count,outAddresses,bytes,alignment,hint);
+        }
+
+        inline void         multi_free_addr(uint32_t count, const size_type* addr, const size_type* bytes) noexcept
+        {
+            SSlot* const slot = tryLockSlot();
+            constexpr uint32_t BatchSize = 64u;
+            size_type batchAddr[BatchSize];
+            size_type batchBytes[BatchSize];
+            uint32_t batchCount = 0u;
+            for (uint32_t i=0u; i<count; i++)
+            {
+                if (addr[i]==invalid_address || (slot && slot->push(addr[i],toGranules(bytes[i]))))
+                    continue;
+                batchAddr[batchCount] = addr[i];
+                batchBytes[batchCount++] = bytes[i];
+                if (batchCount==BatchSize)
+                {
+                    Base::multi_free_addr(batchCount,batchAddr,batchBytes);
+                    batchCount = 0u;
+                }
+            }
+            if (slot)
+                slot->lock.clear(std::memory_order_release);
+            if (batchCount)
+                Base::multi_free_addr(batchCount,batchAddr,batchBytes);
+        }
+
+        //! Returns every parked block to the allocator, call before relying on `max_size`, `safe_shrink_size` or the free size
+        inline void         flush_thread_caches() noexcept
+        {
+            for (auto& slot : m_slots)
+            {
+                slot.lockSpin();
+                for (uint32_t g=0u; g<CachedMaxGranules; g++)
+                {
+                    size_type bytes[CacheBinDepth];
+                    std::fill_n(bytes,slot.fill[g],size_type(g+1u)*getGranuleSize());
+                    Base::multi_free_addr(slot.fill[g],slot.bins[g],bytes);
+                    slot.fill[g] = 0u;
+                }
+                slot.lock.clear(std::memory_order_release);
+            }
+        }
+
+        inline void         reset() noexcept
+        {
+            for (auto& slot : m_slots)
+                slot.lockSpin();
+            for (auto& slot : m_slots)
+                std::fill_n(slot.fill,CachedMaxGranules,0u);
+            Base::reset();
+            for (auto& slot : m_slots)
+                slot.lock.clear(std::memory_order_release);
+        }
+
+    private:
+        inline TLSFAddressAllocator<size_type>& flushedBaseRef() noexcept
+        {
+            flush_thread_caches();
+            return Base::getBaseRef();
+        }
+
+        struct alignas(64) SSlot
+        {
+            inline void lockSpin()
+            {
+                while (lock.test_and_set(std::memory_order_acquire))
+                    std::this_thread::yield();
+            }
+            inline bool push(const size_type addr, const size_type granules)
+            {
+                if (granules>CachedMaxGranules || fill[granules-1u]==CacheBinDepth)
+                    return false;
+                bins[granules-1u][fill[granules-1u]++] = addr;
+                return true;
+            }
+
+            std::atomic_flag lock = ATOMIC_FLAG_INIT;
+            uint8_t fill[CachedMaxGranules] = {};
+            size_type bins[CachedMaxGranules][CacheBinDepth];
+        };
+
+        inline SSlot* tryLockSlot() noexcept
+        {
+            SSlot& slot = m_slots[std::hash<std::thread::id>()(std::this_thread::get_id())&(SlotCount-1u)];
+            if (slot.lock.test_and_set(std::memory_order_acquire))
+                return nullptr;
+            return &slot;
+        }
+
+        // the granule size never changes, but asking the allocator would take its lock
+        inline size_type getGranuleSize() noexcept
+        {
+            size_type granule = m_granuleSize.load(std::memory_order_relaxed);
+            if (!granule)
+            {
+                granule = Base::min_size();
+                m_granuleSize.store(granule,std::memory_order_relaxed);
+            }
+            return granule;
+        }
+        inline size_type toGranules(const size_type bytes) noexcept {return bytes ? ((bytes-1u)/getGranuleSize()+1u):0u;}
+
+        //! returns whether all the allocations were served
+        template<typename AlignmentGetter>
+        inline bool allocFromCache(uint32_t count, size_type* outAddresses, const size_type* bytes, AlignmentGetter&& getAlignment) noexcept
+        {
+            SSlot* const slot = tryLockSlot();
+            if (!slot)
+                return false;
+            bool allServed = true;
+            for (uint32_t i=0u; i<count; i++)
+            {
+                if (outAddresses[i]!=invalid_address)
+                    continue;
+                const size_type granules = toGranules(bytes[i]);
+                if (granules && granules<=CachedMaxGranules)
+                {
+                    auto& fill = slot->fill[granules-1u];
+                    if (fill && (slot->bins[granules-1u][fill-1u]&(getAlignment(i)-1u))==0u)
+                    {
+                        outAddresses[i] = slot->bins[granules-1u][--fill];
+                        continue;
+                    }
+                }
+                allServed = false;
+            }
+            slot->lock.clear(std::memory_order_release);
+            return allServed;
+        }
+
+        SSlot m_slots[SlotCount];
+        std::atomic<size_type> m_granuleSize = 0u;
+};
+
+}
+#endif
@@ -8,6 +8,7 @@
 #include "nbl/core/decl/compile_config.h"
 #include "nbl/core/decl/BaseClasses.h"
 #include "nbl/core/alloc/SimpleBlockBasedAllocator.h"
+#include "nbl/core/alloc/ConcurrentBlockBasedAllocator.h"
 
 #include <type_traits>
 
@@ -19,7 +20,8 @@ template<typename C>
 concept MemoryPoolConfig = requires
 {
 //    {C::ThreadSafe} -> std::same_as<bool>; // TODO: how to do it
-    // Multi-thread safe address allocators shouldn't be used in the MemoryPoolConfigs, because the mem pool needs to sync more stuff
+    // Multi-thread safe address allocators shouldn't be used in the MemoryPoolConfigs, because the mem pool needs to sync more stuff,
+    // the exception being lock-free ones (e.g. `LockFreePoolAddressAllocator`) which make a `ThreadSafe` pool lock-free outside of block creation.
     typename C::AddressAllocator; // TODO: check its an Address Allocator, can we check its not MT?
     typename C::HandleValue;
 };
@@ -34,7 +36,11 @@ class CMemoryPool final : public Uncopyable
 		template<typename T>
 		using typed_pointer_type = block_allocator_st_type::template typed_pointer_type<T>;
 
-        using block_allocator_type = std::conditional_t<Config::ThreadSafe,SimpleBlockBasedAllocatorMT<block_allocator_st_type,std::recursive_mutex>,block_allocator_st_type>;
+        constexpr static inline bool IsLockFree = Config::ThreadSafe && LockFreeAddressAllocator<addr_allocator_type>;
+        using block_allocator_type = std::conditional_t<Config::ThreadSafe,
+            std::conditional_t<IsLockFree,ConcurrentBlockBasedAllocator<addr_allocator_type,typename Config::HandleValue>,SimpleBlockBasedAllocatorMT<block_allocator_st_type,std::recursive_mutex>>,
+            block_allocator_st_type
+        >;
 
         using creation_params_type = block_allocator_st_type::SCreationParams;
         inline CMemoryPool(creation_params_type&& params) : m_block_alctr(std::move(params)) {}
@@ -108,8 +114,25 @@ class CMemoryPool final : public Uncopyable
             deallocate(h,static_cast<size_type>(sizeof(T)*n));
         }
 
+        //! Serialization, see `SimpleBlockBasedAllocator::restoreBlocks`
+        using block_image_type = SAllocatorBlockImage<typename Config::HandleValue,size_type>;
+        inline size_type getBlockSize() const {return m_block_alctr.getBlockCreationParams().blockSize;}
+        template<typename F>
+        inline void visitBlocks(F&& visit) const
+        {
+            m_block_alctr.visitBlocks(std::forward<F>(visit));
+        }
+        inline bool restoreBlocks(const std::span<const block_image_type> images)
+        {
+            return m_block_alctr.restoreBlocks(images);
+        }
+        inline bool isAllocated(const typed_pointer_type<const void> h, const size_type bytes) const
+        {
+            return m_block_alctr.isAllocated(h,bytes);
+        }
+
         //! Extra == Use WITH EXTREME CAUTION
-        template<bool ThreadSafe=Config::ThreadSafe> requires (ThreadSafe && ThreadSafe==Config::ThreadSafe)
+        template<bool ThreadSafe=Config::ThreadSafe> requires (ThreadSafe && ThreadSafe==Config::ThreadSafe && !IsLockFree)
         inline std::recursive_mutex& get_lock() noexcept
         {
             return m_block_alctr.get_lock();
@@ -7,6 +7,8 @@
 
 #include "nbl/core/containers/CMemoryPool.h"
 
+#include <variant>
+
 
 namespace nbl::core
 {
@@ -83,16 +85,20 @@ class CObjectPool final : public IObjectPoolBase
 		// NOTE: C++26 reflection would allow us to find all the `Handle` and `TypedHandle<U>` in `T` and do actual mark-and-sweep Garbage Collection
 		inline ~CObjectPool()
 		{
-			for (auto& entry : m_allocations)
+			for (auto& shard : m_allocations)
+			for (auto& entry : shard.records)
 				destroy(deref<INonTrivial>(entry.first),entry.second.count,entry.second.stride);
 		}
 		
-		//
+		//! Not thread-safe even if `Config::ThreadSafe`
 		inline void reset()
 		{
-			for (auto& entry : m_allocations)
-				destroy(deref<INonTrivial>(entry.first),entry.second.count,entry.second.stride);
-			m_allocations.clear();
+			for (auto& shard : m_allocations)
+			{
+				for (auto& entry : shard.records)
+					destroy(deref<INonTrivial>(entry.first),entry.second.count,entry.second.stride);
+				shard.records.clear();
+			}
 			m_pool.reset();
 		}
 
@@ -111,7 +117,11 @@ class CObjectPool final : public IObjectPoolBase
 			if constexpr (std::is_base_of_v<INonTrivial,T>)
 			if (check.value)
 			{
-				if (auto found=m_allocations.find(h); found==m_allocations.end())
+				auto& shard = getRecordShard(h);
+				shard.lock();
+				const bool found = shard.records.find(h)!=shard.records.end();
+				shard.unlock();
+				if (!found)
 					return nullptr;
 			}
 			return retval;
@@ -139,8 +149,6 @@ class CObjectPool final : public IObjectPoolBase
         {
 			if (n>>MaxSingleAllocCountLog2)
 				return {};
-			if constexpr (Config::ThreadSafe)
-				m_pool.getLock().lock();
             //
             constexpr size_type a = alignof(T);
 			const size_type size = [&]()->size_type
@@ -163,12 +171,15 @@ class CObjectPool final : public IObjectPoolBase
 			{
 				static_assert((sizeof(T)>>MaxNonTrivialObjectSizeLog2)==0);
 				if (retval)
-					m_allocations[retval] = {.stride=size,.count=n};
+				{
+					auto& shard = getRecordShard(retval);
+					shard.lock();
+					shard.records[retval] = {.stride=size,.count=n};
+					shard.unlock();
+				}
 			}
 			else
 				static_assert(std::is_trivially_constructible_v<T>,"All non-trivially-constructible `T` must inherit from INonTrivial!");
-			if constexpr (Config::ThreadSafe)
-				m_pool.getLock().unlock();
 			// run constructors
 			if constexpr (std::is_base_of_v<INonTrivial,T>)
             if (retval)
@@ -196,27 +207,85 @@ class CObjectPool final : public IObjectPoolBase
         template <typename T> requires (!std::is_array_v<T>) // for now until we have a test
         inline void _delete(const typed_pointer_type<T> h, const size_type n=1)
 		{
-			if constexpr (Config::ThreadSafe)
-				m_pool.getLock().lock();
 			// destroy and get total size
             size_type size = static_cast<size_type>(sizeof(T));
 			if constexpr (std::is_base_of_v<INonTrivial,T>)
 			{
 				// remove from our list of live allocations
-				auto found = m_allocations.find(h);
-				assert(found!=m_allocations.end());
+				auto& shard = getRecordShard(h);
+				shard.lock();
+				auto found = shard.records.find(h);
+				assert(found!=shard.records.end());
 				assert(found->second.count==n);
 				if constexpr (std::is_base_of_v<IVariableSize,T>)
 					size = found->second.stride;
+				shard.records.erase(found);
+				shard.unlock();
 				destroy(deref<INonTrivial>(h),n,size);
-				m_allocations.erase(found);
 			}
 			else
 				static_assert(std::is_trivially_destructible_v<T>,"All non-trivially-destructible `T` must inherit from INonTrivial!");
 			// free the memory
 			m_pool.deallocate(h,size*n);
-			if constexpr (Config::ThreadSafe)
-				m_pool.getLock().unlock();
+		}
+
+		//! Serialization, the pool's memory gets stored as-is block by block, plus the records of live non-trivial allocations
+		using block_image_type = typename mem_pool_type::block_image_type;
+		struct SAllocation
+		{
+			typed_pointer_type<INonTrivial> handle;
+			size_type stride;
+			size_type count;
+		};
+		inline size_type getBlockSize() const {return m_pool.getBlockSize();}
+		inline bool isAllocated(const typename mem_pool_type::template typed_pointer_type<const void> h, const size_type bytes) const {return m_pool.isAllocated(h,bytes);}
+		template<typename F>
+		inline void visitBlocks(F&& visit) const
+		{
+			m_pool.visitBlocks(std::forward<F>(visit));
+		}
+		template<typename F>
+		inline void visitAllocations(F&& visit) const
+		{
+			for (const auto& shard : m_allocations)
+			for (const auto& entry : shard.records)
+				visit(SAllocation{.handle=entry.first,.stride=entry.second.stride,.count=entry.second.count});
+		}
+		// Replaces the whole contents of the pool, no objects are alive in the restored blocks until `revive(pStorage,allocation)` constructs them,
+		// it gets called for every object slot of every allocation and must construct the object in place from the bytes it finds there (copy
+		// them aside first), returning false only when it left nothing alive in the slot. Any failure resets the pool.
+		template<typename F>
+		inline bool restore(const std::span<const block_image_type> blocks, const std::span<const SAllocation> allocations, F&& revive)
+		{
+			reset();
+			if (!m_pool.restoreBlocks(blocks))
+				return false;
+			for (const auto& allocation : allocations)
+			{
+				const auto stride = allocation.stride;
+				const auto count = allocation.count;
+				bool valid = count && (count>>MaxSingleAllocCountLog2)==0 && (stride>>MaxNonTrivialObjectSizeLog2)==0;
+				auto& records = getRecordShard(allocation.handle).records;
+				valid = valid && m_pool.isAllocated(allocation.handle,stride*count) && records.find(allocation.handle)==records.end();
+				size_type revived = 0;
+				if (valid)
+				{
+					auto* const base = reinterpret_cast<uint8_t*>(deref(allocation.handle));
+					for (; revived<count; revived++)
+					if (!revive(static_cast<void*>(base+stride*revived),allocation))
+						break;
+					// objects which got revived in a failed allocation need destroying, the ones already recorded get destroyed by the reset
+					if (revived!=count)
+						destroy(reinterpret_cast<INonTrivial*>(base),revived,stride);
+				}
+				if (revived!=count)
+				{
+					reset();
+					return false;
+				}
+				records[allocation.handle] = {.stride=stride,.count=count};
+			}
+			return true;
 		}
 
     private:
@@ -230,7 +299,37 @@ class CObjectPool final : public IObjectPoolBase
 			size_type count : MaxSingleAllocCountLog2;
 		};
 		using allocation_record_t = core::unordered_map<typed_pointer_type<INonTrivial>,SMetadata>;
-		allocation_record_t m_allocations;
+		// With `Config::ThreadSafe` the memory pool does its own synchronization, we only need to guard the records of live allocations,
+		// they're split into shards by handle so that threads creating and deleting objects rarely wait on each other.
+		constexpr static inline uint32_t RecordShardCountLog2 = Config::ThreadSafe ? 4u:0u;
+		struct alignas(Config::ThreadSafe ? 64:alignof(allocation_record_t)) SRecordShard
+		{
+			inline void lock()
+			{
+				if constexpr (Config::ThreadSafe)
+					mutex.lock();
+			}
+			inline void unlock()
+			{
+				if constexpr (Config::ThreadSafe)
+					mutex.unlock();
+			}
+
+			allocation_record_t records;
+			std::conditional_t<Config::ThreadSafe,std::mutex,std::monostate> mutex;
+		};
+		inline SRecordShard& getRecordShard(const typed_pointer_type<const INonTrivial> h)
+		{
+			if constexpr (RecordShardCountLog2)
+			{
+				// low bits of pointers and handles are mostly alignment, so mix all of them in
+				const uint64_t hash = std::hash<typed_pointer_type<const INonTrivial>>()(h)*0x9E3779B97F4A7C15ull;
+				return m_allocations[hash>>(64u-RecordShardCountLog2)];
+			}
+			else
+				return m_allocations[0];
+		}
+		SRecordShard m_allocations[0x1u<<RecordShardCountLog2];
 };
 
 }
@@ -16,6 +16,8 @@ constexpr dont_grab_t dont_grab{};
 struct dont_drop_t {};
 constexpr dont_drop_t dont_drop{};
 
+class refctd_drop_batch;
+
 // A RAII-like class to help you safeguard against memory leaks.
 // Will automagically drop reference counts when it goes out of scope
 template<class I_REFERENCE_COUNTED>
@@ -24,6 +26,7 @@ class smart_refctd_ptr
 		mutable I_REFERENCE_COUNTED* ptr; // since IReferenceCounted declares the refcount mutable atomic
 
 		template<class U> friend class smart_refctd_ptr;
+		friend class refctd_drop_batch;
 		template<class U, class T> friend smart_refctd_ptr<U> smart_refctd_ptr_static_cast(smart_refctd_ptr<T>&&);
 		template<class U, class T> friend smart_refctd_ptr<U> smart_refctd_ptr_dynamic_cast(smart_refctd_ptr<T>&&);
 
@@ -118,6 +121,94 @@ class smart_refctd_ptr
 };
 static_assert(sizeof(smart_refctd_ptr<IReferenceCounted>) == sizeof(IReferenceCounted*), "smart_refctd_ptr has a memory overhead!");
 
+// A non-owning view of an object someone else keeps alive, for read-only walks over graphs of reference counted objects.
+// Copying and destroying a `smart_refctd_ptr` costs an atomic increment and decrement, this costs nothing.
+template<class I_REFERENCE_COUNTED>
+class borrowed_refctd_ptr
+{
+		I_REFERENCE_COUNTED* ptr;
+
+	public:
+		using pointee = I_REFERENCE_COUNTED;
+		using value_type = I_REFERENCE_COUNTED*;
+
+		constexpr borrowed_refctd_ptr() noexcept : ptr(nullptr) {}
+		constexpr borrowed_refctd_ptr(std::nullptr_t) noexcept : ptr(nullptr) {}
+		template<class U>
+		explicit constexpr borrowed_refctd_ptr(U* _pointer) noexcept : ptr(_pointer) {}
+
+		template<class U>
+		inline borrowed_refctd_ptr(const smart_refctd_ptr<U>& other) noexcept : ptr(other.get()) {}
+		// would dangle as soon as the temporary dies
+		template<class U>
+		borrowed_refctd_ptr(smart_refctd_ptr<U>&& other) = delete;
+		template<class U> requires (!std::is_same_v<U,I_REFERENCE_COUNTED>)
+		inline borrowed_refctd_ptr(const borrowed_refctd_ptr<U>& other) noexcept : ptr(other.get()) {}
+
+		// take a reference of your own, the only time this view touches the reference counter
+		inline smart_refctd_ptr<I_REFERENCE_COUNTED> lock() const { return smart_refctd_ptr<I_REFERENCE_COUNTED>(ptr); }
+
+		inline I_REFERENCE_COUNTED* get() const { return ptr; }
+
+		inline I_REFERENCE_COUNTED* operator->() const { return ptr; }
+
+		inline I_REFERENCE_COUNTED& operator*() const { return *ptr; }
+
+		// conversions
+		inline explicit operator bool() const { return ptr; }
+		inline bool operator!() const { return !ptr; }
+
+		template<class U>
+		inline bool operator==(const borrowed_refctd_ptr<U>& other) const { return ptr == other.get(); }
+		template<class U>
+		inline bool operator!=(const borrowed_refctd_ptr<U>& other) const { return ptr != other.get(); }
+
+		template<class U>
+		inline bool operator<(const borrowed_refctd_ptr<U>& other) const { return ptr < other.get(); }
+};
+static_assert(sizeof(borrowed_refctd_ptr<IReferenceCounted>) == sizeof(IReferenceCounted*), "borrowed_refctd_ptr has a memory overhead!");
+
+// Collects the releases of many smart pointers and applies them together on `flush` (or destruction), all the references
+// to the same object coalesce into a single atomic decrement. Also keeps everything it holds alive until then, which lets you
+// release references in the middle of a traversal which still has raw pointers to the objects on its stack.
+// Not thread-safe, each thread should have its own.
+class refctd_drop_batch final
+{
+	public:
+		inline refctd_drop_batch() = default;
+		refctd_drop_batch(const refctd_drop_batch&) = delete;
+		inline refctd_drop_batch(refctd_drop_batch&&) = default;
+		inline ~refctd_drop_batch() { flush(); }
+
+		refctd_drop_batch& operator=(const refctd_drop_batch&) = delete;
+		inline refctd_drop_batch& operator=(refctd_drop_batch&& other)
+		{
+			flush();
+			m_pending = std::move(other.m_pending);
+			return *this;
+		}
+
+		// steals the reference without touching the counter, leaves `ptr` null
+		template<class U>
+		inline void push(smart_refctd_ptr<U>&& ptr)
+		{
+			if (ptr.ptr)
+				m_pending.push_back(ptr.ptr);
+			ptr.ptr = nullptr;
+		}
+
+		inline size_t size() const { return m_pending.size(); }
+		inline bool empty() const { return m_pending.empty(); }
+
+		inline void reserve(const size_t count) { m_pending.reserve(count); }
+
+		// drops everything collected so far, objects which lose their last reference get deleted
+		void flush();
+
+	private:
+		core::vector<const IReferenceCounted*> m_pending;
+};
+
 
 template< class T, class... Args >
 smart_refctd_ptr<T> make_smart_refctd_ptr(Args&& ... args);
@@ -24,14 +24,18 @@
 #include "nbl/core/alloc/aligned_allocator.h"
 #include "nbl/core/alloc/AllocatorTrivialBases.h"
 #include "nbl/core/alloc/GeneralpurposeAddressAllocator.h"
+#include "nbl/core/alloc/TLSFAddressAllocator.h"
 #include "nbl/core/alloc/IAddressAllocator.h"
 #include "nbl/core/alloc/IAllocator.h"
 #include "nbl/core/alloc/LinearAddressAllocator.h"
+#include "nbl/core/alloc/LockFreeLinearAddressAllocator.h"
 #include "nbl/core/alloc/null_allocator.h"
 #include "nbl/core/alloc/PoolAddressAllocator.h"
+#include "nbl/core/alloc/LockFreePoolAddressAllocator.h"
 #include "nbl/core/alloc/IteratablePoolAddressAllocator.h"
 #include "nbl/core/alloc/StackAddressAllocator.h"
 #include "nbl/core/alloc/SimpleBlockBasedAllocator.h"
+#include "nbl/core/alloc/ConcurrentBlockBasedAllocator.h"
 // algorithm
 #include "nbl/core/algorithm/radix_sort.h"
 #include "nbl/core/algorithm/utility.h"
@@ -8,6 +8,8 @@
 
 #include "nbl/core/decl/smart_refctd_ptr.h"
 
+#include <algorithm>
+
 namespace nbl::core
 {
 
@@ -84,6 +86,19 @@ inline smart_refctd_ptr<I_REFERENCE_COUNTED>& smart_refctd_ptr<I_REFERENCE_COUNT
 }
 
 
+inline void refctd_drop_batch::flush()
+{
+	// sorting puts all references to the same object next to each other
+	std::sort(m_pending.begin(),m_pending.end());
+	for (auto it=m_pending.begin(); it!=m_pending.end();)
+	{
+		const auto runEnd = std::find_if(it,m_pending.end(),[obj=*it](const IReferenceCounted* other)->bool{return other!=obj;});
+		(*it)->drop(static_cast<uint32_t>(runEnd-it));
+		it = runEnd;
+	}
+	m_pending.clear();
+}
+
 
 template< class T, class... Args >
 inline smart_refctd_ptr<T> make_smart_refctd_ptr(Args&& ... args)
@@ -33,6 +33,8 @@ ALIAS_TEMPLATE_FUNCTION(for_each_n, std::for_each_n)
 ALIAS_TEMPLATE_FUNCTION(for_each, std::for_each)
 ALIAS_TEMPLATE_FUNCTION(swap_ranges, std::swap_ranges)
 ALIAS_TEMPLATE_FUNCTION(nth_element, std::nth_element)
+ALIAS_TEMPLATE_FUNCTION(transform, std::transform)
+ALIAS_TEMPLATE_FUNCTION(move, std::move)
 //template <class _ExPo, class _FwdIt, class _Diff, class _Fn>
 //const auto for_each_n = std::for_each_n<_ExPo, _FwdIt, _Diff, _Fn>;
 //
@@ -48,6 +50,8 @@ ALIAS_TEMPLATE_FUNCTION(for_each_n, oneapi::dpl::for_each_n)
 ALIAS_TEMPLATE_FUNCTION(for_each, oneapi::dpl::for_each)
 ALIAS_TEMPLATE_FUNCTION(swap_ranges, oneapi::dpl::swap_ranges)
 ALIAS_TEMPLATE_FUNCTION(nth_element, oneapi::dpl::nth_element)
+ALIAS_TEMPLATE_FUNCTION(transform, oneapi::dpl::transform)
+ALIAS_TEMPLATE_FUNCTION(move, oneapi::dpl::move)
 //template <class _ExPo, class _FwdIt, class _Diff, class _Fn>
 //const auto for_each_n = oneapi::dpl::for_each_n<_ExPo, _FwdIt, _Diff, _Fn>;
 //
@@ -41,6 +41,18 @@ class OwenSampler final : protected SequenceSampler
 
 					return oldsample^cachedFlip[index];
 				}
+				// same as calling `sample` for `[firstSample,firstSample+sampleCount)`, but the sequence is evaluated incrementally, result goes to `out[i*stride]`
+				inline void sample(uint32_t* out, const uint32_t firstSample, const uint32_t sampleCount, const size_t stride=1ull) const
+				{
+					assert(uint64_t(firstSample)+sampleCount<=MAX_SAMPLES);
+					sampler.sample({.out=out,.sampleStride=stride,.firstDim=dimension,.dimCount=1u,.firstSample=firstSample,.sampleCount=sampleCount},false);
+					constexpr uint32_t lastLevelStart = MAX_SAMPLES/2u-1u;
+					for (uint32_t i=0u; i<sampleCount; i++)
+					{
+						uint32_t& value = out[i*stride];
+						value ^= cachedFlip[(value>>(OUT_BITS+1u-MAX_SAMPLES_LOG2))+lastLevelStart];
+					}
+				}
 
 			private:
 				friend class OwenSampler;
@@ -93,6 +105,29 @@ class OwenSampler final : protected SequenceSampler
 			return SDimensionSampler(*this,seed,dim);
 		}
 
+		// Bakes a scrambled table in the layout of `SequenceSampler::SBatch`, dimensions get prepared and filled in parallel.
+		// Every dimension in flight holds its own Owen tree of `MAX_SAMPLES` flips, so peak memory is 64MB per worker thread.
+		using SBatch = typename SequenceSampler::SBatch;
+		inline void sample(const SBatch& batch, const bool parallel=true) const
+		{
+			if (!batch.out || batch.dimCount==0u || batch.sampleCount==0u)
+				return;
+			const size_t stride = batch.sampleStride ? batch.sampleStride:batch.dimCount;
+			auto fillDimension = [&](const uint32_t i)->void
+			{
+				const auto dimSampler = prepareDimension(batch.firstDim+i);
+				dimSampler.sample(batch.out+i,batch.firstSample,batch.sampleCount,stride);
+			};
+			if (parallel && batch.dimCount>1u)
+			{
+				core::vector<uint32_t> dims(batch.dimCount);
+				std::iota(dims.begin(),dims.end(),0u);
+				core::for_each(core::execution::par,dims.begin(),dims.end(),fillDimension);
+			}
+			else for (uint32_t i=0u; i<batch.dimCount; i++)
+				fillDimension(i);
+		}
+
 	private:
 		uint32_t seed;
 };
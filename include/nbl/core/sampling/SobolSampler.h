@@ -6,6 +6,9 @@
 #define __NBL_CORE_SOBOL_SAMPLER_H_
 
 #include "nbl/core/decl/Types.h"
+#include "nbl/core/execution.h"
+
+#include <numeric>
 
 namespace nbl::core
 {
@@ -70,9 +73,12 @@ class SobolSampler
 		{
 			directions = _NBL_ALIGNED_MALLOC(dimensions*SOBOL_BITS*sizeof(uint32_t), 64u);
 			generate_direction_vectors();
+			prefixFlips = _NBL_ALIGNED_MALLOC(dimensions*SOBOL_BITS*sizeof(uint32_t), 64u);
+			generate_prefix_flips();
 		}
 		~SobolSampler()
 		{
+			_NBL_ALIGNED_FREE(prefixFlips);
 			_NBL_ALIGNED_FREE(directions);
 		}
 		
@@ -91,7 +97,63 @@ class SobolSampler
 			return retval;
 		}
 
+		// Samples `[firstSample,firstSample+sampleCount)` of dimensions `[firstDim,firstDim+dimCount)`, same values as `sample(dim,sampleNum)`
+		struct SBatch
+		{
+			// sample-major, `out[i*sampleStride+j]` is dimension `firstDim+j` of sample `firstSample+i`
+			uint32_t* out = nullptr;
+			// in uint32_t, 0 means tightly packed
+			size_t sampleStride = 0ull;
+			uint32_t firstDim = 0u;
+			uint32_t dimCount = 0u;
+			uint32_t firstSample = 0u;
+			uint32_t sampleCount = 0u;
+		};
+		// Gray code style incremental evaluation, `n` and `n+1` only differ in the lowest `findLSB(n+1)+1` bits so `sample(n+1) = sample(n)^prefixFlip[findLSB(n+1)]`.
+		// Only the first sample of a range is evaluated bit by bit, every next one is a single XOR per dimension against a row of the transposed
+		// prefix table which is contiguous over dimensions so the inner loop vectorizes. Ranges of `ParallelGrainSize` samples are done in parallel.
+		inline void sample(const SBatch& batch, const bool parallel=true) const
+		{
+			if (!batch.out || batch.dimCount==0u || batch.sampleCount==0u)
+				return;
+			assert(batch.firstDim+batch.dimCount<=dimensions);
+			assert(uint64_t(batch.firstSample)+batch.sampleCount<=(0x1ull<<SOBOL_BITS));
+			const size_t stride = batch.sampleStride ? batch.sampleStride:batch.dimCount;
+			assert(stride>=batch.dimCount);
+
+			const uint32_t* const flips = reinterpret_cast<const uint32_t*>(prefixFlips)+batch.firstDim;
+			auto fillRange = [&](const uint32_t first, const uint32_t count)->void
+			{
+				uint32_t* out = batch.out+size_t(first-batch.firstSample)*stride;
+				for (uint32_t d=0u; d<batch.dimCount; d++)
+					out[d] = sample(batch.firstDim+d,first);
+				for (uint32_t i=1u; i<count; i++)
+				{
+					const uint32_t* const prev = out;
+					out += stride;
+					const uint32_t* const flip = flips+size_t(hlsl::findLSB(first+i))*dimensions;
+					for (uint32_t d=0u; d<batch.dimCount; d++)
+						out[d] = prev[d]^flip[d];
+				}
+			};
+			const uint32_t rangeCount = parallel ? ((batch.sampleCount-1u)/ParallelGrainSize+1u):1u;
+			if (rangeCount>1u)
+			{
+				core::vector<uint32_t> ranges(rangeCount);
+				std::iota(ranges.begin(),ranges.end(),0u);
+				core::for_each(core::execution::par,ranges.begin(),ranges.end(),[&](const uint32_t range)->void
+				{
+					const uint32_t offset = range*ParallelGrainSize;
+					fillRange(batch.firstSample+offset,std::min(ParallelGrainSize,batch.sampleCount-offset));
+				});
+			}
+			else
+				fillRange(batch.firstSample,batch.sampleCount);
+		}
+
 	protected:
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t ParallelGrainSize = 0x1u<<14u;
+
 		typedef struct SobolDirectionNumbers {
 			uint32_t d, s, a;
 			uint32_t m[SOBOL_BITS];
@@ -8297,6 +8359,20 @@ class SobolSampler
 	protected:
 		uint32_t dimensions;
 		void* directions;
+		// `[SOBOL_BITS][dimensions]`, XOR of the first `bit+1` direction numbers of every dimension
+		void* prefixFlips;
+
+		void generate_prefix_flips()
+		{
+			auto vectors = *reinterpret_cast<const uint32_t(*)[][SOBOL_BITS]>(directions);
+			auto* const flips = reinterpret_cast<uint32_t*>(prefixFlips);
+			for (uint32_t dim=0u; dim<dimensions; dim++)
+			{
+				uint32_t flip = 0u;
+				for (uint32_t i=0u; i<SOBOL_BITS; i++)
+					flips[i*dimensions+dim] = flip ^= vectors[dim][i];
+			}
+		}
 
 		void generate_direction_vectors()
 		{
@@ -7,6 +7,7 @@
 
 #include "nbl/asset/metadata/IAssetMetadata.h"
 #include "nbl/asset/ICPUImage.h"
+#include "nbl/asset/material_compiler3/CFrontendIR.h"
 
 #include "nbl/ext/MitsubaLoader/CElementIntegrator.h"
 #include "nbl/ext/MitsubaLoader/CElementSensor.h"
@@ -51,6 +52,15 @@ class CMitsubaMetadata : public asset::IAssetMetadata
 				core::vector<CElementSensor> m_sensors;
 		} m_global;
 
+		// The material forest before lowering, `roots` are in the order they got lowered into the scene's material pool so the lowering can be redone
+		struct SMaterialFrontend
+		{
+			using frontend_ir_t = asset::material_compiler3::CFrontendIR;
+
+			core::smart_refctd_ptr<const frontend_ir_t> ir;
+			core::vector<frontend_ir_t::typed_pointer_type<const frontend_ir_t::CLayer>> roots;
+		} m_materialFrontend;
+
 		inline CMitsubaMetadata() :	IAssetMetadata(), m_metaPolygonGeometryStorage() {}
 
 		constexpr static inline const char* LoaderName = "ext::MitsubaLoader::CMitsubaLoader";
@@ -46,6 +46,7 @@ struct SContext final
 		{
 			meta->setGeometryCollectionMeta(std::move(shapeCache));
 			meta->setGeometryCollectionMeta(std::move(groupCache));
+			meta->m_materialFrontend = {.ir=frontIR,.roots=std::move(loweredMaterials)};
 		}
 
 		using true_ir_t = asset::material_compiler3::CTrueIR;
@@ -58,6 +59,8 @@ struct SContext final
 		std::function<interm_getAssetInHierarchy_t> interm_getImageViewInHierarchy;
 		CMitsubaMetadata* meta;
 		core::smart_refctd_ptr<asset::ICPUScene> scene;
+		// in the order they got lowered into the `scene`'s material pool
+		core::vector<material_t> loweredMaterials;
 
 	private:
 		using frontend_material_t = frontend_ir_t::typed_pointer_type<const frontend_ir_t::CLayer>;
@@ -60,6 +60,17 @@ public:
         }
     }
 
+    //! Doesn't spin, returns false if a writer holds the lock
+    bool try_lock_read(std::memory_order rmw_order = std::memory_order_seq_cst)
+    {
+        if (m_lock.fetch_add(1u, rmw_order) > (LockWriteVal-1u))
+        {
+            m_lock.fetch_sub(1u, rmw_order);
+            return false;
+        }
+        return true;
+    }
+
     void unlock_read(std::memory_order rmw_order = std::memory_order_seq_cst)
     {
         m_lock.fetch_sub(1u, rmw_order);
@@ -70,6 +81,13 @@ public:
         lock_write_impl(0u, rmw_order);
     }
 
+    //! Doesn't spin, returns false if anyone holds the lock
+    bool try_lock_write(std::memory_order rmw_order = std::memory_order_seq_cst)
+    {
+        uint32_t expected = 0u;
+        return m_lock.compare_exchange_strong(expected, impl::SReadWriteSpinLockBase::LockWriteVal, rmw_order);
+    }
+
     void unlock_write(std::memory_order rmw_order = std::memory_order_seq_cst)
     {
         m_lock.fetch_sub(LockWriteVal, rmw_order);
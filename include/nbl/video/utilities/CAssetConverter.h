@@ -507,13 +507,18 @@ class CAssetConverter : public core::IReferenceCounted
 					{
 						return operator()(lookup_t<AssetType>{key.asset.get(),&key.patch});
 					}
+					// Only the pointer goes into the bucket hash, an asset rarely gets more than a few patches and the equality sorts those out.
+					// This used to be a blake3 of the pointer and patch, a cryptographic hash on every lookup costs more than the rest of a cache hit.
 					inline size_t operator()(const lookup_t<AssetType>& lookup) const
 					{
-						core::blake3_hasher hasher;
-						hasher << ptrdiff_t(lookup.asset);
-						hasher << *lookup.patch;
-						// put long hash inside a small hash
-						return std::hash<core::blake3_hash_t>()(static_cast<core::blake3_hash_t>(hasher));
+						// murmur3 finalizer, pointers have mostly zero low bits and mostly equal high bits
+						uint64_t x = static_cast<uint64_t>(ptrdiff_t(lookup.asset));
+						x ^= x>>33;
+						x *= 0xff51afd7ed558ccdull;
+						x ^= x>>33;
+						x *= 0xc4ceb9fe1a85ec53ull;
+						x ^= x>>33;
+						return static_cast<size_t>(x);
 					}
 
 					inline bool operator()(const key_t<AssetType>& lhs, const key_t<AssetType>& rhs) const
@@ -529,8 +534,15 @@ class CAssetConverter : public core::IReferenceCounted
 						return lhs.asset==rhs.asset.get() && lhs.patch && *lhs.patch==rhs.patch;
 					}
 				};
+				// open addressing flat map, the keys are small enough to not bother with node based storage
 				template<asset::Asset AssetType>
 				using container_t = core::unordered_map<key_t<AssetType>,core::blake3_hash_t,HashEquals<AssetType>,HashEquals<AssetType>>;
+				// content hashes loaded from a file, wrapped so each asset type gets a distinct type in the tuple
+				template<asset::Asset AssetType>
+				struct persisted_t
+				{
+					core::unordered_set<core::blake3_hash_t> hashes;
+				};
 
 			public:
 				static const core::blake3_hash_t NoContentHash;
@@ -668,6 +680,21 @@ class CAssetConverter : public core::IReferenceCounted
 					core::for_each_in_tuple(m_containers,[](auto& container)->void{container.clear();});
 				}
 
+				// Persistence: pointers mean nothing to another run, so only the content hashes get saved, per asset type.
+				// New asset pointers still need hashing once to be looked up (there's nothing else to identify content by), but a hash computed
+				// in this run can be checked with `isKnown` against previous runs, to reuse on-disk data derived from the content such as
+				// pipeline caches, serialized acceleration structures or transcoded images.
+				bool save(system::IFile* file) const;
+				// Merges with hashes loaded before, returns false and loads nothing if the file isn't a cache saved by a compatible version.
+				bool load(system::IFile* file);
+				// Whether the content hash was saved by a previous run (and loaded with `load`).
+				template<asset::Asset AssetType>
+				inline bool isKnown(const core::blake3_hash_t& contentHash) const
+				{
+					const auto& hashes = std::get<persisted_t<AssetType>>(m_persisted).hashes;
+					return hashes.find(contentHash)!=hashes.end();
+				}
+
 				// only public to allow inheritance later in the cpp file
 				struct hash_impl_base
 				{
@@ -704,6 +731,7 @@ class CAssetConverter : public core::IReferenceCounted
 
 				//
 				core::tuple_transform_t<container_t,supported_asset_types> m_containers;
+				core::tuple_transform_t<persisted_t,supported_asset_types> m_persisted;
 		};
 		// Typed Cache (for a particular AssetType)
 		class CCacheBase
@@ -0,0 +1,126 @@
+// Lowers the materials of Mitsuba scenes from the frontend IR into a fresh CTrueIR, serially and with `SAddMaterialsArgs::parallel`,
+// checks both paths convert every material and hand out the same material handles and reports the best time of a few runs.
+// Usage: material_lowering_bench <scene.xml|scene.zip>...
+#include "nbl/ext/MitsubaLoader/CMitsubaLoader.h"
+#include "nbl/ext/MitsubaLoader/CSerializedLoader.h"
+
+#include <chrono>
+#include <thread>
+
+using namespace nbl;
+using namespace nbl::system;
+using namespace nbl::core;
+using namespace nbl::asset;
+
+class MaterialLoweringBench final : public system::IApplicationFramework
+{
+    using base_t = system::IApplicationFramework;
+    using frontend_t = ext::MitsubaLoader::CMitsubaMetadata::SMaterialFrontend;
+
+public:
+    using base_t::base_t;
+
+    bool onAppInitialized(smart_refctd_ptr<ISystem>&& system) override
+    {
+        if (!isAPILoaded())
+        {
+            std::cerr << "[ERROR]: Could not load Nabla API, terminating!\n";
+            return false;
+        }
+        if (argv.size() < 2)
+        {
+            std::cerr << "[ERROR]: Pass the Mitsuba scenes to lower as arguments!\n";
+            return false;
+        }
+
+        m_system = system ? std::move(system) : createSystem();
+        if (!m_system)
+            return false;
+        m_assetMgr = make_smart_refctd_ptr<IAssetManager>(smart_refctd_ptr(m_system));
+        m_assetMgr->addAssetLoader(make_smart_refctd_ptr<ext::MitsubaLoader::CSerializedLoader>());
+        m_assetMgr->addAssetLoader(make_smart_refctd_ptr<ext::MitsubaLoader::CMitsubaLoader>(smart_refctd_ptr(m_system)));
+
+        bool success = true;
+        for (size_t i = 1; i < argv.size(); i++)
+            success = benchScene(argv[i]) && success;
+        return success;
+    }
+
+    void workLoopBody() override {}
+    bool keepRunning() override { return false; }
+    bool onAppTerminated() override { return true; }
+
+private:
+    constexpr static inline uint32_t Repetitions = 5;
+
+    struct SRun
+    {
+        std::chrono::nanoseconds best = std::chrono::nanoseconds::max();
+        core::vector<material_compiler3::CTrueIR::SMaterialHandle> handles;
+        size_t materialCount = 0;
+    };
+
+    static SRun lower(const frontend_t& frontend, const bool parallel)
+    {
+        SRun retval;
+        retval.handles.resize(frontend.roots.size());
+        for (uint32_t r = 0; r < Repetitions; r++)
+        {
+            // same pool setup as the loader's
+            auto ir = material_compiler3::CTrueIR::create({ .composed = {.blockSizeKBLog2 = 4} });
+            const auto start = std::chrono::high_resolution_clock::now();
+            frontend.ir->addMaterials({ .rootNodes = frontend.roots, .ir = ir.get(), .result = retval.handles.data(), .parallel = parallel });
+            retval.best = std::min<std::chrono::nanoseconds>(retval.best, std::chrono::high_resolution_clock::now() - start);
+            // not counting the blackhole material every IR starts with
+            retval.materialCount = ir->getMaterials().size() - 1;
+        }
+        return retval;
+    }
+
+    bool benchScene(const std::string& path)
+    {
+        IAssetLoader::SAssetLoadParams params = {};
+        const auto bundle = m_assetMgr->getAsset(path, params);
+        const auto* const meta = bundle.getMetadata() ? bundle.getMetadata()->selfCast<const ext::MitsubaLoader::CMitsubaMetadata>() : nullptr;
+        if (!meta || !meta->m_materialFrontend.ir)
+        {
+            std::cerr << "[ERROR]: Could not load Mitsuba scene " << path << "\n";
+            return false;
+        }
+        const auto& frontend = meta->m_materialFrontend;
+        if (frontend.roots.empty())
+        {
+            std::cout << "[INFO]: " << path << " has no materials to lower\n";
+            return true;
+        }
+
+        const auto serial = lower(frontend, false);
+        const auto parallel = lower(frontend, true);
+        const auto converted = [](const SRun& run) -> bool
+        {
+            return run.materialCount != 0 && std::all_of(run.handles.begin(), run.handles.end(), [](const auto& handle) -> bool { return bool(handle); });
+        };
+        const bool serialConverted = converted(serial);
+        const bool parallelConverted = converted(parallel);
+        const bool same = serial.materialCount == parallel.materialCount && std::equal(serial.handles.begin(), serial.handles.end(), parallel.handles.begin(),
+            [](const auto& lhs, const auto& rhs) -> bool { return lhs.value == rhs.value; }
+        );
+
+        using ms = std::chrono::duration<double, std::milli>;
+        std::cout << "[INFO]: " << path << ": " << frontend.roots.size() << " materials, " << serial.materialCount << " unique\n";
+        std::cout << "\tserial   " << ms(serial.best).count() << " ms\n";
+        std::cout << "\tparallel " << ms(parallel.best).count() << " ms (" << std::thread::hardware_concurrency() << " threads)\n";
+        if (!serialConverted)
+            std::cerr << "[ERROR]: Serial lowering of " << path << " failed to convert some materials!\n";
+        if (!parallelConverted)
+            std::cerr << "[ERROR]: Parallel lowering of " << path << " failed to convert some materials!\n";
+        if (!same)
+            std::cerr << "[ERROR]: Parallel lowering of " << path << " handed out different material handles than the serial one!\n";
+        return serialConverted && parallelConverted && same;
+    }
+
+    smart_refctd_ptr<ISystem> m_system;
+    smart_refctd_ptr<IAssetManager> m_assetMgr;
+};
+
+NBL_MAIN_FUNC(MaterialLoweringBench)
@@ -0,0 +1,185 @@
+// Allocates and frees fixed size slots in batches from a growing number of threads, `LockFreePoolAddressAllocator` against the mutex guarded
+// `PoolAddressAllocatorMT`, and a `ThreadSafe` `CMemoryPool` over each (`ConcurrentBlockBasedAllocator` vs `SimpleBlockBasedAllocatorMT`).
+// Every slot gets tagged by its thread and checked before it's freed, fails if a slot got handed to two threads at once or an allocation failed.
+// Usage: pool_contention_bench [allocations per thread] [max threads]
+#include "timing.hpp"
+
+#include <atomic>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+
+using namespace nbl;
+using namespace nbl::system;
+using namespace nbl::core;
+
+class PoolContentionBench final : public system::IApplicationFramework
+{
+    using base_t = system::IApplicationFramework;
+
+public:
+    using base_t::base_t;
+
+    bool onAppInitialized(smart_refctd_ptr<ISystem>&& system) override
+    {
+        if (!isAPILoaded())
+        {
+            std::cerr << "[ERROR]: Could not load Nabla API, terminating!\n";
+            return false;
+        }
+
+        size_t allocCount = DefaultAllocCount;
+        if (argv.size() > 1)
+            allocCount = std::stoull(argv[1]);
+        if (allocCount < Batch)
+        {
+            std::cerr << "[ERROR]: Need at least " << Batch << " allocations per thread\n";
+            return false;
+        }
+        const size_t rounds = allocCount / Batch;
+        uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        if (argv.size() > 2)
+            maxThreads = std::stoul(argv[2]);
+        if (maxThreads == 0u)
+        {
+            std::cerr << "[ERROR]: Need at least one thread\n";
+            return false;
+        }
+        std::cout << "[INFO]: " << rounds * Batch << " allocations of " << SlotSize << " bytes per thread in batches of " << Batch << ", up to " << maxThreads << " threads\n";
+
+        bool success = true;
+        for (uint32_t threads = 1u; true; threads = std::min(threads * 2u, maxThreads))
+        {
+            std::cout << "[INFO]: " << threads << " threads\n";
+            success = benchAddressAllocator<LockFreePoolAddressAllocator<uint32_t>>("LockFreePoolAddressAllocator", threads, rounds) && success;
+            success = benchAddressAllocator<PoolAddressAllocatorMT<uint32_t, std::recursive_mutex>>("PoolAddressAllocatorMT", threads, rounds) && success;
+            success = benchMemoryPool<SLockFreeConfig>("ConcurrentBlockBasedAllocator", threads, rounds) && success;
+            success = benchMemoryPool<SLockedConfig>("SimpleBlockBasedAllocatorMT", threads, rounds) && success;
+            if (threads == maxThreads)
+                break;
+        }
+        return success;
+    }
+
+    void workLoopBody() override {}
+    bool keepRunning() override { return false; }
+    bool onAppTerminated() override { return true; }
+
+private:
+    constexpr static inline size_t DefaultAllocCount = 0x1ull << 20;
+    constexpr static inline uint32_t Batch = 16u;
+    constexpr static inline uint32_t SlotSize = 64u;
+    constexpr static inline uint32_t Repetitions = 3u;
+
+    // a cacheline each, so the tagging doesn't add false sharing of its own
+    struct alignas(SlotSize) SSlot
+    {
+        uint64_t tag;
+    };
+    static_assert(sizeof(SSlot) == SlotSize);
+
+    struct SLockFreeConfig
+    {
+        using AddressAllocator = LockFreePoolAddressAllocator<uint32_t>;
+        using HandleValue = void*;
+        constexpr static inline bool ThreadSafe = true;
+    };
+    struct SLockedConfig
+    {
+        using AddressAllocator = PoolAddressAllocator<uint32_t>;
+        using HandleValue = void*;
+        constexpr static inline bool ThreadSafe = true;
+    };
+
+    // spawns the threads, each tags a batch of slots, checks the tags and frees the batch `rounds` times
+    template<typename AllocateAndFree>
+    static bool run(const char* name, const uint32_t threads, const size_t rounds, AllocateAndFree&& allocateAndFree)
+    {
+        std::atomic<bool> failed = false;
+        const auto time = smoke::bestOf(Repetitions, []() -> void {}, [&]() -> void
+            {
+                core::vector<std::thread> workers;
+                workers.reserve(threads);
+                for (uint32_t t = 0u; t < threads; t++)
+                    workers.emplace_back([&, t]() -> void
+                        {
+                            for (size_t r = 0u; r < rounds && !failed.load(std::memory_order_relaxed); r++)
+                            if (!allocateAndFree((uint64_t(t) << 32ull) | r))
+                                failed.store(true, std::memory_order_relaxed);
+                        }
+                    );
+                for (auto& worker : workers)
+                    worker.join();
+            }
+        );
+
+        const double allocations = double(threads) * double(rounds * Batch);
+        std::cout << "\t" << std::left << std::setw(30) << name << smoke::milliseconds_t(time).count() << " ms, " << allocations / smoke::milliseconds_t(time).count() << " allocations/ms\n";
+        if (failed)
+            std::cerr << "[ERROR]: " << name << " failed an allocation or handed the same slot to two threads with " << threads << " threads!\n";
+        return !failed;
+    }
+
+    template<class AddressAllocator>
+    static bool benchAddressAllocator(const char* name, const uint32_t threads, const size_t rounds)
+    {
+        using traits = address_allocator_traits<AddressAllocator>;
+        using size_type = typename traits::size_type;
+        constexpr size_type invalid_address = AddressAllocator::invalid_address;
+
+        // twice as many slots as the threads can hold at once, so running out means the allocator lost some
+        const size_type slotCount = threads * Batch * 2u;
+        core::vector<SSlot> slots(slotCount);
+        core::vector<uint8_t> reserved(AddressAllocator::reserved_size(SlotSize, slotCount * SlotSize, SlotSize));
+        AddressAllocator alloc(reserved.data(), 0u, 0u, SlotSize, slotCount * SlotSize, SlotSize);
+
+        return run(name, threads, rounds, [&](const uint64_t tag) -> bool
+            {
+                size_type addresses[Batch];
+                size_type sizes[Batch];
+                std::fill_n(addresses, Batch, invalid_address);
+                std::fill_n(sizes, Batch, SlotSize);
+                traits::multi_alloc_addr(alloc, Batch, addresses, sizes, SlotSize);
+                if (std::find(addresses, addresses + Batch, invalid_address) != addresses + Batch)
+                    return false;
+                for (const auto addr : addresses)
+                    slots[addr / SlotSize].tag = tag;
+                bool retval = true;
+                for (const auto addr : addresses)
+                    retval = slots[addr / SlotSize].tag == tag && retval;
+                traits::multi_free_addr(alloc, Batch, addresses, sizes);
+                return retval;
+            }
+        );
+    }
+
+    template<class Config>
+    static bool benchMemoryPool(const char* name, const uint32_t threads, const size_t rounds)
+    {
+        using pool_t = CMemoryPool<Config>;
+        // blocks of 1024 slots, the pool grows them as needed during the first run
+        pool_t pool({ .composed = {.addrAllocCtorExtraParams = {SlotSize}, .blockSizeKBLog2 = 6} });
+
+        return run(name, threads, rounds, [&](const uint64_t tag) -> bool
+            {
+                typename pool_t::template typed_pointer_type<SSlot> handles[Batch];
+                for (auto& handle : handles)
+                {
+                    handle = pool.template emplace<SSlot>();
+                    if (!handle)
+                        return false;
+                    pool.deref(handle)->tag = tag;
+                }
+                bool retval = true;
+                for (const auto handle : handles)
+                {
+                    retval = pool.deref(handle)->tag == tag && retval;
+                    pool._delete(handle);
+                }
+                return retval;
+            }
+        );
+    }
+};
+
+NBL_MAIN_FUNC(PoolContentionBench)
@@ -0,0 +1,135 @@
+// Sorts random keys with `std::sort`, `std::stable_sort`, `core::RadixLsbSorter` and `core::ParallelRadixSorter`, checks the radix sorts
+// agree with `std::stable_sort` and reports the best time of a few runs. The key-index case is the layout `CVertexHashGrid` sorts.
+// Usage: radix_sort_bench [element count]
+#include "nbl/core/algorithm/radix_sort.h"
+
+#include "timing.hpp"
+
+#include <random>
+#include <thread>
+
+using namespace nbl;
+using namespace nbl::system;
+using namespace nbl::core;
+
+class RadixSortBench final : public system::IApplicationFramework
+{
+    using base_t = system::IApplicationFramework;
+
+public:
+    using base_t::base_t;
+
+    bool onAppInitialized(smart_refctd_ptr<ISystem>&& system) override
+    {
+        if (!isAPILoaded())
+        {
+            std::cerr << "[ERROR]: Could not load Nabla API, terminating!\n";
+            return false;
+        }
+
+        size_t count = DefaultCount;
+        if (argv.size() > 1)
+            count = std::stoull(argv[1]);
+        if (count < 2 || count >= (0x1ull << 32))
+        {
+            std::cerr << "[ERROR]: Element count needs to be in [2,2^32)\n";
+            return false;
+        }
+        std::cout << "[INFO]: Sorting " << count << " elements, " << std::thread::hardware_concurrency() << " threads\n";
+
+        std::mt19937_64 rng(0x45u);
+        bool success = true;
+        {
+            core::vector<uint32_t> keys(count);
+            std::generate(keys.begin(), keys.end(), [&rng]() -> uint32_t { return static_cast<uint32_t>(rng()); });
+            success = benchCase("uint32_t keys", keys, impl::KeyAdaptor<uint32_t>(), std::less<uint32_t>()) && success;
+            // only the low bits used, like hashes into a smaller table, the passes over the top bits get skipped
+            for (auto& key : keys)
+                key &= 0xfffffu;
+            success = benchCase("uint32_t keys, 20 bits used", keys, impl::KeyAdaptor<uint32_t>(), std::less<uint32_t>()) && success;
+        }
+        {
+            core::vector<uint64_t> keys(count);
+            std::generate(keys.begin(), keys.end(), [&rng]() -> uint64_t { return rng(); });
+            success = benchCase("uint64_t keys", keys, impl::KeyAdaptor<uint64_t>(), std::less<uint64_t>()) && success;
+        }
+        {
+            core::vector<SKeyIndex> items(count);
+            for (uint32_t i = 0; i < count; i++)
+                items[i] = { .key = static_cast<uint32_t>(rng()) & 0xfffffu, .index = i };
+            success = benchCase("uint32_t key + uint32_t index", items, SKeyIndexAccessor(), [](const SKeyIndex& lhs, const SKeyIndex& rhs) -> bool { return lhs.key < rhs.key; }) && success;
+        }
+        return success;
+    }
+
+    void workLoopBody() override {}
+    bool keepRunning() override { return false; }
+    bool onAppTerminated() override { return true; }
+
+private:
+    constexpr static inline size_t DefaultCount = 0x1ull << 22;
+    constexpr static inline uint32_t Repetitions = 5;
+
+    struct SKeyIndex
+    {
+        inline bool operator==(const SKeyIndex&) const = default;
+
+        uint32_t key;
+        uint32_t index;
+    };
+    struct SKeyIndexAccessor
+    {
+        constexpr static inline size_t key_bit_count = 32ull;
+
+        template<auto bit_offset, auto radix_mask>
+        inline decltype(radix_mask) operator()(const SKeyIndex& item) const
+        {
+            return static_cast<decltype(radix_mask)>(item.key >> static_cast<uint32_t>(bit_offset)) & radix_mask;
+        }
+    };
+
+    template<typename T, class KeyAccessor, typename Less>
+    static bool benchCase(const char* name, const core::vector<T>& data, const KeyAccessor& comp, Less less)
+    {
+        const size_t count = data.size();
+        core::vector<T> reference(data);
+        std::stable_sort(reference.begin(), reference.end(), less);
+
+        core::vector<T> work(count), scratch(count);
+        const auto prepare = [&]() -> void { std::copy(data.begin(), data.end(), work.begin()); };
+        const T* sorted = nullptr;
+        bool success = true;
+        const auto check = [&](const char* sorter) -> void
+        {
+            if (std::equal(reference.begin(), reference.end(), sorted))
+                return;
+            std::cerr << "[ERROR]: " << sorter << " sorted " << name << " differently than std::stable_sort!\n";
+            success = false;
+        };
+
+        const auto stdSort = smoke::bestOf(Repetitions, prepare, [&]() -> void { std::sort(work.begin(), work.end(), less); });
+        const auto stdStableSort = smoke::bestOf(Repetitions, prepare, [&]() -> void { std::stable_sort(work.begin(), work.end(), less); });
+        const auto lsb = smoke::bestOf(Repetitions, prepare, [&]() -> void
+            {
+                sorted = RadixLsbSorter<KeyAccessor::key_bit_count, uint32_t>()(work.data(), scratch.data(), static_cast<uint32_t>(count), comp);
+            }
+        );
+        check("RadixLsbSorter");
+        const auto parallel = smoke::bestOf(Repetitions, prepare, [&]() -> void
+            {
+                sorted = ParallelRadixSorter<KeyAccessor::key_bit_count>()(work.data(), scratch.data(), count, comp);
+            }
+        );
+        check("ParallelRadixSorter");
+
+        using smoke::milliseconds_t;
+        std::cout << "[INFO]: " << name << "\n";
+        std::cout << "\tstd::sort           " << milliseconds_t(stdSort).count() << " ms\n";
+        std::cout << "\tstd::stable_sort    " << milliseconds_t(stdStableSort).count() << " ms\n";
+        std::cout << "\tRadixLsbSorter      " << milliseconds_t(lsb).count() << " ms\n";
+        std::cout << "\tParallelRadixSorter " << milliseconds_t(parallel).count() << " ms\n";
+        return success;
+    }
+};
+
+NBL_MAIN_FUNC(RadixSortBench)
@@ -0,0 +1,207 @@
+// Times the reference counting the asset DAG walks do with and without `borrowed_refctd_ptr` and `refctd_drop_batch`.
+// `IPreHashed::discardDependantsContents` runs over images sharing buffers (like atlas pages) against the same walk releasing every reference
+// right away. `CAssetConverter::reserve` needs a logical device, so its visitors' dependant lookup is timed on its own: many threads peeking
+// a small cache of shared dependants through borrowed views (`peekDependant`) against taking a reference each time (`getDependant`).
+// Usage: refcount_traffic_bench [image count] [lookups per thread]
+#include "timing.hpp"
+
+#include <thread>
+
+using namespace nbl;
+using namespace nbl::system;
+using namespace nbl::core;
+using namespace nbl::asset;
+
+class RefcountTrafficBench final : public system::IApplicationFramework
+{
+    using base_t = system::IApplicationFramework;
+
+public:
+    using base_t::base_t;
+
+    bool onAppInitialized(smart_refctd_ptr<ISystem>&& system) override
+    {
+        if (!isAPILoaded())
+        {
+            std::cerr << "[ERROR]: Could not load Nabla API, terminating!\n";
+            return false;
+        }
+
+        size_t imageCount = DefaultImageCount;
+        if (argv.size() > 1)
+            imageCount = std::stoull(argv[1]);
+        size_t lookupCount = DefaultLookupCount;
+        if (argv.size() > 2)
+            lookupCount = std::stoull(argv[2]);
+        if (imageCount == 0 || lookupCount == 0)
+        {
+            std::cerr << "[ERROR]: Image and lookup counts need to be non-zero\n";
+            return false;
+        }
+
+        bool success = benchDiscard(imageCount);
+        success = benchLookup(lookupCount) && success;
+        return success;
+    }
+
+    void workLoopBody() override {}
+    bool keepRunning() override { return false; }
+    bool onAppTerminated() override { return true; }
+
+private:
+    constexpr static inline size_t DefaultImageCount = 0x1ull << 16;
+    constexpr static inline size_t DefaultLookupCount = 0x1ull << 22;
+    constexpr static inline uint32_t ImagesPerBuffer = 64u;
+    constexpr static inline uint32_t DependantCount = 16u;
+    constexpr static inline uint32_t Repetitions = 5;
+
+    // the images and buffers are also kept alive by the fixture, so that the immediate walk can't free a buffer which is still on its stack
+    struct SDiscardFixture
+    {
+        core::vector<smart_refctd_ptr<ICPUImage>> images;
+        core::vector<smart_refctd_ptr<ICPUBuffer>> buffers;
+        core::vector<IAsset*> roots;
+    };
+
+    static void create(SDiscardFixture& fixture, const size_t imageCount)
+    {
+        ICPUImage::SCreationParams info = {};
+        info.format = EF_R8G8B8A8_UNORM;
+        info.type = ICPUImage::ET_2D;
+        info.extent = { 2u, 2u, 1u };
+        info.mipLevels = 1u;
+        info.arrayLayers = 1u;
+        info.samples = ICPUImage::E_SAMPLE_COUNT_FLAGS::ESCF_1_BIT;
+        info.flags = static_cast<IImage::E_CREATE_FLAGS>(0u);
+        info.usage = IImage::EUF_SAMPLED_BIT;
+        const size_t imageBytes = info.extent.width * info.extent.height * getTexelOrBlockBytesize(info.format);
+
+        fixture.images.resize(imageCount);
+        fixture.buffers.resize((imageCount + ImagesPerBuffer - 1) / ImagesPerBuffer);
+        fixture.roots.resize(imageCount);
+        for (auto& buffer : fixture.buffers)
+            buffer = ICPUBuffer::create({ ImagesPerBuffer * imageBytes });
+        for (size_t i = 0; i < imageCount; i++)
+        {
+            auto regions = make_refctd_dynamic_array<smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(1u);
+            auto& region = regions->front();
+            region.imageSubresource.aspectMask = IImage::EAF_COLOR_BIT;
+            region.imageSubresource.mipLevel = 0u;
+            region.imageSubresource.baseArrayLayer = 0u;
+            region.imageSubresource.layerCount = 1u;
+            region.bufferOffset = (i % ImagesPerBuffer) * imageBytes;
+            region.bufferRowLength = info.extent.width;
+            region.bufferImageHeight = 0u;
+            region.imageOffset = { 0u, 0u, 0u };
+            region.imageExtent = info.extent;
+
+            auto& image = fixture.images[i];
+            image = ICPUImage::create(info);
+            image->setBufferAndRegions(smart_refctd_ptr(fixture.buffers[i / ImagesPerBuffer]), regions);
+            fixture.roots[i] = image.get();
+        }
+    }
+    // what `discardDependantsContents` did before batching, every discard releases its references on the spot
+    static void discardImmediately(const std::span<IAsset* const> roots)
+    {
+        core::vector<IAsset*> stack;
+        core::unordered_set<IAsset*> alreadyVisited;
+        auto push = [&stack, &alreadyVisited](IAsset* node) -> bool
+        {
+            if (alreadyVisited.insert(node).second)
+                stack.push_back(node);
+            return true;
+        };
+        for (const auto& root : roots)
+            push(root);
+        while (!stack.empty())
+        {
+            auto* entry = stack.back();
+            stack.pop_back();
+            entry->visitDependents(push);
+            if (auto* isPrehashed = dynamic_cast<IPreHashed*>(entry); isPrehashed)
+                isPrehashed->discardContent();
+        }
+    }
+    static bool discarded(const SDiscardFixture& fixture)
+    {
+        for (const auto& image : fixture.images)
+        if (!image->missingContent())
+            return false;
+        // the images must have released all of their references
+        for (const auto& buffer : fixture.buffers)
+        if (!buffer->missingContent() || buffer->getReferenceCount() != 1)
+            return false;
+        return true;
+    }
+
+    static bool benchDiscard(const size_t imageCount)
+    {
+        SDiscardFixture fixture;
+        const auto prepare = [&]() -> void { create(fixture, imageCount); };
+        bool success = true;
+        const auto immediate = smoke::bestOf(Repetitions, prepare, [&]() -> void { discardImmediately(fixture.roots); });
+        success = discarded(fixture) && success;
+        const auto batched = smoke::bestOf(Repetitions, prepare, [&]() -> void { IPreHashed::discardDependantsContents(fixture.roots); });
+        success = discarded(fixture) && success;
+
+        using smoke::milliseconds_t;
+        std::cout << "[INFO]: discardDependantsContents, " << imageCount << " images, " << ImagesPerBuffer << " per buffer\n";
+        std::cout << "\timmediate drops " << milliseconds_t(immediate).count() << " ms\n";
+        std::cout << "\tbatched drops   " << milliseconds_t(batched).count() << " ms\n";
+        if (!success)
+            std::cerr << "[ERROR]: Discarding left contents or references behind!\n";
+        return success;
+    }
+
+    static bool benchLookup(const size_t lookupCount)
+    {
+        // stands in for the DFS cache's GPU objects, e.g. the few pipeline layouts every pipeline in a scene shares
+        core::vector<smart_refctd_ptr<ICPUBuffer>> dependants(DependantCount);
+        for (uint32_t i = 0; i < DependantCount; i++)
+            dependants[i] = ICPUBuffer::create({ i + 1u });
+
+        const uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+        // the sizes get summed so the lookups can't be optimized out
+        std::atomic<size_t> sum = 0;
+        const auto lookup = [&]<typename Pointer>() -> std::chrono::nanoseconds
+        {
+            return smoke::bestOf(Repetitions, [&]() -> void { sum = 0; }, [&]() -> void
+                {
+                    core::vector<std::thread> workers;
+                    workers.reserve(threadCount);
+                    for (uint32_t t = 0u; t < threadCount; t++)
+                        workers.emplace_back([&, t]() -> void
+                            {
+                                size_t localSum = 0;
+                                for (size_t i = 0; i < lookupCount; i++)
+                                {
+                                    const Pointer dep = dependants[(i + t) % DependantCount];
+                                    localSum += dep->getSize();
+                                }
+                                sum.fetch_add(localSum, std::memory_order_relaxed);
+                            }
+                        );
+                    for (auto& worker : workers)
+                        worker.join();
+                }
+            );
+        };
+        const auto owning = lookup.template operator()<smart_refctd_ptr<ICPUBuffer>>();
+        const size_t owningSum = sum;
+        const auto borrowed = lookup.template operator()<borrowed_refctd_ptr<ICPUBuffer>>();
+        bool success = owningSum == sum;
+        for (const auto& dep : dependants)
+            success = dep->getReferenceCount() == 1 && success;
+
+        using smoke::milliseconds_t;
+        std::cout << "[INFO]: Dependant lookups, " << lookupCount << " per thread over " << DependantCount << " shared dependants, " << threadCount << " threads\n";
+        std::cout << "\tsmart_refctd_ptr    " << milliseconds_t(owning).count() << " ms\n";
+        std::cout << "\tborrowed_refctd_ptr " << milliseconds_t(borrowed).count() << " ms\n";
+        if (!success)
+            std::cerr << "[ERROR]: Borrowed lookups saw different dependants or the reference counts didn't return to where they were!\n";
+        return success;
+    }
+};
+
+NBL_MAIN_FUNC(RefcountTrafficBench)
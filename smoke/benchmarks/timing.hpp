@@ -0,0 +1,29 @@
+#ifndef SMOKE_BENCHMARKS_TIMING_HPP
+#define SMOKE_BENCHMARKS_TIMING_HPP
+
+#include <chrono>
+#include <cstdint>
+
+namespace smoke
+{
+
+using milliseconds_t = std::chrono::duration<double,std::milli>;
+
+// best time of `repetitions` runs of `run`, `prepare` resets its inputs outside of the timed section
+template<typename Prepare, typename Run>
+inline std::chrono::nanoseconds bestOf(const uint32_t repetitions, Prepare&& prepare, Run&& run)
+{
+    auto best = std::chrono::nanoseconds::max();
+    for (uint32_t r = 0; r < repetitions; r++)
+    {
+        prepare();
+        const auto start = std::chrono::high_resolution_clock::now();
+        run();
+        best = std::min<std::chrono::nanoseconds>(best, std::chrono::high_resolution_clock::now() - start);
+    }
+    return best;
+}
+
+}
+
+#endif // SMOKE_BENCHMARKS_TIMING_HPP
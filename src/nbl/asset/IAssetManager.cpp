@@ -51,6 +51,10 @@
 #include "nbl/asset/interchange/CGLILoader.h"
 #endif
 
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+#include "nbl/asset/interchange/CImageLoaderKTX2.h"
+#endif
+
 #ifdef _NBL_COMPILE_WITH_STL_WRITER_
 #include "nbl/asset/interchange/CSTLMeshWriter.h"
 #endif
@@ -79,6 +83,10 @@
 #include "nbl/asset/interchange/CImageWriterOpenEXR.h"
 #endif
 
+#ifdef _NBL_COMPILE_WITH_KTX2_WRITER_
+#include "nbl/asset/interchange/CImageWriterKTX2.h"
+#endif
+
 #ifdef _NBL_COMPILE_WITH_GLI_WRITER_
 #include "nbl/asset/interchange/CGLIWriter.h"
 #endif
@@ -149,6 +157,9 @@ void IAssetManager::addLoadersAndWriters()
 #ifdef  _NBL_COMPILE_WITH_GLI_LOADER_
 	addAssetLoader(core::make_smart_refctd_ptr<asset::CGLILoader>());
 #endif 
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+	addAssetLoader(core::make_smart_refctd_ptr<asset::CImageLoaderKTX2>());
+#endif
 #ifdef _NBL_COMPILE_WITH_TGA_LOADER_
 	addAssetLoader(core::make_smart_refctd_ptr<asset::CImageLoaderTGA>());
 #endif
@@ -181,6 +192,9 @@ void IAssetManager::addLoadersAndWriters()
 #ifdef _NBL_COMPILE_WITH_GLI_WRITER_
 	addAssetWriter(core::make_smart_refctd_ptr<asset::CGLIWriter>(core::smart_refctd_ptr<system::ISystem>(m_system)));
 #endif
+#ifdef _NBL_COMPILE_WITH_KTX2_WRITER_
+	addAssetWriter(core::make_smart_refctd_ptr<asset::CImageWriterKTX2>());
+#endif
 addAssetLoader(core::make_smart_refctd_ptr<asset::CIESProfileLoader>());
 
     for (auto& loader : m_loaders.vector)
@@ -204,13 +218,18 @@ SAssetBundle IAssetManager::getAssetInHierarchy_impl(system::IFile* _file, const
 
     const uint64_t levelFlags = params.cacheFlags >> ((uint64_t)_hierarchyLevel * 2ull);
 
+    // partial mip chains of the same file are different assets, so they can't share the cache key of a full load
+    std::string cacheKey = filename.string();
+    if (params.baseMipLevel!=0u || params.mipLevelCount!=~0u)
+        cacheKey += "?mips?"+std::to_string(params.baseMipLevel)+"?"+std::to_string(params.mipLevelCount);
+
     SAssetBundle bundle;
     if ((levelFlags & IAssetLoader::ECF_DUPLICATE_TOP_LEVEL) != IAssetLoader::ECF_DUPLICATE_TOP_LEVEL)
     {
-        auto found = findAssets(filename.string());
+        auto found = findAssets(cacheKey);
         if (found->size())
             return _override->chooseRelevantFromFound(found->begin(), found->end(), ctx, _hierarchyLevel);
-        else if (!(bundle = _override->handleSearchFail(filename.string(), ctx, _hierarchyLevel)).getContents().empty())
+        else if (!(bundle = _override->handleSearchFail(cacheKey, ctx, _hierarchyLevel)).getContents().empty())
             return bundle;
     }
 
@@ -236,14 +255,14 @@ SAssetBundle IAssetManager::getAssetInHierarchy_impl(system::IFile* _file, const
         ((levelFlags & IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL) != IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL) &&
         ((levelFlags & IAssetLoader::ECF_DUPLICATE_TOP_LEVEL) != IAssetLoader::ECF_DUPLICATE_TOP_LEVEL))
     {
-        _override->insertAssetIntoCache(bundle, filename.string(), ctx.params, _hierarchyLevel);
+        _override->insertAssetIntoCache(bundle, cacheKey, ctx.params, _hierarchyLevel);
     }
     else if (bundle.getContents().empty())
     {
         bool addToCache;
-        bundle = _override->handleLoadFail(addToCache, file.get(), filename.string(), filename.string(), ctx, _hierarchyLevel);
+        bundle = _override->handleLoadFail(addToCache, file.get(), filename.string(), cacheKey, ctx, _hierarchyLevel);
         if (!bundle.getContents().empty() && addToCache)
-            _override->insertAssetIntoCache(bundle, filename.string(), ctx.params, _hierarchyLevel);
+            _override->insertAssetIntoCache(bundle, cacheKey, ctx.params, _hierarchyLevel);
     }            
     return bundle;
 }
@@ -0,0 +1,243 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "CImageLoaderKTX2.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+
+#include "SKTX2.h"
+
+#include <atomic>
+#include <numeric>
+
+namespace nbl::asset
+{
+
+bool CImageLoaderKTX2::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+	uint8_t identifier[sizeof(ktx2::Identifier)];
+	system::IFile::success_t success;
+	_file->read(success,identifier,0,sizeof(identifier));
+	if (!success)
+		return false;
+	return memcmp(identifier,ktx2::Identifier,sizeof(identifier))==0;
+}
+
+// reads the "KTXswizzle" entry out of the key/value data, every entry is a 4 byte aligned `{uint32_t length; char keyAndValue[length];}`
+static inline bool readSwizzle(system::IFile* file, const ktx2::SHeader& header, ICPUImageView::SComponentMapping& outComponents)
+{
+	if (header.kvdByteLength==0u)
+		return false;
+
+	core::vector<char> kvd(header.kvdByteLength);
+	system::IFile::success_t success;
+	file->read(success,kvd.data(),header.kvdByteOffset,kvd.size());
+	if (!success)
+		return false;
+
+	constexpr std::string_view SwizzleKey = "KTXswizzle";
+	for (size_t offset=0ull; offset+sizeof(uint32_t)<=kvd.size();)
+	{
+		uint32_t length;
+		memcpy(&length,kvd.data()+offset,sizeof(length));
+		offset += sizeof(length);
+		if (offset+length>kvd.size())
+			break;
+
+		const std::string_view keyAndValue(kvd.data()+offset,length);
+		const auto keyEnd = keyAndValue.find('\0');
+		if (keyEnd!=std::string_view::npos && keyAndValue.substr(0ull,keyEnd)==SwizzleKey)
+			return ktx2::parseSwizzle(keyAndValue.substr(keyEnd+1ull),outComponents);
+		offset = core::alignUp(offset+length,sizeof(uint32_t));
+	}
+	return false;
+}
+
+SAssetBundle CImageLoaderKTX2::loadAsset(system::IFile* _file, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+{
+	if (!_file)
+		return {};
+
+	const auto& logger = _params.logger;
+	const auto fileName = _file->getFileName().string();
+
+	ktx2::SHeader header;
+	{
+		system::IFile::success_t success;
+		_file->read(success,&header,0,sizeof(header));
+		if (!success || memcmp(header.identifier,ktx2::Identifier,sizeof(ktx2::Identifier))!=0)
+		{
+			logger.log("LOAD KTX2: %s is not a KTX2 file!",system::ILogger::ELL_ERROR,fileName.c_str());
+			return {};
+		}
+	}
+
+	const E_FORMAT format = ktx2::getFormat(header.vkFormat);
+	if (format==EF_UNKNOWN || isPlanarFormat(format) || isDepthOrStencilFormat(format))
+	{
+		logger.log("LOAD KTX2: %s has an unsupported VkFormat %u!",system::ILogger::ELL_ERROR,fileName.c_str(),header.vkFormat);
+		return {};
+	}
+	if (!ktx2::isSupercompressionSupported(header.supercompressionScheme))
+	{
+		logger.log("LOAD KTX2: %s uses unsupported supercompression scheme %u!",system::ILogger::ELL_ERROR,fileName.c_str(),header.supercompressionScheme);
+		return {};
+	}
+
+	// KTX2 zeroes out the dimensions which don't exist
+	const bool isCube = header.faceCount==6u;
+	const bool isArray = header.layerCount!=0u;
+	IImage::E_TYPE imageType;
+	ICPUImageView::E_TYPE imageViewType;
+	if (header.pixelHeight==0u)
+	{
+		imageType = IImage::ET_1D;
+		imageViewType = isArray ? ICPUImageView::ET_1D_ARRAY:ICPUImageView::ET_1D;
+	}
+	else if (header.pixelDepth!=0u)
+	{
+		imageType = IImage::ET_3D;
+		imageViewType = ICPUImageView::ET_3D;
+	}
+	else
+	{
+		imageType = IImage::ET_2D;
+		if (isCube)
+			imageViewType = isArray ? ICPUImageView::ET_CUBE_MAP_ARRAY:ICPUImageView::ET_CUBE_MAP;
+		else
+			imageViewType = isArray ? ICPUImageView::ET_2D_ARRAY:ICPUImageView::ET_2D;
+	}
+	if (header.pixelWidth==0u || (header.faceCount!=1u && !isCube) || (isCube && (imageType!=IImage::ET_2D || header.pixelWidth!=header.pixelHeight)) || (isArray && imageType==IImage::ET_3D))
+	{
+		logger.log("LOAD KTX2: %s has invalid dimensions!",system::ILogger::ELL_ERROR,fileName.c_str());
+		return {};
+	}
+
+	// clamp the requested range to the levels the file has, a level count of 0 means the runtime should generate the mips
+	const uint32_t fileLevelCount = core::max(header.levelCount,1u);
+	const uint32_t baseLevel = core::min(_params.baseMipLevel,fileLevelCount-1u);
+	const uint32_t levelCount = core::min(_params.mipLevelCount,fileLevelCount-baseLevel);
+	if (levelCount==0u)
+		return {};
+
+	core::vector<ktx2::SLevelIndexEntry> levelIndex(levelCount);
+	{
+		system::IFile::success_t success;
+		_file->read(success,levelIndex.data(),sizeof(header)+sizeof(ktx2::SLevelIndexEntry)*baseLevel,sizeof(ktx2::SLevelIndexEntry)*levelCount);
+		if (!success)
+			return {};
+	}
+
+	ICPUImage::SCreationParams imageInfo = {};
+	imageInfo.type = imageType;
+	imageInfo.samples = ICPUImage::E_SAMPLE_COUNT_FLAGS::ESCF_1_BIT;
+	imageInfo.format = format;
+	imageInfo.extent.width = core::max(header.pixelWidth>>baseLevel,1u);
+	imageInfo.extent.height = core::max(core::max(header.pixelHeight,1u)>>baseLevel,1u);
+	imageInfo.extent.depth = core::max(core::max(header.pixelDepth,1u)>>baseLevel,1u);
+	imageInfo.mipLevels = levelCount;
+	imageInfo.arrayLayers = core::max(header.layerCount,1u)*header.faceCount;
+	imageInfo.flags = isCube ? ICPUImage::E_CREATE_FLAGS::ECF_CUBE_COMPATIBLE_BIT:static_cast<ICPUImage::E_CREATE_FLAGS>(0u);
+	imageInfo.usage = IImage::EUF_SAMPLED_BIT;
+
+	// the layout of a KTX2 level (layers, then faces, then slices, then rows) is exactly one region with all the layers
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<ICPUImage::SBufferCopy>>(levelCount);
+	uint64_t bufferSize = 0ull;
+	for (uint32_t i=0u; i<levelCount; i++)
+	{
+		auto& region = regions->operator[](i);
+		region.imageExtent.width = core::max(imageInfo.extent.width>>i,1u);
+		region.imageExtent.height = core::max(imageInfo.extent.height>>i,1u);
+		region.imageExtent.depth = core::max(imageInfo.extent.depth>>i,1u);
+		region.imageOffset = {0u,0u,0u};
+		region.bufferRowLength = region.imageExtent.width;
+		region.bufferImageHeight = 0u;
+		region.imageSubresource.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+		region.imageSubresource.mipLevel = i;
+		region.imageSubresource.baseArrayLayer = 0u;
+		region.imageSubresource.layerCount = imageInfo.arrayLayers;
+		region.bufferOffset = bufferSize;
+
+		const uint64_t levelSize = ktx2::getLevelByteSize(format,region.imageExtent,imageInfo.arrayLayers);
+		const auto& entry = levelIndex[i];
+		const uint64_t fileLevelSize = header.supercompressionScheme!=ktx2::ESS_NONE ? entry.uncompressedByteLength:entry.byteLength;
+		if (fileLevelSize!=levelSize)
+		{
+			logger.log("LOAD KTX2: %s mip level %u has size %llu, expected %llu!",system::ILogger::ELL_ERROR,fileName.c_str(),baseLevel+i,fileLevelSize,levelSize);
+			return {};
+		}
+		bufferSize += levelSize;
+	}
+
+	auto texelBuffer = ICPUBuffer::create({bufferSize});
+	uint8_t* const texelData = reinterpret_cast<uint8_t*>(texelBuffer->getPointer());
+	if (header.supercompressionScheme==ktx2::ESS_NONE)
+	{
+		for (uint32_t i=0u; i<levelCount; i++)
+		{
+			system::IFile::success_t success;
+			_file->read(success,texelData+regions->operator[](i).bufferOffset,levelIndex[i].byteOffset,levelIndex[i].byteLength);
+			if (!success)
+				return {};
+		}
+	}
+	else
+	{
+		// file reads stay sequential, the inflating of independent level streams doesn't
+		core::vector<uint64_t> compressedOffsets(levelCount+1u,0ull);
+		for (uint32_t i=0u; i<levelCount; i++)
+			compressedOffsets[i+1u] = compressedOffsets[i]+levelIndex[i].byteLength;
+		core::vector<uint8_t> compressed(compressedOffsets.back());
+		for (uint32_t i=0u; i<levelCount; i++)
+		{
+			system::IFile::success_t success;
+			_file->read(success,compressed.data()+compressedOffsets[i],levelIndex[i].byteOffset,levelIndex[i].byteLength);
+			if (!success)
+				return {};
+		}
+
+		core::vector<uint32_t> levels(levelCount);
+		std::iota(levels.begin(),levels.end(),0u);
+		std::atomic_bool success(true);
+		std::for_each(core::execution::par_unseq,levels.begin(),levels.end(),[&](const uint32_t i) -> void
+		{
+			const auto& entry = levelIndex[i];
+			if (!ktx2::decompressLevel(header.supercompressionScheme,compressed.data()+compressedOffsets[i],entry.byteLength,texelData+regions->operator[](i).bufferOffset,entry.uncompressedByteLength))
+				success = false;
+		});
+		if (!success)
+		{
+			logger.log("LOAD KTX2: %s failed to inflate the mip levels!",system::ILogger::ELL_ERROR,fileName.c_str());
+			return {};
+		}
+	}
+
+	ICPUImageView::SComponentMapping components = {};
+	readSwizzle(_file,header,components);
+
+	auto image = ICPUImage::create(std::move(imageInfo));
+	if (!image || !image->setBufferAndRegions(std::move(texelBuffer),regions))
+		return {};
+	image->setContentHash(image->computeContentHash());
+
+	ICPUImageView::SCreationParams imageViewInfo = {};
+	imageViewInfo.image = std::move(image);
+	imageViewInfo.format = format;
+	imageViewInfo.viewType = imageViewType;
+	imageViewInfo.components = components;
+	imageViewInfo.flags = static_cast<ICPUImageView::E_CREATE_FLAGS>(0u);
+	imageViewInfo.subresourceRange.aspectMask = IImage::E_ASPECT_FLAGS::EAF_COLOR_BIT;
+	imageViewInfo.subresourceRange.baseArrayLayer = 0u;
+	imageViewInfo.subresourceRange.baseMipLevel = 0u;
+	imageViewInfo.subresourceRange.layerCount = imageViewInfo.image->getCreationParameters().arrayLayers;
+	imageViewInfo.subresourceRange.levelCount = levelCount;
+
+	auto imageView = ICPUImageView::create(std::move(imageViewInfo));
+	if (!imageView)
+		return {};
+	return SAssetBundle(nullptr,{std::move(imageView)});
+}
+
+}
+
+#endif // _NBL_COMPILE_WITH_KTX2_LOADER_
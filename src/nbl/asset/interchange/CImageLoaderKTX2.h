@@ -0,0 +1,48 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_IMAGE_LOADER_KTX2_H_INCLUDED_
+#define _NBL_ASSET_C_IMAGE_LOADER_KTX2_H_INCLUDED_
+
+#include "BuildConfigOptions.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_LOADER_
+
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/asset/interchange/IAssetLoader.h"
+
+namespace nbl::asset
+{
+
+//! Loader for Khronos KTX2 textures
+/*
+	Only the level index and the levels in [SAssetLoadParams::baseMipLevel,baseMipLevel+mipLevelCount) get read from the file,
+	so a texture streamer can fetch the coarse tail of a mip chain first and refine later. Supercompressed levels are independent
+	streams and get inflated in parallel. Supported supercompression schemes are ZLIB and, when Nabla was built with it, Zstandard.
+	BasisLZ (ETC1S) payloads would need transcoding and are rejected, as are formats without a `VkFormat` (DFD-only files).
+*/
+class CImageLoaderKTX2 final : public IAssetLoader
+{
+	protected:
+		virtual ~CImageLoaderKTX2() {}
+
+	public:
+		explicit CImageLoaderKTX2() = default;
+
+		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override;
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* extensions[]{ "ktx2", nullptr };
+			return extensions;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override { return IAsset::ET_IMAGE_VIEW; }
+
+		SAssetBundle loadAsset(system::IFile* _file, const IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
+};
+
+}
+
+#endif // _NBL_COMPILE_WITH_KTX2_LOADER_
+#endif
@@ -0,0 +1,501 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "CImageWriterKTX2.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_WRITER_
+
+#include "SKTX2.h"
+
+#include <atomic>
+#include <numeric>
+
+namespace nbl::asset
+{
+
+namespace
+{
+
+// Khronos Data Format basic descriptor block, see https://registry.khronos.org/DataFormat/specs/1.3/dataformat.1.3.html
+class CDFDBuilder
+{
+	public:
+		enum E_COLOR_MODEL : uint8_t
+		{
+			ECM_RGBSDA = 1u,
+			ECM_BC1A = 128u,
+			ECM_BC2 = 129u,
+			ECM_BC3 = 130u,
+			ECM_BC4 = 131u,
+			ECM_BC5 = 132u,
+			ECM_BC6H = 133u,
+			ECM_BC7 = 134u,
+			ECM_ETC2 = 161u,
+			ECM_ASTC = 162u,
+			ECM_PVRTC = 164u,
+			ECM_PVRTC2 = 165u
+		};
+		enum E_CHANNEL : uint8_t
+		{
+			EC_R = 0u,
+			EC_G = 1u,
+			EC_B = 2u,
+			EC_A = 15u,
+			// compressed colour models name their channels differently, but the ids overlap
+			EC_BC1A_ALPHA_PRESENT = 1u,
+			EC_ETC2_COLOR = 2u
+		};
+		enum E_QUALIFIER : uint8_t
+		{
+			EQ_LINEAR = 0x10u,
+			EQ_EXPONENT = 0x20u,
+			EQ_SIGNED = 0x40u,
+			EQ_FLOAT = 0x80u
+		};
+
+		explicit CDFDBuilder(const E_FORMAT _format) : format(_format)
+		{
+			const auto blockDims = getBlockDimensions(format);
+			const bool srgb = isSRGBFormat(format);
+			if (isBlockCompressionFormat(format))
+				addCompressedSamples();
+			else if (!addPackedSamples())
+			{
+				const uint32_t channelCount = getFormatChannelCount(format);
+				const uint32_t channelBits = getTexelOrBlockBytesize(format)*8u/channelCount;
+				constexpr E_CHANNEL rgba[4] = {EC_R,EC_G,EC_B,EC_A};
+				constexpr E_CHANNEL bgra[4] = {EC_B,EC_G,EC_R,EC_A};
+				const auto* order = isBGRALayoutFormat(format) ? bgra:rgba;
+				for (uint32_t c=0u; c<channelCount; c++)
+					addSample(order[c],c*channelBits,channelBits);
+			}
+
+			words[0] = 0u; // Khronos vendor, basic descriptor type
+			words[1] = 2u|((24u+16u*sampleCount)<<16u);
+			words[2] = colorModel|(1u<<8u)|((srgb ? 2u:1u)<<16u); // BT709 primaries, straight alpha
+			words[3] = (blockDims.x-1u)|((blockDims.y-1u)<<8u)|((blockDims.z-1u)<<16u);
+			words[4] = getTexelOrBlockBytesize(format);
+			words[5] = 0u;
+		}
+
+		inline uint32_t getByteSize() const {return sizeof(uint32_t)*(1u+6u+4u*sampleCount);}
+		inline void write(uint8_t* dst) const
+		{
+			const uint32_t totalSize = getByteSize();
+			memcpy(dst,&totalSize,sizeof(totalSize));
+			memcpy(dst+sizeof(uint32_t),words,sizeof(uint32_t)*(6u+4u*sampleCount));
+		}
+
+	private:
+		static inline uint32_t asUint(const float f)
+		{
+			uint32_t u;
+			memcpy(&u,&f,sizeof(u));
+			return u;
+		}
+
+		// lower and upper give the values which map to 0 and 1 (or -1 and 1) in the normalized representation
+		inline void addSample(const uint8_t channel, const uint32_t bitOffset, const uint32_t bitLength, uint8_t qualifiers=0u)
+		{
+			const bool isSigned = isSignedFormat(format);
+			uint32_t lower = 0u, upper = 0xffffffffu;
+			if (qualifiers&EQ_EXPONENT)
+			{
+				lower = 15u;
+				upper = 31u;
+			}
+			else if (isFloatingPointFormat(format))
+			{
+				qualifiers |= EQ_FLOAT;
+				lower = asUint(isSigned ? -1.f:0.f);
+				upper = asUint(1.f);
+			}
+			else if (isIntegerFormat(format) || isScaledFormat(format))
+			{
+				lower = isSigned ? 0xffffffffu:0u;
+				upper = 1u;
+			}
+			else if (!isBlockCompressionFormat(format) && bitLength<32u)
+			{
+				const uint32_t maxVal = isSigned ? ((1u<<(bitLength-1u))-1u):((1u<<bitLength)-1u);
+				lower = isSigned ? static_cast<uint32_t>(-static_cast<int32_t>(maxVal)):0u;
+				upper = maxVal;
+			}
+			else if (isSigned)
+			{
+				lower = 0x80000000u;
+				upper = 0x7fffffffu;
+			}
+			if (isSigned)
+				qualifiers |= EQ_SIGNED;
+			if (channel==EC_A && isSRGBFormat(format) && !isBlockCompressionFormat(format))
+				qualifiers |= EQ_LINEAR;
+
+			uint32_t* sample = words+6u+4u*sampleCount++;
+			sample[0] = bitOffset|((bitLength-1u)<<16u)|(uint32_t(channel|qualifiers)<<24u);
+			sample[1] = 0u;
+			sample[2] = lower;
+			sample[3] = upper;
+		}
+
+		inline bool addPackedSamples()
+		{
+			struct SChannel {uint8_t channel, bitOffset, bitLength;};
+			auto add = [this](std::initializer_list<SChannel> channels) -> bool
+			{
+				for (const auto& c : channels)
+					addSample(c.channel,c.bitOffset,c.bitLength);
+				return true;
+			};
+			switch (format)
+			{
+				case EF_R4G4_UNORM_PACK8: return add({{EC_G,0,4},{EC_R,4,4}});
+				case EF_R4G4B4A4_UNORM_PACK16: return add({{EC_A,0,4},{EC_B,4,4},{EC_G,8,4},{EC_R,12,4}});
+				case EF_B4G4R4A4_UNORM_PACK16: return add({{EC_A,0,4},{EC_R,4,4},{EC_G,8,4},{EC_B,12,4}});
+				case EF_R5G6B5_UNORM_PACK16: return add({{EC_B,0,5},{EC_G,5,6},{EC_R,11,5}});
+				case EF_B5G6R5_UNORM_PACK16: return add({{EC_R,0,5},{EC_G,5,6},{EC_B,11,5}});
+				case EF_R5G5B5A1_UNORM_PACK16: return add({{EC_A,0,1},{EC_B,1,5},{EC_G,6,5},{EC_R,11,5}});
+				case EF_B5G5R5A1_UNORM_PACK16: return add({{EC_A,0,1},{EC_R,1,5},{EC_G,6,5},{EC_B,11,5}});
+				case EF_A1R5G5B5_UNORM_PACK16: return add({{EC_B,0,5},{EC_G,5,5},{EC_R,10,5},{EC_A,15,1}});
+				case EF_B10G11R11_UFLOAT_PACK32: return add({{EC_R,0,11},{EC_G,11,11},{EC_B,22,10}});
+				case EF_E5B9G9R9_UFLOAT_PACK32:
+					for (uint8_t c=EC_R; c<=EC_B; c++)
+					{
+						addSample(c,9u*c,9u);
+						addSample(c,27u,5u,EQ_EXPONENT);
+					}
+					return true;
+				default:
+					break;
+			}
+			if (format>=EF_A8B8G8R8_UNORM_PACK32 && format<=EF_A8B8G8R8_SRGB_PACK32)
+				return add({{EC_R,0,8},{EC_G,8,8},{EC_B,16,8},{EC_A,24,8}});
+			if (format>=EF_A2R10G10B10_UNORM_PACK32 && format<=EF_A2R10G10B10_SINT_PACK32)
+				return add({{EC_B,0,10},{EC_G,10,10},{EC_R,20,10},{EC_A,30,2}});
+			if (format>=EF_A2B10G10R10_UNORM_PACK32 && format<=EF_A2B10G10R10_SINT_PACK32)
+				return add({{EC_R,0,10},{EC_G,10,10},{EC_B,20,10},{EC_A,30,2}});
+			return false;
+		}
+
+		inline void addCompressedSamples()
+		{
+			const uint32_t blockBits = getTexelOrBlockBytesize(format)*8u;
+			if (format>=EF_BC1_RGB_UNORM_BLOCK && format<=EF_BC1_RGBA_SRGB_BLOCK)
+			{
+				colorModel = ECM_BC1A;
+				addSample(format>=EF_BC1_RGBA_UNORM_BLOCK ? EC_BC1A_ALPHA_PRESENT:EC_R,0u,64u);
+			}
+			else if (format>=EF_BC2_UNORM_BLOCK && format<=EF_BC3_SRGB_BLOCK)
+			{
+				colorModel = format<=EF_BC2_SRGB_BLOCK ? ECM_BC2:ECM_BC3;
+				addSample(EC_A,0u,64u);
+				addSample(EC_R,64u,64u);
+			}
+			else if (format>=EF_BC4_UNORM_BLOCK && format<=EF_BC5_SNORM_BLOCK)
+			{
+				colorModel = format<=EF_BC4_SNORM_BLOCK ? ECM_BC4:ECM_BC5;
+				addSample(EC_R,0u,64u);
+				if (colorModel==ECM_BC5)
+					addSample(EC_G,64u,64u);
+			}
+			else if (format>=EF_BC6H_UFLOAT_BLOCK && format<=EF_BC7_SRGB_BLOCK)
+			{
+				colorModel = format<=EF_BC6H_SFLOAT_BLOCK ? ECM_BC6H:ECM_BC7;
+				addSample(EC_R,0u,128u);
+			}
+			else if (format>=EF_ASTC_4x4_UNORM_BLOCK && format<=EF_ASTC_12x12_SRGB_BLOCK)
+			{
+				colorModel = ECM_ASTC;
+				addSample(EC_R,0u,128u);
+			}
+			else if (format>=EF_ETC2_R8G8B8_UNORM_BLOCK && format<=EF_ETC2_R8G8B8A8_SRGB_BLOCK)
+			{
+				colorModel = ECM_ETC2;
+				if (format>=EF_ETC2_R8G8B8A8_UNORM_BLOCK)
+				{
+					addSample(EC_A,0u,64u);
+					addSample(EC_ETC2_COLOR,64u,64u);
+				}
+				else
+					addSample(EC_ETC2_COLOR,0u,64u);
+			}
+			else if (format>=EF_EAC_R11_UNORM_BLOCK && format<=EF_EAC_R11G11_SNORM_BLOCK)
+			{
+				colorModel = ECM_ETC2;
+				addSample(EC_R,0u,64u);
+				if (format>=EF_EAC_R11G11_UNORM_BLOCK)
+					addSample(EC_G,64u,64u);
+			}
+			else
+			{
+				const bool pvrtc2 = (format>=EF_PVRTC2_2BPP_UNORM_BLOCK_IMG && format<=EF_PVRTC2_4BPP_UNORM_BLOCK_IMG) || format>=EF_PVRTC2_2BPP_SRGB_BLOCK_IMG;
+				colorModel = pvrtc2 ? ECM_PVRTC2:ECM_PVRTC;
+				addSample(EC_R,0u,blockBits);
+			}
+		}
+
+		const E_FORMAT format;
+		uint8_t colorModel = ECM_RGBSDA;
+		uint32_t sampleCount = 0u;
+		// block header followed by at most 6 samples (E5B9G9R9)
+		uint32_t words[6u+4u*6u] = {};
+};
+
+// copies one mip level of the selected layers out of the image's regions into KTX2's tightly packed layout
+bool gatherLevel(const ICPUImage* image, const uint32_t mipLevel, const uint32_t baseLayer, const uint32_t layerCount, uint8_t* dst)
+{
+	const auto& params = image->getCreationParameters();
+	const auto blockDims = getBlockDimensions(params.format);
+	const uint32_t blockBytes = getTexelOrBlockBytesize(params.format);
+	const auto* src = reinterpret_cast<const uint8_t*>(image->getBuffer()->getPointer());
+
+	auto inBlocks = [&](const uint32_t texels, const uint32_t dim) -> uint32_t {return (texels+dim-1u)/dim;};
+	const uint32_t levelWidth = core::max(params.extent.width>>mipLevel,1u);
+	const uint32_t levelHeight = core::max(params.extent.height>>mipLevel,1u);
+	const uint32_t levelDepth = core::max(params.extent.depth>>mipLevel,1u);
+	const uint64_t dstRowPitch = uint64_t(inBlocks(levelWidth,blockDims.x))*blockBytes;
+	const uint64_t dstSlicePitch = dstRowPitch*inBlocks(levelHeight,blockDims.y);
+	const uint64_t dstLayerPitch = dstSlicePitch*inBlocks(levelDepth,blockDims.z);
+
+	bool anyRegion = false;
+	for (const auto& region : image->getRegions(mipLevel))
+	{
+		const auto& subresource = region.imageSubresource;
+		const uint32_t firstLayer = core::max(subresource.baseArrayLayer,baseLayer);
+		const uint32_t lastLayer = core::min(subresource.baseArrayLayer+subresource.layerCount,baseLayer+layerCount);
+		if (firstLayer>=lastLayer)
+			continue;
+		anyRegion = true;
+
+		const uint32_t rowBlocks = inBlocks(region.imageExtent.width,blockDims.x);
+		const uint32_t sliceRows = inBlocks(region.imageExtent.height,blockDims.y);
+		const uint32_t slices = inBlocks(region.imageExtent.depth,blockDims.z);
+		const uint64_t srcRowPitch = uint64_t(inBlocks(region.bufferRowLength ? region.bufferRowLength:region.imageExtent.width,blockDims.x))*blockBytes;
+		const uint64_t srcSlicePitch = srcRowPitch*inBlocks(region.bufferImageHeight ? region.bufferImageHeight:region.imageExtent.height,blockDims.y);
+		const uint64_t srcLayerPitch = srcSlicePitch*slices;
+		const uint64_t dstRegionOffset = (region.imageOffset.z/blockDims.z)*dstSlicePitch+(region.imageOffset.y/blockDims.y)*dstRowPitch+uint64_t(region.imageOffset.x/blockDims.x)*blockBytes;
+		for (uint32_t layer=firstLayer; layer<lastLayer; layer++)
+		for (uint32_t z=0u; z<slices; z++)
+		for (uint32_t y=0u; y<sliceRows; y++)
+		{
+			const uint64_t srcOffset = region.bufferOffset+(layer-subresource.baseArrayLayer)*srcLayerPitch+z*srcSlicePitch+y*srcRowPitch;
+			const uint64_t dstOffset = (layer-baseLayer)*dstLayerPitch+dstRegionOffset+z*dstSlicePitch+y*dstRowPitch;
+			memcpy(dst+dstOffset,src+srcOffset,uint64_t(rowBlocks)*blockBytes);
+		}
+	}
+	return anyRegion;
+}
+
+}
+
+bool CImageWriterKTX2::writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override)
+{
+	if (!_override)
+		getDefaultOverride(_override);
+
+	SAssetWriteContext ctx{_params,_file};
+	const auto& logger = _params.logger;
+
+	// a view narrows the subresource range down and tells cubemaps apart from arrays, a plain image gets written whole
+	const ICPUImage* image = nullptr;
+	ICPUImageView::E_TYPE viewType;
+	IImage::SSubresourceRange range = {};
+	ICPUImageView::SComponentMapping components = {};
+	if (const auto* imageView=IAsset::castDown<const ICPUImageView>(_params.rootAsset); imageView)
+	{
+		const auto& viewParams = imageView->getCreationParameters();
+		image = viewParams.image.get();
+		viewType = viewParams.viewType;
+		range = viewParams.subresourceRange;
+		components = viewParams.components;
+	}
+	else if ((image=IAsset::castDown<const ICPUImage>(_params.rootAsset)))
+	{
+		const auto& params = image->getCreationParameters();
+		const bool isArray = params.arrayLayers>1u;
+		switch (params.type)
+		{
+			case IImage::ET_1D: viewType = isArray ? ICPUImageView::ET_1D_ARRAY:ICPUImageView::ET_1D; break;
+			case IImage::ET_2D: viewType = isArray ? ICPUImageView::ET_2D_ARRAY:ICPUImageView::ET_2D; break;
+			default: viewType = ICPUImageView::ET_3D; break;
+		}
+		range.levelCount = params.mipLevels;
+		range.layerCount = params.arrayLayers;
+	}
+	if (!image || !image->getBuffer())
+		return false;
+
+	system::IFile* file = _override->getOutputFile(_file,ctx,{_params.rootAsset,0u});
+	if (!file)
+		return false;
+	const auto fileName = file->getFileName().string();
+
+	const auto& imageParams = image->getCreationParameters();
+	const E_FORMAT format = imageParams.format;
+	const uint32_t vkFormat = ktx2::getVkFormat(format);
+	if (vkFormat==0u || isPlanarFormat(format) || isDepthOrStencilFormat(format))
+	{
+		logger.log("WRITE KTX2: %s can't be written, unsupported format %u!",system::ILogger::ELL_ERROR,fileName.c_str(),format);
+		return false;
+	}
+
+	const uint32_t baseLevel = core::min(range.baseMipLevel,imageParams.mipLevels-1u);
+	const uint32_t levelCount = core::min(range.levelCount,imageParams.mipLevels-baseLevel);
+	const uint32_t baseLayer = core::min(range.baseArrayLayer,imageParams.arrayLayers-1u);
+	const uint32_t layerCount = core::min(range.layerCount,imageParams.arrayLayers-baseLayer);
+	const bool isCube = viewType==ICPUImageView::ET_CUBE_MAP || viewType==ICPUImageView::ET_CUBE_MAP_ARRAY;
+	const bool isArray = viewType==ICPUImageView::ET_1D_ARRAY || viewType==ICPUImageView::ET_2D_ARRAY || viewType==ICPUImageView::ET_CUBE_MAP_ARRAY;
+	const uint32_t faceCount = isCube ? 6u:1u;
+	if (levelCount==0u || layerCount==0u || layerCount%faceCount)
+		return false;
+
+	const auto flags = _override->getAssetWritingFlags(ctx,_params.rootAsset,0u);
+	ktx2::E_SUPERCOMPRESSION_SCHEME scheme = ktx2::ESS_NONE;
+	if (flags&EWF_COMPRESSED)
+	{
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+		scheme = ktx2::ESS_ZSTD;
+#else
+		scheme = ktx2::ESS_ZLIB;
+#endif
+	}
+	const float compressionLevel = _override->getAssetCompressionLevel(ctx,_params.rootAsset,0u);
+
+	ktx2::SHeader header = {};
+	memcpy(header.identifier,ktx2::Identifier,sizeof(ktx2::Identifier));
+	header.vkFormat = vkFormat;
+	const bool isPacked = (format>=EF_R4G4_UNORM_PACK8 && format<=EF_A1R5G5B5_UNORM_PACK16) ||
+		(format>=EF_A8B8G8R8_UNORM_PACK32 && format<=EF_A2B10G10R10_SINT_PACK32) ||
+		format==EF_B10G11R11_UFLOAT_PACK32 || format==EF_E5B9G9R9_UFLOAT_PACK32;
+	if (isBlockCompressionFormat(format))
+		header.typeSize = 1u;
+	else if (isPacked)
+		header.typeSize = getTexelOrBlockBytesize(format);
+	else
+		header.typeSize = getTexelOrBlockBytesize(format)/getFormatChannelCount(format);
+	header.pixelWidth = core::max(imageParams.extent.width>>baseLevel,1u);
+	header.pixelHeight = imageParams.type!=IImage::ET_1D ? core::max(imageParams.extent.height>>baseLevel,1u):0u;
+	header.pixelDepth = imageParams.type==IImage::ET_3D ? core::max(imageParams.extent.depth>>baseLevel,1u):0u;
+	header.layerCount = isArray ? layerCount/faceCount:0u;
+	header.faceCount = faceCount;
+	header.levelCount = levelCount;
+	header.supercompressionScheme = scheme;
+
+	// gather and supercompress every level independently
+	core::vector<core::vector<uint8_t>> levelData(levelCount);
+	core::vector<ktx2::SLevelIndexEntry> levelIndex(levelCount);
+	{
+		core::vector<uint32_t> levels(levelCount);
+		std::iota(levels.begin(),levels.end(),0u);
+		std::atomic_bool success(true);
+		std::for_each(core::execution::par_unseq,levels.begin(),levels.end(),[&](const uint32_t i) -> void
+		{
+			const uint32_t mipLevel = baseLevel+i;
+			const VkExtent3D extent = {
+				core::max(imageParams.extent.width>>mipLevel,1u),
+				core::max(imageParams.extent.height>>mipLevel,1u),
+				core::max(imageParams.extent.depth>>mipLevel,1u)
+			};
+			const uint64_t levelSize = ktx2::getLevelByteSize(format,extent,layerCount);
+			core::vector<uint8_t> uncompressed(levelSize);
+			if (!gatherLevel(image,mipLevel,baseLayer,layerCount,uncompressed.data()))
+			{
+				success = false;
+				return;
+			}
+
+			auto& entry = levelIndex[i];
+			entry.uncompressedByteLength = levelSize;
+			if (scheme==ktx2::ESS_NONE)
+				levelData[i] = std::move(uncompressed);
+			else
+			{
+				auto& compressed = levelData[i];
+				compressed.resize(ktx2::getCompressBound(scheme,levelSize));
+				const size_t compressedSize = ktx2::compressLevel(scheme,compressionLevel,uncompressed.data(),levelSize,compressed.data(),compressed.size());
+				if (compressedSize==0ull)
+				{
+					success = false;
+					return;
+				}
+				compressed.resize(compressedSize);
+			}
+			entry.byteLength = levelData[i].size();
+		});
+		if (!success)
+		{
+			logger.log("WRITE KTX2: %s failed to gather or supercompress the mip levels!",system::ILogger::ELL_ERROR,fileName.c_str());
+			return false;
+		}
+	}
+
+	// key/value pairs sorted by key, each padded to 4 bytes
+	core::vector<uint8_t> kvd;
+	auto addKeyValue = [&kvd](const std::string_view key, const std::string_view value) -> void
+	{
+		const uint32_t length = key.size()+value.size()+2u;
+		const size_t offset = kvd.size();
+		kvd.resize(core::alignUp(offset+sizeof(length)+length,sizeof(uint32_t)),0u);
+		memcpy(kvd.data()+offset,&length,sizeof(length));
+		memcpy(kvd.data()+offset+sizeof(length),key.data(),key.size());
+		memcpy(kvd.data()+offset+sizeof(length)+key.size()+1u,value.data(),value.size());
+	};
+	{
+		char swizzle[4];
+		ktx2::writeSwizzle(components,swizzle);
+		if (std::string_view(swizzle,4u)!="rgba")
+			addKeyValue("KTXswizzle",std::string_view(swizzle,4u));
+		addKeyValue("KTXwriter","Nabla");
+	}
+
+	const CDFDBuilder dfd(format);
+	header.dfdByteOffset = sizeof(header)+sizeof(ktx2::SLevelIndexEntry)*levelCount;
+	header.dfdByteLength = dfd.getByteSize();
+	header.kvdByteOffset = header.dfdByteOffset+header.dfdByteLength;
+	header.kvdByteLength = kvd.size();
+	header.sgdByteOffset = 0ull;
+	header.sgdByteLength = 0ull;
+
+	// smallest level goes first, so reading the file sequentially yields a usable texture as early as possible
+	const size_t alignment = scheme==ktx2::ESS_NONE ? std::lcm<size_t>(getTexelOrBlockBytesize(format),4u):1ull;
+	size_t fileSize = header.kvdByteOffset+header.kvdByteLength;
+	for (uint32_t i=levelCount; i--;)
+	{
+		levelIndex[i].byteOffset = core::alignUp(fileSize,alignment);
+		fileSize = levelIndex[i].byteOffset+levelIndex[i].byteLength;
+	}
+
+	// everything up to the smallest level in one write, zeroed padding included
+	core::vector<uint8_t> prologue(levelIndex.back().byteOffset,0u);
+	memcpy(prologue.data(),&header,sizeof(header));
+	memcpy(prologue.data()+sizeof(header),levelIndex.data(),sizeof(ktx2::SLevelIndexEntry)*levelCount);
+	dfd.write(prologue.data()+header.dfdByteOffset);
+	if (!kvd.empty())
+		memcpy(prologue.data()+header.kvdByteOffset,kvd.data(),kvd.size());
+
+	system::IFile::success_t success;
+	file->write(success,prologue.data(),0ull,prologue.size());
+	if (!success)
+		return false;
+	size_t writeOffset = prologue.size();
+	for (uint32_t i=levelCount; i--;)
+	{
+		const auto& entry = levelIndex[i];
+		if (entry.byteOffset!=writeOffset)
+		{
+			const uint8_t padding[32] = {};
+			file->write(success,padding,writeOffset,entry.byteOffset-writeOffset);
+			if (!success)
+				return false;
+		}
+		file->write(success,levelData[i].data(),entry.byteOffset,entry.byteLength);
+		if (!success)
+			return false;
+		writeOffset = entry.byteOffset+entry.byteLength;
+	}
+	return true;
+}
+
+}
+
+#endif // _NBL_COMPILE_WITH_KTX2_WRITER_
@@ -0,0 +1,50 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_C_IMAGE_WRITER_KTX2_H_INCLUDED_
+#define _NBL_ASSET_C_IMAGE_WRITER_KTX2_H_INCLUDED_
+
+#include "BuildConfigOptions.h"
+
+#ifdef _NBL_COMPILE_WITH_KTX2_WRITER_
+
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/asset/interchange/IAssetWriter.h"
+
+namespace nbl::asset
+{
+
+//! Writer for Khronos KTX2 textures
+/*
+	Accepts an ICPUImageView (its subresource range, cube-ness and swizzle get written out) or a whole ICPUImage.
+	Mip levels are stored smallest first, so a streamer reading the file front to back gets the coarse levels first.
+	`EWF_COMPRESSED` supercompresses every level as an independent stream (in parallel), with Zstandard when Nabla was
+	built with it and ZLIB otherwise, `compressionLevel` in [0,1] maps onto the codec's level range.
+*/
+class CImageWriterKTX2 final : public IAssetWriter
+{
+	protected:
+		virtual ~CImageWriterKTX2() {}
+
+	public:
+		explicit CImageWriterKTX2() = default;
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* extensions[]{ "ktx2", nullptr };
+			return extensions;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override { return IAsset::ET_IMAGE_VIEW|IAsset::ET_IMAGE; }
+
+		uint32_t getSupportedFlags() override { return EWF_BINARY|EWF_COMPRESSED; }
+
+		uint32_t getForcedFlags() override { return EWF_BINARY; }
+
+		bool writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override = nullptr) override;
+};
+
+}
+
+#endif // _NBL_COMPILE_WITH_KTX2_WRITER_
+#endif
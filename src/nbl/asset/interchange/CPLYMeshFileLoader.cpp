@@ -8,7 +8,9 @@
 #include "CPLYMeshFileLoader.h"
 
 #include <numeric>
+#include <charconv>
 
+#include "nbl/core/execution.h"
 #include "nbl/asset/IAssetManager.h"
 
 #include "nbl/system/ISystem.h"
@@ -55,6 +57,163 @@ inline T byteswap(const T& v)
 	return retval;
 }
 
+// Swaps `count` words `stride` bytes apart in place. Shifts and masks over aligned words rather than byte copies,
+// when the words are tightly packed compilers turn the loop into vector byte shuffles.
+template<typename T>
+inline void byteswapWords(uint8_t* const data, const size_t count, const size_t stride)
+{
+	auto swap = [](const T word)->T
+	{
+		if constexpr (sizeof(T)==8)
+			return (T(core::Byteswap::byteswap(uint32_t(word)))<<32)|core::Byteswap::byteswap(uint32_t(word>>32));
+		else
+			return core::Byteswap::byteswap(word);
+	};
+	if (stride==sizeof(T))
+	{
+		auto* const words = reinterpret_cast<T*>(data);
+		for (size_t i=0; i<count; i++)
+			words[i] = swap(words[i]);
+	}
+	else
+	for (size_t i=0; i<count; i++)
+	{
+		auto& word = *reinterpret_cast<T*>(data+i*stride);
+		word = swap(word);
+	}
+}
+
+// turn single channel format to multiple
+inline E_FORMAT getMultiChannelFormat(const E_FORMAT componentFormat, const uint32_t componentCount)
+{
+	switch (componentFormat)
+	{
+		case EF_R8_SINT:
+			switch (componentCount)
+			{
+				case 1:
+					return EF_R8_SINT;
+				case 2:
+					return EF_R8G8_SINT;
+				case 3:
+					return EF_R8G8B8_SINT;
+				case 4:
+					return EF_R8G8B8A8_SINT;
+				default:
+					break;
+			}
+			break;
+		case EF_R8_UINT:
+			switch (componentCount)
+			{
+				case 1:
+					return EF_R8_UINT;
+				case 2:
+					return EF_R8G8_UINT;
+				case 3:
+					return EF_R8G8B8_UINT;
+				case 4:
+					return EF_R8G8B8A8_UINT;
+				default:
+					break;
+			}
+			break;
+		case EF_R16_SINT:
+			switch (componentCount)
+			{
+				case 1:
+					return EF_R16_SINT;
+				case 2:
+					return EF_R16G16_SINT;
+				case 3:
+					return EF_R16G16B16_SINT;
+				case 4:
+					return EF_R16G16B16A16_SINT;
+				default:
+					break;
+			}
+			break;
+		case EF_R16_UINT:
+			switch (componentCount)
+			{
+				case 1:
+					return EF_R16_UINT;
+				case 2:
+					return EF_R16G16_UINT;
+				case 3:
+					return EF_R16G16B16_UINT;
+				case 4:
+					return EF_R16G16B16A16_UINT;
+				default:
+					break;
+			}
+			break;
+		case EF_R32_SINT:
+			switch (componentCount)
+			{
+				case 1:
+					return EF_R32_SINT;
+				case 2:
+					return EF_R32G32_SINT;
+				case 3:
+					return EF_R32G32B32_SINT;
+				case 4:
+					return EF_R32G32B32A32_SINT;
+				default:
+					break;
+			}
+			break;
+		case EF_R32_UINT:
+			switch (componentCount)
+			{
+				case 1:
+					return EF_R32_UINT;
+				case 2:
+					return EF_R32G32_UINT;
+				case 3:
+					return EF_R32G32B32_UINT;
+				case 4:
+					return EF_R32G32B32A32_UINT;
+				default:
+					break;
+			}
+			break;
+		case EF_R32_SFLOAT:
+			switch (componentCount)
+			{
+				case 1:
+					return EF_R32_SFLOAT;
+				case 2:
+					return EF_R32G32_SFLOAT;
+				case 3:
+					return EF_R32G32B32_SFLOAT;
+				case 4:
+					return EF_R32G32B32A32_SFLOAT;
+				default:
+					break;
+			}
+			break;
+		case EF_R64_SFLOAT:
+			switch (componentCount)
+			{
+				case 1:
+					return EF_R64_SFLOAT;
+				case 2:
+					return EF_R64G64_SFLOAT;
+				case 3:
+					return EF_R64G64B64_SFLOAT;
+				case 4:
+					return EF_R64G64B64A64_SFLOAT;
+				default:
+					break;
+			}
+			break;
+		default:
+			break;
+	}
+	return EF_UNKNOWN;
+}
+
 struct SContext
 {
 	
@@ -71,9 +230,9 @@ struct SContext
 				return EF_R16_SINT;
 			else if (strcmp(typeString, "ushort")==0 || strcmp(typeString, "uint16")==0)
 				return EF_R16_UINT;
-			else if (strcmp(typeString, "long")==0 || strcmp(typeString, "int")==0 || strcmp(typeString, "int16")==0)
+			else if (strcmp(typeString, "long")==0 || strcmp(typeString, "int")==0 || strcmp(typeString, "int32")==0)
 				return EF_R32_SINT;
-			else if (strcmp(typeString, "ulong")==0 || strcmp(typeString, "uint16")==0)
+			else if (strcmp(typeString, "ulong")==0 || strcmp(typeString, "uint")==0 || strcmp(typeString, "uint32")==0)
 				return EF_R32_UINT;
 			else if (strcmp(typeString, "float")==0 || strcmp(typeString, "float32")==0)
 				return EF_R32_SFLOAT;
@@ -114,7 +273,7 @@ struct SContext
 		{
 			if (_ctx.IsBinaryFile)
 			{
-				if (KnownSize)
+				if (!HasList)
 					_ctx.moveForward(KnownSize);
 				else
 				for (auto i=0u; i<Properties.size(); ++i)
@@ -133,6 +292,8 @@ struct SContext
 		size_t Count;
 		// known size in bytes, 0 if unknown
 		uint32_t KnownSize;
+		// lists make the size vary per element
+		bool HasList = false;
 	};
 
 	inline void init()
@@ -347,7 +508,7 @@ struct SContext
 			}
 			return 0;
 		}
-		return std::atoi(getNextWord());
+		return std::atof(getNextWord());
 	}
 	// read the next thing from the file and move the start pointer along
 	void getData(void* dst, const E_FORMAT f)
@@ -388,8 +549,8 @@ struct SContext
 				prop.skip(*this);
 				continue;
 			}
-			// conversion required? 
-			if (it.dstFmt!=prop.type)
+			// conversion required? (always for text)
+			if (it.dstFmt!=prop.type || !IsBinaryFile)
 			{
 				assert(isIntegerFormat(it.dstFmt)==isIntegerFormat(prop.type));
 				if (isIntegerFormat(it.dstFmt))
@@ -409,6 +570,280 @@ struct SContext
 			it.ptr += it.stride;
 		}
 	}
+	// Parses the lines of a vertex element without lists starting at `offset` into `vertAttrIts`, a window of the file at a time.
+	// Windows get split into chunks of whole lines, the lines of every chunk get counted and then parsed in parallel.
+	// Returns the file offset past the element's last line, or 0 on failure.
+	size_t readVerticesASCII(const SElement& el, size_t offset) const
+	{
+		assert(!IsBinaryFile && !el.HasList);
+		assert(el.Properties.size()==vertAttrIts.size());
+		constexpr size_t WindowSize = 64ull<<20;
+		constexpr size_t ChunkSize = 1ull<<20;
+		
+		const size_t fileSize = inner.mainFile->getSize();
+		core::vector<char> window;
+		core::vector<size_t> chunkBegins, chunkLines;
+		core::vector<uint32_t> chunks;
+		for (size_t done=0; done<el.Count;)
+		{
+			if (offset>=fileSize)
+				return 0;
+			const size_t readSize = core::min(WindowSize,fileSize-offset);
+			window.resize(readSize+1);
+			system::IFile::success_t success;
+			inner.mainFile->read(success,window.data(),offset,readSize);
+			if (!success)
+				return 0;
+			// only whole lines get parsed, the rest gets read again with the next window, the last line of the file might lack a newline
+			size_t usable = readSize;
+			if (offset+readSize==fileSize)
+			{
+				if (window[readSize-1]!='\n')
+					window[usable++] = '\n';
+			}
+			else
+			{
+				while (usable && window[usable-1]!='\n')
+					usable--;
+				// line longer than the window
+				if (!usable)
+					return 0;
+			}
+
+			const char* const data = window.data();
+			chunkBegins.clear();
+			for (size_t begin=0; begin<usable;)
+			{
+				chunkBegins.push_back(begin);
+				begin = std::distance(data,std::find(data+core::min(begin+ChunkSize,usable)-1,data+usable,'\n'))+1;
+			}
+			chunkBegins.push_back(usable);
+			const auto chunkCount = static_cast<uint32_t>(chunkBegins.size()-1);
+			chunks.resize(chunkCount);
+			std::iota(chunks.begin(),chunks.end(),0u);
+			chunkLines.assign(chunkCount+1,0);
+			std::for_each(core::execution::par_unseq,chunks.begin(),chunks.end(),[&](const uint32_t chunk)->void
+			{
+				chunkLines[chunk+1] = std::count(data+chunkBegins[chunk],data+chunkBegins[chunk+1],'\n');
+			});
+			// first line of every chunk
+			std::inclusive_scan(chunkLines.begin(),chunkLines.end(),chunkLines.begin());
+
+			const size_t remaining = el.Count-done;
+			std::atomic_bool failed = false;
+			std::for_each(core::execution::par,chunks.begin(),chunks.end(),[&](const uint32_t chunk)->void
+			{
+				const char* it = data+chunkBegins[chunk];
+				for (size_t line=chunkLines[chunk]; line<chunkLines[chunk+1] && line<remaining; line++)
+				{
+					const char* const lineEnd = std::find(it,data+chunkBegins[chunk+1],'\n');
+					if (!parseVertex(el,it,lineEnd,done+line))
+						failed = true;
+					it = lineEnd+1;
+				}
+			});
+			if (failed)
+				return 0;
+
+			if (chunkLines.back()>=remaining)
+			{
+				// the rest of the window belongs to the next elements
+				const auto chunk = std::distance(chunkLines.begin(),std::upper_bound(chunkLines.begin(),chunkLines.end(),remaining-1))-1;
+				const char* it = data+chunkBegins[chunk];
+				for (size_t line=chunkLines[chunk]; line<remaining; line++)
+					it = std::find(it,data+usable,'\n')+1;
+				return core::min(offset+std::distance(data,it),fileSize);
+			}
+			done += chunkLines.back();
+			offset += usable;
+		}
+		return offset;
+	}
+	// parses the properties of vertex `vertexIx` from a line
+	bool parseVertex(const SElement& el, const char* it, const char* const lineEnd, const size_t vertexIx) const
+	{
+		auto isWhiteSpace = [](const char c)->bool{return c==' ' || c=='\t' || c=='\r';};
+		for (auto i=0u; i<vertAttrIts.size(); i++)
+		{
+			it = std::find_if_not(it,lineEnd,isWhiteSpace);
+			// `from_chars` doesn't take an explicit plus sign
+			if (it!=lineEnd && *it=='+')
+				it++;
+			const auto& prop = el.Properties[i];
+			const auto& attr = vertAttrIts[i];
+			uint8_t* const dst = attr.ptr ? (attr.ptr+vertexIx*attr.stride):nullptr;
+			std::from_chars_result result;
+			if (isIntegerFormat(prop.type))
+			{
+				int64_t value;
+				result = std::from_chars(it,lineEnd,value);
+				if (dst)
+				{
+					uint64_t tmp = value;
+					encodePixels(attr.dstFmt,dst,&tmp);
+				}
+			}
+			else
+			{
+				hlsl::float64_t value;
+				result = std::from_chars(it,lineEnd,value);
+				if (dst)
+					encodePixels(attr.dstFmt,dst,&value);
+			}
+			if (result.ec!=std::errc())
+				return false;
+			it = result.ptr;
+		}
+		return true;
+	}
+	// Binary vertex elements without lists whose position and normal components are consecutive, of the same type and everything aligned
+	// can be used in place, as interleaved views into one buffer over the element's data.
+	struct SInPlaceLayout
+	{
+		explicit inline operator bool() const {return stride!=0u;}
+
+		struct SView
+		{
+			E_FORMAT format = EF_UNKNOWN;
+			uint32_t offset = 0u;
+		};
+		SView position = {}, normal = {};
+		core::vector<SView> aux = {};
+		uint32_t stride = 0u;
+	};
+	SInPlaceLayout getInPlaceLayout(const SElement& el) const
+	{
+		if (!IsBinaryFile || el.HasList || el.KnownSize==0u || el.Count==0u)
+			return {};
+
+		SInPlaceLayout retval = {};
+		std::array<int32_t,3> position = {-1,-1,-1}, normal = {-1,-1,-1};
+		core::vector<uint32_t> offsets(el.Properties.size());
+		uint32_t offset = 0u;
+		for (auto i=0u; i<el.Properties.size(); i++)
+		{
+			const auto& prop = el.Properties[i];
+			const auto size = getTexelOrBlockBytesize(prop.type);
+			// alignment is needed for decoding in place and for vertex input
+			if (offset%size || el.KnownSize%size)
+				return {};
+			offsets[i] = offset;
+			offset += size;
+			auto setComponent = [i](std::array<int32_t,3>& components, const uint8_t component)->bool
+			{
+				if (components[component]>=0)
+					return false;
+				components[component] = i;
+				return true;
+			};
+			bool unique = true;
+			if (prop.Name=="x")
+				unique = setComponent(position,0);
+			else if (prop.Name=="y")
+				unique = setComponent(position,1);
+			else if (prop.Name=="z")
+				unique = setComponent(position,2);
+			else if (prop.Name=="nx")
+				unique = setComponent(normal,0);
+			else if (prop.Name=="ny")
+				unique = setComponent(normal,1);
+			else if (prop.Name=="nz")
+				unique = setComponent(normal,2);
+			else
+				retval.aux.push_back({.format=prop.type,.offset=offsets[i]});
+			if (!unique)
+				return {};
+		}
+		assert(offset==el.KnownSize);
+
+		auto getGroupView = [&](const std::array<int32_t,3>& components, SInPlaceLayout::SView& view)->bool
+		{
+			uint32_t count = 0u;
+			while (count<3u && components[count]>=0)
+				count++;
+			if (std::any_of(components.begin()+count,components.end(),[](const int32_t c)->bool{return c>=0;}))
+				return false;
+			if (count==0u)
+				return true;
+			const auto& first = el.Properties[components[0]];
+			const auto size = getTexelOrBlockBytesize(first.type);
+			for (auto c=1u; c<count; c++)
+			if (el.Properties[components[c]].type!=first.type || offsets[components[c]]!=offsets[components[0]]+c*size)
+				return false;
+			view = {.format=getMultiChannelFormat(first.type,count),.offset=offsets[components[0]]};
+			return view.format!=EF_UNKNOWN;
+		};
+		if (!getGroupView(position,retval.position) || !getGroupView(normal,retval.normal))
+			return {};
+		retval.stride = el.KnownSize;
+		return retval;
+	}
+	// big endian data read into `data` gets swapped in place, a property at a time in parallel over blocks of vertices
+	void byteswapVertices(const SElement& el, uint8_t* const data) const
+	{
+		assert(IsWrongEndian && !el.HasList);
+		constexpr size_t BlockSize = 0x1ull<<16;
+		const uint32_t stride = el.KnownSize;
+		core::vector<uint32_t> blocks((el.Count+BlockSize-1)/BlockSize);
+		std::iota(blocks.begin(),blocks.end(),0u);
+		const bool uniform = std::all_of(el.Properties.begin(),el.Properties.end(),[&](const SProperty& prop)->bool
+		{
+			return getTexelOrBlockBytesize(prop.type)==getTexelOrBlockBytesize(el.Properties.front().type);
+		});
+		std::for_each(core::execution::par_unseq,blocks.begin(),blocks.end(),[&](const uint32_t block)->void
+		{
+			const size_t first = block*BlockSize;
+			const size_t count = core::min(BlockSize,el.Count-first);
+			uint8_t* const blockData = data+first*stride;
+			auto swap = [](const uint32_t size, uint8_t* const words, const size_t count, const size_t stride)->void
+			{
+				switch (size)
+				{
+					case 2:
+						byteswapWords<uint16_t>(words,count,stride);
+						break;
+					case 4:
+						byteswapWords<uint32_t>(words,count,stride);
+						break;
+					case 8:
+						byteswapWords<uint64_t>(words,count,stride);
+						break;
+					default:
+						break;
+				}
+			};
+			// all properties the same size means the whole block is one run of words
+			if (uniform)
+			{
+				const auto size = getTexelOrBlockBytesize(el.Properties.front().type);
+				swap(size,blockData,count*stride/size,size);
+				return;
+			}
+			uint32_t offset = 0u;
+			for (const auto& prop : el.Properties)
+			{
+				const auto size = getTexelOrBlockBytesize(prop.type);
+				swap(size,blockData+offset,count,stride);
+				offset += size;
+			}
+		});
+	}
+	// file offset of a position in `Buffer`
+	inline size_t getFileOffset(const char* const ptr) const
+	{
+		return fileOffset-std::distance(ptr,const_cast<const char*>(EndPointer));
+	}
+	// drops the buffered data and continues reading from `offset`
+	inline void seek(const size_t offset)
+	{
+		fileOffset = offset;
+		EndOfFile = false;
+		EndPointer = StartPointer = Buffer.data();
+		LineEndPointer = EndPointer-1;
+		WordLength = -1;
+		fillBuffer();
+	}
+
 	bool readFace(const SElement& Element, core::vector<uint32_t>& _outIndices)
 	{
 		if (!IsBinaryFile)
@@ -521,7 +956,8 @@ SAssetBundle CPLYMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 				prop.type = prop.getType(word);
 				if (prop.type==EF_UNKNOWN)
 				{
-					el.KnownSize = false;
+					el.KnownSize = 0;
+					el.HasList = true;
 
 					word = ctx.getNextWord();
 
@@ -547,7 +983,7 @@ SAssetBundle CPLYMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 					_params.logger.log("Cannot read binary PLY file containing data types of unknown length %s", system::ILogger::ELL_ERROR, word);
 					continueReading = false;
 				}
-				else
+				else if (!el.HasList)
 					el.KnownSize += getTexelOrBlockBytesize(prop.type);
 
 				prop.Name = ctx.getNextWord();
@@ -638,17 +1074,64 @@ SAssetBundle CPLYMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 				_params.logger.log("Multiple `vertex` elements not supported!", system::ILogger::ELL_ERROR);
 				return {};
 			}
+			// binary vertices get used as they are in the file whenever possible, mapped or with a single read
+			if (const auto layout=ctx.getInPlaceLayout(el); layout)
+			{
+				const size_t offset = ctx.getFileOffset(ctx.StartPointer);
+				const size_t size = el.Count*layout.stride;
+				auto buffer = createBuffer(core::smart_refctd_ptr<system::IFile>(_file),offset,size,ctx.IsWrongEndian);
+				if (buffer)
+				{
+					if (ctx.IsWrongEndian)
+						ctx.byteswapVertices(el,reinterpret_cast<uint8_t*>(buffer->getPointer()));
+					auto createInPlaceView = [&](const SContext::SInPlaceLayout::SView& view)->ICPUPolygonGeometry::SDataView
+					{
+						return {
+							.composed = {
+								.stride = layout.stride,
+								.format = view.format,
+								.rangeFormat = IGeometryBase::getMatchingAABBFormat(view.format)
+							},
+							// ends with the view's last element, not a whole stride after it, so the view stays within the buffer
+							.src = {.offset=view.offset,.size=(el.Count-1ull)*layout.stride+getTexelOrBlockBytesize(view.format),.buffer=core::smart_refctd_ptr(buffer)}
+						};
+					};
+					if (layout.position.format!=EF_UNKNOWN)
+						geometry->setPositionView(createInPlaceView(layout.position));
+					if (layout.normal.format!=EF_UNKNOWN)
+						geometry->setNormalView(createInPlaceView(layout.normal));
+// TODO: record the property names
+					for (const auto& aux : layout.aux)
+						geometry->getAuxAttributeViews()->push_back(createInPlaceView(aux));
+					ctx.seek(offset+size);
+					verticesProcessed = true;
+					continue;
+				}
+			}
+
+			// every property gets converted into its own view or a channel of the position or normal view
+			ctx.vertAttrIts.assign(el.Properties.size(),{.ptr=nullptr});
 			ICPUPolygonGeometry::SDataViewBase posView = {}, normalView = {};
-			for (auto& vertexProperty : el.Properties)
+			struct SChannel
+			{
+				const ICPUPolygonGeometry::SDataViewBase* view = nullptr;
+				uint8_t component = 0;
+			};
+			core::vector<SChannel> channels(el.Properties.size());
+			for (auto i=0u; i<el.Properties.size(); i++)
 			{
+				const auto& vertexProperty = el.Properties[i];
+				if (vertexProperty.isList())
+					continue;
 				const auto& propertyName = vertexProperty.Name;
 				// only positions and normals need to be structured/canonicalized in any way
-				auto negotiateFormat = [&vertexProperty](ICPUPolygonGeometry::SDataViewBase& view, const uint8_t component)->void
+				auto negotiateFormat = [&vertexProperty,&channels,i](ICPUPolygonGeometry::SDataViewBase& view, const uint8_t component)->void
 				{
 					assert(getFormatChannelCount(vertexProperty.type)!=0);
 					if (getTexelOrBlockBytesize(vertexProperty.type)>getTexelOrBlockBytesize(view.format))
 						view.format = vertexProperty.type;
 					view.stride = hlsl::max<uint32_t>(view.stride,component);
+					channels[i] = {.view=&view,.component=component};
 				};
 				if (propertyName=="x")
 					negotiateFormat(posView,0);
@@ -665,182 +1148,50 @@ SAssetBundle CPLYMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 				else
 				{
 // TODO: record the `propertyName`
-					geometry->getAuxAttributeViews()->push_back(createView(vertexProperty.type,el.Count));
+					auto& view = geometry->getAuxAttributeViews()->emplace_back(createView(vertexProperty.type,el.Count));
+					ctx.vertAttrIts[i] = {
+						.ptr = reinterpret_cast<uint8_t*>(view.src.buffer->getPointer())+view.src.offset,
+						.stride = getTexelOrBlockBytesize(view.composed.format),
+						.dstFmt = view.composed.format
+					};
 				}
 			}
-			auto setFinalFormat = [&ctx](ICPUPolygonGeometry::SDataViewBase& view)->void
+			auto createMultiChannelView = [&](ICPUPolygonGeometry::SDataViewBase& viewBase)->ICPUPolygonGeometry::SDataView
 			{
-				const auto componentFormat = view.format;
-				const auto componentCount = view.stride+1;
-				// turn single channel format to multiple
-				view.format = [=]()->E_FORMAT
-				{
-					switch (view.format)
-					{
-						case EF_R8_SINT:
-							switch (componentCount)
-							{
-								case 1:
-									return EF_R8_SINT;
-								case 2:
-									return EF_R8G8_SINT;
-								case 3:
-									return EF_R8G8B8_SINT;
-								case 4:
-									return EF_R8G8B8A8_SINT;
-								default:
-									break;
-							}
-							break;
-						case EF_R8_UINT:
-							switch (componentCount)
-							{
-								case 1:
-									return EF_R8_UINT;
-								case 2:
-									return EF_R8G8_UINT;
-								case 3:
-									return EF_R8G8B8_UINT;
-								case 4:
-									return EF_R8G8B8A8_UINT;
-								default:
-									break;
-							}
-							break;
-						case EF_R16_SINT:
-							switch (componentCount)
-							{
-								case 1:
-									return EF_R16_SINT;
-								case 2:
-									return EF_R16G16_SINT;
-								case 3:
-									return EF_R16G16B16_SINT;
-								case 4:
-									return EF_R16G16B16A16_SINT;
-								default:
-									break;
-							}
-							break;
-						case EF_R16_UINT:
-							switch (componentCount)
-							{
-								case 1:
-									return EF_R16_UINT;
-								case 2:
-									return EF_R16G16_UINT;
-								case 3:
-									return EF_R16G16B16_UINT;
-								case 4:
-									return EF_R16G16B16A16_UINT;
-								default:
-									break;
-							}
-							break;
-						case EF_R32_SINT:
-							switch (componentCount)
-							{
-								case 1:
-									return EF_R32_SINT;
-								case 2:
-									return EF_R32G32_SINT;
-								case 3:
-									return EF_R32G32B32_SINT;
-								case 4:
-									return EF_R32G32B32A32_SINT;
-								default:
-									break;
-							}
-							break;
-						case EF_R32_UINT:
-							switch (componentCount)
-							{
-								case 1:
-									return EF_R32_UINT;
-								case 2:
-									return EF_R32G32_UINT;
-								case 3:
-									return EF_R32G32B32_UINT;
-								case 4:
-									return EF_R32G32B32A32_UINT;
-								default:
-									break;
-							}
-							break;
-						case EF_R32_SFLOAT:
-							switch (componentCount)
-							{
-								case 1:
-									return EF_R32_SFLOAT;
-								case 2:
-									return EF_R32G32_SFLOAT;
-								case 3:
-									return EF_R32G32B32_SFLOAT;
-								case 4:
-									return EF_R32G32B32A32_SFLOAT;
-								default:
-									break;
-							}
-							break;
-						case EF_R64_SFLOAT:
-							switch (componentCount)
-							{
-								case 1:
-									return EF_R64_SFLOAT;
-								case 2:
-									return EF_R64G64_SFLOAT;
-								case 3:
-									return EF_R64G64B64_SFLOAT;
-								case 4:
-									return EF_R64G64B64A64_SFLOAT;
-								default:
-									break;
-							}
-							break;
-						default:
-							break;
-					}
-					return EF_UNKNOWN;
-				}();
-				view.stride = getTexelOrBlockBytesize(view.format);
-				//
-				for (auto c=0u; c<componentCount; c++)
-				{
-					size_t offset = getTexelOrBlockBytesize(componentFormat)*c;
-					ctx.vertAttrIts.push_back({
-						.ptr = reinterpret_cast<uint8_t*>(offset),
-						.stride = view.stride,
+				const auto componentFormat = viewBase.format;
+				const auto componentCount = viewBase.stride+1;
+				auto view = createView(getMultiChannelFormat(componentFormat,componentCount),el.Count);
+				auto* const basePtr = reinterpret_cast<uint8_t*>(view.src.buffer->getPointer())+view.src.offset;
+				for (auto i=0u; i<channels.size(); i++)
+				if (channels[i].view==&viewBase)
+					ctx.vertAttrIts[i] = {
+						.ptr = basePtr+getTexelOrBlockBytesize(componentFormat)*channels[i].component,
+						.stride = view.composed.stride,
 						.dstFmt = componentFormat
-					});
-				}
+					};
+				return view;
 			};
 			if (posView.format!=EF_UNKNOWN)
-			{
-				auto beginIx = ctx.vertAttrIts.size();
-				setFinalFormat(posView);
-				auto view = createView(posView.format,el.Count);
-				for (const auto size=ctx.vertAttrIts.size(); beginIx!=size; beginIx++)
-					ctx.vertAttrIts[beginIx].ptr += ptrdiff_t(view.src.buffer->getPointer())+view.src.offset;
-				geometry->setPositionView(std::move(view));
-			}
+				geometry->setPositionView(createMultiChannelView(posView));
 			if (normalView.format!=EF_UNKNOWN)
+				geometry->setNormalView(createMultiChannelView(normalView));
+			// loop through vertex properties
+			if (!ctx.IsBinaryFile && !el.HasList)
 			{
-				auto beginIx = ctx.vertAttrIts.size();
-				setFinalFormat(normalView);
-				auto view = createView(normalView.format,el.Count);
-				for (const auto size=ctx.vertAttrIts.size(); beginIx!=size; beginIx++)
-					ctx.vertAttrIts[beginIx].ptr += ptrdiff_t(view.src.buffer->getPointer())+view.src.offset;
-				geometry->setNormalView(std::move(view));
+				// the previous line has been consumed, unless its CRLF got split by the end of the buffer
+				const char* lineStart = ctx.LineEndPointer+1;
+				if (lineStart<ctx.EndPointer && *lineStart=='\n')
+					lineStart++;
+				const size_t end = ctx.readVerticesASCII(el,ctx.getFileOffset(lineStart));
+				if (!end)
+				{
+					_params.logger.log("Failed to parse PLY vertices in %s", system::ILogger::ELL_ERROR,ctx.inner.mainFile->getFileName().string().c_str());
+					return {};
+				}
+				ctx.seek(end);
 			}
-			//
-			for (auto& view : *geometry->getAuxAttributeViews())
-				ctx.vertAttrIts.push_back({
-					.ptr = reinterpret_cast<uint8_t*>(view.src.buffer->getPointer())+view.src.offset,
-					.stride = getTexelOrBlockBytesize(view.composed.format),
-					.dstFmt = view.composed.format
-				});
-			// loop through vertex properties
-			ctx.readVertex(_params,el);
+			else
+				ctx.readVertex(_params,el);
 			verticesProcessed = true;
 		}
 		else if (el.Name=="face")
@@ -858,7 +1209,16 @@ SAssetBundle CPLYMeshFileLoader::loadAsset(system::IFile* _file, const IAssetLoa
 
 	// do before indices so we don't compute their stuff again
 	CPolygonGeometryManipulator::recomputeContentHashes(geometry.get());
-	CPolygonGeometryManipulator::recomputeRanges(geometry.get());
+	{
+		// same as `CPolygonGeometryManipulator::recomputeRanges`, but the views are independent so they can go in parallel
+		core::vector<const ICPUPolygonGeometry::SDataView*> views = {&geometry->getPositionView(),&geometry->getNormalView()};
+		for (const auto& view : *geometry->getAuxAttributeViews())
+			views.push_back(&view);
+		std::for_each(core::execution::par,views.begin(),views.end(),[](const ICPUPolygonGeometry::SDataView* view)->void
+		{
+			CGeometryManipulator::recomputeRange(const_cast<ICPUPolygonGeometry::SDataView&>(*view));
+		});
+	}
 
 	if (indices.empty())
 	{
@@ -0,0 +1,243 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#ifndef _NBL_ASSET_S_KTX2_H_INCLUDED_
+#define _NBL_ASSET_S_KTX2_H_INCLUDED_
+
+#include "BuildConfigOptions.h"
+
+#include "nbl/asset/format/EFormat.h"
+#include "nbl/asset/ICPUImageView.h"
+
+#include <zlib/zlib.h>
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+#include <zstd.h>
+#endif
+
+#include <cstring>
+#include <string_view>
+
+//! Structures and helpers shared by the KTX2 loader and writer, see https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+namespace nbl::asset::ktx2
+{
+
+constexpr uint8_t Identifier[12] = {0xABu,0x4Bu,0x54u,0x58u,0x20u,0x32u,0x30u,0xBBu,0x0Du,0x0Au,0x1Au,0x0Au};
+
+enum E_SUPERCOMPRESSION_SCHEME : uint32_t
+{
+	ESS_NONE = 0u,
+	ESS_BASIS_LZ = 1u,
+	ESS_ZSTD = 2u,
+	ESS_ZLIB = 3u
+};
+
+#include "nbl/nblpack.h"
+struct SHeader
+{
+	uint8_t identifier[12];
+	uint32_t vkFormat;
+	uint32_t typeSize;
+	uint32_t pixelWidth;
+	uint32_t pixelHeight;
+	uint32_t pixelDepth;
+	uint32_t layerCount;
+	uint32_t faceCount;
+	uint32_t levelCount;
+	E_SUPERCOMPRESSION_SCHEME supercompressionScheme;
+	// index
+	uint32_t dfdByteOffset;
+	uint32_t dfdByteLength;
+	uint32_t kvdByteOffset;
+	uint32_t kvdByteLength;
+	uint64_t sgdByteOffset;
+	uint64_t sgdByteLength;
+} PACK_STRUCT;
+struct SLevelIndexEntry
+{
+	uint64_t byteOffset;
+	uint64_t byteLength;
+	uint64_t uncompressedByteLength;
+} PACK_STRUCT;
+#include "nbl/nblunpack.h"
+static_assert(sizeof(SHeader)==80u);
+static_assert(sizeof(SLevelIndexEntry)==24u);
+
+//! `VkFormat` value of an `E_FORMAT`, 0 (VK_FORMAT_UNDEFINED) if there's none
+inline uint32_t getVkFormat(const E_FORMAT format)
+{
+	if (format<=EF_D32_SFLOAT_S8_UINT)
+		return 124u+format-EF_D16_UNORM;
+	if (format<=EF_E5B9G9R9_UFLOAT_PACK32)
+		return 1u+format-EF_R4G4_UNORM_PACK8;
+	if (format<=EF_BC7_SRGB_BLOCK)
+		return 131u+format-EF_BC1_RGB_UNORM_BLOCK;
+	if (format<=EF_ASTC_12x12_SRGB_BLOCK)
+		return 157u+format-EF_ASTC_4x4_UNORM_BLOCK;
+	if (format<=EF_EAC_R11G11_SNORM_BLOCK)
+		return 147u+format-EF_ETC2_R8G8B8_UNORM_BLOCK;
+	if (format<=EF_PVRTC2_4BPP_SRGB_BLOCK_IMG)
+		return 1000054000u+format-EF_PVRTC1_2BPP_UNORM_BLOCK_IMG;
+	if (format<=EF_G8_B8_R8_3PLANE_444_UNORM)
+		return 1000156002u+format-EF_G8_B8_R8_3PLANE_420_UNORM;
+	return 0u;
+}
+//! inverse of `getVkFormat`, `EF_UNKNOWN` for formats Nabla doesn't have
+inline E_FORMAT getFormat(const uint32_t vkFormat)
+{
+	auto inRange = [vkFormat](const uint32_t first, const E_FORMAT firstFormat, const E_FORMAT lastFormat) -> E_FORMAT
+	{
+		if (vkFormat<first || vkFormat-first>static_cast<uint32_t>(lastFormat-firstFormat))
+			return EF_UNKNOWN;
+		return static_cast<E_FORMAT>(firstFormat+vkFormat-first);
+	};
+	for (const auto format : {
+		inRange(1u,EF_R4G4_UNORM_PACK8,EF_E5B9G9R9_UFLOAT_PACK32),
+		inRange(124u,EF_D16_UNORM,EF_D32_SFLOAT_S8_UINT),
+		inRange(131u,EF_BC1_RGB_UNORM_BLOCK,EF_BC7_SRGB_BLOCK),
+		inRange(147u,EF_ETC2_R8G8B8_UNORM_BLOCK,EF_EAC_R11G11_SNORM_BLOCK),
+		inRange(157u,EF_ASTC_4x4_UNORM_BLOCK,EF_ASTC_12x12_SRGB_BLOCK),
+		inRange(1000054000u,EF_PVRTC1_2BPP_UNORM_BLOCK_IMG,EF_PVRTC2_4BPP_SRGB_BLOCK_IMG),
+		inRange(1000156002u,EF_G8_B8_R8_3PLANE_420_UNORM,EF_G8_B8_R8_3PLANE_444_UNORM)
+	})
+	if (format!=EF_UNKNOWN)
+		return format;
+	return EF_UNKNOWN;
+}
+
+//! Size of one mip level with all layers and faces tightly packed, which is both KTX2's and our region layout
+inline uint64_t getLevelByteSize(const E_FORMAT format, const VkExtent3D& levelExtent, const uint32_t layersAndFaces)
+{
+	const auto blockDims = getBlockDimensions(format);
+	uint64_t size = uint64_t(layersAndFaces)*getTexelOrBlockBytesize(format);
+	size *= (levelExtent.width+blockDims.x-1u)/blockDims.x;
+	size *= (levelExtent.height+blockDims.y-1u)/blockDims.y;
+	size *= (levelExtent.depth+blockDims.z-1u)/blockDims.z;
+	return size;
+}
+
+//! "KTXswizzle" metadata value, i.e. "rgba" or "rrr1"
+inline bool parseSwizzle(const std::string_view value, IImageView<ICPUImage>::SComponentMapping& outComponents)
+{
+	using swizzle_t = IImageView<ICPUImage>::SComponentMapping::E_SWIZZLE;
+	if (value.size()<4u)
+		return false;
+	for (uint32_t c=0u; c<4u; c++)
+	switch (value[c])
+	{
+		case 'r': outComponents[c] = swizzle_t::ES_R; break;
+		case 'g': outComponents[c] = swizzle_t::ES_G; break;
+		case 'b': outComponents[c] = swizzle_t::ES_B; break;
+		case 'a': outComponents[c] = swizzle_t::ES_A; break;
+		case '0': outComponents[c] = swizzle_t::ES_ZERO; break;
+		case '1': outComponents[c] = swizzle_t::ES_ONE; break;
+		default: return false;
+	}
+	return true;
+}
+inline void writeSwizzle(const IImageView<ICPUImage>::SComponentMapping& components, char outValue[4])
+{
+	using swizzle_t = IImageView<ICPUImage>::SComponentMapping::E_SWIZZLE;
+	constexpr char identity[] = "rgba";
+	for (uint32_t c=0u; c<4u; c++)
+	switch ((&components.r)[c])
+	{
+		case swizzle_t::ES_R: outValue[c] = 'r'; break;
+		case swizzle_t::ES_G: outValue[c] = 'g'; break;
+		case swizzle_t::ES_B: outValue[c] = 'b'; break;
+		case swizzle_t::ES_A: outValue[c] = 'a'; break;
+		case swizzle_t::ES_ZERO: outValue[c] = '0'; break;
+		case swizzle_t::ES_ONE: outValue[c] = '1'; break;
+		default: outValue[c] = identity[c]; break;
+	}
+}
+
+inline bool isSupercompressionSupported(const E_SUPERCOMPRESSION_SCHEME scheme)
+{
+	switch (scheme)
+	{
+		case ESS_NONE: [[fallthrough]];
+		case ESS_ZLIB:
+			return true;
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+		case ESS_ZSTD:
+			return true;
+#endif
+		default:
+			break;
+	}
+	return false;
+}
+
+//! Every level is a separate stream, so levels can be inflated independently and in parallel
+inline bool decompressLevel(const E_SUPERCOMPRESSION_SCHEME scheme, const void* src, const size_t srcSize, void* dst, const size_t dstSize)
+{
+	switch (scheme)
+	{
+		case ESS_NONE:
+			if (srcSize!=dstSize)
+				return false;
+			memcpy(dst,src,dstSize);
+			return true;
+		case ESS_ZLIB:
+		{
+			uLongf outSize = dstSize;
+			return uncompress(reinterpret_cast<Bytef*>(dst),&outSize,reinterpret_cast<const Bytef*>(src),srcSize)==Z_OK && outSize==dstSize;
+		}
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+		case ESS_ZSTD:
+		{
+			const size_t outSize = ZSTD_decompress(dst,dstSize,src,srcSize);
+			return !ZSTD_isError(outSize) && outSize==dstSize;
+		}
+#endif
+		default:
+			break;
+	}
+	return false;
+}
+
+inline size_t getCompressBound(const E_SUPERCOMPRESSION_SCHEME scheme, const size_t srcSize)
+{
+	switch (scheme)
+	{
+		case ESS_ZLIB:
+			return compressBound(srcSize);
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+		case ESS_ZSTD:
+			return ZSTD_compressBound(srcSize);
+#endif
+		default:
+			break;
+	}
+	return srcSize;
+}
+//! `level` is normalized to [0,1] and mapped onto the codec's own range, returns the compressed size or 0 on failure
+inline size_t compressLevel(const E_SUPERCOMPRESSION_SCHEME scheme, const float level, const void* src, const size_t srcSize, void* dst, const size_t dstCapacity)
+{
+	const float clampedLevel = core::clamp(level,0.f,1.f);
+	switch (scheme)
+	{
+		case ESS_ZLIB:
+		{
+			uLongf outSize = dstCapacity;
+			const int zlibLevel = 1+static_cast<int>(clampedLevel*8.f+0.5f);
+			if (compress2(reinterpret_cast<Bytef*>(dst),&outSize,reinterpret_cast<const Bytef*>(src),srcSize,zlibLevel)!=Z_OK)
+				return 0ull;
+			return outSize;
+		}
+#ifdef _NBL_COMPILE_WITH_ZSTD_
+		case ESS_ZSTD:
+		{
+			const int zstdLevel = 1+static_cast<int>(clampedLevel*(ZSTD_maxCLevel()-1)+0.5f);
+			const size_t outSize = ZSTD_compress(dst,dstCapacity,src,srcSize,zstdLevel);
+			return ZSTD_isError(outSize) ? 0ull:outSize;
+		}
+#endif
+		default:
+			break;
+	}
+	return 0ull;
+}
+
+}
+#endif
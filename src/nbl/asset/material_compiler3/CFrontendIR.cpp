@@ -4,9 +4,14 @@
 #define _NBL_ASSET_MATERIAL_COMPILER3_C_FRONTEND_IR_CPP_
 #include "nbl/asset/material_compiler3/CFrontendIR.h"
 
+#include "nbl/core/execution.h"
+
 #include "nbl/builtin/hlsl/complex.hlsl"
 #include "nbl/builtin/hlsl/portable/vector_t.hlsl"
 
+#include <numeric>
+#include <thread>
+
 
 namespace nbl::asset::material_compiler3
 {
@@ -553,6 +558,62 @@ void CFrontendIR::CCookTorrance::printDot(std::ostringstream& sstr, const core::
 
 
 //! IR making
+uint32_t CFrontendIR::addMaterialsParallel(const SAddMaterialsArgs& args) const
+{
+	// not worth spinning up the temporary pools of a session for fewer
+	constexpr uint32_t MinMaterialsPerWorker = 16;
+	const uint32_t materialCount = args.rootNodes.size();
+	const uint32_t workerCount = hlsl::max(hlsl::min(std::thread::hardware_concurrency(),(materialCount+MinMaterialsPerWorker-1)/MinMaterialsPerWorker),1u);
+	const uint32_t materialsPerWorker = (materialCount+workerCount-1)/workerCount;
+
+	// every worker canonicalizes its range with the serial path into a staging IR of its own, so no IR pool is ever shared between threads
+	struct SWorker
+	{
+		core::smart_refctd_ptr<CTrueIR> staging;
+		core::vector<CTrueIR::SMaterialHandle> handles;
+	};
+	core::vector<SWorker> workers(workerCount);
+	// same pool setup as the IR the materials end up in
+	const uint16_t blockSizeKBLog2 = hlsl::findMSB(args.ir->getObjectPool().getBlockSize())-10;
+	core::vector<uint32_t> workerIxs(workerCount);
+	std::iota(workerIxs.begin(),workerIxs.end(),0u);
+	std::for_each(core::execution::par,workerIxs.begin(),workerIxs.end(),[&](const uint32_t workerIx)->void
+		{
+			const uint32_t begin = workerIx*materialsPerWorker;
+			const uint32_t end = hlsl::min(begin+materialsPerWorker,materialCount);
+			if (begin>=end)
+				return;
+			auto& worker = workers[workerIx];
+			worker.staging = CTrueIR::create({.composed={.blockSizeKBLog2=blockSizeKBLog2}});
+			worker.handles.resize(end-begin);
+			addMaterials({
+				.rootNodes = args.rootNodes.subspan(begin,end-begin),
+				.ir = worker.staging.get(),
+				.result = worker.handles.data(),
+				.logger = args.logger
+			});
+		}
+	);
+
+	// merging in material order makes the handles in the shared IR deterministic
+	uint32_t retval = 0;
+	for (uint32_t i=0; i<materialCount; i++)
+	{
+		const auto& worker = workers[i/materialsPerWorker];
+		const auto stagedH = worker.handles[i%materialsPerWorker];
+		auto& out = args.result[i];
+		if (!stagedH)
+			out = {};
+		else if (stagedH.value==CTrueIR::BlackholeMaterialHandle.value)
+			out = CTrueIR::BlackholeMaterialHandle;
+		else
+			out = args.ir->addMaterial(worker.staging->getMaterials()[stagedH.value],worker.staging.get());
+		if (out)
+			retval++;
+	}
+	return retval;
+}
+
 CTrueIR::SMaterialHandle CFrontendIR::SAdd2IRSession::makeFinalIR(const typed_pointer_type<const CLayer> rootH, const CFrontendIR* ast)
 {
 	const auto& astPool = ast->getObjectPool();
@@ -686,10 +747,12 @@ auto CFrontendIR::SAdd2IRSession::makeOrientedMaterial(const CFrontendIR::typed_
 					if (retval.root)
 						transmission->coated = retval.root;
 				}
-				outLayer->firstTransmission = tmpIR->hashNCache(transmissionH);
+				outLayer->firstTransmission = tmpIR->intern(transmissionH);
 			}
 		}
-		retval.root = tmpIR->hashNCache(layerH);
+		// `layerH` is gone if an equal layer already existed, but it stays around if it couldn't be hashed
+		retval.root = tmpIR->intern(layerH);
+		const CTrueIR::typed_pointer_type<const CTrueIR::COrientedLayer> printLayerH = retval.root ? retval.root:layerH;
 		// Now optimize everything inserting it into the proper IR
 		{
 			// extra debug print
@@ -697,13 +760,13 @@ auto CFrontendIR::SAdd2IRSession::makeOrientedMaterial(const CFrontendIR::typed_
 			if constexpr(DebugBeforeAndAfterOpt)
 			{
 				args.logger.log("Before optimization:",ELL_DEBUG);
-				printIRLayer(layerH,tmpIR.get());
+				printIRLayer(printLayerH,tmpIR.get());
 			}
 			// avoid O(Layer^2) scaling by processing bottom layers over and over
 			if (!tmpIR->rewriteSingleLayer(retval.root,retval.metadata,tmpIR.get()))
 			{
 				args.logger.log("Failed to rewrite and optimize IR layer (printing layer and everything it coats):\n",ELL_ERROR);
-				printIRLayer(layerH,tmpIR.get());
+				printIRLayer(printLayerH,tmpIR.get());
 				return {.root=errorLayer};
 			}
 			// Now remember that our rewriter can optimize us into a blackhole/null layer
@@ -758,13 +821,23 @@ auto CFrontendIR::SAdd2IRSession::makeContributors(const CFrontendIR::typed_poin
 		// then by handle
 		return lhs.value<rhs.value;
 	};
+	// the binary ADD linked lists made for function arguments are only referenced by the argument, they're garbage once folded into a single ADD
+	auto dropAddChain = [&](CTrueIR::typed_pointer_type<const CTrueIR::INode> addH)->void
+	{
+		while (addH)
+		{
+			const auto nextH = irPool.deref(addH)->getChildHandle(1);
+			irPool._delete(block_allocator_type::_static_cast<add_ir_t>(addH._const_cast()));
+			addH = nextH;
+		}
+	};
 	//
 	auto hashIfFunction = [&](const CTrueIR::typed_pointer_type<const CTrueIR::IFactorLeaf> leafH)->CTrueIR::typed_pointer_type<const CTrueIR::IFactorLeaf>
 	{
 		if (const auto funcH=irPool._dynamic_cast<const CTrueIR::IFunctionNode>(leafH); funcH)
 		{
 			// not finalized yet (I know what I'm doing with the const_cast)
-			if (auto* const func=const_cast<CTrueIR::IFunctionNode*>(irPool.deref(funcH)); func->getHash()==core::blake3_hash_t::EmptyInput())
+			if (auto* const func=const_cast<CTrueIR::IFunctionNode*>(irPool.deref(funcH)); !func->isHashed())
 			{
 				// replace the argument linked list with a single add
 				const uint8_t argCount = func->getChildCount();
@@ -796,6 +869,7 @@ auto CFrontendIR::SAdd2IRSession::makeContributors(const CFrontendIR::typed_poin
 					if (state.childCount==1)
 					{
 						func->setChild(irPool,a,irPool.deref(firstAddH)->getChildHandle(0));
+						dropAddChain(firstAddH);
 						continue;
 					}
 					const auto argH = irPool.emplace<add_ir_t>(state);
@@ -817,8 +891,9 @@ auto CFrontendIR::SAdd2IRSession::makeContributors(const CFrontendIR::typed_poin
 							binAdd = irPool.deref(rhsH);
 						}
 					}
-					// and hashNCache
-					const auto uniqueArgH = tmpIR->hashNCache(argH);
+					dropAddChain(firstAddH);
+					// and intern, nothing else references the new node
+					const auto uniqueArgH = tmpIR->intern(argH);
 					if (!uniqueArgH)
 					{
 						args.logger.log("Couldn't hash a `CTrueIR::IFunction` argument %d node",ELL_ERROR,arg32);
@@ -882,7 +957,7 @@ auto CFrontendIR::SAdd2IRSession::makeContributors(const CFrontendIR::typed_poin
 					// shouldn't invalidate iterator, but underline our vector changes
 					pEntry = nullptr;
 					// create the contributor node and mark as found
-					const auto contributorH = tmpIR->hashNCache(static_cast<const IContributor*>(node)->createIRNode(btdfSubtree,srcAST,tmpIR.get()));
+					const auto contributorH = tmpIR->intern(static_cast<const IContributor*>(node)->createIRNode(btdfSubtree,srcAST,tmpIR.get()));
 					if (contributorH)
 					{
 						const auto weightedH = irPool.emplace<CTrueIR::CWeightedContributor>();
@@ -1033,7 +1108,7 @@ auto CFrontendIR::SAdd2IRSession::makeContributors(const CFrontendIR::typed_poin
 					// shouldn't invalidate iterator, but underline our vector changes
 					pEntry = nullptr;
 					//
-					const auto varH = tmpIR->hashNCache(static_cast<const CSpectralVariableExpr*>(node)->createIRNode(srcAST,tmpIR.get()));
+					const auto varH = tmpIR->intern(static_cast<const CSpectralVariableExpr*>(node)->createIRNode(srcAST,tmpIR.get()));
 					const auto* const var = irPool.deref(varH);
 					// no soft fail, the node wasn't null to begin with
 					if (!var)
@@ -1188,13 +1263,13 @@ auto CFrontendIR::SAdd2IRSession::makeContributors(const CFrontendIR::typed_poin
 								// make the non-monochrome negation node, not using premade cause that would tie me up with spectral buckets
 								if (it->negate && it->negate!=0b111)
 								{
-									const auto negationH = irPool.emplace<CTrueIR::CSpectralVariableFactor>(uint8_t(3));
-									if (auto* const negation=irPool.deref(negationH); negation)
-									{
-										for (uint8_t c=0; c<3; c++)
-											negation->setParameter(c,{.scale=bool((it->negate>>c)&0x1u) ? (-1.f):1.f});
-									}
-									const auto uniqueH = tmpIR->hashNCache(negationH);
+									const auto uniqueH = tmpIR->create<CTrueIR::CSpectralVariableFactor>([&](CTrueIR::CSpectralVariableFactor* negation)->bool
+										{
+											for (uint8_t c=0; c<3; c++)
+												negation->setParameter(c,{.scale=bool((it->negate>>c)&0x1u) ? (-1.f):1.f});
+											return true;
+										},uint8_t(3)
+									);
 									if (!uniqueH)
 									{
 										args.logger.log("Couldn't create a unique spectral negation node",ELL_ERROR);
@@ -1219,7 +1294,7 @@ auto CFrontendIR::SAdd2IRSession::makeContributors(const CFrontendIR::typed_poin
 						}
 					}
 				}
-				uniqueFactorH = tmpIR->hashNCache(factorH);
+				uniqueFactorH = tmpIR->intern(factorH);
 				if (!uniqueFactorH)
 				{
 					args.logger.log("Couldn't allocate or hash a `CTrueIR::CFactorCombiner` Mul node",ELL_ERROR);
@@ -1236,7 +1311,7 @@ auto CFrontendIR::SAdd2IRSession::makeContributors(const CFrontendIR::typed_poin
 				const auto weightedContribH = sumTerm->product._const_cast();
 				// attach the factor
 				irPool.deref(weightedContribH)->factor = uniqueFactorH;
-				const auto uniqueWeightedH = tmpIR->hashNCache(weightedContribH);
+				const auto uniqueWeightedH = tmpIR->intern(weightedContribH);
 				assert(uniqueWeightedH);
 				if (!uniqueWeightedH)
 				{
@@ -1264,10 +1339,10 @@ auto CFrontendIR::SAdd2IRSession::makeContributors(const CFrontendIR::typed_poin
 			auto* const func = irPool.deref(it->funcH);
 			assert(func);
 			// first time a function gets used, it gets hashedNCache-d, which finalizes it, can't be mutating its state afterwards!
-			assert(func->getHash()==core::blake3_hash_t::EmptyInput());
+			assert(!func->isHashed());
 			// make sure to update that factor is not scalar if we have any non-scalar factor term
 			if (!monochromeFactor)
-				func->scalar = false;
+				func->flags.scalar = false;
 			// allocate space for 2 add factors, we'll clean up later to have no dangling binop
 			const auto addTailH = irPool.emplace<add_ir_t>(add_ir_t::SState{.type=add_ir_t::Type::Add,.childCount=2});
 			if (!addTailH)
@@ -1293,14 +1368,13 @@ auto CFrontendIR::SAdd2IRSession::makeContributors(const CFrontendIR::typed_poin
 	// now hash in reverse
 	for (auto it=canonicalSum.rbegin(); it!=canonicalSum.rend(); it++)
 	{
-		// last contributor becomes the new head node, also hashNCache
+		// last contributor becomes the new head node, also intern
 		if (it->hasContributor)
 		{
-			const auto uniqueH = tmpIR->hashNCache(it->contribSumH);
-			// replace reference to previous tail with hashed and cached tail
+			// replace reference to the tail with the hashed and cached one before hashing, the original tail is gone if it was a duplicate
 			if (headH)
-				irPool.deref(headH._const_cast())->rest = uniqueH;
-			headH = uniqueH;
+				irPool.deref(it->contribSumH)->rest = headH;
+			headH = tmpIR->intern(it->contribSumH);
 		}
 		// thankfully args to functions come before the expressions the functions are used in
 	}
@@ -1383,7 +1457,7 @@ auto CFrontendIR::CCookTorrance::createIRNode(const bool forBTDF, const CFronten
 		const auto* const srcEta = ast->getObjectPool().deref(orientedRealEta);
 		if (!srcEta)
 			return {};
-		etaH = ir->hashNCache(srcEta->createIRNode(ast,ir));
+		etaH = ir->intern(srcEta->createIRNode(ast,ir));
 		if (!etaH)
 			return {};
 	}
@@ -72,7 +72,7 @@ CTrueIR::SBasicNodes::SBasicNodes(CTrueIR* ir)
 		node->product = {};
 		const bool success = node->recomputeHash(pool);
 		assert(success);
-		ir->m_uniqueNodes[node->getHash()] = blackHoleBxDF;
+		ir->insertUnique(node,blackHoleBxDF);
 	}
 	//
 	scalarNegation = pool.emplace<CSpectralVariableFactor>(uint8_t(1));
@@ -81,7 +81,7 @@ CTrueIR::SBasicNodes::SBasicNodes(CTrueIR* ir)
 		node->setParameter(0,{.scale=-1.f});
 		const bool success = node->recomputeHash(pool);
 		assert(success);
-		ir->m_uniqueNodes[node->getHash()] = scalarNegation;
+		ir->insertUnique(node,scalarNegation);
 	}
 	// we never compute the hashes on these ones, they're supposed to have invalid hash
 	errorLayer = pool.emplace<COrientedLayer>();
@@ -110,7 +110,488 @@ CTrueIR::SBasicNodes::SBasicNodes(CTrueIR* ir)
 	}
 }
 
-uint32_t CTrueIR::deepCopy(typed_pointer_type<INode>* out, const std::span<const typed_pointer_type<const INode>> orig, const CTrueIR* srcIR)
+namespace
+{
+// Node layouts are stored verbatim, so a file is only meant to be read back by the same build
+struct SMaterialPoolFileHeader
+{
+	constexpr static inline uint32_t Magic = 0x5249544eu; // "NTIR"
+	constexpr static inline uint32_t Version = 2u;
+	// block contents are aligned in the file so they can get copied straight out of a mapping
+	constexpr static inline uint64_t BlockAlignment = 64u;
+
+	uint32_t magic = Magic;
+	uint32_t version = Version;
+	uint32_t blockSizeLog2 = 0;
+	uint32_t blockCount = 0;
+	uint32_t allocationCount = 0;
+	uint32_t uniqueNodeCount = 0;
+	uint32_t materialCount = 0;
+	uint32_t viewCount = 0;
+};
+struct SBlockRecord
+{
+	uint32_t id;
+	uint32_t size;
+	uint64_t offset;
+};
+struct SAllocationRecord
+{
+	uint32_t handle;
+	uint32_t stride;
+	uint8_t count;
+	uint8_t type;
+	uint8_t reserved[2] = {0,0};
+};
+
+template<typename F>
+inline void forEachObject(const CNodePool::obj_pool_type& pool, const CNodePool::obj_pool_type::SAllocation& allocation, F&& f)
+{
+	const auto* const base = reinterpret_cast<const uint8_t*>(pool.deref(allocation.handle));
+	for (uint32_t i=0; i<allocation.count; i++)
+		f(reinterpret_cast<const CNodePool::obj_pool_type::INonTrivial*>(base+allocation.stride*i));
+}
+}
+
+bool CTrueIR::gatherAllocations(core::vector<obj_pool_type::SAllocation>& outAllocations, core::vector<uint8_t>& outTypes) const
+{
+	const auto& pool = getObjectPool();
+	pool.visitAllocations([&](const obj_pool_type::SAllocation& allocation)->void{outAllocations.push_back(allocation);});
+	// so the same IR always serializes the same
+	std::sort(outAllocations.begin(),outAllocations.end(),[](const auto& lhs, const auto& rhs)->bool{return lhs.handle.value<rhs.handle.value;});
+	outTypes.reserve(outAllocations.size());
+	for (const auto& allocation : outAllocations)
+	{
+		const auto* const obj = pool.deref(allocation.handle);
+		if (const auto* const node=dynamic_cast<const INode*>(obj); node)
+			outTypes.push_back(static_cast<uint8_t>(node->getFinalType()));
+		else if (dynamic_cast<const CDebugInfo*>(obj))
+			outTypes.push_back(DebugInfoType);
+		else
+			return false;
+	}
+	return true;
+}
+
+bool CTrueIR::restore(const SRestoreArgs& args)
+{
+	if (args.types.size()!=args.allocations.size())
+		return false;
+	m_materials.clear();
+	m_uniqueNodes.clear();
+
+	// constructing over a slot overwrites it, so the constructors read the members from a copy
+	core::vector<uint8_t> image;
+	auto revive = [&](void* const storage, const obj_pool_type::SAllocation& allocation)->bool
+	{
+		const auto type = args.types[&allocation-args.allocations.data()];
+		const auto stride = allocation.stride;
+		const auto* const bytes = reinterpret_cast<const uint8_t*>(storage);
+		image.assign(bytes,bytes+stride);
+		SRestoreTag tag = {};
+		tag.storage = bytes;
+		tag.image = image.data();
+		tag.size = stride;
+		tag.resolveView = &args.resolveView;
+		// variable sized nodes check their trailing contents fit themselves, but their smallest variant must fit
+#define RESTORE(TYPE,MIN_SIZE) { \
+					if (stride<(MIN_SIZE)) \
+						return false; \
+					auto* const obj = std::construct_at(reinterpret_cast<TYPE*>(storage),tag); \
+					if (!tag.valid) \
+						obj->~TYPE(); \
+					break; \
+				}
+		switch (type)
+		{
+			case static_cast<uint8_t>(INode::EFinalType::COrientedLayer):
+				RESTORE(COrientedLayer,sizeof(COrientedLayer));
+			case static_cast<uint8_t>(INode::EFinalType::CCorellatedTransmission):
+				RESTORE(CCorellatedTransmission,sizeof(CCorellatedTransmission));
+			case static_cast<uint8_t>(INode::EFinalType::CContributorSum):
+				RESTORE(CContributorSum,sizeof(CContributorSum));
+			case static_cast<uint8_t>(INode::EFinalType::CWeightedContributor):
+				RESTORE(CWeightedContributor,sizeof(CWeightedContributor));
+			case static_cast<uint8_t>(INode::EFinalType::CEmitter):
+				RESTORE(CEmitter,sizeof(CEmitter));
+			case static_cast<uint8_t>(INode::EFinalType::CDeltaTransmission):
+				RESTORE(CDeltaTransmission,sizeof(CDeltaTransmission));
+			case static_cast<uint8_t>(INode::EFinalType::CSpectralVariable):
+				RESTORE(CSpectralVariableFactor,CSpectralVariableFactor::calc_size(uint8_t(1)));
+			case static_cast<uint8_t>(INode::EFinalType::COrenNayar):
+				RESTORE(COrenNayar,sizeof(COrenNayar));
+			case static_cast<uint8_t>(INode::EFinalType::CCookTorrance):
+				RESTORE(CCookTorrance,sizeof(CCookTorrance));
+			case static_cast<uint8_t>(INode::EFinalType::CFactorCombiner):
+				RESTORE(CFactorCombiner,sizeof(CFactorCombiner));
+			case static_cast<uint8_t>(INode::EFinalType::CBeer):
+				RESTORE(CBeer,sizeof(CBeer));
+			case static_cast<uint8_t>(INode::EFinalType::CFresnel):
+				RESTORE(CFresnel,sizeof(CFresnel));
+			case static_cast<uint8_t>(INode::EFinalType::CThinInfiniteScatterCorrection):
+				RESTORE(CThinInfiniteScatterCorrection,sizeof(CThinInfiniteScatterCorrection));
+			case DebugInfoType:
+				RESTORE(CDebugInfo,sizeof(CDebugInfo));
+			default:
+				return false;
+		}
+#undef RESTORE
+		return tag.valid;
+	};
+	auto& pool = getObjectPool();
+	if (!pool.restore(args.blocks,args.allocations,revive))
+	{
+		reset();
+		return false;
+	}
+
+	// every handle in the file must point at one of the objects just revived, not just somewhere into a block
+	// (handles to a node are to its `INode` base, which needn't be at the start of the object)
+	core::unordered_map<uint32_t,const obj_pool_type::INonTrivial*> objects;
+	core::unordered_map<uint32_t,const INode*> nodes;
+	for (const auto& allocation : args.allocations)
+	{
+		const auto* const base = reinterpret_cast<const uint8_t*>(pool.deref(allocation.handle));
+		for (uint32_t i=0; i<allocation.count; i++)
+		{
+			const auto* const obj = reinterpret_cast<const obj_pool_type::INonTrivial*>(base+allocation.stride*i);
+			const uint32_t value = allocation.handle.value+allocation.stride*i;
+			objects[value] = obj;
+			if (const auto* const node=dynamic_cast<const INode*>(obj); node)
+				nodes[value+uint32_t(reinterpret_cast<const uint8_t*>(node)-reinterpret_cast<const uint8_t*>(obj))] = node;
+		}
+	}
+	auto getObject = [&](const uint32_t value)->const obj_pool_type::INonTrivial*
+	{
+		const auto found = objects.find(value);
+		return found!=objects.end() ? found->second:nullptr;
+	};
+
+	bool success = true;
+	for (const auto& [value,node] : nodes)
+	for (uint8_t c=0; success && c<node->getChildCount(); c++)
+	{
+		const auto child = node->getChildHandle(c);
+		success = !child || nodes.contains(child.value);
+	}
+	for (const auto value : args.uniqueNodes)
+	{
+		const auto found = nodes.find(value);
+		if (!success || found==nodes.end() || !found->second->isHashed())
+		{
+			success = false;
+			break;
+		}
+		typed_pointer_type<const INode> h = {};
+		h.value = value;
+		insertUnique(found->second,h);
+	}
+	for (const auto& material : args.materials)
+	{
+		for (const auto root : {material.front.root,material.back.root})
+			success = success && (!root || dynamic_cast<const COrientedLayer*>(getObject(root.value)));
+		success = success && (!material.debugInfo || dynamic_cast<const CNodePool::CDebugInfo*>(getObject(material.debugInfo.value)));
+	}
+	// the basic nodes are the first ones any IR makes, so they must be where the file had them
+	if (success)
+	{
+		const typed_pointer_type<const INode> blackHole = m_basicNodes.blackHoleBxDF;
+		const auto found = nodes.find(blackHole.value);
+		success = found!=nodes.end() && findUnique(found->second)==blackHole;
+	}
+	if (!success)
+	{
+		reset();
+		return false;
+	}
+	m_materials.assign(args.materials.begin(),args.materials.end());
+	return true;
+}
+
+bool CTrueIR::save(system::IFile* file, core::vector<core::smart_refctd_ptr<const ICPUImageView>>& outViews) const
+{
+	if (!file)
+		return false;
+	const auto& pool = getObjectPool();
+	core::vector<obj_pool_type::SAllocation> allocations;
+	core::vector<uint8_t> types;
+	if (!gatherAllocations(allocations,types))
+		return false;
+
+	// copy the blocks so the texture references can get swapped for indices
+	struct SBlockCopy
+	{
+		uint32_t id;
+		const uint8_t* src;
+		core::vector<uint8_t> data;
+	};
+	core::vector<SBlockCopy> blocks;
+	pool.visitBlocks([&](const obj_pool_type::block_image_type& image)->void
+		{
+			blocks.push_back({.id=image.id,.src=image.data,.data=core::vector<uint8_t>(image.data,image.data+image.size)});
+		}
+	);
+	std::sort(blocks.begin(),blocks.end(),[](const SBlockCopy& lhs, const SBlockCopy& rhs)->bool{return lhs.id<rhs.id;});
+	core::unordered_map<uint32_t,uint32_t> blockIndices;
+	for (uint32_t i=0; i<blocks.size(); i++)
+		blockIndices[blocks[i].id] = i;
+
+	const uint32_t blockSizeLog2 = hlsl::findMSB(pool.getBlockSize());
+	// indices are offset by one so that null stays null
+	core::unordered_map<const ICPUImageView*,uintptr_t> viewIndices;
+	outViews.clear();
+	for (const auto& allocation : allocations)
+	{
+		auto& block = blocks[blockIndices[allocation.handle.value>>blockSizeLog2]];
+		forEachObject(pool,allocation,[&](const obj_pool_type::INonTrivial* obj)->void
+			{
+				const auto* const node = dynamic_cast<const INode*>(obj);
+				if (!node)
+					return;
+				for (const auto& param : node->getParameters())
+				{
+					uintptr_t index = 0;
+					if (param.view)
+					{
+						const auto [found,inserted] = viewIndices.insert({param.view.get(),outViews.size()+1});
+						if (inserted)
+							outViews.push_back(param.view);
+						index = found->second;
+					}
+					memcpy(block.data.data()+(reinterpret_cast<const uint8_t*>(&param.view)-block.src),&index,sizeof(index));
+				}
+			}
+		);
+	}
+
+	SMaterialPoolFileHeader header = {};
+	header.blockSizeLog2 = blockSizeLog2;
+	header.blockCount = blocks.size();
+	header.allocationCount = allocations.size();
+	header.uniqueNodeCount = m_uniqueNodes.size();
+	header.materialCount = m_materials.size();
+	header.viewCount = outViews.size();
+
+	core::vector<SAllocationRecord> allocationRecords(allocations.size());
+	for (size_t i=0; i<allocations.size(); i++)
+		allocationRecords[i] = {.handle=allocations[i].handle.value,.stride=allocations[i].stride,.count=static_cast<uint8_t>(allocations[i].count),.type=types[i]};
+	core::vector<uint32_t> uniqueNodes;
+	uniqueNodes.reserve(m_uniqueNodes.size());
+	for (const auto& entry : m_uniqueNodes)
+		uniqueNodes.push_back(entry.second.value);
+	std::sort(uniqueNodes.begin(),uniqueNodes.end());
+	static_assert(std::is_trivially_copyable_v<SMaterial>);
+
+	uint64_t offset = sizeof(header)+sizeof(SBlockRecord)*blocks.size()+sizeof(SAllocationRecord)*allocationRecords.size();
+	offset += sizeof(uint32_t)*uniqueNodes.size()+sizeof(SMaterial)*m_materials.size();
+	core::vector<SBlockRecord> blockRecords(blocks.size());
+	for (size_t i=0; i<blocks.size(); i++)
+	{
+		offset = core::alignUp(offset,SMaterialPoolFileHeader::BlockAlignment);
+		blockRecords[i] = {.id=blocks[i].id,.size=static_cast<uint32_t>(blocks[i].data.size()),.offset=offset};
+		offset += blocks[i].data.size();
+	}
+
+	bool success = true;
+	auto write = [&](const void* data, const size_t size, const size_t at)->void
+	{
+		if (!success || size==0)
+			return;
+		system::IFile::success_t result;
+		file->write(result,data,at,size);
+		success = bool(result);
+	};
+	offset = 0;
+	auto writeNext = [&](const void* data, const size_t size)->void
+	{
+		write(data,size,offset);
+		offset += size;
+	};
+	writeNext(&header,sizeof(header));
+	writeNext(blockRecords.data(),sizeof(SBlockRecord)*blockRecords.size());
+	writeNext(allocationRecords.data(),sizeof(SAllocationRecord)*allocationRecords.size());
+	writeNext(uniqueNodes.data(),sizeof(uint32_t)*uniqueNodes.size());
+	writeNext(m_materials.data(),sizeof(SMaterial)*m_materials.size());
+	for (size_t i=0; i<blocks.size(); i++)
+		write(blocks[i].data.data(),blocks[i].data.size(),blockRecords[i].offset);
+	return success;
+}
+
+core::smart_refctd_ptr<CTrueIR> CTrueIR::load(system::IFile* file, const std::span<const core::smart_refctd_ptr<const ICPUImageView>> views, creation_params_type&& params)
+{
+	if (!file)
+		return nullptr;
+	const size_t fileSize = file->getSize();
+	size_t offset = 0;
+	auto read = [&](void* data, const size_t size)->bool
+	{
+		if (size==0)
+			return true;
+		if (offset+size>fileSize)
+			return false;
+		system::IFile::success_t success;
+		file->read(success,data,offset,size);
+		offset += size;
+		return bool(success);
+	};
+
+	SMaterialPoolFileHeader header;
+	if (!read(&header,sizeof(header)) || header.magic!=SMaterialPoolFileHeader::Magic || header.version!=SMaterialPoolFileHeader::Version)
+		return nullptr;
+	// `create` wants at least 16kb blocks and the handles are 32bit
+	if (header.blockSizeLog2<14 || header.blockSizeLog2>31 || header.viewCount!=views.size())
+		return nullptr;
+	// don't trust the counts with allocations before checking they fit in the file
+	const uint64_t tablesSize = sizeof(SBlockRecord)*uint64_t(header.blockCount)+sizeof(SAllocationRecord)*uint64_t(header.allocationCount)+
+		sizeof(uint32_t)*uint64_t(header.uniqueNodeCount)+sizeof(SMaterial)*uint64_t(header.materialCount);
+	if (sizeof(header)+tablesSize>fileSize)
+		return nullptr;
+	core::vector<SBlockRecord> blockRecords(header.blockCount);
+	core::vector<SAllocationRecord> allocationRecords(header.allocationCount);
+	core::vector<uint32_t> uniqueNodes(header.uniqueNodeCount);
+	core::vector<SMaterial> materials(header.materialCount);
+	if (!read(blockRecords.data(),sizeof(SBlockRecord)*blockRecords.size()) || !read(allocationRecords.data(),sizeof(SAllocationRecord)*allocationRecords.size()))
+		return nullptr;
+	if (!read(uniqueNodes.data(),sizeof(uint32_t)*uniqueNodes.size()) || !read(materials.data(),sizeof(SMaterial)*materials.size()))
+		return nullptr;
+
+	// block contents come straight out of the mapping when there is one
+	const size_t dataStart = offset;
+	const auto* dataBase = reinterpret_cast<const uint8_t*>(file->getMappedPointer());
+	core::vector<uint8_t> blockData;
+	if (dataBase)
+		dataBase += dataStart;
+	else
+	{
+		blockData.resize(fileSize-dataStart);
+		if (!read(blockData.data(),blockData.size()))
+			return nullptr;
+		dataBase = blockData.data();
+	}
+	core::vector<obj_pool_type::block_image_type> blocks;
+	blocks.reserve(blockRecords.size());
+	uint32_t maxBlockID = 0;
+	for (const auto& record : blockRecords)
+	{
+		// the block index needs to fit in the handle above the offset within the block
+		if (record.id>=(0x1u<<(32u-header.blockSizeLog2)) || record.offset<dataStart || record.offset+record.size>fileSize)
+			return nullptr;
+		blocks.push_back({.id=record.id,.size=record.size,.data=dataBase+(record.offset-dataStart)});
+		maxBlockID = hlsl::max(maxBlockID,record.id);
+	}
+	core::vector<obj_pool_type::SAllocation> allocations(allocationRecords.size());
+	core::vector<uint8_t> types(allocationRecords.size());
+	for (size_t i=0; i<allocationRecords.size(); i++)
+	{
+		const auto& record = allocationRecords[i];
+		allocations[i].handle.value = record.handle;
+		allocations[i].stride = record.stride;
+		allocations[i].count = record.count;
+		types[i] = record.type;
+	}
+
+	params.composed.blockSizeKBLog2 = header.blockSizeLog2-10;
+	if (maxBlockID>=params.maxBlocks)
+		params.maxBlocks = maxBlockID+1;
+	auto retval = create(std::move(params));
+	if (!retval)
+		return nullptr;
+	const bool success = retval->restore({
+		.blocks = blocks,
+		.allocations = allocations,
+		.types = types,
+		.uniqueNodes = uniqueNodes,
+		.materials = materials,
+		.resolveView = [&views](const uintptr_t index, core::smart_refctd_ptr<const ICPUImageView>& out)->bool
+		{
+			if (index>views.size())
+				return false;
+			if (index)
+				out = views[index-1];
+			return true;
+		}
+	});
+	if (!success)
+		return nullptr;
+	return retval;
+}
+
+core::smart_refctd_ptr<IAsset> CTrueIR::clone(uint32_t _depth) const
+{
+	const auto& pool = getObjectPool();
+	creation_params_type params = {};
+	params.composed.blockSizeKBLog2 = hlsl::findMSB(pool.getBlockSize())-10;
+	auto retval = create(std::move(params));
+	if (!retval)
+		return nullptr;
+	auto& dstPool = retval->getObjectPool();
+
+	// the clone made its own basic nodes, whatever references ours gets to reference those
+	core::unordered_map<typed_pointer_type<const INode>,typed_pointer_type<INode>> substitutions;
+	{
+		const auto& ours = getBasicNodes();
+		const auto& theirs = retval->getBasicNodes();
+		substitutions[ours.blackHoleBxDF] = theirs.blackHoleBxDF._const_cast();
+		substitutions[ours.scalarNegation] = theirs.scalarNegation._const_cast();
+		substitutions[ours.errorBxDF] = theirs.errorBxDF._const_cast();
+		substitutions[ours.errorLayer] = theirs.errorLayer._const_cast();
+	}
+	// unique nodes come along even if no material references them, so the clone de-duplicates against the same set
+	core::vector<typed_pointer_type<const INode>> roots;
+	roots.reserve(m_uniqueNodes.size()+2*m_materials.size());
+	for (const auto& entry : m_uniqueNodes)
+		roots.push_back(entry.second);
+	for (const auto& material : m_materials)
+	for (const auto* oriented : {&material.front,&material.back})
+	if (oriented->root)
+		roots.push_back(oriented->root);
+	core::vector<typed_pointer_type<INode>> copies(roots.size());
+	if (retval->deepCopy(copies.data(),roots,this,substitutions))
+		return nullptr;
+
+	// copies keep their hashes, the basic ones are in the table already
+	for (size_t i=0; i<m_uniqueNodes.size(); i++)
+	{
+		const auto* const copy = dstPool.deref(copies[i]);
+		if (!retval->findUnique(copy))
+			retval->insertUnique(copy,copies[i]);
+	}
+	// the clone has its own blackhole material already
+	for (size_t i=BlackholeMaterialHandle.value+1; i<m_materials.size(); i++)
+	{
+		auto material = m_materials[i];
+		for (auto* oriented : {&material.front,&material.back})
+		if (oriented->root)
+			oriented->root = dstPool._dynamic_cast<const COrientedLayer>(substitutions[oriented->root]);
+		material.debugInfo = retval->copyDebugInfo(material.debugInfo,this);
+		retval->m_materials.push_back(material);
+	}
+	return retval;
+}
+
+void CTrueIR::visitDependents_impl(std::function<bool(const IAsset*)> visit) const
+{
+	const auto& pool = getObjectPool();
+	bool keepGoing = true;
+	pool.visitAllocations([&](const obj_pool_type::SAllocation& allocation)->void
+		{
+			forEachObject(pool,allocation,[&](const obj_pool_type::INonTrivial* obj)->void
+				{
+					const auto* const node = keepGoing ? dynamic_cast<const INode*>(obj):nullptr;
+					if (node)
+					for (const auto& param : node->getParameters())
+					if (param.view && !visit(param.view.get()))
+					{
+						keepGoing = false;
+						return;
+					}
+				}
+			);
+		}
+	);
+}
+
+uint32_t CTrueIR::deepCopy(typed_pointer_type<INode>* out, const std::span<const typed_pointer_type<const INode>> orig, const CTrueIR* srcIR, core::unordered_map<typed_pointer_type<const INode>,typed_pointer_type<INode>>& substitutions)
 {
 	auto& dstPool = getObjectPool();
 	// if not explicitly other, then its ours
@@ -122,13 +603,20 @@ uint32_t CTrueIR::deepCopy(typed_pointer_type<INode>* out, const std::span<const
 	stack.reserve(orig.size() + 32);
 	for (const auto& o : orig)
 	    stack.push_back(o);
-	// use a hashmap to not explore whole DAG
-	core::unordered_map<typed_pointer_type<const INode>, typed_pointer_type<INode>> substitutions;
+	// use a hashmap to not explore whole DAG, the nodes it got seeded with are final
+	core::unordered_set<typed_pointer_type<const INode>> seeded;
+	for (const auto& entry : substitutions)
+		seeded.insert(entry.first);
 	while (!stack.empty())
 	{
 		const auto entry = stack.back();
+		if (seeded.contains(entry))
+		{
+			stack.pop_back();
+			continue;
+		}
 		const auto* const node = srcPool.deref(entry);
-		assert(!node);
+		assert(node);
 		const auto childCount = node->getChildCount();
 		if (auto& copyH = substitutions[entry]; !copyH)
 		{
@@ -274,14 +762,75 @@ CTrueIR::SRewriteSession::~SRewriteSession()
 		args.dst->getObjectPool()._delete(handle,1);
 }
 
+bool CTrueIR::SRewriteSession::copyAcross(typed_pointer_type<const COrientedLayer>& oriented)
+{
+	const auto& srcPool = args.src->getObjectPool();
+	auto& dstPool = args.dst->getObjectPool();
+	if (copies.empty())
+	{
+		// the basic nodes aren't all hashed, whatever references the source's gets to reference ours
+		const auto& theirs = args.src->getBasicNodes();
+		const auto& ours = args.dst->getBasicNodes();
+		copies[theirs.blackHoleBxDF] = ours.blackHoleBxDF;
+		copies[theirs.scalarNegation] = ours.scalarNegation;
+		copies[theirs.errorBxDF] = ours.errorBxDF;
+		copies[theirs.errorLayer] = ours.errorLayer;
+	}
+
+	// children get copied before their parents, so a copy can take its children's unique handles and de-duplicate against our nodes right away
+	const typed_pointer_type<const INode> rootH = oriented;
+	core::vector<typed_pointer_type<const INode>> stack = {rootH};
+	while (!stack.empty())
+	{
+		const auto entry = stack.back();
+		if (copies.contains(entry))
+		{
+			stack.pop_back();
+			continue;
+		}
+		const auto* const node = srcPool.deref(entry);
+		if (!node)
+			return false;
+		const auto childCount = node->getChildCount();
+		bool childrenCopied = true;
+		for (uint8_t c=0; c<childCount; c++)
+		if (const auto childH=node->getChildHandle(c); childH && !copies.contains(childH))
+		{
+			stack.push_back(childH);
+			childrenCopied = false;
+		}
+		if (!childrenCopied)
+			continue;
+		stack.pop_back();
+
+		// copy copies everything including child handles, the hashes stay valid because the children they get swapped for are equal
+		const auto copyH = node->copy(args.dst);
+		auto* const copy = dstPool.deref(copyH);
+		if (!copy)
+			return false;
+		for (uint8_t c=0; c<childCount; c++)
+		if (const auto childH=node->getChildHandle(c); childH)
+			copy->setChild(dstPool,c,copies[childH]);
+		const auto uniqueH = args.dst->intern(copyH);
+		if (!uniqueH)
+		{
+			dstPool._delete(copyH);
+			return false;
+		}
+		copies[entry] = uniqueH;
+	}
+	oriented = dstPool._dynamic_cast<const COrientedLayer>(copies[rootH]);
+	return bool(oriented);
+}
+
 bool CTrueIR::SRewriteSession::rewrite(typed_pointer_type<const COrientedLayer>& oriented)
 {
 	if (!success)
 		return false;
 
-	success = args.src==args.dst;
 	// TODO: go through the layers
-//	assert(success);
+	if (args.needDeepCopy())
+		success = copyAcross(oriented);
 	return success;
 }
 
@@ -300,8 +849,8 @@ bool CTrueIR::SRewriteSession::rewriteSingleLayer(typed_pointer_type<const COrie
 
 	// TODO: deduplicate, collect metadata and insert into current IR
 
-	success = args.src==args.dst;
-	assert(success);
+	if (args.needDeepCopy())
+		success = copyAcross(oriented);
 	return success;
 }
 
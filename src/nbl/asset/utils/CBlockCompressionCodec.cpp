@@ -0,0 +1,1401 @@
+// Copyright (C) 2018-2024 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "nbl/asset/utils/CBlockCompressionCodec.h"
+
+#include "nbl/core/math/colorutil.h"
+#include "nbl/asset/format/convertRows.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace nbl;
+using namespace nbl::asset;
+
+namespace
+{
+using texel_block_t = CBlockCompressionCodec::texel_block_t;
+
+// BCn blocks are little endian bitstreams, fields are written LSB first
+struct SBitWriter
+{
+	uint8_t bytes[16] = {};
+	uint32_t pos = 0u;
+
+	inline void write(const uint32_t value, const uint32_t bitCount)
+	{
+		for (uint32_t i=0u; i<bitCount; i++,pos++)
+		if ((value>>i)&0x1u)
+			bytes[pos>>3u] |= uint8_t(0x1u<<(pos&7u));
+	}
+};
+struct SBitReader
+{
+	const uint8_t* bytes;
+	uint32_t pos = 0u;
+
+	inline uint32_t read(const uint32_t bitCount)
+	{
+		uint32_t retval = 0u;
+		for (uint32_t i=0u; i<bitCount; i++,pos++)
+			retval |= uint32_t((bytes[pos>>3u]>>(pos&7u))&0x1u)<<i;
+		return retval;
+	}
+};
+
+inline float saturate(const float x) {return std::isnan(x) ? 0.f:std::clamp(x,0.f,1.f);}
+inline float snormClamp(const float x) {return std::isnan(x) ? 0.f:std::clamp(x,-1.f,1.f);}
+
+constexpr uint32_t getRefinementIterations(const CBlockCompressionCodec::E_QUALITY quality)
+{
+	switch (quality)
+	{
+		case CBlockCompressionCodec::EQ_FAST:
+			return 1u;
+		case CBlockCompressionCodec::EQ_NORMAL:
+			return 3u;
+		default:
+			return 8u;
+	}
+}
+
+//! Initial endpoints for the texels selected by `mask`, `e0` ends up at the "high" end of the fitted line.
+void fitLine(const texel_block_t& px, const bool* mask, const uint32_t channels, const bool boundingBox, float (&e0)[4], float (&e1)[4])
+{
+	float mean[4] = {0.f,0.f,0.f,0.f};
+	float lo[4],hi[4];
+	std::fill_n(lo,4,std::numeric_limits<float>::max());
+	std::fill_n(hi,4,-std::numeric_limits<float>::max());
+	uint32_t count = 0u;
+	for (uint32_t i=0u; i<16u; i++)
+	{
+		if (mask && !mask[i])
+			continue;
+		for (uint32_t c=0u; c<channels; c++)
+		{
+			mean[c] += px[i][c];
+			lo[c] = std::min(lo[c],px[i][c]);
+			hi[c] = std::max(hi[c],px[i][c]);
+		}
+		count++;
+	}
+	if (count==0u)
+	{
+		std::fill_n(e0,4,0.f);
+		std::fill_n(e1,4,0.f);
+		return;
+	}
+	for (uint32_t c=0u; c<channels; c++)
+		mean[c] /= float(count);
+
+	float cov[4][4] = {};
+	for (uint32_t i=0u; i<16u; i++)
+	{
+		if (mask && !mask[i])
+			continue;
+		for (uint32_t c=0u; c<channels; c++)
+		for (uint32_t d=c; d<channels; d++)
+			cov[c][d] += (px[i][c]-mean[c])*(px[i][d]-mean[d]);
+	}
+	for (uint32_t c=0u; c<channels; c++)
+	for (uint32_t d=0u; d<c; d++)
+		cov[c][d] = cov[d][c];
+
+	if (boundingBox)
+	{
+		// flip the box diagonal along channels which anticorrelate with the widest one
+		uint32_t widest = 0u;
+		for (uint32_t c=1u; c<channels; c++)
+		if (hi[c]-lo[c]>hi[widest]-lo[widest])
+			widest = c;
+		for (uint32_t c=0u; c<channels; c++)
+		{
+			const bool flip = cov[widest][c]<0.f;
+			e0[c] = flip ? lo[c]:hi[c];
+			e1[c] = flip ? hi[c]:lo[c];
+		}
+		return;
+	}
+
+	// power iteration for the principal axis, seeded with the bounding box diagonal
+	float axis[4] = {0.f,0.f,0.f,0.f};
+	for (uint32_t c=0u; c<channels; c++)
+		axis[c] = hi[c]-lo[c];
+	for (uint32_t it=0u; it<8u; it++)
+	{
+		float next[4] = {0.f,0.f,0.f,0.f};
+		float maxComp = 0.f;
+		for (uint32_t c=0u; c<channels; c++)
+		{
+			for (uint32_t d=0u; d<channels; d++)
+				next[c] += cov[c][d]*axis[d];
+			maxComp = std::max(maxComp,std::abs(next[c]));
+		}
+		if (maxComp<=std::numeric_limits<float>::min())
+			break;
+		for (uint32_t c=0u; c<channels; c++)
+			axis[c] = next[c]/maxComp;
+	}
+	float lenSq = 0.f;
+	for (uint32_t c=0u; c<channels; c++)
+		lenSq += axis[c]*axis[c];
+	if (lenSq<=std::numeric_limits<float>::min())
+	{
+		std::copy_n(mean,4,e0);
+		std::copy_n(mean,4,e1);
+		return;
+	}
+
+	float tMin = std::numeric_limits<float>::max();
+	float tMax = -std::numeric_limits<float>::max();
+	for (uint32_t i=0u; i<16u; i++)
+	{
+		if (mask && !mask[i])
+			continue;
+		float t = 0.f;
+		for (uint32_t c=0u; c<channels; c++)
+			t += (px[i][c]-mean[c])*axis[c];
+		tMin = std::min(tMin,t);
+		tMax = std::max(tMax,t);
+	}
+	for (uint32_t c=0u; c<channels; c++)
+	{
+		e0[c] = mean[c]+axis[c]*tMax/lenSq;
+		e1[c] = mean[c]+axis[c]*tMin/lenSq;
+	}
+	for (uint32_t c=channels; c<4u; c++)
+		e0[c] = e1[c] = 0.f;
+}
+
+//! Least squares endpoints given the interpolation weight `w` (0 is `e0`, 1 is `e1`) each texel got quantized to.
+bool refineLine(const texel_block_t& px, const bool* mask, const uint32_t channels, const float (&w)[16], float (&e0)[4], float (&e1)[4])
+{
+	float a=0.f, b=0.f, c=0.f;
+	float x0[4] = {0.f,0.f,0.f,0.f};
+	float x1[4] = {0.f,0.f,0.f,0.f};
+	for (uint32_t i=0u; i<16u; i++)
+	{
+		if (mask && !mask[i])
+			continue;
+		const float v = 1.f-w[i];
+		a += v*v;
+		b += v*w[i];
+		c += w[i]*w[i];
+		for (uint32_t ch=0u; ch<channels; ch++)
+		{
+			x0[ch] += v*px[i][ch];
+			x1[ch] += w[i]*px[i][ch];
+		}
+	}
+	const float det = a*c-b*b;
+	if (std::abs(det)<1e-6f)
+		return false;
+	for (uint32_t ch=0u; ch<channels; ch++)
+	{
+		e0[ch] = (c*x0[ch]-b*x1[ch])/det;
+		e1[ch] = (a*x1[ch]-b*x0[ch])/det;
+	}
+	return true;
+}
+
+template<uint32_t PaletteSize>
+inline uint32_t findClosest(const float* texel, const float (&palette)[PaletteSize][4], const uint32_t channels, const uint32_t usable, float& error)
+{
+	uint32_t best = 0u;
+	error = std::numeric_limits<float>::max();
+	for (uint32_t j=0u; j<usable; j++)
+	{
+		float d = 0.f;
+		for (uint32_t c=0u; c<channels; c++)
+		{
+			const float diff = palette[j][c]-texel[c];
+			d += diff*diff;
+		}
+		if (d<error)
+		{
+			error = d;
+			best = j;
+		}
+	}
+	return best;
+}
+
+// weights BC6H and BC7 interpolate endpoints with
+constexpr uint16_t BPTCWeights2[4] = {0,21,43,64};
+constexpr uint16_t BPTCWeights3[8] = {0,9,18,27,37,46,55,64};
+constexpr uint16_t BPTCWeights4[16] = {0,4,9,13,17,21,26,30,34,38,43,47,51,55,60,64};
+
+inline const uint16_t* getBPTCWeights(const uint32_t indexBits)
+{
+	switch (indexBits)
+	{
+		case 2u:
+			return BPTCWeights2;
+		case 3u:
+			return BPTCWeights3;
+		default:
+			return BPTCWeights4;
+	}
+}
+
+inline int32_t bptcInterpolate(const int32_t e0, const int32_t e1, const uint16_t w)
+{
+	return ((64-int32_t(w))*e0+int32_t(w)*e1+32)>>6;
+}
+
+//! Four channels at once, every channel may use a different weight (BC7 modes 4 and 5 index alpha separately).
+inline void bptcInterpolate(const int32_t (&e0)[4], const int32_t (&e1)[4], const int32_t (&w)[4], int32_t (&out)[4])
+{
+#ifdef __NBL_COMPILE_WITH_X86_SIMD_
+	const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(e0));
+	const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(e1));
+	const __m128i wb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(w));
+	const __m128i wa = _mm_sub_epi32(_mm_set1_epi32(64),wb);
+	const __m128i sum = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(wa,a),_mm_mullo_epi32(wb,b)),_mm_set1_epi32(32));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out),_mm_srai_epi32(sum,6));
+#else
+	for (uint32_t c=0u; c<4u; c++)
+		out[c] = ((64-w[c])*e0[c]+w[c]*e1[c]+32)>>6;
+#endif
+}
+
+// partition tables shared by BC6H and BC7, one bit per texel for two subsets and two bits per texel for three
+constexpr uint16_t BPTCPartitions2[64] = {
+	0xcccc,0x8888,0xeeee,0xecc8,0xc880,0xfeec,0xfec8,0xec80,
+	0xc800,0xffec,0xfe80,0xe800,0xffe8,0xff00,0xfff0,0xf000,
+	0xf710,0x008e,0x7100,0x08ce,0x008c,0x7310,0x3100,0x8cce,
+	0x088c,0x3110,0x6666,0x366c,0x17e8,0x0ff0,0x718e,0x399c,
+	0xaaaa,0xf0f0,0x5a5a,0x33cc,0x3c3c,0x55aa,0x9696,0xa55a,
+	0x73ce,0x13c8,0x324c,0x3bdc,0x6996,0xc33c,0x9966,0x0660,
+	0x0272,0x04e4,0x4e40,0x2720,0xc936,0x936c,0x39c6,0x639c,
+	0x9336,0x9cc6,0x817e,0xe718,0xccf0,0x0fcc,0x7744,0xee22
+};
+constexpr uint32_t BPTCPartitions3[64] = {
+	0xaa685050,0x6a5a5040,0x5a5a4200,0x5450a0a8,0xa5a50000,0xa0a05050,0x5555a0a0,0x5a5a5050,
+	0xaa550000,0xaa555500,0xaaaa5500,0x90909090,0x94949494,0xa4a4a4a4,0xa9a59450,0x2a0a4250,
+	0xa5945040,0x0a425054,0xa5a5a500,0x55a0a0a0,0xa8a85454,0x6a6a4040,0xa4a45000,0x1a1a0500,
+	0x0050a4a4,0xaaa59090,0x14696914,0x69691400,0xa08585a0,0xaa821414,0x50a4a450,0x6a5a0200,
+	0xa9a58000,0x5090a0a8,0xa8a09050,0x24242424,0x00aa5500,0x24924924,0x24499224,0x50a50a50,
+	0x500aa550,0xaaaa4444,0x66660000,0xa5a0a5a0,0x50a050a0,0x69286928,0x44aaaa44,0x66666600,
+	0xaa444444,0x54a854a8,0x95809580,0x96969600,0xa85454a8,0x80959580,0xaa141414,0x96960000,
+	0xaaaa1414,0xa05050a0,0xa0a5a5a0,0x96000000,0x40804080,0xa9a8a9a8,0xaaaaaa44,0x2a4a5254
+};
+// anchor texels, whose index has an implicit zero MSB, subset 0 always anchors at texel 0
+constexpr uint8_t BPTCAnchors2[64] = {
+	15,15,15,15,15,15,15,15,15,15,15,15,15,15,15,15,
+	15, 2, 8, 2, 2, 8, 8,15, 2, 8, 2, 2, 8, 8, 2, 2,
+	15,15, 6, 8, 2, 8,15,15, 2, 8, 2, 2, 2,15,15, 6,
+	 6, 2, 6, 8,15,15, 2, 2,15,15,15,15,15, 2, 2,15
+};
+constexpr uint8_t BPTCAnchors3[2][64] = {
+	{
+		 3, 3,15,15, 8, 3,15,15, 8, 8, 6, 6, 6, 5, 3, 3,
+		 3, 3, 8,15, 3, 3, 6,10, 5, 8, 8, 6, 8, 5,15,15,
+		 8,15, 3, 5, 6,10, 8,15,15, 3,15, 5,15,15,15,15,
+		 3,15, 5, 5, 5, 8, 5,10, 5,10, 8,13,15,12, 3, 3
+	},
+	{
+		15, 8, 8, 3,15,15, 3, 8,15,15,15,15,15,15,15, 8,
+		15, 8,15, 3,15, 8,15, 8, 3,15, 6,10,15,15,10, 8,
+		15, 3,15,10,10, 8, 9,10, 6,15, 8,15, 3, 6, 6, 8,
+		15, 3,15,15,15,15,15,15,15,15,15,15, 3,15,15, 8
+	}
+};
+
+inline uint32_t getBPTCSubset(const uint32_t subsets, const uint32_t partition, const uint32_t texel)
+{
+	switch (subsets)
+	{
+		case 2u:
+			return (BPTCPartitions2[partition]>>texel)&0x1u;
+		case 3u:
+			return (BPTCPartitions3[partition]>>(texel*2u))&0x3u;
+		default:
+			return 0u;
+	}
+}
+
+inline bool isBPTCAnchor(const uint32_t subsets, const uint32_t partition, const uint32_t texel)
+{
+	if (texel==0u)
+		return true;
+	switch (subsets)
+	{
+		case 2u:
+			return texel==BPTCAnchors2[partition];
+		case 3u:
+			return texel==BPTCAnchors3[0][partition] || texel==BPTCAnchors3[1][partition];
+		default:
+			return false;
+	}
+}
+
+inline int32_t signExtend(const uint32_t v, const uint32_t bits)
+{
+	const uint32_t shift = 32u-bits;
+	return int32_t(v<<shift)>>shift;
+}
+
+//
+// BC1-BC3 colour
+//
+inline uint16_t packRGB565(const float* rgb)
+{
+	const uint32_t r = uint32_t(std::lround(saturate(rgb[0])*31.f));
+	const uint32_t g = uint32_t(std::lround(saturate(rgb[1])*63.f));
+	const uint32_t b = uint32_t(std::lround(saturate(rgb[2])*31.f));
+	return uint16_t((r<<11u)|(g<<5u)|b);
+}
+inline void unpackRGB565(const uint16_t v, uint32_t (&out)[3])
+{
+	const uint32_t r = (v>>11u)&0x1fu;
+	const uint32_t g = (v>>5u)&0x3fu;
+	const uint32_t b = v&0x1fu;
+	out[0] = (r<<3u)|(r>>2u);
+	out[1] = (g<<2u)|(g>>4u);
+	out[2] = (b<<3u)|(b>>2u);
+}
+
+//! Returns whether the block decodes in 4 colour mode, BC2 and BC3 always do.
+bool decodeBC1Palette(const uint16_t c0, const uint16_t c1, const bool forceFourColor, float (&palette)[4][4])
+{
+	uint32_t a[3],b[3];
+	unpackRGB565(c0,a);
+	unpackRGB565(c1,b);
+	const bool fourColor = forceFourColor || c0>c1;
+	for (uint32_t c=0u; c<3u; c++)
+	{
+		palette[0][c] = float(a[c])/255.f;
+		palette[1][c] = float(b[c])/255.f;
+		if (fourColor)
+		{
+			palette[2][c] = float((2u*a[c]+b[c])/3u)/255.f;
+			palette[3][c] = float((a[c]+2u*b[c])/3u)/255.f;
+		}
+		else
+		{
+			palette[2][c] = float((a[c]+b[c])/2u)/255.f;
+			palette[3][c] = 0.f;
+		}
+	}
+	palette[0][3] = palette[1][3] = palette[2][3] = 1.f;
+	palette[3][3] = fourColor ? 1.f:0.f;
+	return fourColor;
+}
+
+struct SBC1Color
+{
+	uint16_t c0 = 0u;
+	uint16_t c1 = 0u;
+	uint32_t indices = 0u;
+	float error = std::numeric_limits<float>::max();
+};
+
+SBC1Color encodeBC1Color(const texel_block_t& px, const bool* transparent, const bool allowThreeColor, const CBlockCompressionCodec::E_QUALITY quality)
+{
+	bool opaque[16];
+	bool anyOpaque = false, anyTransparent = false;
+	for (uint32_t i=0u; i<16u; i++)
+	{
+		opaque[i] = !(transparent && transparent[i]);
+		anyOpaque = anyOpaque || opaque[i];
+		anyTransparent = anyTransparent || !opaque[i];
+	}
+	if (!anyOpaque)
+	{
+		// equal endpoints select 3 colour mode, index 3 is transparent black
+		SBC1Color retval;
+		retval.indices = ~0u;
+		retval.error = 0.f;
+		return retval;
+	}
+
+	auto tryEndpoints = [&](const bool wantFourColor, float (&e0)[4], float (&e1)[4], float (&weights)[16]) -> SBC1Color
+	{
+		SBC1Color retval;
+		retval.c0 = packRGB565(e0);
+		retval.c1 = packRGB565(e1);
+		if (wantFourColor ? (retval.c0<retval.c1):(retval.c0>retval.c1))
+		{
+			std::swap(retval.c0,retval.c1);
+			std::swap(e0,e1);
+		}
+		float palette[4][4];
+		const bool fourColor = decodeBC1Palette(retval.c0,retval.c1,!allowThreeColor,palette);
+		const float paletteWeights[4] = {0.f,1.f,fourColor ? (1.f/3.f):0.5f,fourColor ? (2.f/3.f):0.f};
+		retval.error = 0.f;
+		for (uint32_t i=0u; i<16u; i++)
+		{
+			uint32_t index = 3u;
+			if (opaque[i])
+			{
+				float error;
+				index = findClosest(px[i],palette,3u,fourColor ? 4u:3u,error);
+				retval.error += error;
+			}
+			retval.indices |= index<<(i*2u);
+			weights[i] = paletteWeights[index];
+		}
+		return retval;
+	};
+	auto search = [&](const bool wantFourColor) -> SBC1Color
+	{
+		float e0[4],e1[4];
+		fitLine(px,opaque,3u,quality==CBlockCompressionCodec::EQ_FAST,e0,e1);
+		SBC1Color best;
+		for (uint32_t it=0u; it<getRefinementIterations(quality); it++)
+		{
+			float weights[16];
+			const auto candidate = tryEndpoints(wantFourColor,e0,e1,weights);
+			if (candidate.error<best.error)
+				best = candidate;
+			if (best.error==0.f || !refineLine(px,opaque,3u,weights,e0,e1))
+				break;
+		}
+		return best;
+	};
+
+	if (anyTransparent)
+		return search(false);
+	auto best = search(true);
+	if (allowThreeColor && quality==CBlockCompressionCodec::EQ_HIGH)
+	{
+		const auto threeColor = search(false);
+		if (threeColor.error<best.error)
+			best = threeColor;
+	}
+	return best;
+}
+
+void writeBC1Color(const SBC1Color& color, uint8_t* out)
+{
+	out[0] = uint8_t(color.c0);
+	out[1] = uint8_t(color.c0>>8u);
+	out[2] = uint8_t(color.c1);
+	out[3] = uint8_t(color.c1>>8u);
+	std::memcpy(out+4,&color.indices,sizeof(uint32_t));
+}
+
+void decodeBC1Color(const uint8_t* in, const bool forceFourColor, texel_block_t& out)
+{
+	const uint16_t c0 = uint16_t(in[0])|(uint16_t(in[1])<<8u);
+	const uint16_t c1 = uint16_t(in[2])|(uint16_t(in[3])<<8u);
+	uint32_t indices;
+	std::memcpy(&indices,in+4,sizeof(uint32_t));
+
+	float palette[4][4];
+	decodeBC1Palette(c0,c1,forceFourColor,palette);
+	for (uint32_t i=0u; i<16u; i++)
+		std::copy_n(palette[(indices>>(i*2u))&0x3u],4,out[i]);
+}
+
+//
+// BC4 (also BC3 alpha and BC5 channels)
+//
+void decodeBC4Palette(const int32_t a0, const int32_t a1, const bool isSigned, float (&palette)[8])
+{
+	const auto toFloat = [isSigned](const int32_t v) -> float
+	{
+		return isSigned ? float(std::max(v,-127))/127.f:float(v)/255.f;
+	};
+	const float r0 = toFloat(a0);
+	const float r1 = toFloat(a1);
+	palette[0] = r0;
+	palette[1] = r1;
+	if (a0>a1)
+	{
+		for (int32_t i=2; i<8; i++)
+			palette[i] = (float(8-i)*r0+float(i-1)*r1)/7.f;
+	}
+	else
+	{
+		for (int32_t i=2; i<6; i++)
+			palette[i] = (float(6-i)*r0+float(i-1)*r1)/5.f;
+		palette[6] = isSigned ? -1.f:0.f;
+		palette[7] = 1.f;
+	}
+}
+
+struct SBC4Channel
+{
+	int32_t a0 = 0;
+	int32_t a1 = 0;
+	uint64_t indices = 0ull;
+	float error = std::numeric_limits<float>::max();
+};
+
+SBC4Channel encodeBC4Channel(const float (&values)[16], const bool isSigned, const CBlockCompressionCodec::E_QUALITY quality)
+{
+	const auto quantize = [isSigned](const float x) -> int32_t
+	{
+		return isSigned ? std::clamp<int32_t>(std::lround(x*127.f),-127,127):std::clamp<int32_t>(std::lround(x*255.f),0,255);
+	};
+	const float minVal = isSigned ? -1.f:0.f;
+
+	auto tryEndpoints = [&](const int32_t a0, const int32_t a1, float (&weights)[16]) -> SBC4Channel
+	{
+		SBC4Channel retval;
+		retval.a0 = a0;
+		retval.a1 = a1;
+		retval.error = 0.f;
+		float palette[8];
+		decodeBC4Palette(a0,a1,isSigned,palette);
+		const bool eightValue = a0>a1;
+		for (uint32_t i=0u; i<16u; i++)
+		{
+			uint32_t best = 0u;
+			float bestError = std::numeric_limits<float>::max();
+			for (uint32_t j=0u; j<8u; j++)
+			{
+				const float diff = palette[j]-values[i];
+				if (diff*diff<bestError)
+				{
+					bestError = diff*diff;
+					best = j;
+				}
+			}
+			retval.error += bestError;
+			retval.indices |= uint64_t(best)<<(i*3ull);
+			// explicit 0/1 extremes of the 6 value mode don't constrain the endpoints
+			if (eightValue)
+				weights[i] = best<2u ? float(best):(float(best-1u)/7.f);
+			else
+				weights[i] = best<2u ? float(best):(best<6u ? (float(best-1u)/5.f):-1.f);
+		}
+		return retval;
+	};
+	auto refine = [&](const float (&weights)[16], float& e0, float& e1) -> bool
+	{
+		texel_block_t px = {};
+		bool mask[16];
+		float w[16];
+		for (uint32_t i=0u; i<16u; i++)
+		{
+			px[i][0] = values[i];
+			mask[i] = weights[i]>=0.f;
+			w[i] = std::max(weights[i],0.f);
+		}
+		float f0[4] = {e0}, f1[4] = {e1};
+		if (!refineLine(px,mask,1u,w,f0,f1))
+			return false;
+		e0 = f0[0];
+		e1 = f1[0];
+		return true;
+	};
+
+	float lo = values[0], hi = values[0];
+	for (uint32_t i=1u; i<16u; i++)
+	{
+		lo = std::min(lo,values[i]);
+		hi = std::max(hi,values[i]);
+	}
+
+	// 8 value mode needs a0>a1
+	SBC4Channel best;
+	{
+		float e0 = hi, e1 = lo;
+		for (uint32_t it=0u; it<getRefinementIterations(quality); it++)
+		{
+			int32_t a0 = quantize(e0);
+			int32_t a1 = quantize(e1);
+			if (a0<a1)
+			{
+				std::swap(a0,a1);
+				std::swap(e0,e1);
+			}
+			float weights[16];
+			const auto candidate = tryEndpoints(a0,a1,weights);
+			if (candidate.error<best.error)
+				best = candidate;
+			if (best.error==0.f || a0==a1 || !refine(weights,e0,e1))
+				break;
+		}
+	}
+	if (quality==CBlockCompressionCodec::EQ_HIGH && best.error>0.f)
+	{
+		// 6 value mode, only fit the texels which aren't served by the explicit extremes
+		float innerLo = std::numeric_limits<float>::max();
+		float innerHi = -std::numeric_limits<float>::max();
+		for (uint32_t i=0u; i<16u; i++)
+		if (values[i]>minVal && values[i]<1.f)
+		{
+			innerLo = std::min(innerLo,values[i]);
+			innerHi = std::max(innerHi,values[i]);
+		}
+		if (innerLo<=innerHi)
+		{
+			float e0 = innerLo, e1 = innerHi;
+			for (uint32_t it=0u; it<getRefinementIterations(quality); it++)
+			{
+				int32_t a0 = quantize(e0);
+				int32_t a1 = quantize(e1);
+				if (a0>a1)
+				{
+					std::swap(a0,a1);
+					std::swap(e0,e1);
+				}
+				float weights[16];
+				const auto candidate = tryEndpoints(a0,a1,weights);
+				if (candidate.error<best.error)
+					best = candidate;
+				if (best.error==0.f || !refine(weights,e0,e1))
+					break;
+			}
+		}
+	}
+	return best;
+}
+
+void writeBC4Channel(const SBC4Channel& channel, uint8_t* out)
+{
+	out[0] = uint8_t(channel.a0);
+	out[1] = uint8_t(channel.a1);
+	for (uint32_t i=0u; i<6u; i++)
+		out[2u+i] = uint8_t(channel.indices>>(i*8ull));
+}
+
+void decodeBC4Channel(const uint8_t* in, const bool isSigned, const uint32_t channel, texel_block_t& out)
+{
+	const int32_t a0 = isSigned ? int32_t(int8_t(in[0])):int32_t(in[0]);
+	const int32_t a1 = isSigned ? int32_t(int8_t(in[1])):int32_t(in[1]);
+	uint64_t indices = 0ull;
+	for (uint32_t i=0u; i<6u; i++)
+		indices |= uint64_t(in[2u+i])<<(i*8ull);
+
+	float palette[8];
+	decodeBC4Palette(a0,a1,isSigned,palette);
+	for (uint32_t i=0u; i<16u; i++)
+		out[i][channel] = palette[(indices>>(i*3ull))&0x7ull];
+}
+
+//
+// BC7
+//
+inline uint32_t bc7Expand(const uint32_t v, const uint32_t bits)
+{
+	return bits<8u ? ((v<<(8u-bits))|(v>>(2u*bits-8u))):v;
+}
+
+struct SBC7Mode6
+{
+	uint32_t endpoints[2][4] = {};
+	uint32_t pbits[2] = {};
+	uint8_t indices[16] = {};
+	float error = std::numeric_limits<float>::max();
+};
+
+void quantizeBC7Mode6Endpoint(const float (&e)[4], const int32_t forcedPBit, uint32_t (&out)[4], uint32_t& pbit)
+{
+	float bestError = std::numeric_limits<float>::max();
+	for (uint32_t p=0u; p<2u; p++)
+	{
+		if (forcedPBit>=0 && uint32_t(forcedPBit)!=p)
+			continue;
+		uint32_t q[4];
+		float error = 0.f;
+		for (uint32_t c=0u; c<4u; c++)
+		{
+			const float target = saturate(e[c])*255.f;
+			q[c] = uint32_t(std::clamp<int32_t>(std::lround((target-float(p))*0.5f),0,127));
+			const float diff = float((q[c]<<1u)|p)-target;
+			error += diff*diff;
+		}
+		if (error<bestError)
+		{
+			bestError = error;
+			std::copy_n(q,4,out);
+			pbit = p;
+		}
+	}
+}
+
+SBC7Mode6 encodeBC7Mode6(const texel_block_t& px, const CBlockCompressionCodec::E_QUALITY quality)
+{
+	auto tryEndpoints = [&](const float (&e0)[4], const float (&e1)[4], const int32_t p0, const int32_t p1, float (&weights)[16]) -> SBC7Mode6
+	{
+		SBC7Mode6 retval;
+		quantizeBC7Mode6Endpoint(e0,p0,retval.endpoints[0],retval.pbits[0]);
+		quantizeBC7Mode6Endpoint(e1,p1,retval.endpoints[1],retval.pbits[1]);
+		float palette[16][4];
+		for (uint32_t c=0u; c<4u; c++)
+		{
+			const int32_t a = int32_t((retval.endpoints[0][c]<<1u)|retval.pbits[0]);
+			const int32_t b = int32_t((retval.endpoints[1][c]<<1u)|retval.pbits[1]);
+			for (uint32_t j=0u; j<16u; j++)
+				palette[j][c] = float(bptcInterpolate(a,b,BPTCWeights4[j]))/255.f;
+		}
+		retval.error = 0.f;
+		for (uint32_t i=0u; i<16u; i++)
+		{
+			float error;
+			retval.indices[i] = uint8_t(findClosest(px[i],palette,4u,16u,error));
+			retval.error += error;
+			weights[i] = float(BPTCWeights4[retval.indices[i]])/64.f;
+		}
+		return retval;
+	};
+
+	float e0[4],e1[4];
+	fitLine(px,nullptr,4u,quality==CBlockCompressionCodec::EQ_FAST,e0,e1);
+	SBC7Mode6 best;
+	float bestE0[4],bestE1[4];
+	for (uint32_t it=0u; it<getRefinementIterations(quality); it++)
+	{
+		float weights[16];
+		const auto candidate = tryEndpoints(e0,e1,-1,-1,weights);
+		if (candidate.error<best.error)
+		{
+			best = candidate;
+			std::copy_n(e0,4,bestE0);
+			std::copy_n(e1,4,bestE1);
+		}
+		if (best.error==0.f || !refineLine(px,nullptr,4u,weights,e0,e1))
+			break;
+	}
+	if (quality==CBlockCompressionCodec::EQ_HIGH)
+	for (int32_t p=0; p<4; p++)
+	{
+		float weights[16];
+		const auto candidate = tryEndpoints(bestE0,bestE1,p&0x1,p>>1,weights);
+		if (candidate.error<best.error)
+			best = candidate;
+	}
+
+	// anchor index must have its MSB clear
+	if (best.indices[0]&0x8u)
+	{
+		std::swap(best.endpoints[0],best.endpoints[1]);
+		std::swap(best.pbits[0],best.pbits[1]);
+		for (auto& index : best.indices)
+			index = 15u-index;
+	}
+	return best;
+}
+
+void writeBC7Mode6(const SBC7Mode6& block, uint8_t* out)
+{
+	SBitWriter writer;
+	writer.write(0x1u<<6u,7u);
+	for (uint32_t c=0u; c<4u; c++)
+	{
+		writer.write(block.endpoints[0][c],7u);
+		writer.write(block.endpoints[1][c],7u);
+	}
+	writer.write(block.pbits[0],1u);
+	writer.write(block.pbits[1],1u);
+	for (uint32_t i=0u; i<16u; i++)
+		writer.write(block.indices[i],i ? 4u:3u);
+	std::memcpy(out,writer.bytes,16u);
+}
+
+struct SBC7ModeInfo
+{
+	uint8_t subsets;
+	uint8_t partitionBits;
+	uint8_t rotationBits;
+	uint8_t indexSelectionBits;
+	uint8_t colorBits;
+	uint8_t alphaBits;
+	uint8_t endpointPBits;
+	uint8_t sharedPBits;
+	uint8_t indexBits;
+	uint8_t index2Bits;
+};
+constexpr SBC7ModeInfo BC7Modes[8] = {
+	{3,4,0,0,4,0,1,0,3,0},
+	{2,6,0,0,6,0,0,1,3,0},
+	{3,6,0,0,5,0,0,0,2,0},
+	{2,6,0,0,7,0,1,0,2,0},
+	{1,0,2,1,5,6,0,0,2,3},
+	{1,0,2,0,7,8,0,0,2,2},
+	{1,0,0,0,7,7,1,0,4,0},
+	{2,6,0,0,5,5,1,0,2,0}
+};
+
+bool decodeBC7(const uint8_t* in, texel_block_t& out)
+{
+	SBitReader reader = {in};
+	uint32_t mode = 0u;
+	while (mode<8u && reader.read(1u)==0u)
+		mode++;
+	if (mode==8u)
+	{
+		// the reserved mode decodes to transparent black
+		for (auto& texel : out)
+			std::fill_n(texel,4,0.f);
+		return true;
+	}
+
+	const auto& info = BC7Modes[mode];
+	const uint32_t partition = reader.read(info.partitionBits);
+	const uint32_t rotation = reader.read(info.rotationBits);
+	const uint32_t indexSelection = reader.read(info.indexSelectionBits);
+
+	// endpoints are stored channel-major, alpha is implicitly opaque in the colour-only modes
+	const uint32_t endpointCount = info.subsets*2u;
+	int32_t endpoints[6][4];
+	for (uint32_t c=0u; c<3u; c++)
+	for (uint32_t e=0u; e<endpointCount; e++)
+		endpoints[e][c] = int32_t(reader.read(info.colorBits));
+	for (uint32_t e=0u; e<endpointCount; e++)
+		endpoints[e][3] = info.alphaBits ? int32_t(reader.read(info.alphaBits)):255;
+
+	uint32_t colorBits = info.colorBits, alphaBits = info.alphaBits;
+	if (info.endpointPBits || info.sharedPBits)
+	{
+		uint32_t pbits[6];
+		if (info.endpointPBits)
+		for (uint32_t e=0u; e<endpointCount; e++)
+			pbits[e] = reader.read(1u);
+		else
+		for (uint32_t s=0u; s<info.subsets; s++)
+			pbits[s*2u] = pbits[s*2u+1u] = reader.read(1u);
+		for (uint32_t e=0u; e<endpointCount; e++)
+		for (uint32_t c=0u; c<(alphaBits ? 4u:3u); c++)
+			endpoints[e][c] = (endpoints[e][c]<<1)|int32_t(pbits[e]);
+		colorBits++;
+		if (alphaBits)
+			alphaBits++;
+	}
+	for (uint32_t e=0u; e<endpointCount; e++)
+	{
+		for (uint32_t c=0u; c<3u; c++)
+			endpoints[e][c] = int32_t(bc7Expand(uint32_t(endpoints[e][c]),colorBits));
+		if (alphaBits)
+			endpoints[e][3] = int32_t(bc7Expand(uint32_t(endpoints[e][3]),alphaBits));
+	}
+
+	uint8_t colorIndices[16], alphaIndices[16];
+	for (uint32_t i=0u; i<16u; i++)
+		colorIndices[i] = uint8_t(reader.read(info.indexBits-(isBPTCAnchor(info.subsets,partition,i) ? 1u:0u)));
+	if (info.index2Bits)
+	for (uint32_t i=0u; i<16u; i++)
+		alphaIndices[i] = uint8_t(reader.read(i ? info.index2Bits:(info.index2Bits-1u)));
+	else
+		std::copy_n(colorIndices,16,alphaIndices);
+
+	uint32_t colorIndexBits = info.indexBits;
+	uint32_t alphaIndexBits = info.index2Bits ? info.index2Bits:info.indexBits;
+	if (indexSelection)
+	{
+		std::swap(colorIndices,alphaIndices);
+		std::swap(colorIndexBits,alphaIndexBits);
+	}
+
+	const uint16_t* colorWeights = getBPTCWeights(colorIndexBits);
+	const uint16_t* alphaWeights = getBPTCWeights(alphaIndexBits);
+	for (uint32_t i=0u; i<16u; i++)
+	{
+		const uint32_t subset = getBPTCSubset(info.subsets,partition,i);
+		const int32_t colorWeight = colorWeights[colorIndices[i]];
+		const int32_t weights[4] = {colorWeight,colorWeight,colorWeight,alphaWeights[alphaIndices[i]]};
+		int32_t texel[4];
+		bptcInterpolate(endpoints[subset*2u],endpoints[subset*2u+1u],weights,texel);
+		if (rotation)
+			std::swap(texel[3],texel[rotation-1u]);
+		for (uint32_t c=0u; c<4u; c++)
+			out[i][c] = float(texel[c])/255.f;
+	}
+	return true;
+}
+
+//
+// BC6H
+//
+inline int32_t bc6hUnquantize(const int32_t e, const uint32_t bits, const bool isSigned)
+{
+	if (isSigned)
+	{
+		if (bits>=16u)
+			return e;
+		const int32_t magnitude = std::abs(e);
+		int32_t unq;
+		if (magnitude==0)
+			unq = 0;
+		else if (magnitude>=(0x1<<(bits-1))-1)
+			unq = 0x7fff;
+		else
+			unq = ((magnitude<<15)+0x4000)>>(bits-1);
+		return e<0 ? -unq:unq;
+	}
+	if (bits>=15u || e==0)
+		return e;
+	if (e==(0x1<<bits)-1)
+		return 0xffff;
+	return ((e<<16)+0x8000)>>bits;
+}
+
+//! Returns the value in the "half bits as integer" domain, negative for negative halves.
+inline int32_t bc6hFinish(const int32_t v, const bool isSigned)
+{
+	if (isSigned)
+		return v<0 ? -(((-v)*31)>>5):((v*31)>>5);
+	return (v*31)>>6;
+}
+
+inline uint16_t bc6hToHalfBits(const int32_t v)
+{
+	return v<0 ? uint16_t(0x8000u|uint32_t(-v)):uint16_t(v);
+}
+
+int32_t bc6hQuantizeEndpoint(const float x, const bool isSigned)
+{
+	const int32_t lo = isSigned ? -511:0;
+	const int32_t hi = isSigned ? 511:1023;
+	const float guess = isSigned ? (std::copysign(std::max(std::abs(x)/62.f-0.5f,0.f),x)):(x/31.f-0.5f);
+	const int32_t center = std::clamp<int32_t>(std::lround(guess),lo,hi);
+	int32_t best = center;
+	float bestError = std::numeric_limits<float>::max();
+	for (int32_t e=std::max(center-1,lo); e<=std::min(center+1,hi); e++)
+	{
+		const float error = std::abs(float(bc6hFinish(bc6hUnquantize(e,10u,isSigned),isSigned))-x);
+		if (error<bestError)
+		{
+			bestError = error;
+			best = e;
+		}
+	}
+	return best;
+}
+
+struct SBC6HMode11
+{
+	int32_t endpoints[2][3] = {};
+	uint8_t indices[16] = {};
+	float error = std::numeric_limits<float>::max();
+};
+
+SBC6HMode11 encodeBC6HMode11(const texel_block_t& texels, const bool isSigned, const CBlockCompressionCodec::E_QUALITY quality)
+{
+	// fit in the "half bits as integer" domain which is roughly logarithmic, same as the hardware interpolates in
+	texel_block_t px = {};
+	for (uint32_t i=0u; i<16u; i++)
+	{
+		float clamped[3];
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			const float v = std::isnan(texels[i][c]) ? 0.f:texels[i][c];
+			clamped[c] = std::clamp(v,isSigned ? -65504.f:0.f,65504.f);
+		}
+		uint16_t halves[3];
+		impl::floatToHalf(clamped,halves,3u);
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			const int32_t magnitude = halves[c]&0x7fffu;
+			px[i][c] = float((halves[c]&0x8000u) ? -magnitude:magnitude);
+		}
+	}
+
+	auto tryEndpoints = [&](const float (&e0)[4], const float (&e1)[4], float (&weights)[16]) -> SBC6HMode11
+	{
+		SBC6HMode11 retval;
+		float palette[16][4] = {};
+		for (uint32_t c=0u; c<3u; c++)
+		{
+			retval.endpoints[0][c] = bc6hQuantizeEndpoint(e0[c],isSigned);
+			retval.endpoints[1][c] = bc6hQuantizeEndpoint(e1[c],isSigned);
+			const int32_t a = bc6hUnquantize(retval.endpoints[0][c],10u,isSigned);
+			const int32_t b = bc6hUnquantize(retval.endpoints[1][c],10u,isSigned);
+			for (uint32_t j=0u; j<16u; j++)
+				palette[j][c] = float(bc6hFinish(bptcInterpolate(a,b,BPTCWeights4[j]),isSigned));
+		}
+		retval.error = 0.f;
+		for (uint32_t i=0u; i<16u; i++)
+		{
+			float error;
+			retval.indices[i] = uint8_t(findClosest(px[i],palette,3u,16u,error));
+			retval.error += error;
+			weights[i] = float(BPTCWeights4[retval.indices[i]])/64.f;
+		}
+		return retval;
+	};
+
+	float e0[4],e1[4];
+	fitLine(px,nullptr,3u,quality==CBlockCompressionCodec::EQ_FAST,e0,e1);
+	SBC6HMode11 best;
+	for (uint32_t it=0u; it<getRefinementIterations(quality); it++)
+	{
+		float weights[16];
+		const auto candidate = tryEndpoints(e0,e1,weights);
+		if (candidate.error<best.error)
+			best = candidate;
+		if (best.error==0.f || !refineLine(px,nullptr,3u,weights,e0,e1))
+			break;
+	}
+
+	if (best.indices[0]&0x8u)
+	{
+		std::swap(best.endpoints[0],best.endpoints[1]);
+		for (auto& index : best.indices)
+			index = 15u-index;
+	}
+	return best;
+}
+
+void writeBC6HMode11(const SBC6HMode11& block, uint8_t* out)
+{
+	SBitWriter writer;
+	writer.write(0x03u,5u);
+	for (uint32_t e=0u; e<2u; e++)
+	for (uint32_t c=0u; c<3u; c++)
+		writer.write(uint32_t(block.endpoints[e][c])&0x3ffu,10u);
+	for (uint32_t i=0u; i<16u; i++)
+		writer.write(block.indices[i],i ? 4u:3u);
+	std::memcpy(out,writer.bytes,16u);
+}
+
+// endpoint fields of the BC6H bit layouts, `endpoint*3+channel` with endpoints ordered W,X,Y,Z
+enum E_BC6H_FIELD : uint8_t
+{
+	RW,GW,BW,
+	RX,GX,BX,
+	RY,GY,BY,
+	RZ,GZ,BZ,
+	D
+};
+struct SBC6HBits
+{
+	uint8_t field;
+	uint8_t lsb;
+	uint8_t count;
+	// the 12 and 16 bit modes store the top bits of the base endpoint MSB first
+	bool reversed = false;
+};
+struct SBC6HModeInfo
+{
+	bool transformed;
+	uint8_t regions;
+	uint8_t endpointBits;
+	uint8_t deltaBits[3];
+	SBC6HBits layout[24];
+};
+// in the order of the mode field values 0x00,0x01,0x02,0x06,...,0x1e,0x03,0x07,0x0b,0x0f, the mode field itself is not part of the layout
+constexpr SBC6HModeInfo BC6HModes[14] = {
+	{true,2,10,{5,5,5},{
+		{GY,4,1},{BY,4,1},{BZ,4,1},{RW,0,10},{GW,0,10},{BW,0,10},{RX,0,5},{GZ,4,1},{GY,0,4},{GX,0,5},{BZ,0,1},
+		{GZ,0,4},{BX,0,5},{BZ,1,1},{BY,0,4},{RY,0,5},{BZ,2,1},{RZ,0,5},{BZ,3,1},{D,0,5}
+	}},
+	{true,2,7,{6,6,6},{
+		{GY,5,1},{GZ,4,1},{GZ,5,1},{RW,0,7},{BZ,0,1},{BZ,1,1},{BY,4,1},{GW,0,7},{BY,5,1},{BZ,2,1},{GY,4,1},{BW,0,7},
+		{BZ,3,1},{BZ,5,1},{BZ,4,1},{RX,0,6},{GY,0,4},{GX,0,6},{GZ,0,4},{BX,0,6},{BY,0,4},{RY,0,6},{RZ,0,6},{D,0,5}
+	}},
+	{true,2,11,{5,4,4},{
+		{RW,0,10},{GW,0,10},{BW,0,10},{RX,0,5},{RW,10,1},{GY,0,4},{GX,0,4},{GW,10,1},{BZ,0,1},{GZ,0,4},{BX,0,4},
+		{BW,10,1},{BZ,1,1},{BY,0,4},{RY,0,5},{BZ,2,1},{RZ,0,5},{BZ,3,1},{D,0,5}
+	}},
+	{true,2,11,{4,5,4},{
+		{RW,0,10},{GW,0,10},{BW,0,10},{RX,0,4},{RW,10,1},{GZ,4,1},{GY,0,4},{GX,0,5},{GW,10,1},{GZ,0,4},{BX,0,4},
+		{BW,10,1},{BZ,1,1},{BY,0,4},{RY,0,4},{BZ,0,1},{BZ,2,1},{RZ,0,4},{GY,4,1},{BZ,3,1},{D,0,5}
+	}},
+	{true,2,11,{4,4,5},{
+		{RW,0,10},{GW,0,10},{BW,0,10},{RX,0,4},{RW,10,1},{BY,4,1},{GY,0,4},{GX,0,4},{GW,10,1},{BZ,0,1},{GZ,0,4},
+		{BX,0,5},{BW,10,1},{BY,0,4},{RY,0,4},{BZ,1,1},{BZ,2,1},{RZ,0,4},{BZ,4,1},{BZ,3,1},{D,0,5}
+	}},
+	{true,2,9,{5,5,5},{
+		{RW,0,9},{BY,4,1},{GW,0,9},{GY,4,1},{BW,0,9},{BZ,4,1},{RX,0,5},{GZ,4,1},{GY,0,4},{GX,0,5},{BZ,0,1},
+		{GZ,0,4},{BX,0,5},{BZ,1,1},{BY,0,4},{RY,0,5},{BZ,2,1},{RZ,0,5},{BZ,3,1},{D,0,5}
+	}},
+	{true,2,8,{6,5,5},{
+		{RW,0,8},{GZ,4,1},{BY,4,1},{GW,0,8},{BZ,2,1},{GY,4,1},{BW,0,8},{BZ,3,1},{BZ,4,1},{RX,0,6},{GY,0,4},
+		{GX,0,5},{BZ,0,1},{GZ,0,4},{BX,0,5},{BZ,1,1},{BY,0,4},{RY,0,6},{RZ,0,6},{D,0,5}
+	}},
+	{true,2,8,{5,6,5},{
+		{RW,0,8},{BZ,0,1},{BY,4,1},{GW,0,8},{GY,5,1},{GY,4,1},{BW,0,8},{GZ,5,1},{BZ,4,1},{RX,0,5},{GZ,4,1},
+		{GY,0,4},{GX,0,6},{GZ,0,4},{BX,0,5},{BZ,1,1},{BY,0,4},{RY,0,5},{BZ,2,1},{RZ,0,5},{BZ,3,1},{D,0,5}
+	}},
+	{true,2,8,{5,5,6},{
+		{RW,0,8},{BZ,1,1},{BY,4,1},{GW,0,8},{BY,5,1},{GY,4,1},{BW,0,8},{BZ,5,1},{BZ,4,1},{RX,0,5},{GZ,4,1},
+		{GY,0,4},{GX,0,5},{BZ,0,1},{GZ,0,4},{BX,0,6},{BY,0,4},{RY,0,5},{BZ,2,1},{RZ,0,5},{BZ,3,1},{D,0,5}
+	}},
+	{false,2,6,{6,6,6},{
+		{RW,0,6},{GZ,4,1},{BZ,0,1},{BZ,1,1},{BY,4,1},{GW,0,6},{GY,5,1},{BY,5,1},{BZ,2,1},{GY,4,1},{BW,0,6},{GZ,5,1},
+		{BZ,3,1},{BZ,5,1},{BZ,4,1},{RX,0,6},{GY,0,4},{GX,0,6},{GZ,0,4},{BX,0,6},{BY,0,4},{RY,0,6},{RZ,0,6},{D,0,5}
+	}},
+	{false,1,10,{10,10,10},{
+		{RW,0,10},{GW,0,10},{BW,0,10},{RX,0,10},{GX,0,10},{BX,0,10}
+	}},
+	{true,1,11,{9,9,9},{
+		{RW,0,10},{GW,0,10},{BW,0,10},{RX,0,9},{RW,10,1},{GX,0,9},{GW,10,1},{BX,0,9},{BW,10,1}
+	}},
+	{true,1,12,{8,8,8},{
+		{RW,0,10},{GW,0,10},{BW,0,10},{RX,0,8},{RW,10,2,true},{GX,0,8},{GW,10,2,true},{BX,0,8},{BW,10,2,true}
+	}},
+	{true,1,16,{4,4,4},{
+		{RW,0,10},{GW,0,10},{BW,0,10},{RX,0,4},{RW,10,6,true},{GX,0,4},{GW,10,6,true},{BX,0,4},{BW,10,6,true}
+	}}
+};
+
+inline int32_t getBC6HModeIndex(const uint32_t modeField)
+{
+	if (modeField<2u)
+		return int32_t(modeField);
+	switch (modeField)
+	{
+		case 0x02u: case 0x06u: case 0x0au: case 0x0eu:
+		case 0x12u: case 0x16u: case 0x1au: case 0x1eu:
+			return 2+int32_t(modeField>>2u);
+		case 0x03u: case 0x07u: case 0x0bu: case 0x0fu:
+			return 10+int32_t(modeField>>2u);
+		default:
+			return -1;
+	}
+}
+
+bool decodeBC6H(const uint8_t* in, const bool isSigned, texel_block_t& out)
+{
+	SBitReader reader = {in};
+	uint32_t modeField = reader.read(2u);
+	if (modeField>=2u)
+		modeField |= reader.read(3u)<<2u;
+	const int32_t modeIndex = getBC6HModeIndex(modeField);
+	if (modeIndex<0)
+	{
+		// reserved modes decode to black
+		for (auto& texel : out)
+		{
+			std::fill_n(texel,3,0.f);
+			texel[3] = 1.f;
+		}
+		return true;
+	}
+	const auto& info = BC6HModes[modeIndex];
+
+	uint32_t fields[D+1] = {};
+	for (const auto& bits : info.layout)
+	{
+		if (!bits.count)
+			break;
+		uint32_t v = reader.read(bits.count);
+		if (bits.reversed)
+		{
+			uint32_t flipped = 0u;
+			for (uint32_t i=0u; i<bits.count; i++)
+				flipped |= ((v>>i)&0x1u)<<(bits.count-1u-i);
+			v = flipped;
+		}
+		fields[bits.field] |= v<<bits.lsb;
+	}
+
+	const uint32_t endpointCount = info.regions*2u;
+	const uint32_t endpointMask = (0x1u<<info.endpointBits)-1u;
+	int32_t endpoints[4][4] = {};
+	for (uint32_t c=0u; c<3u; c++)
+	{
+		const uint32_t base = fields[RW+c];
+		endpoints[0][c] = isSigned ? signExtend(base,info.endpointBits):int32_t(base);
+		for (uint32_t e=1u; e<endpointCount; e++)
+		{
+			const uint32_t v = fields[e*3u+c];
+			if (info.transformed)
+			{
+				// deltas are always signed, the sum wraps around at the endpoint precision
+				const uint32_t sum = (base+uint32_t(signExtend(v,info.deltaBits[c])))&endpointMask;
+				endpoints[e][c] = isSigned ? signExtend(sum,info.endpointBits):int32_t(sum);
+			}
+			else
+				endpoints[e][c] = isSigned ? signExtend(v,info.endpointBits):int32_t(v);
+		}
+		for (uint32_t e=0u; e<endpointCount; e++)
+			endpoints[e][c] = bc6hUnquantize(endpoints[e][c],info.endpointBits,isSigned);
+	}
+
+	const uint32_t partition = fields[D];
+	const uint32_t indexBits = info.regions>1u ? 3u:4u;
+	const uint16_t* weights = getBPTCWeights(indexBits);
+	for (uint32_t i=0u; i<16u; i++)
+	{
+		const uint32_t index = reader.read(indexBits-(isBPTCAnchor(info.regions,partition,i) ? 1u:0u));
+		const uint32_t region = getBPTCSubset(info.regions,partition,i);
+		const int32_t w = weights[index];
+		const int32_t texelWeights[4] = {w,w,w,w};
+		int32_t texel[4];
+		bptcInterpolate(endpoints[region*2u],endpoints[region*2u+1u],texelWeights,texel);
+		uint16_t halves[3];
+		for (uint32_t c=0u; c<3u; c++)
+			halves[c] = bc6hToHalfBits(bc6hFinish(texel[c],isSigned));
+		impl::halfToFloat(halves,out[i],3u);
+		out[i][3] = 1.f;
+	}
+	return true;
+}
+
+inline bool isSRGBBlockFormat(const E_FORMAT format)
+{
+	switch (format)
+	{
+		case EF_BC1_RGB_SRGB_BLOCK:
+		case EF_BC1_RGBA_SRGB_BLOCK:
+		case EF_BC2_SRGB_BLOCK:
+		case EF_BC3_SRGB_BLOCK:
+		case EF_BC7_SRGB_BLOCK:
+			return true;
+		default:
+			return false;
+	}
+}
+}
+
+bool CBlockCompressionCodec::canEncode(const E_FORMAT format)
+{
+	return format>=EF_BC1_RGB_UNORM_BLOCK && format<=EF_BC7_SRGB_BLOCK;
+}
+
+bool CBlockCompressionCodec::encodeBlock(const E_FORMAT format, const texel_block_t& texels, void* outBlock, const E_QUALITY quality)
+{
+	if (!canEncode(format) || !outBlock)
+		return false;
+
+	texel_block_t px;
+	const bool srgb = isSRGBBlockFormat(format);
+	for (uint32_t i=0u; i<16u; i++)
+	for (uint32_t c=0u; c<4u; c++)
+	{
+		float v = texels[i][c];
+		switch (format)
+		{
+			case EF_BC4_SNORM_BLOCK:
+			case EF_BC5_SNORM_BLOCK:
+				v = snormClamp(v);
+				break;
+			case EF_BC6H_UFLOAT_BLOCK:
+			case EF_BC6H_SFLOAT_BLOCK:
+				break;
+			default:
+				v = saturate(v);
+				if (srgb && c<3u)
+					v = float(core::lin2srgb(v));
+				break;
+		}
+		px[i][c] = v;
+	}
+
+	auto* const out = reinterpret_cast<uint8_t*>(outBlock);
+	switch (format)
+	{
+		case EF_BC1_RGB_UNORM_BLOCK:
+		case EF_BC1_RGB_SRGB_BLOCK:
+			writeBC1Color(encodeBC1Color(px,nullptr,true,quality),out);
+			break;
+		case EF_BC1_RGBA_UNORM_BLOCK:
+		case EF_BC1_RGBA_SRGB_BLOCK:
+		{
+			bool transparent[16];
+			for (uint32_t i=0u; i<16u; i++)
+				transparent[i] = px[i][3]<0.5f;
+			writeBC1Color(encodeBC1Color(px,transparent,true,quality),out);
+			break;
+		}
+		case EF_BC2_UNORM_BLOCK:
+		case EF_BC2_SRGB_BLOCK:
+		{
+			uint64_t alpha = 0ull;
+			for (uint32_t i=0u; i<16u; i++)
+				alpha |= uint64_t(std::lround(px[i][3]*15.f))<<(i*4ull);
+			std::memcpy(out,&alpha,sizeof(uint64_t));
+			writeBC1Color(encodeBC1Color(px,nullptr,false,quality),out+8);
+			break;
+		}
+		case EF_BC3_UNORM_BLOCK:
+		case EF_BC3_SRGB_BLOCK:
+		{
+			float alpha[16];
+			for (uint32_t i=0u; i<16u; i++)
+				alpha[i] = px[i][3];
+			writeBC4Channel(encodeBC4Channel(alpha,false,quality),out);
+			writeBC1Color(encodeBC1Color(px,nullptr,false,quality),out+8);
+			break;
+		}
+		case EF_BC4_UNORM_BLOCK:
+		case EF_BC4_SNORM_BLOCK:
+		case EF_BC5_UNORM_BLOCK:
+		case EF_BC5_SNORM_BLOCK:
+		{
+			const bool isSigned = format==EF_BC4_SNORM_BLOCK || format==EF_BC5_SNORM_BLOCK;
+			const uint32_t channels = format==EF_BC4_UNORM_BLOCK || format==EF_BC4_SNORM_BLOCK ? 1u:2u;
+			for (uint32_t c=0u; c<channels; c++)
+			{
+				float values[16];
+				for (uint32_t i=0u; i<16u; i++)
+					values[i] = px[i][c];
+				writeBC4Channel(encodeBC4Channel(values,isSigned,quality),out+c*8u);
+			}
+			break;
+		}
+		case EF_BC6H_UFLOAT_BLOCK:
+		case EF_BC6H_SFLOAT_BLOCK:
+			writeBC6HMode11(encodeBC6HMode11(px,format==EF_BC6H_SFLOAT_BLOCK,quality),out);
+			break;
+		default:
+			writeBC7Mode6(encodeBC7Mode6(px,quality),out);
+			break;
+	}
+	return true;
+}
+
+bool CBlockCompressionCodec::decodeBlock(const E_FORMAT format, const void* block, texel_block_t& outTexels)
+{
+	if (!canDecode(format) || !block)
+		return false;
+
+	const auto* const in = reinterpret_cast<const uint8_t*>(block);
+	for (auto& texel : outTexels)
+	{
+		texel[0] = texel[1] = texel[2] = 0.f;
+		texel[3] = 1.f;
+	}
+	switch (format)
+	{
+		case EF_BC1_RGB_UNORM_BLOCK:
+		case EF_BC1_RGB_SRGB_BLOCK:
+			decodeBC1Color(in,false,outTexels);
+			// no punch-through alpha, the 4th palette entry is just black
+			for (auto& texel : outTexels)
+				texel[3] = 1.f;
+			break;
+		case EF_BC1_RGBA_UNORM_BLOCK:
+		case EF_BC1_RGBA_SRGB_BLOCK:
+			decodeBC1Color(in,false,outTexels);
+			break;
+		case EF_BC2_UNORM_BLOCK:
+		case EF_BC2_SRGB_BLOCK:
+		{
+			decodeBC1Color(in+8,true,outTexels);
+			uint64_t alpha;
+			std::memcpy(&alpha,in,sizeof(uint64_t));
+			for (uint32_t i=0u; i<16u; i++)
+				outTexels[i][3] = float((alpha>>(i*4ull))&0xfull)/15.f;
+			break;
+		}
+		case EF_BC3_UNORM_BLOCK:
+		case EF_BC3_SRGB_BLOCK:
+			decodeBC1Color(in+8,true,outTexels);
+			decodeBC4Channel(in,false,3u,outTexels);
+			break;
+		case EF_BC4_UNORM_BLOCK:
+		case EF_BC4_SNORM_BLOCK:
+			decodeBC4Channel(in,format==EF_BC4_SNORM_BLOCK,0u,outTexels);
+			break;
+		case EF_BC5_UNORM_BLOCK:
+		case EF_BC5_SNORM_BLOCK:
+			decodeBC4Channel(in,format==EF_BC5_SNORM_BLOCK,0u,outTexels);
+			decodeBC4Channel(in+8,format==EF_BC5_SNORM_BLOCK,1u,outTexels);
+			break;
+		case EF_BC6H_UFLOAT_BLOCK:
+		case EF_BC6H_SFLOAT_BLOCK:
+			if (!decodeBC6H(in,format==EF_BC6H_SFLOAT_BLOCK,outTexels))
+				return false;
+			break;
+		default:
+			if (!decodeBC7(in,outTexels))
+				return false;
+			break;
+	}
+
+	if (isSRGBBlockFormat(format))
+	for (auto& texel : outTexels)
+	for (uint32_t c=0u; c<3u; c++)
+		texel[c] = float(core::srgb2lin(texel[c]));
+	return true;
+}
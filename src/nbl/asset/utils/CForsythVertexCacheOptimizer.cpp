@@ -22,388 +22,414 @@
 
 
 #include <cmath>
+#include <numeric>
 
 
 #include "nbl/macros.h"
 
 #include "nbl/asset/utils/CForsythVertexCacheOptimizer.h"
+#include "nbl/asset/utils/CPolygonGeometryManipulator.h"
+#include "nbl/core/execution.h"
 
 
-#define maxSIZE_VERTEX_CACHE 16
-
 namespace nbl
 {
 namespace asset
 {
-	template<typename IdxT>
-	void CForsythVertexCacheOptimizer::optimizeTriangleOrdering(const size_t _numVerts, const size_t _numIndices, const IdxT* _indices, IdxT* _outIndices) const
-	{
-		if (_numVerts == 0 || _numIndices == 0)
-		{
-			memcpy(_outIndices, _indices, _numIndices*sizeof(IdxT));
-			return;
-		}
-
-		const uint32_t NumPrimitives = _numIndices / 3;
-		_NBL_DEBUG_BREAK_IF(NumPrimitives != uint32_t(std::floor(_numIndices / 3.0f))); // Number of indicies not divisible by 3, not a good triangle list.
-
-		//
-		// Step 1: Run through the data, and initialize
-		//
-		core::vector<VertData> vertexData(_numVerts);
-		core::vector<TriData> triangleData(NumPrimitives);
-
-		uint32_t curIdx = 0;
-		for (int32_t tri = 0; tri < NumPrimitives; tri++)
-		{
-			TriData &curTri = triangleData[tri];
+namespace
+{
+	constexpr uint32_t InvalidTriangle = ~0u;
+	// vertices with more live triangles than this all get the same valence boost, it's tiny by then anyway
+	constexpr uint32_t MaxValence = 32u;
 
-			for (int32_t c = 0; c < 3; c++)
+	// http://home.comcast.net/~tom_forsyth/papers/fast_vert_cache_opt.html
+	// The scores only depend on the cache position and the live triangle count, so they get tabulated once instead of calling `pow` per update.
+	class CScoreTables
+	{
+		public:
+			CScoreTables(const uint32_t cacheSize)
 			{
-				const IdxT &curVIdx = _indices[curIdx];
-				_NBL_DEBUG_BREAK_IF(curVIdx >= _numVerts); // Out of range index.
+				constexpr float CacheDecayPower = 1.5f;
+				constexpr float LastTriScore = 0.75f;
+				constexpr float ValenceBoostScale = 2.0f;
+				constexpr float ValenceBoostPower = 0.5f;
 
-				// Add this vert to the list of verts that define the triangle
-				curTri.vertIdx[c] = curVIdx;
+				for (uint32_t pos=0u; pos<cacheSize; pos++)
+				{
+					// This vertex was used in the last triangle, so it has a fixed score, whichever of the three it's in.
+					// Otherwise, you can get very different answers depending on whether you add the triangle 1,2,3 or 3,1,2 - which is silly.
+					if (pos<3u)
+						m_cache[pos] = LastTriScore;
+					else // Points for being high in the cache.
+						m_cache[pos] = std::pow(1.0f-float(pos-3u)/float(cacheSize-3u),CacheDecayPower);
+				}
+				// Bonus points for having a low number of tris still to use the vert, so we get rid of lone verts quickly.
+				m_valence[0] = 0.f;
+				for (uint32_t valence=1u; valence<=MaxValence; valence++)
+					m_valence[valence] = ValenceBoostScale*std::pow(float(valence),-ValenceBoostPower);
+			}
 
-				VertData &curVert = vertexData[curVIdx];
+			inline float score(const int32_t cachePosition, const uint32_t liveTriangles) const
+			{
+				// If nobody needs this vertex, return -1.0
+				if (liveTriangles==0u)
+					return -1.0f;
+				return (cachePosition<0 ? 0.f:m_cache[cachePosition])+m_valence[core::min(liveTriangles,MaxValence)];
+			}
 
-				// Increment the number of triangles that reference this vertex
-				curVert.numUnaddedReferences++;
+		private:
+			float m_cache[CForsythVertexCacheOptimizer::MaxCacheSize];
+			float m_valence[MaxValence+1u];
+	};
+}
 
-				curIdx++;
-			}
-		}
+	void CForsythVertexCacheOptimizer::optimizeChunk(const uint32_t* indices, const uint32_t triangleCount, const uint32_t vertexCount, const uint32_t cacheSize, uint32_t* outIndices)
+	{
+		const CScoreTables tables(cacheSize);
 
-		// Allocate per-vertex triangle lists, and calculate the starting score of
-		// each of the verts
-		for (int32_t v = 0; v < _numVerts; v++)
+		//
+		// Step 1: Run through the data, and initialize
+		//
+		// per-vertex triangle lists are packed back to back, the live (not yet emitted) triangles of a vertex are always at the front of its list
+		core::vector<uint32_t> liveTriangles(vertexCount,0u);
+		for (uint32_t i=0u; i<triangleCount*3u; i++)
+			liveTriangles[indices[i]]++;
+		core::vector<uint32_t> adjacencyOffsets(vertexCount);
+		std::exclusive_scan(liveTriangles.begin(),liveTriangles.end(),adjacencyOffsets.begin(),0u);
+		core::vector<uint32_t> adjacency(triangleCount*3u);
 		{
-			VertData &curVert = vertexData[v];
-			curVert.triIndex = new int32_t[curVert.numUnaddedReferences];
-			curVert.score = score(curVert);
+			core::vector<uint32_t> cursors(adjacencyOffsets);
+			for (uint32_t i=0u; i<triangleCount*3u; i++)
+				adjacency[cursors[indices[i]]++] = i/3u;
 		}
 
-		// These variables will be used later, but need to be declared now
-		int32_t nextNextBestTriIdx = -1, nextBestTriIdx = -1;
-		float nextNextBestTriScore = -1.0f, nextBestTriScore = -1.0f;
-
-#define _VALIDATE_TRI_IDX(idx) if(idx > -1) { _NBL_DEBUG_BREAK_IF(idx >= NumPrimitives); /*Out of range triangle index.*/ _NBL_DEBUG_BREAK_IF(triangleData[idx].isInList); /*Triangle already in list, bad.*/ }
-#define _CHECK_NEXT_NEXT_BEST(scr, idx) { if(scr > nextNextBestTriScore) { nextNextBestTriIdx = idx; nextNextBestTriScore = scr; } }
-#define _CHECK_NEXT_BEST(scr, idx) { if(scr > nextBestTriScore) { _CHECK_NEXT_NEXT_BEST(nextBestTriScore, nextBestTriIdx); nextBestTriIdx = idx; nextBestTriScore = scr; } _VALIDATE_TRI_IDX(nextBestTriIdx); }
-
-		// Fill-in per-vertex triangle lists, and sum the scores of each vertex used
-		// per-triangle, to get the starting triangle score
-		curIdx = 0;
-		for (int32_t tri = 0; tri < NumPrimitives; tri++)
+		core::vector<int32_t> cachePositions(vertexCount,-1);
+		core::vector<float> vertexScores(vertexCount);
+		for (uint32_t v=0u; v<vertexCount; v++)
+			vertexScores[v] = tables.score(-1,liveTriangles[v]);
+
+		// This will pick the first triangle to add to the list in 'Step 2'
+		core::vector<float> triangleScores(triangleCount);
+		core::vector<uint8_t> emitted(triangleCount,0u);
+		uint32_t bestTriangle = InvalidTriangle;
+		float bestScore = -1.f;
+		for (uint32_t tri=0u; tri<triangleCount; tri++)
 		{
-			TriData &curTri = triangleData[tri];
-
-			for (int32_t c = 0; c < 3; c++)
+			const uint32_t* triIndices = indices+tri*3u;
+			triangleScores[tri] = vertexScores[triIndices[0]]+vertexScores[triIndices[1]]+vertexScores[triIndices[2]];
+			if (triangleScores[tri]>bestScore)
 			{
-				const IdxT &curVIdx = _indices[curIdx];
-				_NBL_DEBUG_BREAK_IF(curVIdx >= _numVerts); // Out of range index.
-				VertData &curVert = vertexData[curVIdx];
-
-				// Add triangle to triangle list
-				curVert.triIndex[curVert.numReferences++] = tri;
-
-				// Add vertex score to triangle score
-				curTri.score += curVert.score;
-
-				curIdx++;
+				bestTriangle = tri;
+				bestScore = triangleScores[tri];
 			}
-
-			// This will pick the first triangle to add to the list in 'Step 2'
-			_CHECK_NEXT_BEST(curTri.score, tri);
-			_CHECK_NEXT_NEXT_BEST(curTri.score, tri);
 		}
 
 		//
 		// Step 2: Start emitting triangles...this is the emit loop
 		//
-		LRUCacheModel lruCache;
-		for (int32_t outIdx = 0; outIdx < _numIndices; /* this space intentionally left blank */)
+		uint32_t cache[MaxCacheSize+3u], newCache[MaxCacheSize+3u];
+		uint32_t cacheCount = 0u;
+		// when no triangle touches the cache anymore, continue in input order which usually has some locality left
+		uint32_t inputCursor = 0u;
+		for (uint32_t outTri=0u; outTri<triangleCount; outTri++)
 		{
-			// If there is no next best triangle, than search for the next highest
-			// scored triangle that isn't in the list already
-			if (nextBestTriIdx < 0)
+			if (bestTriangle==InvalidTriangle)
 			{
-				// TODO: Something better than linear performance here...
-				nextBestTriScore = nextNextBestTriScore = -1.0f;
-				nextBestTriIdx = nextNextBestTriIdx = -1;
-
-				for (int32_t tri = 0; tri < NumPrimitives; tri++)
-				{
-					TriData &curTri = triangleData[tri];
-
-					if (!curTri.isInList)
-					{
-						_CHECK_NEXT_BEST(curTri.score, tri);
-						_CHECK_NEXT_NEXT_BEST(curTri.score, tri);
-					}
-				}
+				while (emitted[inputCursor])
+					inputCursor++;
+				bestTriangle = inputCursor;
 			}
-			_NBL_DEBUG_BREAK_IF(nextBestTriIdx <= -1); // Ran out of 'nextBestTriangle' before I ran out of indices...not good.
 
 			// Emit the next best triangle
-			TriData &nextBestTri = triangleData[nextBestTriIdx];
-			_NBL_DEBUG_BREAK_IF(nextBestTri.isInList); // Next best triangle already in list, this is no good.
-			for (int32_t i = 0; i < 3; i++)
+			const uint32_t* const triIndices = indices+bestTriangle*3u;
+			memcpy(outIndices+outTri*3u,triIndices,sizeof(uint32_t)*3u);
+			emitted[bestTriangle] = 1u;
+
+			// the triangle's vertices go to the front of the LRU cache, degenerate triangles only push their vertices once
+			uint32_t newCacheCount = 0u;
+			for (uint32_t c=0u; c<3u; c++)
 			{
-				// Emit index
-				_outIndices[outIdx++] = IdxT(nextBestTri.vertIdx[i]);
+				const uint32_t vertex = triIndices[c];
+				if (std::find(newCache,newCache+newCacheCount,vertex)==newCache+newCacheCount)
+					newCache[newCacheCount++] = vertex;
 
 				// Update the list of triangles on the vert
-				VertData &curVert = vertexData[nextBestTri.vertIdx[i]];
-				curVert.numUnaddedReferences--;
-				for (uint32_t t = 0; t < curVert.numReferences; t++)
-				{
-					if (curVert.triIndex[t] == nextBestTriIdx)
-					{
-						curVert.triIndex[t] = -1;
-						break;
-					}
-				}
-
-				// Update cache
-				lruCache.useVertex(nextBestTri.vertIdx[i], &curVert);
+				uint32_t* const live = adjacency.data()+adjacencyOffsets[vertex];
+				uint32_t* const found = std::find(live,live+liveTriangles[vertex],bestTriangle);
+				_NBL_DEBUG_BREAK_IF(found==live+liveTriangles[vertex]);
+				std::swap(*found,live[--liveTriangles[vertex]]);
 			}
-			nextBestTri.isInList = true;
-
-			// Enforce cache size, this will update the cache position of all verts
-			// still in the cache. It will also update the score of the verts in the
-			// cache, and give back a list of triangle indicies that need updating.
-			core::vector<uint32_t> trisToUpdate;
-			lruCache.enforceSize(maxSIZE_VERTEX_CACHE, trisToUpdate);
-
-			// Now update scores for triangles that need updates, and find the new best
-			// triangle score/index
-			nextBestTriIdx = -1;
-			nextBestTriScore = -1.0f;
-			for (core::vector<uint32_t>::iterator itr = trisToUpdate.begin(); itr != trisToUpdate.end(); ++itr)
-			{
-				TriData &tri = triangleData[*itr];
+			for (uint32_t i=0u; i<cacheCount; i++)
+			if (cache[i]!=triIndices[0] && cache[i]!=triIndices[1] && cache[i]!=triIndices[2])
+				newCache[newCacheCount++] = cache[i];
 
-				// If this triangle isn't already emitted, re-score it
-				if (!tri.isInList)
-				{
-					tri.score = 0.0f;
-
-					for (int32_t i = 0; i < 3; i++)
-						tri.score += vertexData[tri.vertIdx[i]].score;
-
-					_CHECK_NEXT_BEST(tri.score, *itr);
-					_CHECK_NEXT_NEXT_BEST(tri.score, *itr);
-				}
+			// Update cache positions and scores, including the vertices falling out of the cache, and propagate the change to the live triangles
+			for (uint32_t i=0u; i<newCacheCount; i++)
+			{
+				const uint32_t vertex = newCache[i];
+				const int32_t cachePosition = i<cacheSize ? int32_t(i):-1;
+				cachePositions[vertex] = cachePosition;
+				const float score = tables.score(cachePosition,liveTriangles[vertex]);
+				const float delta = score-vertexScores[vertex];
+				vertexScores[vertex] = score;
+				const uint32_t* const live = adjacency.data()+adjacencyOffsets[vertex];
+				for (uint32_t t=0u; t<liveTriangles[vertex]; t++)
+					triangleScores[live[t]] += delta;
 			}
 
-			// If there was no love finding a good triangle, than see if there is a
-			// next-next-best triangle, and if there isn't one of those...well than
-			// I guess we have to find one next time
-			if (nextBestTriIdx < 0 && nextNextBestTriIdx > -1)
+			// Only triangles touching the cache can be the next best, everything else only has valence scores
+			cacheCount = core::min(newCacheCount,cacheSize);
+			bestTriangle = InvalidTriangle;
+			bestScore = -1.f;
+			for (uint32_t i=0u; i<cacheCount; i++)
 			{
-				if (!triangleData[nextNextBestTriIdx].isInList)
+				const uint32_t vertex = newCache[i];
+				cache[i] = vertex;
+				const uint32_t* const live = adjacency.data()+adjacencyOffsets[vertex];
+				for (uint32_t t=0u; t<liveTriangles[vertex]; t++)
+				if (triangleScores[live[t]]>bestScore)
 				{
-					nextBestTriIdx = nextNextBestTriIdx;
-					nextBestTriScore = nextNextBestTriScore;
-					_VALIDATE_TRI_IDX(nextNextBestTriIdx);
+					bestTriangle = live[t];
+					bestScore = triangleScores[live[t]];
 				}
-
-				// Nuke the next-next best
-				nextNextBestTriIdx = -1;
-				nextNextBestTriScore = -1.0f;
 			}
-
-			// Validate triangle we are marking as next-best
-			_VALIDATE_TRI_IDX(nextBestTriIdx);
 		}
-
-#undef _CHECK_NEXT_BEST
-#undef _CHECK_NEXT_NEXT_BEST
-#undef _VALIDATE_TRI_IDX
-
-		// FrameTemp will call destructInPlace to clean up vertex lists
 	}
 
-	// explicit instantiations
-	template void CForsythVertexCacheOptimizer::optimizeTriangleOrdering<uint16_t>(const size_t, const size_t, const uint16_t*, uint16_t*) const;
-	template void CForsythVertexCacheOptimizer::optimizeTriangleOrdering<uint32_t>(const size_t, const size_t, const uint32_t*, uint32_t*) const;
-
-	//------------------------------------------------------------------------------
-	//------------------------------------------------------------------------------
-
-	CForsythVertexCacheOptimizer::LRUCacheModel::~LRUCacheModel()
+	template<typename IdxT>
+	void CForsythVertexCacheOptimizer::optimizeTriangleOrdering(const size_t _numVerts, const size_t _numIndices, const IdxT* _indices, IdxT* _outIndices, const SParams& _params) const
 	{
-		for (LRUCacheEntry* entry = mCacheHead; entry != NULL; )
-		{
-			LRUCacheEntry* next = entry->next;
-			delete entry;
-			entry = next;
-		}
-	}
+		const size_t NumPrimitives = _numIndices / 3;
+		_NBL_DEBUG_BREAK_IF(NumPrimitives*3 != _numIndices); // Number of indicies not divisible by 3, not a good triangle list.
+		if (_outIndices != _indices)
+			memmove(_outIndices, _indices, _numIndices*sizeof(IdxT));
+		if (_numVerts == 0 || NumPrimitives == 0 || _numVerts > std::numeric_limits<uint32_t>::max() || NumPrimitives*3 > std::numeric_limits<uint32_t>::max())
+			return;
 
-	//------------------------------------------------------------------------------
+		const uint32_t cacheSize = core::max(core::min(_params.cacheSize, MaxCacheSize), 4u);
+		const size_t chunkTriangleCount = _params.chunkTriangleCount ? core::min<size_t>(_params.chunkTriangleCount, NumPrimitives) : NumPrimitives;
+		const size_t chunkCount = (NumPrimitives + chunkTriangleCount - 1) / chunkTriangleCount;
 
-	void CForsythVertexCacheOptimizer::LRUCacheModel::useVertex(const uint32_t vIdx, VertData *vData)
-	{
-		LRUCacheEntry *search = mCacheHead;
-		LRUCacheEntry *last = NULL;
-
-		while (search != NULL)
+		// every chunk only reads and writes its own range of the output, which already holds a copy of the input
+		core::vector<uint32_t> chunks(chunkCount);
+		std::iota(chunks.begin(), chunks.end(), 0u);
+		std::for_each(core::execution::par, chunks.begin(), chunks.end(), [&](const uint32_t chunk) -> void
 		{
-			if (search->vIdx == vIdx)
-				break;
+			const size_t firstIndex = size_t(chunk) * chunkTriangleCount * 3;
+			const uint32_t triangleCount = static_cast<uint32_t>(core::min(chunkTriangleCount, NumPrimitives - firstIndex / 3));
+			IdxT* const chunkIndices = _outIndices + firstIndex;
 
-			last = search;
-			search = search->next;
-		}
+			core::vector<uint32_t> localIndices(chunkIndices, chunkIndices + triangleCount * 3);
+			for (const auto index : localIndices)
+			{
+				_NBL_DEBUG_BREAK_IF(index >= _numVerts); // Out of range index.
+			}
+			// a chunk only touches a fraction of the vertices, so renumber them densely to keep the per-vertex state small
+			core::vector<uint32_t> chunkVertices;
+			uint32_t vertexCount = static_cast<uint32_t>(_numVerts);
+			if (chunkCount > 1)
+			{
+				chunkVertices = localIndices;
+				std::sort(chunkVertices.begin(), chunkVertices.end());
+				chunkVertices.erase(std::unique(chunkVertices.begin(), chunkVertices.end()), chunkVertices.end());
+				for (auto& index : localIndices)
+					index = static_cast<uint32_t>(std::lower_bound(chunkVertices.begin(), chunkVertices.end(), index) - chunkVertices.begin());
+				vertexCount = static_cast<uint32_t>(chunkVertices.size());
+			}
 
-		// If this vertex wasn't found in the cache, create a new entry
-		if (search == NULL)
-		{
-			search = new LRUCacheEntry;
-			search->vIdx = vIdx;
-			search->vData = vData;
-		}
+			core::vector<uint32_t> optimized(localIndices.size());
+			optimizeChunk(localIndices.data(), triangleCount, vertexCount, cacheSize, optimized.data());
+			for (size_t i = 0; i < optimized.size(); i++)
+				chunkIndices[i] = IdxT(chunkVertices.empty() ? optimized[i] : chunkVertices[optimized[i]]);
+		});
+	}
 
-		if (search != mCacheHead)
+	template<typename IdxT>
+	uint32_t CForsythVertexCacheOptimizer::optimizeVertexFetch(const size_t _numVerts, const size_t _numIndices, IdxT* _indices, uint32_t* _outRemap)
+	{
+		std::fill_n(_outRemap, _numVerts, ~0u);
+		uint32_t nextVertex = 0;
+		for (size_t i = 0; i < _numIndices; i++)
 		{
-			// Unlink the entry from the linked list
-			if (last)
-				last->next = search->next;
-
-			// Vertex that got passed in is now at the head of the cache
-			search->next = mCacheHead;
-			mCacheHead = search;
+			uint32_t& remap = _outRemap[_indices[i]];
+			if (remap == ~0u)
+				remap = nextVertex++;
+			_indices[i] = IdxT(remap);
 		}
+		return nextVertex;
 	}
 
-	//------------------------------------------------------------------------------
-
-	void CForsythVertexCacheOptimizer::LRUCacheModel::enforceSize(const size_t maxSize, core::vector<uint32_t> &outTrisToUpdate)
+	template<typename IdxT>
+	CForsythVertexCacheOptimizer::SStatistics CForsythVertexCacheOptimizer::analyze(const size_t _numVerts, const size_t _numIndices, const IdxT* _indices, const uint32_t _cacheSize)
 	{
-		// Clear list of triangles to update scores for
-		outTrisToUpdate.clear();
-
-		size_t length = 0;
-		LRUCacheEntry *next = mCacheHead;
-		LRUCacheEntry *last = NULL;
-
-		// Run through list, up to the max size
-		while (next != NULL && length < maxSIZE_VERTEX_CACHE)
+		SStatistics retval = {};
+		const size_t NumPrimitives = _numIndices / 3;
+		if (NumPrimitives == 0 || _cacheSize == 0)
+			return retval;
+
+		// a vertex is in the FIFO if it got pushed less than `_cacheSize` pushes ago, timestamps start past the cache size so 0 means never pushed
+		core::vector<uint32_t> pushedAt(_numVerts, 0u);
+		uint32_t timestamp = _cacheSize + 1;
+		size_t transformed = 0, referenced = 0;
+		for (size_t i = 0; i < NumPrimitives * 3; i++)
 		{
-			VertData &vData = *next->vData;
-
-			// Update cache position on verts still in cache
-			vData.cachePosition = length++;
-
-			for (int32_t i = 0; i < vData.numReferences; i++)
+			uint32_t& vertexTimestamp = pushedAt[_indices[i]];
+			if (vertexTimestamp == 0)
+				referenced++;
+			if (timestamp - vertexTimestamp > _cacheSize)
 			{
-				const int32_t &triIdx = vData.triIndex[i];
-				if (triIdx > -1)
-				{
-					int32_t j = 0;
-					for (; j < outTrisToUpdate.size(); j++)
-						if (outTrisToUpdate[j] == triIdx)
-							break;
-					if (j == outTrisToUpdate.size())
-						outTrisToUpdate.push_back(triIdx);
-				}
+				vertexTimestamp = timestamp++;
+				transformed++;
 			}
-
-			// Update score
-			vData.score = CForsythVertexCacheOptimizer::score(vData);
-
-			last = next;
-			next = next->next;
-		}
-
-		// NULL out the pointer to the next entry on the last valid entry
-		last->next = NULL;
-
-		// If next != NULL, than we need to prune entries from the tail of the cache
-		while (next != NULL)
-		{
-			// Update cache position on verts which are going to get tossed from cache
-			next->vData->cachePosition = -1;
-
-			LRUCacheEntry *curEntry = next;
-			next = next->next;
-
-			delete curEntry;
 		}
+		retval.acmr = float(double(transformed) / double(NumPrimitives));
+		retval.atvr = float(double(transformed) / double(referenced));
+		return retval;
 	}
 
-	//------------------------------------------------------------------------------
-
-	int32_t CForsythVertexCacheOptimizer::LRUCacheModel::getCachePosition(const uint32_t vIdx)
+	core::smart_refctd_ptr<ICPUPolygonGeometry> CForsythVertexCacheOptimizer::createOptimized(const ICPUPolygonGeometry* geo, const SParams& params, SStatistics* outBefore, SStatistics* outAfter, const bool recomputeHash)
 	{
-		size_t length = 0;
-		LRUCacheEntry *next = mCacheHead;
-		while (next != NULL)
+		if (!geo || !geo->getIndexingCallback() || geo->getIndexingCallback()->degree() != 3 || !geo->getPositionView())
+			return nullptr;
+
+		const size_t vertexCount = geo->getPositionView().getElementCount();
+		const size_t primitiveCount = geo->getPrimitiveCount();
+		if (vertexCount == 0 || vertexCount > std::numeric_limits<uint32_t>::max() || primitiveCount * 3 > std::numeric_limits<uint32_t>::max())
+			return nullptr;
+
+		core::vector<uint32_t> indices(primitiveCount * 3);
+		if (!geo->getPrimitiveIndices(indices.data(), 0u, static_cast<uint32_t>(primitiveCount)))
+			return nullptr;
+		if (std::any_of(indices.begin(), indices.end(), [vertexCount](const uint32_t index)->bool{return index >= vertexCount;}))
+			return nullptr;
+
+		if (outBefore)
+			*outBefore = analyze(vertexCount, indices.size(), indices.data());
+		CForsythVertexCacheOptimizer().optimizeTriangleOrdering(vertexCount, indices.size(), indices.data(), indices.data(), params);
+		core::vector<uint32_t> remap(vertexCount);
+		const uint32_t newVertexCount = optimizeVertexFetch(vertexCount, indices.size(), indices.data(), remap.data());
+		if (outAfter)
+			*outAfter = analyze(newVertexCount, indices.size(), indices.data());
+
+		auto outGeo = core::move_and_static_cast<ICPUPolygonGeometry>(geo->clone(0u));
+
+		// vertex views which read the same buffer with the same stride from within one vertex record get remapped together,
+		// so interleaved attributes stay interleaved and every buffer gets copied only once
+		using SDataView = ICPUPolygonGeometry::SDataView;
+		core::vector<SDataView*> views;
+		SDataView positionView = geo->getPositionView();
+		SDataView normalView = geo->getNormalView();
+		views.push_back(&positionView);
+		if (normalView)
+			views.push_back(&normalView);
+		for (auto& view : *outGeo->getAuxAttributeViews())
+		if (view)
+			views.push_back(&view);
+		for (auto& jointWeight : *outGeo->getJointWeightViews())
 		{
-			if (next->vIdx == vIdx)
-				return length;
-
-			length++;
-			next = next->next;
+			if (jointWeight.indices)
+				views.push_back(&jointWeight.indices);
+			if (jointWeight.weights)
+				views.push_back(&jointWeight.weights);
 		}
+		for (const auto* view : views)
+		if (view->getElementCount() < vertexCount || view->composed.stride == 0)
+			return nullptr;
 
-		return -1;
-	}
-
-	//------------------------------------------------------------------------------
-	//------------------------------------------------------------------------------
-
-	// http://home.comcast.net/~tom_forsyth/papers/fast_vert_cache_opt.html
-	float CForsythVertexCacheOptimizer::score(const VertData &vertexData)
-	{
-		const float CacheDecayPower = 1.5f;
-		const float LastTriScore = 0.75f;
-		const float ValenceBoostScale = 2.0f;
-		const float ValenceBoostPower = 0.5f;
-
-		// If nobody needs this vertex, return -1.0
-		if (vertexData.numUnaddedReferences < 1)
-			return -1.0f;
-
-		float Score = 0.0f;
-
-		if (vertexData.cachePosition < 0)
+		struct SRecord
 		{
-			// Vertex is not in FIFO cache - no score.
+			const ICPUBuffer* buffer;
+			uint32_t stride;
+			size_t offset;
+			core::smart_refctd_ptr<ICPUBuffer> remapped = nullptr;
+		};
+		core::vector<SRecord> records;
+		auto sharesRecord = [](const SDataView* view, const SRecord& record)->bool
+		{
+			return record.buffer == view->src.buffer.get() && record.stride == view->composed.stride;
+		};
+		for (const auto* view : views)
+		{
+			auto found = std::find_if(records.begin(), records.end(), [&](const SRecord& record)->bool{return sharesRecord(view, record);});
+			if (found == records.end())
+				records.push_back({ view->src.buffer.get(), view->composed.stride, view->src.offset });
+			else
+				found->offset = core::min(found->offset, view->src.offset);
 		}
-		else
+		for (auto* view : views)
 		{
-			if (vertexData.cachePosition < 3)
+			const uint32_t stride = view->composed.stride;
+			// views of the same buffer and stride which aren't within one record of each other get their own copy
+			auto found = std::find_if(records.begin(), records.end(), [&](const SRecord& record)->bool{return sharesRecord(view, record);});
+			if (view->src.offset >= found->offset + stride)
 			{
-				// This vertex was used in the last triangle,
-				// so it has a fixed score, whichever of the three
-				// it's in. Otherwise, you can get very different
-				// answers depending on whether you add
-				// the triangle 1,2,3 or 3,1,2 - which is silly.
-				Score = LastTriScore;
+				found = std::find_if(records.begin(), records.end(), [&](const SRecord& record)->bool{return sharesRecord(view, record) && record.offset == view->src.offset;});
+				if (found == records.end())
+					found = records.insert(records.end(), SRecord{ view->src.buffer.get(), stride, view->src.offset });
 			}
-			else
+			auto& record = *found;
+			const size_t offsetInRecord = view->src.offset - record.offset;
+			if (!record.remapped)
 			{
-				_NBL_DEBUG_BREAK_IF(vertexData.cachePosition >= maxSIZE_VERTEX_CACHE); // Out of range cache position for vertex
-
-				// Points for being high in the cache.
-				const float Scaler = 1.0f / (maxSIZE_VERTEX_CACHE - 3);
-				Score = 1.0f - (vertexData.cachePosition - 3) * Scaler;
-				Score = pow(Score, CacheDecayPower);
+				// the last vertex's record might end before a full stride does
+				const size_t recordBytes = core::min<size_t>(stride, record.buffer->getSize() - record.offset - (vertexCount - 1) * stride);
+				record.remapped = ICPUBuffer::create({ size_t(newVertexCount) * stride, record.buffer->getUsageFlags() });
+				if (!record.remapped)
+					return nullptr;
+				const auto* const in = reinterpret_cast<const uint8_t*>(record.buffer->getPointer()) + record.offset;
+				auto* const out = reinterpret_cast<uint8_t*>(record.remapped->getPointer());
+				for (size_t v = 0; v < vertexCount; v++)
+				if (remap[v] != ~0u)
+					memcpy(out + size_t(remap[v]) * stride, in + v * stride, v + 1 < vertexCount ? stride : recordBytes);
 			}
+			view->src.offset = offsetInRecord;
+			view->src.size = record.remapped->getSize() - offsetInRecord;
+			view->src.buffer = record.remapped;
 		}
+		outGeo->setPositionView(std::move(positionView));
+		outGeo->setNormalView(std::move(normalView));
+
+		const bool shortIndices = newVertexCount <= std::numeric_limits<uint16_t>::max() + 1u;
+		const uint32_t indexSize = shortIndices ? sizeof(uint16_t) : sizeof(uint32_t);
+		auto indexBuffer = ICPUBuffer::create({ indices.size() * indexSize, IBuffer::EUF_INDEX_BUFFER_BIT });
+		if (!indexBuffer)
+			return nullptr;
+		SDataView indexView = {
+			.composed = {
+				.stride = indexSize,
+			},
+			.src = {.offset = 0, .size = indexBuffer->getSize(), .buffer = std::move(indexBuffer)}
+		};
+		if (shortIndices)
+		{
+			std::copy(indices.begin(), indices.end(), reinterpret_cast<uint16_t*>(indexView.getPointer()));
+			indexView.composed.encodedDataRange.u16.minVx[0] = 0;
+			indexView.composed.encodedDataRange.u16.maxVx[0] = newVertexCount - 1;
+			indexView.composed.format = EF_R16_UINT;
+			indexView.composed.rangeFormat = IGeometryBase::EAABBFormat::U16;
+		}
+		else
+		{
+			memcpy(indexView.getPointer(), indices.data(), indices.size() * sizeof(uint32_t));
+			indexView.composed.encodedDataRange.u32.minVx[0] = 0;
+			indexView.composed.encodedDataRange.u32.maxVx[0] = newVertexCount - 1;
+			indexView.composed.format = EF_R32_UINT;
+			indexView.composed.rangeFormat = IGeometryBase::EAABBFormat::U32;
+		}
+		outGeo->setIndexing(IPolygonGeometryBase::TriangleList());
+		outGeo->setIndexView(std::move(indexView));
 
-
-		// Bonus points for having a low number of tris still to
-		// use the vert, so we get rid of lone verts quickly.
-		float ValenceBoost = pow(vertexData.numUnaddedReferences, -ValenceBoostPower);
-		Score += ValenceBoostScale * ValenceBoost;
-
-		return Score;
+		if (recomputeHash)
+			CPolygonGeometryManipulator::recomputeContentHashes(outGeo.get());
+		return outGeo;
 	}
-#undef maxSIZE_VERTEX_CACHE
 
-}} // nbl::scene
+	// explicit instantiations
+	template void CForsythVertexCacheOptimizer::optimizeTriangleOrdering<uint16_t>(const size_t, const size_t, const uint16_t*, uint16_t*, const SParams&) const;
+	template void CForsythVertexCacheOptimizer::optimizeTriangleOrdering<uint32_t>(const size_t, const size_t, const uint32_t*, uint32_t*, const SParams&) const;
+	template uint32_t CForsythVertexCacheOptimizer::optimizeVertexFetch<uint16_t>(const size_t, const size_t, uint16_t*, uint32_t*);
+	template uint32_t CForsythVertexCacheOptimizer::optimizeVertexFetch<uint32_t>(const size_t, const size_t, uint32_t*, uint32_t*);
+	template CForsythVertexCacheOptimizer::SStatistics CForsythVertexCacheOptimizer::analyze<uint16_t>(const size_t, const size_t, const uint16_t*, const uint32_t);
+	template CForsythVertexCacheOptimizer::SStatistics CForsythVertexCacheOptimizer::analyze<uint32_t>(const size_t, const size_t, const uint32_t*, const uint32_t);
+
+}} // nbl::asset
@@ -0,0 +1,396 @@
+// Copyright (C) 2018-2025 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+
+#include "nbl/asset/utils/CMeshletBuilder.h"
+#include "nbl/core/execution.h"
+
+#include <numeric>
+
+
+namespace nbl::asset
+{
+
+namespace
+{
+constexpr uint32_t InvalidIndex = ~0u;
+
+// spreads the low 10 bits of `v` 3 bits apart
+inline uint32_t spreadBits(uint32_t v)
+{
+	v &= 0x3ffu;
+	v = (v|(v<<16u))&0x030000ffu;
+	v = (v|(v<<8u))&0x0300f00fu;
+	v = (v|(v<<4u))&0x030c30c3u;
+	v = (v|(v<<2u))&0x09249249u;
+	return v;
+}
+
+template<uint32_t Channels, typename T>
+CMeshletBuilder::SDataView createView(const core::vector<T>& elements)
+{
+	static_assert(sizeof(T)%Channels==0u);
+	using scalar_t = std::conditional_t<std::is_floating_point_v<T>||std::is_same_v<T,hlsl::float32_t3>||std::is_same_v<T,hlsl::float32_t4>,hlsl::float32_t,uint32_t>;
+	static_assert(sizeof(T)==sizeof(scalar_t)*Channels);
+
+	const size_t bytesize = sizeof(T)*elements.size();
+	auto buffer = ICPUBuffer::create({bytesize,IBuffer::EUF_NONE});
+	if (!buffer)
+		return {};
+	memcpy(buffer->getPointer(),elements.data(),bytesize);
+
+	hlsl::shapes::AABB<4,scalar_t> aabb = hlsl::shapes::AABB<4,scalar_t>::create();
+	const auto* const scalars = reinterpret_cast<const scalar_t*>(elements.data());
+	for (size_t i=0u; i<elements.size(); i++)
+	for (uint32_t c=0u; c<Channels; c++)
+	{
+		aabb.minVx[c] = core::min(aabb.minVx[c],scalars[i*Channels+c]);
+		aabb.maxVx[c] = core::max(aabb.maxVx[c],scalars[i*Channels+c]);
+	}
+
+	CMeshletBuilder::SDataView retval = {
+		.composed = {
+			.stride = sizeof(T),
+		},
+		.src = {.offset=0,.size=bytesize,.buffer=std::move(buffer)}
+	};
+	if constexpr (std::is_same_v<scalar_t,hlsl::float32_t>)
+	{
+		retval.composed.encodedDataRange.f32 = aabb;
+		retval.composed.format = Channels==3u ? EF_R32G32B32_SFLOAT:EF_R32G32B32A32_SFLOAT;
+		retval.composed.rangeFormat = IGeometryBase::EAABBFormat::F32;
+	}
+	else
+	{
+		retval.composed.encodedDataRange.u32 = aabb;
+		retval.composed.format = Channels==1u ? EF_R32_UINT:EF_R32G32B32A32_UINT;
+		retval.composed.rangeFormat = IGeometryBase::EAABBFormat::U32;
+	}
+	return retval;
+}
+}
+
+CMeshletBuilder::SResult CMeshletBuilder::build(const ICPUPolygonGeometry* geometry, const SParams& params)
+{
+	if (!geometry || !params.valid())
+		return {};
+	const auto* indexing = geometry->getIndexingCallback();
+	if (!indexing || indexing->degree()!=3)
+		return {};
+	const auto& positionView = geometry->getPositionView();
+	if (!positionView || !positionView.composed.isFormatted())
+		return {};
+
+	const uint64_t triangleCount = geometry->getPrimitiveCount();
+	const uint64_t vertexCount = positionView.getElementCount();
+	if (triangleCount==0ull || triangleCount*3ull>=InvalidIndex || vertexCount>=InvalidIndex)
+		return {};
+
+	// flatten whatever the indexing is into a triangle list
+	core::vector<uint32_t> indices(triangleCount*3ull);
+	{
+		const auto& indexView = geometry->getIndexView();
+		IPolygonGeometryBase::IIndexingCallback::SContext<uint32_t> context{
+			.indexBuffer = indexView.getPointer(),
+			.indexSize = indexView.composed.stride,
+			.beginPrimitive = 0ull,
+			.endPrimitive = triangleCount,
+			.out = indices.data()
+		};
+		indexing->operator()(context);
+	}
+	if (std::any_of(indices.begin(),indices.end(),[vertexCount](const uint32_t index)->bool{return index>=vertexCount;}))
+		return {};
+
+	core::vector<hlsl::float32_t3> positions(vertexCount);
+	if (!positionView.decodeRange<float>(0ull,vertexCount,reinterpret_cast<float*>(positions.data()),3u))
+	for (uint64_t i=0ull; i<vertexCount; i++)
+		positionView.decodeElement<hlsl::float32_t3>(i,positions[i]);
+
+	// vertex to triangle adjacency, `liveTriangles` counts the ones not in a meshlet yet
+	core::vector<uint32_t> adjacencyOffsets(vertexCount+1ull,0u);
+	for (const auto index : indices)
+		adjacencyOffsets[index+1u]++;
+	std::inclusive_scan(adjacencyOffsets.begin(),adjacencyOffsets.end(),adjacencyOffsets.begin());
+	core::vector<uint32_t> liveTriangles(vertexCount);
+	for (uint64_t i=0ull; i<vertexCount; i++)
+		liveTriangles[i] = adjacencyOffsets[i+1ull]-adjacencyOffsets[i];
+	core::vector<uint32_t> adjacency(indices.size());
+	{
+		core::vector<uint32_t> cursors(adjacencyOffsets.begin(),adjacencyOffsets.end()-1);
+		for (uint32_t i=0u; i<indices.size(); i++)
+			adjacency[cursors[indices[i]]++] = i/3u;
+	}
+
+	core::vector<hlsl::float32_t3> centroids(triangleCount);
+	core::vector<hlsl::float32_t3> normals(triangleCount);
+	hlsl::shapes::AABB<3,hlsl::float32_t> centroidBounds = hlsl::shapes::AABB<3,hlsl::float32_t>::create();
+	for (uint64_t t=0ull; t<triangleCount; t++)
+	{
+		const auto& p0 = positions[indices[t*3]];
+		const auto& p1 = positions[indices[t*3+1]];
+		const auto& p2 = positions[indices[t*3+2]];
+		centroids[t] = (p0+p1+p2)/3.f;
+		const auto normal = hlsl::cross(p1-p0,p2-p0);
+		const float normalLen2 = hlsl::dot(normal,normal);
+		normals[t] = normalLen2>0.f ? normal*hlsl::rsqrt(normalLen2):hlsl::float32_t3(0.f);
+		centroidBounds.addPoint(centroids[t]);
+	}
+
+	// restart order for when a meshlet runs out of adjacent triangles
+	core::vector<uint32_t> seedOrder(triangleCount);
+	{
+		const auto extent = centroidBounds.maxVx-centroidBounds.minVx;
+		const float maxExtent = core::max(core::max(extent.x,extent.y),core::max(extent.z,hlsl::numeric_limits<float>::min));
+		core::vector<uint64_t> keys(triangleCount);
+		for (uint64_t t=0ull; t<triangleCount; t++)
+		{
+			const auto q = (centroids[t]-centroidBounds.minVx)*(1023.f/maxExtent);
+			const uint32_t morton = spreadBits(uint32_t(q.x))|(spreadBits(uint32_t(q.y))<<1u)|(spreadBits(uint32_t(q.z))<<2u);
+			keys[t] = (uint64_t(morton)<<32ull)|t;
+		}
+		std::sort(keys.begin(),keys.end());
+		for (uint64_t t=0ull; t<triangleCount; t++)
+			seedOrder[t] = uint32_t(keys[t]);
+	}
+
+	core::vector<SMeshlet> meshlets;
+	core::vector<uint32_t> vertexIndices;
+	core::vector<uint32_t> localIndices;
+	core::vector<hlsl::float32_t4> boundingSpheres;
+	core::vector<hlsl::float32_t4> normalCones;
+	core::vector<hlsl::float32_t3> coneApices;
+	meshlets.reserve(triangleCount/params.maxTriangles+1u);
+	localIndices.reserve(triangleCount);
+
+	core::vector<uint8_t> emitted(triangleCount,0u);
+	// position of a vertex in the current meshlet
+	core::vector<uint32_t> localIx(vertexCount,InvalidIndex);
+	core::vector<uint32_t> meshletVertices;
+	core::vector<uint32_t> meshletTriangles;
+	meshletVertices.reserve(params.maxVertices);
+	meshletTriangles.reserve(params.maxTriangles);
+	hlsl::float32_t3 positionSum(0.f), normalSum(0.f);
+	hlsl::float32_t3 center(0.f), averageNormal(0.f);
+	float radius = 0.f;
+
+	auto newVertexCount = [&](const uint32_t triangle) -> uint32_t
+	{
+		uint32_t retval = 0u;
+		for (uint32_t i=0u; i<3u; i++)
+		if (localIx[indices[triangle*3u+i]]==InvalidIndex)
+			retval++;
+		return retval;
+	};
+	auto fits = [&](const uint32_t triangle) -> bool
+	{
+		return meshletTriangles.size()<params.maxTriangles && meshletVertices.size()+newVertexCount(triangle)<=params.maxVertices;
+	};
+	auto cost = [&](const uint32_t triangle) -> float
+	{
+		float retval = float(newVertexCount(triangle));
+		// closing off a vertex means it won't ever need to be duplicated into another meshlet
+		for (uint32_t i=0u; i<3u; i++)
+		if (liveTriangles[indices[triangle*3u+i]]==1u)
+			retval -= 0.5f;
+		retval += params.spatialWeight*hlsl::length(centroids[triangle]-center)/core::max(radius,hlsl::numeric_limits<float>::min);
+		retval += params.coneWeight*(1.f-hlsl::dot(normals[triangle],averageNormal));
+		return retval;
+	};
+	auto addTriangle = [&](const uint32_t triangle) -> void
+	{
+		emitted[triangle] = 1u;
+		meshletTriangles.push_back(triangle);
+		for (uint32_t i=0u; i<3u; i++)
+		{
+			const uint32_t vertex = indices[triangle*3u+i];
+			liveTriangles[vertex]--;
+			if (localIx[vertex]!=InvalidIndex)
+				continue;
+			localIx[vertex] = static_cast<uint32_t>(meshletVertices.size());
+			meshletVertices.push_back(vertex);
+			positionSum += positions[vertex];
+		}
+		center = positionSum/float(meshletVertices.size());
+		radius = 0.f;
+		for (const auto vertex : meshletVertices)
+			radius = core::max(radius,hlsl::length(positions[vertex]-center));
+		normalSum += normals[triangle];
+		const float normalSumLen2 = hlsl::dot(normalSum,normalSum);
+		averageNormal = normalSumLen2>0.f ? normalSum*hlsl::rsqrt(normalSumLen2):hlsl::float32_t3(0.f);
+	};
+	auto flush = [&]() -> void
+	{
+		if (meshletTriangles.empty())
+			return;
+		meshlets.push_back({
+			.vertexOffset = static_cast<uint32_t>(vertexIndices.size()),
+			.triangleOffset = static_cast<uint32_t>(localIndices.size()),
+			.vertexCount = static_cast<uint32_t>(meshletVertices.size()),
+			.triangleCount = static_cast<uint32_t>(meshletTriangles.size())
+		});
+		vertexIndices.insert(vertexIndices.end(),meshletVertices.begin(),meshletVertices.end());
+		for (const auto triangle : meshletTriangles)
+		{
+			uint32_t packed = 0u;
+			for (uint32_t i=0u; i<3u; i++)
+				packed |= localIx[indices[triangle*3u+i]]<<(i*8u);
+			localIndices.push_back(packed);
+		}
+
+		// Ritter's bounding sphere, seeded with the most distant pair of axis extremal points
+		{
+			std::array<uint32_t,3> minIx, maxIx;
+			minIx.fill(meshletVertices[0]);
+			maxIx.fill(meshletVertices[0]);
+			for (const auto vertex : meshletVertices)
+			for (uint32_t axis=0u; axis<3u; axis++)
+			{
+				if (positions[vertex][axis]<positions[minIx[axis]][axis])
+					minIx[axis] = vertex;
+				if (positions[vertex][axis]>positions[maxIx[axis]][axis])
+					maxIx[axis] = vertex;
+			}
+			uint32_t widestAxis = 0u;
+			float widestLen2 = -1.f;
+			for (uint32_t axis=0u; axis<3u; axis++)
+			{
+				const auto diagonal = positions[maxIx[axis]]-positions[minIx[axis]];
+				const float len2 = hlsl::dot(diagonal,diagonal);
+				if (len2>widestLen2)
+				{
+					widestLen2 = len2;
+					widestAxis = axis;
+				}
+			}
+			hlsl::float32_t3 sphereCenter = (positions[minIx[widestAxis]]+positions[maxIx[widestAxis]])*0.5f;
+			float sphereRadius = std::sqrt(widestLen2)*0.5f;
+			for (const auto vertex : meshletVertices)
+			{
+				const float distance = hlsl::length(positions[vertex]-sphereCenter);
+				if (distance<=sphereRadius)
+					continue;
+				const float newRadius = (sphereRadius+distance)*0.5f;
+				sphereCenter += (positions[vertex]-sphereCenter)*((newRadius-sphereRadius)/distance);
+				sphereRadius = newRadius;
+			}
+			boundingSpheres.push_back(hlsl::float32_t4(sphereCenter,sphereRadius));
+
+			// normal cone, apex is pushed back along the axis until every triangle's plane is behind it
+			hlsl::float32_t3 axis(0.f);
+			for (const auto triangle : meshletTriangles)
+				axis += normals[triangle];
+			const float axisLen2 = hlsl::dot(axis,axis);
+			float minDot = 1.f;
+			if (axisLen2>0.f)
+			{
+				axis *= hlsl::rsqrt(axisLen2);
+				for (const auto triangle : meshletTriangles)
+				if (hlsl::dot(normals[triangle],normals[triangle])>0.f)
+					minDot = core::min(minDot,hlsl::dot(normals[triangle],axis));
+			}
+			// wider than ~85 degrees would cull next to nothing and make the apex run off
+			if (axisLen2<=0.f || minDot<=0.1f)
+			{
+				normalCones.push_back(hlsl::float32_t4(0.f,0.f,0.f,1.f));
+				coneApices.push_back(sphereCenter);
+			}
+			else
+			{
+				float maxT = 0.f;
+				for (const auto triangle : meshletTriangles)
+				{
+					const auto& normal = normals[triangle];
+					const float dn = hlsl::dot(axis,normal);
+					if (dn<=0.f)
+						continue;
+					maxT = core::max(maxT,hlsl::dot(sphereCenter-positions[indices[triangle*3u]],normal)/dn);
+				}
+				normalCones.push_back(hlsl::float32_t4(axis,std::sqrt(1.f-minDot*minDot)));
+				coneApices.push_back(sphereCenter-axis*maxT);
+			}
+		}
+
+		for (const auto vertex : meshletVertices)
+			localIx[vertex] = InvalidIndex;
+		meshletVertices.clear();
+		meshletTriangles.clear();
+		positionSum = normalSum = hlsl::float32_t3(0.f);
+		radius = 0.f;
+	};
+
+	uint64_t seedCursor = 0ull;
+	for (uint64_t remaining=triangleCount; remaining; remaining--)
+	{
+		uint32_t best = InvalidIndex;
+		float bestCost = std::numeric_limits<float>::infinity();
+		auto consider = [&](const uint32_t vertex) -> void
+		{
+			for (uint32_t i=adjacencyOffsets[vertex]; i<adjacencyOffsets[vertex+1u]; i++)
+			{
+				const uint32_t triangle = adjacency[i];
+				if (emitted[triangle] || !fits(triangle))
+					continue;
+				const float triangleCost = cost(triangle);
+				if (triangleCost<bestCost)
+				{
+					bestCost = triangleCost;
+					best = triangle;
+				}
+			}
+		};
+		if (!meshletTriangles.empty())
+		{
+			// the last triangle's neighbourhood first, then anything touching the meshlet
+			const uint32_t last = meshletTriangles.back();
+			for (uint32_t i=0u; i<3u; i++)
+				consider(indices[last*3u+i]);
+			if (best==InvalidIndex)
+			for (const auto vertex : meshletVertices)
+				consider(vertex);
+		}
+		if (best==InvalidIndex)
+		{
+			while (emitted[seedOrder[seedCursor]])
+				seedCursor++;
+			best = seedOrder[seedCursor];
+			if (!fits(best))
+				flush();
+		}
+		addTriangle(best);
+		if (meshletTriangles.size()==params.maxTriangles)
+			flush();
+	}
+	flush();
+
+	SResult retval = {
+		.meshlets = createView<4>(meshlets),
+		.vertexIndices = createView<1>(vertexIndices),
+		.localIndices = createView<1>(localIndices),
+		.boundingSpheres = createView<4>(boundingSpheres),
+		.normalCones = createView<4>(normalCones),
+		.coneApices = createView<3>(coneApices)
+	};
+	return retval;
+}
+
+core::vector<CMeshletBuilder::SResult> CMeshletBuilder::build(const ICPUGeometryCollection* collection, const SParams& params)
+{
+	if (!collection)
+		return {};
+
+	const auto& geometries = collection->getGeometries();
+	core::vector<SResult> retval(geometries.size());
+	core::vector<uint32_t> geometryIxs(geometries.size());
+	std::iota(geometryIxs.begin(),geometryIxs.end(),0u);
+	std::for_each(core::execution::par,geometryIxs.begin(),geometryIxs.end(),[&](const uint32_t geometryIx) -> void
+	{
+		const auto* geometry = geometries[geometryIx].geometry.get();
+		if (geometry && geometry->getPrimitiveType()==IGeometryBase::EPrimitiveType::Polygon)
+			retval[geometryIx] = build(static_cast<const ICPUPolygonGeometry*>(geometry),params);
+	});
+	return retval;
+}
+
+}
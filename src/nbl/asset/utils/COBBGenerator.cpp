@@ -0,0 +1,532 @@
+// Copyright (C) 2018-2025 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+
+#include "nbl/asset/utils/COBBGenerator.h"
+#include "nbl/core/execution.h"
+
+#include <numeric>
+#include <optional>
+
+
+namespace nbl::asset
+{
+
+namespace
+{
+using float32_t2 = hlsl::float32_t2;
+using float32_t3 = hlsl::float32_t3;
+using obb_t = hlsl::shapes::OBB<>;
+
+// point sets larger than twice this get hulled in chunks first
+constexpr size_t HullChunkSize = 0x1u<<14;
+
+class CQuickHull
+{
+	public:
+		inline CQuickHull(std::span<const float32_t3> points, const float epsilon) : m_points(points)
+		{
+			float32_t3 maxAbs(0.f);
+			for (const auto& p : m_points)
+				maxAbs = hlsl::max(maxAbs,hlsl::abs(p));
+			// distances below the rounding error of the plane equations can't be told apart from 0
+			m_epsilon = hlsl::max(epsilon,3.f*std::numeric_limits<float>::epsilon()*(maxAbs.x+maxAbs.y+maxAbs.z));
+		}
+
+		inline bool build()
+		{
+			if (m_points.size()<4ull || !createSimplex())
+				return false;
+
+			for (size_t f=0ull; f<m_faces.size(); f++)
+			{
+				// faces only ever get added at the back, and only new faces get new outside points, so a single sweep is enough
+				if (!m_faces[f].alive || m_faces[f].outside.empty())
+					continue;
+
+				const uint32_t eye = [&]()->uint32_t
+				{
+					const auto& outside = m_faces[f].outside;
+					return *std::max_element(outside.begin(),outside.end(),[&](const uint32_t a, const uint32_t b)->bool{return distance(m_faces[f],a)<distance(m_faces[f],b);});
+				}();
+
+				// faces which can see the eye point form a connected patch around `f`, so walk it over the neighbour links
+				if (!(distance(m_faces[f],eye)>m_epsilon)) // can only happen through numerical trouble
+				{
+					m_faces[f].outside.clear();
+					continue;
+				}
+				m_visitStamp++;
+				m_visible.clear();
+				m_visible.push_back(static_cast<uint32_t>(f));
+				m_faces[f].visited = m_visitStamp;
+				for (size_t i=0ull; i<m_visible.size(); i++)
+				for (const auto n : m_faces[m_visible[i]].neighbours)
+				{
+					if (n==InvalidFace || m_faces[n].visited==m_visitStamp)
+						continue;
+					m_faces[n].visited = m_visitStamp;
+					if (distance(m_faces[n],eye)>m_epsilon)
+						m_visible.push_back(n);
+				}
+
+				// horizon edges are the edges of visible faces whose neighbour stays
+				for (const auto i : m_visible)
+					m_faces[i].alive = false;
+				m_orphans.clear();
+				m_horizon.clear();
+				for (const auto i : m_visible)
+				{
+					auto& face = m_faces[i];
+					for (auto e=0u; e<3u; e++)
+					{
+						const uint32_t n = face.neighbours[e];
+						if (n!=InvalidFace && m_faces[n].alive)
+							m_horizon.push_back({face.v[e],face.v[(e+1u)%3u],n});
+					}
+					for (const auto p : face.outside)
+					if (p!=eye)
+						m_orphans.push_back(p);
+					face.outside = {};
+				}
+
+				const auto firstNew = static_cast<uint32_t>(m_faces.size());
+				m_cone.clear();
+				for (const auto& edge : m_horizon)
+				{
+					const auto newFace = static_cast<uint32_t>(m_faces.size());
+					addFace(edge[0],edge[1],eye);
+					link(newFace,edge[2],edge[0],edge[1]);
+					// the other two edges are shared with the neighbouring new faces, keyed by their vertex which isn't the eye
+					m_cone.push_back({edge[0],newFace});
+					m_cone.push_back({edge[1],newFace});
+				}
+				std::sort(m_cone.begin(),m_cone.end());
+				for (size_t i=0ull; i+1ull<m_cone.size(); i+=2ull)
+				if (m_cone[i][0]==m_cone[i+1ull][0])
+					link(m_cone[i][1],m_cone[i+1ull][1],m_cone[i][0],eye);
+				// points which aren't outside any new face are inside the hull now
+				for (const auto p : m_orphans)
+				for (auto i=firstNew; i<m_faces.size(); i++)
+				if (distance(m_faces[i],p)>m_epsilon)
+				{
+					m_faces[i].outside.push_back(p);
+					break;
+				}
+			}
+			return true;
+		}
+
+		inline void getResult(core::vector<float32_t3>& outVertices, core::vector<uint32_t>* outTriangles) const
+		{
+			constexpr uint32_t Unused = ~0u;
+			core::vector<uint32_t> remap(m_points.size(),Unused);
+			outVertices.clear();
+			if (outTriangles)
+				outTriangles->clear();
+			for (const auto& face : m_faces)
+			if (face.alive)
+			for (const auto v : face.v)
+			{
+				if (remap[v]==Unused)
+				{
+					remap[v] = static_cast<uint32_t>(outVertices.size());
+					outVertices.push_back(m_points[v]);
+				}
+				if (outTriangles)
+					outTriangles->push_back(remap[v]);
+			}
+		}
+
+	private:
+		static inline constexpr uint32_t InvalidFace = ~0u;
+
+		struct SFace
+		{
+			std::array<uint32_t,3> v;
+			float32_t3 normal;
+			float offset;
+			// face across the edge `v[e]`,`v[(e+1)%3]`
+			std::array<uint32_t,3> neighbours = {InvalidFace,InvalidFace,InvalidFace};
+			core::vector<uint32_t> outside = {};
+			uint32_t visited = 0u;
+			bool alive = true;
+		};
+
+		static inline uint32_t findEdge(const SFace& face, const uint32_t a, const uint32_t b)
+		{
+			for (auto e=0u; e<3u; e++)
+			{
+				const uint32_t u = face.v[e], w = face.v[(e+1u)%3u];
+				if (u==a && w==b || u==b && w==a)
+					return e;
+			}
+			return 3u;
+		}
+		// makes faces `x` and `y` neighbours across their shared edge `a`,`b`
+		inline void link(const uint32_t x, const uint32_t y, const uint32_t a, const uint32_t b)
+		{
+			const auto ex = findEdge(m_faces[x],a,b), ey = findEdge(m_faces[y],a,b);
+			if (ex<3u && ey<3u)
+			{
+				m_faces[x].neighbours[ex] = y;
+				m_faces[y].neighbours[ey] = x;
+			}
+		}
+
+		inline float distance(const SFace& face, const uint32_t p) const {return hlsl::dot(face.normal,m_points[p])-face.offset;}
+
+		inline void addFace(uint32_t a, uint32_t b, uint32_t c)
+		{
+			auto normal = hlsl::cross(m_points[b]-m_points[a],m_points[c]-m_points[a]);
+			const float len = hlsl::length(normal);
+			normal = len>0.f ? normal/len:float32_t3(0.f);
+			// orienting against a point strictly inside keeps the winding consistent even if the horizon got slightly mangled by rounding
+			if (hlsl::dot(normal,m_interior-m_points[a])>0.f)
+			{
+				std::swap(b,c);
+				normal = -normal;
+			}
+			m_faces.push_back({.v={a,b,c},.normal=normal,.offset=hlsl::dot(normal,m_points[a])});
+		}
+
+		inline bool createSimplex()
+		{
+			const auto count = static_cast<uint32_t>(m_points.size());
+			// the most distant pair of the axis extremes
+			std::array<uint32_t,6> extremes = {};
+			for (uint32_t i=1u; i<count; i++)
+			for (auto axis=0u; axis<3u; axis++)
+			{
+				if (m_points[i][axis]<m_points[extremes[axis*2u]][axis])
+					extremes[axis*2u] = i;
+				if (m_points[i][axis]>m_points[extremes[axis*2u+1u]][axis])
+					extremes[axis*2u+1u] = i;
+			}
+			uint32_t v[4] = {0u,0u,0u,0u};
+			float best = 0.f;
+			for (auto i=0u; i<6u; i++)
+			for (auto j=i+1u; j<6u; j++)
+			{
+				const auto diff = m_points[extremes[i]]-m_points[extremes[j]];
+				if (const float sqDist=hlsl::dot(diff,diff); sqDist>best)
+				{
+					best = sqDist;
+					v[0] = extremes[i];
+					v[1] = extremes[j];
+				}
+			}
+			if (best<=m_epsilon*m_epsilon)
+				return false;
+
+			// furthest from the line
+			const auto dir = hlsl::normalize(m_points[v[1]]-m_points[v[0]]);
+			best = 0.f;
+			for (uint32_t i=0u; i<count; i++)
+			{
+				const auto rel = m_points[i]-m_points[v[0]];
+				const auto perp = rel-dir*hlsl::dot(rel,dir);
+				if (const float sqDist=hlsl::dot(perp,perp); sqDist>best)
+				{
+					best = sqDist;
+					v[2] = i;
+				}
+			}
+			if (best<=m_epsilon*m_epsilon)
+				return false;
+
+			// furthest from the plane
+			const auto normal = hlsl::normalize(hlsl::cross(m_points[v[1]]-m_points[v[0]],m_points[v[2]]-m_points[v[0]]));
+			best = 0.f;
+			for (uint32_t i=0u; i<count; i++)
+			if (const float dist=hlsl::abs(hlsl::dot(normal,m_points[i]-m_points[v[0]])); dist>best)
+			{
+				best = dist;
+				v[3] = i;
+			}
+			if (best<=m_epsilon)
+				return false;
+
+			m_interior = (m_points[v[0]]+m_points[v[1]]+m_points[v[2]]+m_points[v[3]])*0.25f;
+			addFace(v[0],v[1],v[2]);
+			addFace(v[0],v[1],v[3]);
+			addFace(v[0],v[2],v[3]);
+			addFace(v[1],v[2],v[3]);
+			for (uint32_t x=0u; x<4u; x++)
+			for (uint32_t y=x+1u; y<4u; y++)
+			for (auto e=0u; e<3u; e++)
+			{
+				const uint32_t a = m_faces[x].v[e], b = m_faces[x].v[(e+1u)%3u];
+				if (findEdge(m_faces[y],a,b)<3u)
+					link(x,y,a,b);
+			}
+			for (uint32_t i=0u; i<count; i++)
+			{
+				if (i==v[0] || i==v[1] || i==v[2] || i==v[3])
+					continue;
+				for (auto& face : m_faces)
+				if (distance(face,i)>m_epsilon)
+				{
+					face.outside.push_back(i);
+					break;
+				}
+			}
+			return true;
+		}
+
+		std::span<const float32_t3> m_points;
+		float m_epsilon;
+		float32_t3 m_interior;
+		core::vector<SFace> m_faces;
+		// scratch
+		uint32_t m_visitStamp = 0u;
+		core::vector<uint32_t> m_visible, m_orphans;
+		// horizon edge and the face behind it, then the new faces around the eye point keyed by a horizon vertex
+		core::vector<std::array<uint32_t,3>> m_horizon;
+		core::vector<std::array<uint32_t,2>> m_cone;
+};
+
+struct SBox
+{
+	inline float volume() const
+	{
+		const auto len = localMax-localMin;
+		return len.x*len.y*len.z;
+	}
+
+	inline obb_t getOBB() const
+	{
+		const auto localMid = (localMin+localMax)*0.5f;
+		return obb_t::create(axes[0]*localMid.x+axes[1]*localMid.y+axes[2]*localMid.z,(localMax-localMin)*0.5f,axes);
+	}
+
+	float32_t3 axes[3];
+	float32_t3 localMin;
+	float32_t3 localMax;
+};
+
+// the columns of the upper 3x3 are the scaled axes
+inline float volume(const obb_t& obb)
+{
+	const auto& m = obb.transform;
+	const float32_t3 x(m[0][0],m[1][0],m[2][0]), y(m[0][1],m[1][1],m[2][1]), z(m[0][2],m[1][2],m[2][2]);
+	return hlsl::abs(hlsl::dot(x,hlsl::cross(y,z)));
+}
+
+inline obb_t approximate(std::span<const float32_t3> points, const float epsilon)
+{
+	return COBBGenerator::compute(points.size(),[points](const size_t i)->float32_t3{return points[i];},epsilon);
+}
+
+// smallest box with a face lying in the plane of one of the hull's faces, rotating calipers find the minimum area rectangle of every projection,
+// nothing if every face was degenerate
+std::optional<SBox> minVolumeFaceFlush(std::span<const float32_t3> hullVertices, std::span<const uint32_t> hullTriangles)
+{
+	const auto faceCount = static_cast<uint32_t>(hullTriangles.size()/3ull);
+	core::vector<SBox> bestPerFace(faceCount);
+	core::vector<float> bestVolume(faceCount,std::numeric_limits<float>::infinity());
+	core::vector<uint32_t> faces(faceCount);
+	std::iota(faces.begin(),faces.end(),0u);
+	std::for_each(core::execution::par,faces.begin(),faces.end(),[&](const uint32_t face)->void
+	{
+		const auto& a = hullVertices[hullTriangles[face*3u+0u]];
+		const auto& b = hullVertices[hullTriangles[face*3u+1u]];
+		const auto& c = hullVertices[hullTriangles[face*3u+2u]];
+		const auto cross = hlsl::cross(b-a,c-a);
+		const float crossLen = hlsl::length(cross);
+		if (!(crossLen>0.f))
+			return;
+		const auto n = cross/crossLen;
+		const auto u = hlsl::normalize(b-a);
+		const auto v = hlsl::cross(n,u);
+
+		core::vector<float32_t2> projected(hullVertices.size());
+		for (size_t i=0ull; i<hullVertices.size(); i++)
+			projected[i] = float32_t2(hlsl::dot(hullVertices[i],u),hlsl::dot(hullVertices[i],v));
+		// Andrew's monotone chain, counter-clockwise without collinear points
+		std::sort(projected.begin(),projected.end(),[](const float32_t2& l, const float32_t2& r)->bool{return l.x<r.x || l.x==r.x && l.y<r.y;});
+		auto turn = [](const float32_t2& o, const float32_t2& p, const float32_t2& q)->float{return (p.x-o.x)*(q.y-o.y)-(p.y-o.y)*(q.x-o.x);};
+		core::vector<float32_t2> hull(projected.size()*2ull);
+		size_t k = 0ull;
+		for (size_t i=0ull; i<projected.size(); i++)
+		{
+			while (k>=2ull && turn(hull[k-2ull],hull[k-1ull],projected[i])<=0.f)
+				k--;
+			hull[k++] = projected[i];
+		}
+		for (size_t i=projected.size()-1ull, lower=k+1ull; i>0ull; i--)
+		{
+			while (k>=lower && turn(hull[k-2ull],hull[k-1ull],projected[i-1ull])<=0.f)
+				k--;
+			hull[k++] = projected[i-1ull];
+		}
+		const auto m = static_cast<uint32_t>(k-1ull);
+		if (m<3u)
+			return;
+
+		// edge `i` is flush with the rectangle, the other three sides touch the points furthest along the edge, against it and away from it
+		float bestArea = std::numeric_limits<float>::infinity();
+		float32_t2 bestDir;
+		uint32_t right = 0u, top = 0u, left = 0u;
+		for (uint32_t i=0u; i<m; i++)
+		{
+			const auto& origin = hull[i];
+			const auto dir = hlsl::normalize(hull[i+1u]-origin);
+			const float32_t2 inward(-dir.y,dir.x);
+			auto advance = [&](uint32_t& ix, const float32_t2& axis, const float sign)->void
+			{
+				for (uint32_t steps=0u; steps<m && sign*hlsl::dot(hull[(ix+1u)%m]-hull[ix],axis)>0.f; steps++)
+					ix = (ix+1u)%m;
+			};
+			if (i==0u)
+			{
+				right = 0u;
+				advance(right,dir,1.f);
+				top = right;
+				advance(top,inward,1.f);
+				left = top;
+				advance(left,dir,-1.f);
+			}
+			else
+			{
+				advance(right,dir,1.f);
+				advance(top,inward,1.f);
+				advance(left,dir,-1.f);
+			}
+			const float area = (hlsl::dot(hull[right]-origin,dir)-hlsl::dot(hull[left]-origin,dir))*hlsl::dot(hull[top]-origin,inward);
+			if (area<bestArea)
+			{
+				bestArea = area;
+				bestDir = dir;
+			}
+		}
+		if (!(bestArea<std::numeric_limits<float>::infinity()))
+			return;
+
+		// extents get recomputed in 3D, so the projection's rounding doesn't leak into the box
+		SBox box = {.axes={u*bestDir.x+v*bestDir.y,u*-bestDir.y+v*bestDir.x,n}};
+		box.localMin = float32_t3(std::numeric_limits<float>::infinity());
+		box.localMax = float32_t3(-std::numeric_limits<float>::infinity());
+		for (const auto& p : hullVertices)
+		{
+			const float32_t3 local(hlsl::dot(p,box.axes[0]),hlsl::dot(p,box.axes[1]),hlsl::dot(p,box.axes[2]));
+			box.localMin = hlsl::min(box.localMin,local);
+			box.localMax = hlsl::max(box.localMax,local);
+		}
+		bestPerFace[face] = box;
+		bestVolume[face] = box.volume();
+	});
+	const auto best = std::min_element(bestVolume.begin(),bestVolume.end());
+	if (best==bestVolume.end() || !(*best<std::numeric_limits<float>::infinity()))
+		return std::nullopt;
+	return bestPerFace[std::distance(bestVolume.begin(),best)];
+}
+}
+
+bool COBBGenerator::computeConvexHull(std::span<const float32_t3> points, const float epsilon, core::vector<float32_t3>& outVertices, core::vector<uint32_t>* outTriangles)
+{
+	auto hullOf = [epsilon](std::span<const float32_t3> subset, core::vector<float32_t3>& vertices, core::vector<uint32_t>* triangles)->bool
+	{
+		CQuickHull quickHull(subset,epsilon);
+		if (!quickHull.build())
+			return false;
+		quickHull.getResult(vertices,triangles);
+		return true;
+	};
+
+	if (points.size()<=HullChunkSize*2ull)
+		return hullOf(points,outVertices,outTriangles);
+
+	// the hull of the union of the chunk hulls is the hull of all points, and the chunk hulls are usually tiny
+	const auto chunkCount = static_cast<uint32_t>((points.size()-1ull)/HullChunkSize+1ull);
+	core::vector<core::vector<float32_t3>> chunkHulls(chunkCount);
+	core::vector<uint32_t> chunks(chunkCount);
+	std::iota(chunks.begin(),chunks.end(),0u);
+	std::for_each(core::execution::par,chunks.begin(),chunks.end(),[&](const uint32_t chunk)->void
+	{
+		const auto subset = points.subspan(chunk*HullChunkSize,std::min(HullChunkSize,points.size()-chunk*HullChunkSize));
+		// a flat chunk can still contribute, so keep all of it
+		if (!hullOf(subset,chunkHulls[chunk],nullptr))
+			chunkHulls[chunk].assign(subset.begin(),subset.end());
+	});
+	core::vector<float32_t3> merged;
+	for (auto& chunkHull : chunkHulls)
+		merged.insert(merged.end(),chunkHull.begin(),chunkHull.end());
+	return hullOf(merged,outVertices,outTriangles);
+}
+
+hlsl::shapes::OBB<> COBBGenerator::compute(std::span<const float32_t3> points, const SParams& params)
+{
+	if (points.empty())
+		return obb_t::createAxisAligned(float32_t3(0.f),float32_t3(0.f));
+
+	core::vector<float32_t3> hullVertices;
+	core::vector<uint32_t> hullTriangles;
+	const bool needHull = params.useHull || params.method==EMethod::MinVolumeFaceFlush;
+	if (!needHull || !computeConvexHull(points,params.epsilon,hullVertices,params.method==EMethod::MinVolumeFaceFlush ? (&hullTriangles):nullptr))
+		return approximate(points,params.epsilon);
+
+	const auto approx = approximate(hullVertices,params.epsilon);
+	if (params.method!=EMethod::MinVolumeFaceFlush || hullTriangles.empty())
+		return approx;
+
+	// falls back to the approximate box when no face gave a box
+	const auto box = minVolumeFaceFlush(hullVertices,hullTriangles);
+	if (box && box->volume()<volume(approx))
+		return box->getOBB();
+	return approx;
+}
+
+core::vector<hlsl::shapes::OBB<>> COBBGenerator::compute(std::span<const std::span<const float32_t3>> pointSets, const SParams& params)
+{
+	core::vector<obb_t> retval(pointSets.size());
+	core::vector<uint32_t> sets(pointSets.size());
+	std::iota(sets.begin(),sets.end(),0u);
+	// a single huge set still gets its hull chunks done in parallel by the nested loop
+	std::for_each(core::execution::par,sets.begin(),sets.end(),[&](const uint32_t set)->void
+	{
+		retval[set] = compute(pointSets[set],params);
+	});
+	return retval;
+}
+
+core::vector<hlsl::shapes::OBB<>> COBBGenerator::computeJointOBBs(const ICPUPolygonGeometry* geometry, const SParams& params)
+{
+	if (!geometry)
+		return {};
+	const auto jointCount = geometry->getJointCount();
+	const auto& positionView = geometry->getPositionView();
+	if (jointCount==0u || !positionView)
+		return {};
+
+	const auto vertexCount = positionView.getElementCount();
+	core::vector<float32_t3> positions(vertexCount);
+	if (!positionView.decodeRange<float>(0ull,vertexCount,reinterpret_cast<float*>(positions.data()),3u))
+	for (uint64_t i=0ull; i<vertexCount; i++)
+		positionView.decodeElement<float32_t3>(i,positions[i]);
+
+	core::vector<core::vector<float32_t3>> jointPoints(jointCount);
+	for (const auto& jointWeight : geometry->getJointWeightViews())
+	{
+		if (!jointWeight)
+			continue;
+		const auto channels = getFormatChannelCount(jointWeight.weights.composed.format);
+		const auto count = std::min<uint64_t>(jointWeight.weights.getElementCount(),vertexCount);
+		for (uint64_t i=0ull; i<count; i++)
+		{
+			hlsl::uint32_t4 indices;
+			hlsl::float32_t4 weights;
+			if (!jointWeight.indices.decodeElement(i,indices) || !jointWeight.weights.decodeElement(i,weights))
+				continue;
+			for (auto c=0u; c<channels; c++)
+			if (weights[c]>0.f && indices[c]<jointCount)
+				jointPoints[indices[c]].push_back(positions[i]);
+		}
+	}
+
+	core::vector<std::span<const float32_t3>> pointSets(jointPoints.begin(),jointPoints.end());
+	return compute(pointSets,params);
+}
+
+}
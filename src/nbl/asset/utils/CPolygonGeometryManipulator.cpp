@@ -14,6 +14,7 @@
 #include "nbl/asset/utils/CForsythVertexCacheOptimizer.h"
 #include "nbl/asset/utils/COverdrawPolygonGeometryOptimizer.h"
 #include "nbl/asset/utils/COBBGenerator.h"
+#include "nbl/core/execution.h"
 
 
 namespace nbl::asset
@@ -143,28 +144,224 @@ core::smart_refctd_ptr<ICPUPolygonGeometry> CPolygonGeometryManipulator::createU
 	return outGeometry;
 }
 
-core::smart_refctd_ptr<ICPUPolygonGeometry> CPolygonGeometryManipulator::createSmoothVertexNormal(const ICPUPolygonGeometry* inPolygon, bool enableWelding, float epsilon, SSNGVxCmpFunction vxcmp, const bool recomputeHash)
+namespace
+{
+using SDataView = ICPUPolygonGeometry::SDataView;
+
+constexpr uint64_t QuantizationBatchSize = 4096ull;
+
+// only floating point data with 32bit or wider channels gets smaller when quantized to 16bit
+inline bool isQuantizable(const SDataView& view)
+{
+	if (!view || !view.composed.isFormatted() || !isFloatingPointFormat(view.composed.format) || isBlockCompressionFormat(view.composed.format))
+		return false;
+	const auto channels = getFormatChannelCount(view.composed.format);
+	return getTexelOrBlockBytesize(view.composed.format)>=4u*channels;
+}
+
+inline core::vector<uint64_t> quantizationBatches(const uint64_t count)
+{
+	core::vector<uint64_t> batches((count+QuantizationBatchSize-1ull)/QuantizationBatchSize);
+	std::iota(batches.begin(),batches.end(),0ull);
+	return batches;
+}
+
+inline SDataView createQuantizedView(const SDataView& inView, const E_FORMAT format, const uint64_t count)
+{
+	const uint32_t stride = getTexelOrBlockBytesize(format);
+	auto buffer = ICPUBuffer::create({stride*count,inView.src.buffer->getUsageFlags()});
+	if (!buffer)
+		return {};
+	SDataView retval = {
+		.composed = {
+			.stride = stride,
+		},
+		.src = {.offset=0,.size=buffer->getSize(),.buffer=std::move(buffer)}
+	};
+	retval.composed.format = format;
+	return retval;
+}
+
+// UNORM relative to the AABB has the same worst case error in every channel relative to that channel's extent, so the format follows from the bound
+SDataView quantizeToUnorm(const SDataView& inView, const float maxRelativeError)
+{
+	if (!isQuantizable(inView))
+		return {};
+	const uint32_t channels = getFormatChannelCount(inView.composed.format);
+	// 3 channel data goes into 4 channel formats, 3 channel ones have poor vertex fetch support and misaligned elements
+	constexpr E_FORMAT Formats[4][2] = {
+		{EF_R8_UNORM,EF_R16_UNORM},
+		{EF_R8G8_UNORM,EF_R16G16_UNORM},
+		{EF_R8G8B8A8_UNORM,EF_R16G16B16A16_UNORM},
+		{EF_R8G8B8A8_UNORM,EF_R16G16B16A16_UNORM}
+	};
+	constexpr float MaxErrors[2] = {0.5f/255.f,0.5f/65535.f};
+	uint32_t choice = 0u;
+	while (choice<2u && MaxErrors[choice]>maxRelativeError)
+		choice++;
+	if (choice==2u)
+		return {};
+	const auto format = Formats[channels-1u][choice];
+
+	const uint64_t count = inView.getElementCount();
+	if (count==0ull)
+		return {};
+	core::vector<float> values(count*channels);
+	if (!inView.decodeRange<float>(0ull,count,values.data(),channels))
+		return {};
+	// channels the data doesn't have stay at 0
+	hlsl::shapes::AABB<4,hlsl::float32_t> aabb;
+	aabb.minVx = hlsl::float32_t4(0.f,0.f,0.f,0.f);
+	aabb.maxVx = aabb.minVx;
+	for (uint32_t c=0u; c<channels; c++)
+		aabb.minVx[c] = aabb.maxVx[c] = values[c];
+	for (uint64_t i=0ull; i<count; i++)
+	for (uint32_t c=0u; c<channels; c++)
+	{
+		aabb.minVx[c] = core::min(aabb.minVx[c],values[i*channels+c]);
+		aabb.maxVx[c] = core::max(aabb.maxVx[c],values[i*channels+c]);
+	}
+	if (!std::isfinite(aabb.minVx[0]+aabb.minVx[1]+aabb.minVx[2]+aabb.minVx[3]+aabb.maxVx[0]+aabb.maxVx[1]+aabb.maxVx[2]+aabb.maxVx[3]))
+		return {};
+
+	auto retval = createQuantizedView(inView,format,count);
+	if (!retval)
+		return {};
+	retval.composed.encodedDataRange.f32 = aabb;
+	retval.composed.rangeFormat = IGeometryBase::EAABBFormat::F32;
+	const auto batches = quantizationBatches(count);
+	std::for_each(core::execution::par_unseq,batches.begin(),batches.end(),[&](const uint64_t batch)->void
+	{
+		const uint64_t first = batch*QuantizationBatchSize;
+		retval.encodeRange<float>(first,core::min(QuantizationBatchSize,count-first),values.data()+first*channels,channels);
+	});
+	return retval;
+}
+
+// `Format` is what gets stored, `CacheFormat` what `CQuantNormalCache` quantizes to, the extra channel of the former stays 0
+template<E_FORMAT CacheFormat, E_FORMAT Format=CacheFormat>
+SDataView quantizeNormals(const SDataView& inView, const core::vector<hlsl::float32_t3>& normals, const float maxError, CQuantNormalCache& cache)
+{
+	using value_t = CQuantNormalCache::value_type_t<Format>;
+	constexpr uint32_t QuantizationBits = CQuantNormalCache::quantization_bits_v<CacheFormat>;
+	constexpr int16_t MaxCode = int16_t((0x1u<<QuantizationBits)-1u);
+	constexpr float MaxValue = float(MaxCode);
+
+	const uint64_t count = normals.size();
+	auto retval = createQuantizedView(inView,Format,count);
+	if (!retval)
+		return {};
+	// raw SNORM extents, same as the geometry creator
+	hlsl::shapes::AABB<4,int16_t> aabb;
+	aabb.maxVx = hlsl::vector<int16_t,4>(MaxCode,MaxCode,MaxCode,0);
+	aabb.minVx = -aabb.maxVx;
+	retval.composed.encodedDataRange.s16 = aabb;
+	retval.composed.rangeFormat = IGeometryBase::EAABBFormat::S16_NORM;
+
+	std::atomic_bool withinError = true;
+	auto* const out = reinterpret_cast<value_t*>(retval.getPointer());
+	auto quantizeRange = [&](const uint64_t first, const uint64_t last)->void
+	{
+		for (uint64_t i=first; i<last && withinError.load(std::memory_order_relaxed); i++)
+		{
+			const float lengthSquared = hlsl::dot(normals[i],normals[i]);
+			if (!(lengthSquared>hlsl::numeric_limits<float>::min))
+			{
+				out[i] = value_t();
+				continue;
+			}
+			const auto normal = normals[i]*hlsl::rsqrt(lengthSquared);
+			const auto raw = cache.quantize<CacheFormat>(normal).getValue();
+			out[i] = value_t(raw);
+
+			// decode the two's complement fields of the packed value to check the error
+			hlsl::float32_t3 decoded;
+			for (uint32_t c=0u; c<3u; c++)
+			{
+				constexpr uint32_t Shift = 31u-QuantizationBits;
+				decoded[c] = core::max(float(int32_t(uint32_t(raw[c])<<Shift)>>Shift)/MaxValue,-1.f);
+			}
+			const float decodedLengthSquared = hlsl::dot(decoded,decoded);
+			if (!(decodedLengthSquared>0.f) || 1.f-hlsl::dot(normal,decoded)*hlsl::rsqrt(decodedLengthSquared)>maxError)
+				withinError = false;
+		}
+	};
+	// the cache is sharded, so all batches share it and a direction only gets fitted once
+	const auto batches = quantizationBatches(count);
+	std::for_each(core::execution::par,batches.begin(),batches.end(),[&](const uint64_t batch)->void
+	{
+		const uint64_t first = batch*QuantizationBatchSize;
+		quantizeRange(first,core::min(first+QuantizationBatchSize,count));
+	});
+	if (!withinError)
+		return {};
+	return retval;
+}
+}
+
+core::smart_refctd_ptr<ICPUPolygonGeometry> CPolygonGeometryManipulator::createQuantized(const ICPUPolygonGeometry* inGeo, const SQuantizationParams& params, const bool recomputeHash)
+{
+	if (!inGeo || !inGeo->getPositionView())
+		return nullptr;
+	auto outGeometry = core::move_and_static_cast<ICPUPolygonGeometry>(inGeo->clone(0u));
+	auto* const outGeo = outGeometry.get();
+
+	const auto& positionView = inGeo->getPositionView();
+	if (isQuantizable(positionView) && getFormatChannelCount(positionView.composed.format)>=3u)
+	if (auto quantized=quantizeToUnorm(positionView,params.positionError); quantized)
+		outGeo->setPositionView(std::move(quantized));
+
+	const auto& normalView = inGeo->getNormalView();
+	if (isQuantizable(normalView) && getFormatChannelCount(normalView.composed.format)==3u)
+	{
+		const uint64_t count = normalView.getElementCount();
+		core::vector<hlsl::float32_t3> normals(count);
+		if (normalView.decodeRange<float>(0ull,count,reinterpret_cast<float*>(normals.data()),3u))
+		{
+			auto localCache = params.normalCache ? nullptr:core::make_smart_refctd_ptr<CQuantNormalCache>();
+			auto& cache = params.normalCache ? *params.normalCache:*localCache;
+			auto quantized = quantizeNormals<EF_A2B10G10R10_SNORM_PACK32>(normalView,normals,params.normalError,cache);
+			if (!quantized)
+				quantized = quantizeNormals<EF_R16G16B16_SNORM,EF_R16G16B16A16_SNORM>(normalView,normals,params.normalError,cache);
+			if (quantized)
+				outGeo->setNormalView(std::move(quantized));
+		}
+	}
+
+	for (auto& view : *outGeo->getAuxAttributeViews())
+	if (auto quantized=quantizeToUnorm(view,params.auxAttributeError); quantized)
+		view = std::move(quantized);
+
+	if (recomputeHash)
+		recomputeContentHashes(outGeo);
+	return outGeometry;
+}
+
+bool CPolygonGeometryManipulator::canCreateSmoothVertexNormal(const ICPUPolygonGeometry* inPolygon)
 {
 	if (!inPolygon)
 	{
 			_NBL_DEBUG_BREAK_IF(true);
-			return nullptr;
+			return false;
 	}
 
-	if (!inPolygon->getIndexingCallback() && inPolygon->getIndexingCallback()->degree()!=3)
+	if (!inPolygon->getIndexingCallback() || inPolygon->getIndexingCallback()->degree()!=3)
 	{
 		_NBL_DEBUG_BREAK_IF(true);
-		return nullptr;
+		return false;
 	}
 
     // right now we can't handle this, see TODOs in CSmoothNormalGenerator
 	if (inPolygon->getIndexView())
 	{
 		_NBL_DEBUG_BREAK_IF(true);
-		return nullptr;
+		return false;
 	}
+	return true;
+}
 
-	auto result = CSmoothNormalGenerator::calculateNormals(inPolygon, epsilon, vxcmp, false);
+core::smart_refctd_ptr<ICPUPolygonGeometry> CPolygonGeometryManipulator::finalizeSmoothVertexNormal(CSmoothNormalGenerator::Result&& result, const bool enableWelding, const float epsilon, const bool recomputeHash)
+{
 	if (enableWelding)
 	{
 		auto weldPredicate = CVertexWelder::DefaultWeldPredicate(epsilon);
@@ -173,7 +370,7 @@ core::smart_refctd_ptr<ICPUPolygonGeometry> CPolygonGeometryManipulator::createS
 
     if (recomputeHash)
         recomputeContentHashes(result.geom.get());
-	return result.geom;
+	return std::move(result.geom);
 }
 
 #if 0
@@ -0,0 +1,609 @@
+// Copyright (C) 2018-2025 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+
+#include "nbl/asset/utils/CQuadricSimplifier.h"
+#include "nbl/asset/utils/CVertexHashGrid.h"
+#include "nbl/asset/utils/CVertexWelder.h"
+#include "nbl/core/execution.h"
+
+#include <array>
+#include <numeric>
+
+
+namespace nbl::asset
+{
+
+namespace
+{
+constexpr uint32_t InvalidIndex = ~0u;
+// normals and two UV channels, or normals and a color, fit without the quadrics getting too fat
+constexpr uint32_t MaxAttributes = 5u;
+constexpr uint32_t MaxDimension = 3u+MaxAttributes;
+// border edges get a perpendicular plane quadric so the outline keeps its shape
+constexpr float BorderPlaneWeight = 10.f;
+
+// symmetric matrix stored as its packed upper triangle
+struct SQuadric
+{
+	static inline uint32_t packedIx(const uint32_t i, const uint32_t j)
+	{
+		return i*(2u*MaxDimension-i+1u)/2u+(j-i);
+	}
+
+	inline SQuadric& operator+=(const SQuadric& other)
+	{
+		for (uint32_t i=0u; i<std::size(a); i++)
+			a[i] += other.a[i];
+		for (uint32_t i=0u; i<MaxDimension; i++)
+			b[i] += other.b[i];
+		c += other.c;
+		weight += other.weight;
+		return *this;
+	}
+
+	// (v^T*A*v+2*b^T*v+c)/weight, the weighted mean of the squared distances so it's comparable to `targetError` squared
+	inline float evaluate(const float* v, const uint32_t dimension) const
+	{
+		float retval = c;
+		for (uint32_t i=0u; i<dimension; i++)
+		{
+			float row = a[packedIx(i,i)]*v[i];
+			for (uint32_t j=i+1u; j<dimension; j++)
+				row += 2.f*a[packedIx(i,j)]*v[j];
+			retval += (row+2.f*b[i])*v[i];
+		}
+		return weight>0.f ? core::max(retval,0.f)/weight:0.f;
+	}
+
+	// the plane (or in higher dimensions the 2-flat) through the triangle, weighted by its area
+	inline void addTriangle(const float* p0, const float* p1, const float* p2, const uint32_t dimension, const float weight)
+	{
+		float e1[MaxDimension], e2[MaxDimension];
+		float e1Len2 = 0.f;
+		for (uint32_t i=0u; i<dimension; i++)
+		{
+			e1[i] = p1[i]-p0[i];
+			e1Len2 += e1[i]*e1[i];
+		}
+		if (e1Len2<=0.f)
+			return;
+		const float e1RcpLen = 1.f/std::sqrt(e1Len2);
+		float e1DotE2 = 0.f;
+		for (uint32_t i=0u; i<dimension; i++)
+		{
+			e1[i] *= e1RcpLen;
+			e2[i] = p2[i]-p0[i];
+			e1DotE2 += e1[i]*e2[i];
+		}
+		float e2Len2 = 0.f;
+		for (uint32_t i=0u; i<dimension; i++)
+		{
+			e2[i] -= e1DotE2*e1[i];
+			e2Len2 += e2[i]*e2[i];
+		}
+		if (e2Len2<=0.f)
+			return;
+		const float e2RcpLen = 1.f/std::sqrt(e2Len2);
+		float pDotE1 = 0.f, pDotE2 = 0.f, pDotP = 0.f;
+		for (uint32_t i=0u; i<dimension; i++)
+		{
+			e2[i] *= e2RcpLen;
+			pDotE1 += p0[i]*e1[i];
+			pDotE2 += p0[i]*e2[i];
+			pDotP += p0[i]*p0[i];
+		}
+
+		// A = I-e1*e1^T-e2*e2^T, b = (p.e1)*e1+(p.e2)*e2-p, c = p.p-(p.e1)^2-(p.e2)^2
+		for (uint32_t i=0u; i<dimension; i++)
+		{
+			for (uint32_t j=i; j<dimension; j++)
+				a[packedIx(i,j)] += weight*((i==j ? 1.f:0.f)-e1[i]*e1[j]-e2[i]*e2[j]);
+			b[i] += weight*(pDotE1*e1[i]+pDotE2*e2[i]-p0[i]);
+		}
+		c += weight*(pDotP-pDotE1*pDotE1-pDotE2*pDotE2);
+		this->weight += weight;
+	}
+
+	// only constrains positions
+	inline void addPlane(const hlsl::float32_t3& normal, const float distance, const float weight)
+	{
+		for (uint32_t i=0u; i<3u; i++)
+		{
+			for (uint32_t j=i; j<3u; j++)
+				a[packedIx(i,j)] += weight*normal[i]*normal[j];
+			b[i] += weight*distance*normal[i];
+		}
+		c += weight*distance*distance;
+		this->weight += weight;
+	}
+
+	float a[MaxDimension*(MaxDimension+1u)/2u] = {};
+	float b[MaxDimension] = {};
+	float c = 0.f;
+	// sum of the areas (and border plane weights) the quadric was accumulated from
+	float weight = 0.f;
+};
+
+struct SWeldVertex
+{
+	uint32_t index;
+	uint32_t hash;
+	hlsl::float32_t3 position;
+
+	hlsl::float32_t3 getPosition() const {return position;}
+	void setHash(uint32_t _hash) {hash = _hash;}
+	uint32_t getHash() const {return hash;}
+};
+
+core::smart_refctd_ptr<const ICPUPolygonGeometry> weld(const ICPUPolygonGeometry* geometry, const CQuadricSimplifier::SParams& params)
+{
+	auto retval = core::smart_refctd_ptr<const ICPUPolygonGeometry>(geometry);
+	if (!params.weld)
+		return retval;
+
+	const auto& positionView = geometry->getPositionView();
+	const uint64_t vertexCount = positionView.getElementCount();
+	const uint32_t hashTableSizeLog2 = core::max(core::min(hlsl::findMSB(static_cast<uint32_t>(vertexCount))+1,24),2);
+	CVertexHashGrid<SWeldVertex> grid(params.weldEpsilon*2.f,hashTableSizeLog2,vertexCount);
+	for (uint32_t i=0u; i<vertexCount; i++)
+	{
+		hlsl::float32_t3 position;
+		positionView.decodeElement<hlsl::float32_t3>(i,position);
+		grid.add({i,0u,position});
+	}
+	grid.bake();
+
+	CVertexWelder::DefaultWeldPredicate predicate(params.weldEpsilon);
+	if (auto welded=CVertexWelder::weldVertices(geometry,grid,predicate,false); welded)
+		retval = std::move(welded);
+	return retval;
+}
+
+class CSimplifier
+{
+	public:
+		inline CSimplifier(const ICPUPolygonGeometry* geometry, const CQuadricSimplifier::SParams& params) : m_params(params)
+		{
+			const auto& positionView = geometry->getPositionView();
+			const uint64_t vertexCount = positionView.getElementCount();
+			const uint64_t triangleCount = geometry->getPrimitiveCount();
+			if (vertexCount==0ull || vertexCount>=InvalidIndex || triangleCount==0ull || triangleCount*3ull>=InvalidIndex)
+				return;
+			m_vertexCount = static_cast<uint32_t>(vertexCount);
+
+			// triangle list, without degenerate triangles or primitive restarts
+			m_indices.resize(triangleCount*3ull);
+			if (!geometry->getPrimitiveIndices(m_indices.data(),0u,static_cast<uint32_t>(triangleCount)))
+			{
+				m_indices.clear();
+				return;
+			}
+			{
+				size_t outIx = 0ull;
+				for (size_t i=0ull; i<m_indices.size(); i+=3ull)
+				{
+					const uint32_t i0 = m_indices[i], i1 = m_indices[i+1], i2 = m_indices[i+2];
+					if (i0>=m_vertexCount || i1>=m_vertexCount || i2>=m_vertexCount || i0==i1 || i1==i2 || i2==i0)
+						continue;
+					m_indices[outIx++] = i0;
+					m_indices[outIx++] = i1;
+					m_indices[outIx++] = i2;
+				}
+				m_indices.resize(outIx);
+			}
+
+			core::vector<hlsl::float32_t3> positions(m_vertexCount);
+			if (!positionView.decodeRange<float>(0ull,m_vertexCount,reinterpret_cast<float*>(positions.data()),3u))
+			{
+				for (uint32_t i=0u; i<m_vertexCount; i++)
+					positionView.decodeElement<hlsl::float32_t3>(i,positions[i]);
+			}
+
+			// normalize positions so errors are relative to the extent and attributes weights mean the same for any scale
+			auto bounds = hlsl::shapes::AABB<3,hlsl::float32_t>::create();
+			for (const auto& position : positions)
+				bounds.addPoint(position);
+			const auto extent = bounds.getExtent();
+			const float scale = 1.f/core::max(core::max(extent.x,extent.y),core::max(extent.z,hlsl::numeric_limits<float>::min));
+
+			m_dimension = 3u;
+			core::vector<float> attributes;
+			auto addAttributes = [&](const ICPUPolygonGeometry::SDataView& view, const uint32_t maxChannels, const float weight) -> void
+			{
+				if (!view || !view.composed.isFormatted() || view.getElementCount()<m_vertexCount || weight<=0.f)
+					return;
+				const uint32_t channels = core::min(core::min(getFormatChannelCount(view.composed.format),maxChannels),MaxDimension-m_dimension);
+				if (channels==0u)
+					return;
+				attributes.resize(m_vertexCount*channels);
+				if (!view.decodeRange<float>(0ull,m_vertexCount,attributes.data(),channels))
+					return;
+				for (uint32_t v=0u; v<m_vertexCount; v++)
+				for (uint32_t c=0u; c<channels; c++)
+					m_points[v*MaxDimension+m_dimension+c] = attributes[v*channels+c]*weight;
+				m_dimension += channels;
+			};
+			m_points.resize(m_vertexCount*MaxDimension,0.f);
+			for (uint32_t v=0u; v<m_vertexCount; v++)
+			{
+				const auto normalized = (positions[v]-bounds.minVx)*scale;
+				for (uint32_t c=0u; c<3u; c++)
+					m_points[v*MaxDimension+c] = normalized[c];
+			}
+			addAttributes(geometry->getNormalView(),3u,m_params.normalWeight);
+			for (const auto& view : geometry->getAuxAttributeViews())
+				addAttributes(view,4u,m_params.auxAttributeWeight);
+
+			classifyVertices();
+
+			m_quadrics.resize(m_vertexCount);
+			for (size_t i=0ull; i<m_indices.size(); i+=3ull)
+			{
+				const uint32_t i0 = m_indices[i], i1 = m_indices[i+1], i2 = m_indices[i+2];
+				const auto normal = hlsl::cross(getPosition(i1)-getPosition(i0),getPosition(i2)-getPosition(i0));
+				const float doubleArea = hlsl::length(normal);
+				if (doubleArea<=0.f)
+					continue;
+				SQuadric quadric;
+				quadric.addTriangle(getPoint(i0),getPoint(i1),getPoint(i2),m_dimension,doubleArea*0.5f);
+				m_quadrics[i0] += quadric;
+				m_quadrics[i1] += quadric;
+				m_quadrics[i2] += quadric;
+
+				// open edges get a plane perpendicular to the triangle through them
+				const uint32_t triangle[3] = {i0,i1,i2};
+				for (uint32_t e=0u; e<3u; e++)
+				{
+					const uint32_t from = triangle[e], to = triangle[(e+1u)%3u];
+					if (!isBorderEdge(from,to))
+						continue;
+					const auto edge = getPosition(to)-getPosition(from);
+					const float edgeLen2 = hlsl::dot(edge,edge);
+					const auto planeNormal = hlsl::cross(edge,normal);
+					const float planeNormalLen2 = hlsl::dot(planeNormal,planeNormal);
+					if (planeNormalLen2<=0.f)
+						continue;
+					const auto unitNormal = planeNormal*hlsl::rsqrt(planeNormalLen2);
+					SQuadric plane;
+					plane.addPlane(unitNormal,-hlsl::dot(unitNormal,getPosition(from)),edgeLen2*BorderPlaneWeight);
+					m_quadrics[from] += plane;
+					m_quadrics[to] += plane;
+				}
+			}
+		}
+
+		inline explicit operator bool() const {return !m_indices.empty();}
+
+		inline const core::vector<uint32_t>& getIndices() const {return m_indices;}
+		inline float getError() const {return std::sqrt(m_maxError);}
+
+		// returns whether any collapse happened
+		inline bool reduce(const size_t targetIndexCount)
+		{
+			const float maxError = m_params.targetError*m_params.targetError;
+			bool retval = false;
+			while (m_indices.size()>targetIndexCount)
+			{
+				const size_t collapseGoal = core::max<size_t>((m_indices.size()-targetIndexCount)/6ull,1ull);
+				if (collapsePass(collapseGoal,maxError)==0ull)
+					break;
+				retval = true;
+			}
+			return retval;
+		}
+
+	private:
+		enum E_VERTEX_KIND : uint8_t
+		{
+			EVK_MANIFOLD,
+			// can only collapse along border edges
+			EVK_BORDER,
+			// seams or locked borders
+			EVK_LOCKED
+		};
+		struct SCollapse
+		{
+			float cost;
+			uint32_t from;
+			uint32_t to;
+		};
+
+		inline const float* getPoint(const uint32_t vertex) const {return m_points.data()+vertex*MaxDimension;}
+		inline hlsl::float32_t3 getPosition(const uint32_t vertex) const
+		{
+			const float* point = getPoint(vertex);
+			return hlsl::float32_t3(point[0],point[1],point[2]);
+		}
+
+		static inline uint64_t edgeKey(const uint32_t from, const uint32_t to) {return (uint64_t(from)<<32ull)|to;}
+		// border edges only exist in one direction
+		inline bool isBorderEdge(const uint32_t from, const uint32_t to) const
+		{
+			return std::binary_search(m_edges.begin(),m_edges.end(),edgeKey(from,to))!=std::binary_search(m_edges.begin(),m_edges.end(),edgeKey(to,from));
+		}
+		inline void gatherEdges()
+		{
+			m_edges.resize(m_indices.size());
+			for (size_t i=0ull; i<m_indices.size(); i+=3ull)
+			for (uint32_t e=0u; e<3u; e++)
+				m_edges[i+e] = edgeKey(m_indices[i+e],m_indices[i+(e+1u)%3u]);
+			std::sort(m_edges.begin(),m_edges.end());
+		}
+
+		inline void classifyVertices()
+		{
+			gatherEdges();
+			m_kinds.assign(m_vertexCount,EVK_MANIFOLD);
+			for (const auto edge : m_edges)
+			{
+				const uint32_t from = uint32_t(edge>>32ull), to = uint32_t(edge);
+				if (!std::binary_search(m_edges.begin(),m_edges.end(),edgeKey(to,from)))
+				{
+					const auto kind = m_params.lockBorders ? EVK_LOCKED:EVK_BORDER;
+					m_kinds[from] = core::max(m_kinds[from],kind);
+					m_kinds[to] = core::max(m_kinds[to],kind);
+				}
+			}
+
+			// vertices with the same position but other attributes are seams, sort by the position's bits to find them,
+			// vertices the welding made unreferenced must not count
+			core::vector<uint8_t> referenced(m_vertexCount,0u);
+			for (const auto index : m_indices)
+				referenced[index] = 1u;
+			core::vector<uint32_t> byPosition;
+			byPosition.reserve(m_vertexCount);
+			for (uint32_t i=0u; i<m_vertexCount; i++)
+			if (referenced[i])
+				byPosition.push_back(i);
+			auto positionBits = [&](const uint32_t vertex) -> std::array<uint32_t,3>
+			{
+				std::array<uint32_t,3> retval;
+				memcpy(retval.data(),getPoint(vertex),sizeof(retval));
+				return retval;
+			};
+			std::sort(byPosition.begin(),byPosition.end(),[&](const uint32_t lhs, const uint32_t rhs)->bool{return positionBits(lhs)<positionBits(rhs);});
+			for (size_t i=1ull; i<byPosition.size(); i++)
+			if (positionBits(byPosition[i-1u])==positionBits(byPosition[i]))
+				m_kinds[byPosition[i-1u]] = m_kinds[byPosition[i]] = EVK_LOCKED;
+		}
+
+		inline bool canCollapse(const uint32_t from, const uint32_t to) const
+		{
+			switch (m_kinds[from])
+			{
+				case EVK_MANIFOLD:
+					return true;
+				case EVK_BORDER:
+					return isBorderEdge(from,to);
+				default:
+					break;
+			}
+			return false;
+		}
+
+		// moving `from` onto `to` mustn't turn any of the triangles around `from` inside out
+		inline bool flipsTriangles(const uint32_t from, const uint32_t to) const
+		{
+			const auto newPosition = getPosition(to);
+			for (uint32_t i=m_adjacencyOffsets[from]; i<m_adjacencyOffsets[from+1u]; i++)
+			{
+				const uint32_t* triangle = m_indices.data()+m_adjacency[i]*3u;
+				if (triangle[0]==to || triangle[1]==to || triangle[2]==to)
+					continue;
+				hlsl::float32_t3 oldPositions[3], newPositions[3];
+				for (uint32_t v=0u; v<3u; v++)
+				{
+					oldPositions[v] = getPosition(triangle[v]);
+					newPositions[v] = triangle[v]==from ? newPosition:oldPositions[v];
+				}
+				const auto oldNormal = hlsl::cross(oldPositions[1]-oldPositions[0],oldPositions[2]-oldPositions[0]);
+				const auto newNormal = hlsl::cross(newPositions[1]-newPositions[0],newPositions[2]-newPositions[0]);
+				if (hlsl::dot(oldNormal,newNormal)<=0.f)
+					return true;
+			}
+			return false;
+		}
+
+		inline size_t collapsePass(const size_t collapseGoal, const float maxError)
+		{
+			// vertex to triangle adjacency of the current triangles
+			m_adjacencyOffsets.assign(m_vertexCount+1u,0u);
+			for (const auto index : m_indices)
+				m_adjacencyOffsets[index+1u]++;
+			std::inclusive_scan(m_adjacencyOffsets.begin(),m_adjacencyOffsets.end(),m_adjacencyOffsets.begin());
+			m_adjacency.resize(m_indices.size());
+			{
+				core::vector<uint32_t> cursors(m_adjacencyOffsets.begin(),m_adjacencyOffsets.end()-1);
+				for (uint32_t i=0u; i<m_indices.size(); i++)
+					m_adjacency[cursors[m_indices[i]]++] = i/3u;
+			}
+			gatherEdges();
+
+			// cheapest collapse of every vertex, costs are independent so get evaluated in parallel
+			core::vector<SCollapse> collapses(m_vertexCount,{std::numeric_limits<float>::infinity(),InvalidIndex,InvalidIndex});
+			core::vector<uint32_t> vertices(m_vertexCount);
+			std::iota(vertices.begin(),vertices.end(),0u);
+			std::for_each(core::execution::par_unseq,vertices.begin(),vertices.end(),[&](const uint32_t from) -> void
+			{
+				if (m_kinds[from]==EVK_LOCKED)
+					return;
+				auto& best = collapses[from];
+				for (uint32_t i=m_adjacencyOffsets[from]; i<m_adjacencyOffsets[from+1u]; i++)
+				{
+					const uint32_t* triangle = m_indices.data()+m_adjacency[i]*3u;
+					for (uint32_t v=0u; v<3u; v++)
+					{
+						const uint32_t to = triangle[v];
+						if (to==from || !canCollapse(from,to))
+							continue;
+						const float cost = m_quadrics[from].evaluate(getPoint(to),m_dimension);
+						if (cost<best.cost)
+							best = {cost,from,to};
+					}
+				}
+			});
+			collapses.erase(std::remove_if(collapses.begin(),collapses.end(),[maxError](const SCollapse& collapse)->bool{return collapse.from==InvalidIndex || collapse.cost>maxError;}),collapses.end());
+			std::sort(collapses.begin(),collapses.end(),[](const SCollapse& lhs, const SCollapse& rhs)->bool{return lhs.cost<rhs.cost;});
+
+			// every vertex takes part in at most one collapse per pass, so the remap never chains
+			core::vector<uint32_t> remap(m_vertexCount);
+			std::iota(remap.begin(),remap.end(),0u);
+			core::vector<uint8_t> touched(m_vertexCount,0u);
+			size_t collapsed = 0ull;
+			for (const auto& collapse : collapses)
+			{
+				if (touched[collapse.from] || touched[collapse.to] || flipsTriangles(collapse.from,collapse.to))
+					continue;
+				remap[collapse.from] = collapse.to;
+				m_quadrics[collapse.to] += m_quadrics[collapse.from];
+				touched[collapse.from] = touched[collapse.to] = 1u;
+				m_maxError = core::max(m_maxError,collapse.cost);
+				if (++collapsed>=collapseGoal)
+					break;
+			}
+			if (collapsed==0ull)
+				return 0ull;
+
+			size_t outIx = 0ull;
+			for (size_t i=0ull; i<m_indices.size(); i+=3ull)
+			{
+				const uint32_t i0 = remap[m_indices[i]], i1 = remap[m_indices[i+1]], i2 = remap[m_indices[i+2]];
+				if (i0==i1 || i1==i2 || i2==i0)
+					continue;
+				m_indices[outIx++] = i0;
+				m_indices[outIx++] = i1;
+				m_indices[outIx++] = i2;
+			}
+			m_indices.resize(outIx);
+			return collapsed;
+		}
+
+		const CQuadricSimplifier::SParams m_params;
+		uint32_t m_vertexCount = 0u;
+		uint32_t m_dimension = 3u;
+		float m_maxError = 0.f;
+		core::vector<uint32_t> m_indices;
+		// positions then weighted attributes, `MaxDimension` floats per vertex
+		core::vector<float> m_points;
+		core::vector<SQuadric> m_quadrics;
+		core::vector<E_VERTEX_KIND> m_kinds;
+		// sorted directed edges
+		core::vector<uint64_t> m_edges;
+		core::vector<uint32_t> m_adjacencyOffsets;
+		core::vector<uint32_t> m_adjacency;
+};
+
+// shares all the vertex buffers with `base`, only the index view is new
+core::smart_refctd_ptr<ICPUPolygonGeometry> createLevel(const ICPUPolygonGeometry* base, const core::vector<uint32_t>& indices)
+{
+	auto retval = core::move_and_static_cast<ICPUPolygonGeometry>(base->clone(0u));
+	const uint32_t maxIndex = indices.empty() ? 0u:*std::max_element(indices.begin(),indices.end());
+	const bool shortIndices = maxIndex<=std::numeric_limits<uint16_t>::max();
+	const size_t indexSize = shortIndices ? sizeof(uint16_t):sizeof(uint32_t);
+
+	auto indexBuffer = ICPUBuffer::create({indexSize*indices.size(),IBuffer::EUF_INDEX_BUFFER_BIT});
+	if (!indexBuffer)
+		return nullptr;
+	ICPUPolygonGeometry::SDataView indexView = {
+		.composed = {
+			.stride = static_cast<uint32_t>(indexSize),
+		},
+		.src = {.offset=0,.size=indexBuffer->getSize(),.buffer=std::move(indexBuffer)}
+	};
+	if (shortIndices)
+	{
+		hlsl::shapes::AABB<4,uint16_t> aabb;
+		aabb.minVx[0] = 0;
+		aabb.maxVx[0] = maxIndex;
+		indexView.composed.encodedDataRange.u16 = aabb;
+		indexView.composed.format = EF_R16_UINT;
+		indexView.composed.rangeFormat = IGeometryBase::EAABBFormat::U16;
+		auto* out = reinterpret_cast<uint16_t*>(indexView.getPointer());
+		for (size_t i=0ull; i<indices.size(); i++)
+			out[i] = static_cast<uint16_t>(indices[i]);
+	}
+	else
+	{
+		hlsl::shapes::AABB<4,uint32_t> aabb;
+		aabb.minVx[0] = 0;
+		aabb.maxVx[0] = maxIndex;
+		indexView.composed.encodedDataRange.u32 = aabb;
+		indexView.composed.format = EF_R32_UINT;
+		indexView.composed.rangeFormat = IGeometryBase::EAABBFormat::U32;
+		memcpy(indexView.getPointer(),indices.data(),indices.size()*sizeof(uint32_t));
+	}
+
+	retval->setIndexing(IPolygonGeometryBase::TriangleList());
+	retval->setIndexView(std::move(indexView));
+	CGeometryManipulator::recomputeContentHash(retval->getIndexView());
+	return retval;
+}
+
+inline bool isSimplifiable(const ICPUPolygonGeometry* geometry)
+{
+	if (!geometry || !geometry->getIndexingCallback() || geometry->getIndexingCallback()->degree()!=3)
+		return false;
+	const auto& positionView = geometry->getPositionView();
+	return positionView && positionView.composed.isFormatted();
+}
+}
+
+core::smart_refctd_ptr<ICPUPolygonGeometry> CQuadricSimplifier::simplify(const ICPUPolygonGeometry* geometry, const SParams& params, float* outError)
+{
+	if (!isSimplifiable(geometry))
+		return nullptr;
+
+	const auto base = weld(geometry,params);
+	CSimplifier simplifier(base.get(),params);
+	if (!simplifier)
+		return nullptr;
+	simplifier.reduce(params.targetIndexCount);
+	if (outError)
+		*outError = simplifier.getError();
+	return createLevel(base.get(),simplifier.getIndices());
+}
+
+core::vector<core::smart_refctd_ptr<ICPUPolygonGeometry>> CQuadricSimplifier::createLODChain(const ICPUPolygonGeometry* geometry, const SLODChainParams& params)
+{
+	core::vector<core::smart_refctd_ptr<ICPUPolygonGeometry>> retval;
+	if (!isSimplifiable(geometry) || params.maxLevels==0u || params.levelRatio<=0.f || params.levelRatio>=1.f)
+		return retval;
+
+	const auto base = weld(geometry,params.base);
+	CSimplifier simplifier(base.get(),params.base);
+	if (!simplifier)
+		return retval;
+
+	retval.reserve(params.maxLevels);
+	retval.push_back(createLevel(base.get(),simplifier.getIndices()));
+	for (uint32_t level=1u; level<params.maxLevels; level++)
+	{
+		const size_t targetIndexCount = static_cast<size_t>(double(simplifier.getIndices().size())*params.levelRatio)/3ull*3ull;
+		if (!simplifier.reduce(targetIndexCount))
+			break;
+		retval.push_back(createLevel(base.get(),simplifier.getIndices()));
+	}
+	return retval;
+}
+
+core::vector<core::vector<core::smart_refctd_ptr<ICPUPolygonGeometry>>> CQuadricSimplifier::createLODChains(const ICPUGeometryCollection* collection, const SLODChainParams& params)
+{
+	if (!collection)
+		return {};
+
+	const auto& geometries = collection->getGeometries();
+	core::vector<core::vector<core::smart_refctd_ptr<ICPUPolygonGeometry>>> retval(geometries.size());
+	core::vector<uint32_t> geometryIxs(geometries.size());
+	std::iota(geometryIxs.begin(),geometryIxs.end(),0u);
+	std::for_each(core::execution::par,geometryIxs.begin(),geometryIxs.end(),[&](const uint32_t geometryIx) -> void
+	{
+		const auto* geometry = geometries[geometryIx].geometry.get();
+		if (geometry && geometry->getPrimitiveType()==IGeometryBase::EPrimitiveType::Polygon)
+			retval[geometryIx] = createLODChain(static_cast<const ICPUPolygonGeometry*>(geometry),params);
+	});
+	return retval;
+}
+
+}
@@ -3,93 +3,89 @@
 // For conditions of distribution and use, see copyright notice in nabla.h
 
 #include "CSmoothNormalGenerator.h"
+#include "nbl/asset/utils/CPolygonGeometryManipulator.h"
 
 #include "nbl/core/declarations.h"
 #include "nbl/builtin/hlsl/shapes/triangle.hlsl"
 
 #include <algorithm>
+#include <numeric>
 
 namespace nbl
 {
 namespace asset
 {
-static bool operator<(uint32_t lhs, const CSmoothNormalGenerator::VertexData& rhs)
-{
-	return lhs < rhs.hash;
-}
-
-static bool operator<(const CSmoothNormalGenerator::VertexData& lhs, uint32_t rhs)
-{
-	return lhs.hash < rhs;
-}
-
-static bool compareVertexPosition(const hlsl::float32_t3& a, const hlsl::float32_t3& b, float epsilon)
+CSmoothNormalGenerator::Result CSmoothNormalGenerator::calculateNormals(const asset::ICPUPolygonGeometry* polygon, float epsilon, VxCmpFunction vxcmp, const bool recomputeHash)
 {
-	const hlsl::float32_t3 difference = abs(b - a);
-	return (difference.x <= epsilon && difference.y <= epsilon && difference.z <= epsilon);
+	return calculateNormals<VxCmpFunction>(polygon, epsilon, vxcmp, recomputeHash);
 }
 
-CSmoothNormalGenerator::Result CSmoothNormalGenerator::calculateNormals(const asset::ICPUPolygonGeometry* polygon, float epsilon, VxCmpFunction vxcmp, const bool recomputeHash)
+void CSmoothNormalGenerator::recomputeContentHashes(ICPUPolygonGeometry* polygon)
 {
-	assert(polygon->getIndexingCallback()->degree() == 3);
-
-	static constexpr auto MinEpsilon = 0.00001f;
-	const auto patchedEpsilon = epsilon < MinEpsilon ? MinEpsilon : epsilon;
-	VertexHashMap vertexHashMap = setupData(polygon, patchedEpsilon);
-	
-	const auto smoothPolygon = processConnectedVertices(polygon, vertexHashMap, patchedEpsilon,vxcmp);
-	if (recomputeHash)
-		CPolygonGeometryManipulator::recomputeContentHashes(smoothPolygon.get());
-
-	return { vertexHashMap, smoothPolygon };
+	CPolygonGeometryManipulator::recomputeContentHashes(polygon);
 }
 
-
-CSmoothNormalGenerator::VertexHashMap CSmoothNormalGenerator::setupData(const asset::ICPUPolygonGeometry* polygon, float epsilon)
+CSmoothNormalGenerator::SCorners CSmoothNormalGenerator::setupData(const asset::ICPUPolygonGeometry* polygon, float epsilon)
 {
-	const size_t idxCount = polygon->getPrimitiveCount() * 3;
+	const size_t triangleCount = polygon->getPrimitiveCount();
+	const size_t idxCount = triangleCount * 3;
 
 	const auto cellCount = std::max<uint32_t>(core::roundUpToPoT<uint32_t>((idxCount + 31) >> 5), 4);
-	VertexHashMap vertices(idxCount, std::min(16u * 1024u, cellCount), epsilon * 2.f);
-
-	for (uint32_t i = 0; i < idxCount; i += 3)
+	SCorners corners = {
+		.vertexHashGrid = VertexHashMap(epsilon * 2.f, hlsl::findMSB(std::min(16u * 1024u, cellCount)), idxCount),
+		.weightedNormals = core::vector<hlsl::float32_t3>(idxCount)
+	};
+
+	// TODO: could iterate over an index buffer properly
+	const auto& positionView = polygon->getPositionView();
+	core::vector<hlsl::float32_t3> positions(idxCount);
+	if (!positionView.decodeRange<float>(0ull, idxCount, reinterpret_cast<float*>(positions.data()), 3u))
+	for (uint32_t i = 0; i < idxCount; i++)
+		positionView.decodeElement<hlsl::float32_t3>(i, positions[i]);
+
+	core::vector<uint8_t> validTriangles(triangleCount);
+	core::vector<uint32_t> triangles(triangleCount);
+	std::iota(triangles.begin(), triangles.end(), 0u);
+	std::for_each(core::execution::par_unseq, triangles.begin(), triangles.end(), [&](const uint32_t triangle) -> void
 	{
 		//calculate face normal of parent triangle
-		hlsl::float32_t3 v0, v1, v2;
-		// TODO: could iterate over an index buffer properly
-		polygon->getPositionView().decodeElement<hlsl::float32_t3>(i, v0);
-		polygon->getPositionView().decodeElement<hlsl::float32_t3>(i + 1, v1);
-		polygon->getPositionView().decodeElement<hlsl::float32_t3>(i + 2, v2);
+		const uint32_t i = triangle * 3;
+		const auto& v0 = positions[i];
+		const auto& v1 = positions[i + 1];
+		const auto& v2 = positions[i + 2];
 
 		auto faceNormal = cross(v1 - v0, v2 - v0);
 		// if any triangle edge is 0 length, the cross product will be 0 length too
 		const float normLen2 = dot(faceNormal,faceNormal);
 		// need to filter invalid triangles while we're at it
-		if (normLen2<hlsl::numeric_limits<float>::min)
-			continue;
+		validTriangles[triangle] = normLen2 >= hlsl::numeric_limits<float>::min;
+		if (!validTriangles[triangle])
+			return;
 		faceNormal *= hlsl::rsqrt(normLen2);
 
-		//set data for m_vertices
 		const auto angleWeights = hlsl::shapes::util::anglesFromTriangleEdges(v2 - v1, v0 - v2, v1 - v2);
+		corners.weightedNormals[i] = faceNormal * angleWeights.x;
+		corners.weightedNormals[i + 1] = faceNormal * angleWeights.y;
+		corners.weightedNormals[i + 2] = faceNormal * angleWeights.z;
+	});
 
-		vertices.add({ i,	0,	faceNormal * angleWeights.x, v0});
-		vertices.add({ i + 1,	0,	faceNormal * angleWeights.y,v1});
-		vertices.add({ i + 2,	0,	faceNormal * angleWeights.z, v2});
-	}
+	for (uint32_t triangle = 0; triangle < triangleCount; triangle++)
+	if (validTriangles[triangle])
+	for (uint32_t i = triangle * 3; i < triangle * 3 + 3; i++)
+		corners.vertexHashGrid.add({ i, 0, positions[i] });
 
-	vertices.bake();
+	corners.vertexHashGrid.bake();
 
-	return vertices;
+	return corners;
 }
 
-core::smart_refctd_ptr<ICPUPolygonGeometry> CSmoothNormalGenerator::processConnectedVertices(const asset::ICPUPolygonGeometry* polygon, VertexHashMap& vertexHashMap, const float epsilon, VxCmpFunction vxcmp)
+core::smart_refctd_ptr<ICPUPolygonGeometry> CSmoothNormalGenerator::createSmoothPolygon(const asset::ICPUPolygonGeometry* polygon)
 {
 	// TODO: its semi doable to defer unwelding/rewelding until later an just work on a duplicated normal buffer only
 	auto outPolygon = core::move_and_static_cast<ICPUPolygonGeometry>(polygon->clone(0u));
 	static constexpr auto NormalFormat = EF_R32G32B32_SFLOAT;
 	const auto normalFormatBytesize = asset::getTexelOrBlockBytesize(NormalFormat);
 	auto normalBuf = ICPUBuffer::create({ normalFormatBytesize * outPolygon->getPositionView().getElementCount()});
-	auto normalView = polygon->getNormalView();
 
 	// TODO: compute actual range
 	hlsl::shapes::AABB<4,hlsl::float32_t> aabb;
@@ -104,33 +100,7 @@ core::smart_refctd_ptr<ICPUPolygonGeometry> CSmoothNormalGenerator::processConne
 		},
 		.src = { .offset = 0, .size = normalBuf->getSize(), .buffer = std::move(normalBuf) }
 	});
-
-	auto* normalPtr = reinterpret_cast<std::byte*>(outPolygon->getNormalAccessor().getPointer());
-	constexpr auto normalStride = sizeof(hlsl::float32_t3);
-	assert(outPolygon->getNormalView().composed.stride==normalStride);
-
-	for (auto& processedVertex : vertexHashMap.vertices())
-	{
-		auto normal = processedVertex.weightedNormal;
-
-		// We perform double the work (since `vxcmp` must be commutative but not required to be associative) intentionally,
-		// because without guaranteed associativity we cannot partition the vertices into disjoint sets (we're not reconstructing OBJ-like
-		// smooth groups with this), so we can't have all vertices in a set just copy their normal from a "master vertex".
-		// For an example of why that is good, think of a cone or cylinder and why its good to have non-associative smoothing predicate.
-		vertexHashMap.forEachBroadphaseNeighborCandidates(processedVertex.getPosition(), [&](const VertexHashMap::vertex_data_t& candidate)
-			{
-				if (processedVertex.index != candidate.index && compareVertexPosition(processedVertex.position, candidate.position, epsilon) &&
-					vxcmp(processedVertex, candidate, polygon))
-				{
-					//TODO: better mean calculation algorithm
-					normal += candidate.weightedNormal;
-				}
-				return true;
-			});
-
-		normal = normalize(normal);
-		memcpy(normalPtr + (normalStride * processedVertex.index), &normal, sizeof(normal));
-	}
+	assert(outPolygon->getNormalView().composed.stride==sizeof(hlsl::float32_t3));
 
 	return outPolygon;
 }
@@ -4,19 +4,20 @@
 #ifndef _NBL_ASSET_C_SMOOTH_NORMAL_GENERATOR_H_INCLUDED_
 #define _NBL_ASSET_C_SMOOTH_NORMAL_GENERATOR_H_INCLUDED_
 
+#include "nbl/asset/ICPUPolygonGeometry.h"
 #include "nbl/asset/utils/CVertexHashGrid.h"
 
 
-namespace nbl::asset 
+namespace nbl::asset
 {
 
-// TODO: implement a class template that take position type(either float32_t3 or float64_t3 as template argument
-class CSmoothNormalGenerator final
+class NBL_API2 CSmoothNormalGenerator final
 {
 	public:
 		CSmoothNormalGenerator() = delete;
 		~CSmoothNormalGenerator() = delete;
 
+		// what the vertex comparison predicate gets to see about a triangle corner
 		struct VertexData
 		{
 			//offset of the vertex into index buffer
@@ -45,19 +46,119 @@ class CSmoothNormalGenerator final
 
 		using VxCmpFunction = std::function<bool(const VertexData&, const VertexData&, const ICPUPolygonGeometry*)>;
 
-		using VertexHashMap = CVertexHashGrid<VertexData>;
+		// what the hash grid stores per triangle corner, the angle weighted normals live in a separate array indexed by `index`
+		// so the neighbour walk only drags the bytes it needs through the cache
+		struct GridVertex
+		{
+			uint32_t index;
+			uint32_t hash;
+			hlsl::float32_t3 position;
+
+			hlsl::float32_t3 getPosition() const
+			{
+				return position;
+			}
+
+			void setHash(uint32_t hash)
+			{
+				this->hash = hash;
+			}
+
+			uint32_t getHash() const
+			{
+				return hash;
+			};
+		};
+
+		using VertexHashMap = CVertexHashGrid<GridVertex>;
 
 		struct Result
 		{
 			VertexHashMap vertexHashGrid;
 			core::smart_refctd_ptr<ICPUPolygonGeometry> geom;
 		};
+		//! The predicate gets inlined into the neighbour loop and gets called from multiple threads at once, so it must not mutate shared state.
+		template<typename VxCmp> requires std::is_invocable_r_v<bool, const VxCmp&, const VertexData&, const VertexData&, const ICPUPolygonGeometry*>
+		static inline Result calculateNormals(const ICPUPolygonGeometry* polygon, float epsilon, const VxCmp& vxcmp, const bool recomputeHash=true)
+		{
+			assert(polygon->getIndexingCallback()->degree() == 3);
+
+			static constexpr auto MinEpsilon = 0.00001f;
+			const auto patchedEpsilon = epsilon < MinEpsilon ? MinEpsilon : epsilon;
+			SCorners corners = setupData(polygon, patchedEpsilon);
+
+			auto smoothPolygon = createSmoothPolygon(polygon);
+			processConnectedVertices(polygon, corners, patchedEpsilon, vxcmp, reinterpret_cast<std::byte*>(smoothPolygon->getNormalAccessor().getPointer()));
+			if (recomputeHash)
+				recomputeContentHashes(smoothPolygon.get());
+
+			return { std::move(corners.vertexHashGrid), std::move(smoothPolygon) };
+		}
+		// for callers which only know the predicate at runtime, pays for an indirect call per candidate pair
 		static Result calculateNormals(const ICPUPolygonGeometry* polygon, float epsilon, VxCmpFunction function, const bool recomputeHash=true);
 
 	private:
-		static VertexHashMap setupData(const ICPUPolygonGeometry* polygon, float epsilon);
-		static core::smart_refctd_ptr<ICPUPolygonGeometry> processConnectedVertices(const ICPUPolygonGeometry* polygon, VertexHashMap& vertices, float epsilon, VxCmpFunction vxcmp);
+		struct SCorners
+		{
+			VertexHashMap vertexHashGrid;
+			// indexed by corner
+			core::vector<hlsl::float32_t3> weightedNormals;
+		};
+		static constexpr inline uint32_t ProcessBatchSize = 4096u;
+
+		static inline bool compareVertexPosition(const hlsl::float32_t3& a, const hlsl::float32_t3& b, float epsilon)
+		{
+			const hlsl::float32_t3 difference = abs(b - a);
+			return (difference.x <= epsilon && difference.y <= epsilon && difference.z <= epsilon);
+		}
+
+		static SCorners setupData(const ICPUPolygonGeometry* polygon, float epsilon);
+		// clones the polygon and gives it a fresh `EF_R32G32B32_SFLOAT` normal view
+		static core::smart_refctd_ptr<ICPUPolygonGeometry> createSmoothPolygon(const ICPUPolygonGeometry* polygon);
+		// `CPolygonGeometryManipulator` includes this header, so can't be called from the template directly
+		static void recomputeContentHashes(ICPUPolygonGeometry* polygon);
+
+		template<typename VxCmp>
+		static inline void processConnectedVertices(const ICPUPolygonGeometry* polygon, const SCorners& corners, const float epsilon, const VxCmp& vxcmp, std::byte* const normalPtr)
+		{
+			constexpr auto normalStride = sizeof(hlsl::float32_t3);
+			const auto& vertexHashMap = corners.vertexHashGrid;
+			const auto& vertices = vertexHashMap.vertices();
+
+			// every corner only writes its own normal, so batches of corners can accumulate and normalize independently
+			core::vector<uint32_t> batches((vertices.size() + ProcessBatchSize - 1u) / ProcessBatchSize);
+			std::iota(batches.begin(), batches.end(), 0u);
+			std::for_each(core::execution::par, batches.begin(), batches.end(), [&](const uint32_t batch) -> void
+			{
+				const size_t end = core::min<size_t>(size_t(batch + 1u) * ProcessBatchSize, vertices.size());
+				for (size_t i = size_t(batch) * ProcessBatchSize; i < end; i++)
+				{
+					const auto& processedVertex = vertices[i];
+					const VertexData processedData = { processedVertex.index, processedVertex.hash, corners.weightedNormals[processedVertex.index], processedVertex.position };
+					auto normal = processedData.weightedNormal;
+
+					// We perform double the work (since `vxcmp` must be commutative but not required to be associative) intentionally,
+					// because without guaranteed associativity we cannot partition the vertices into disjoint sets (we're not reconstructing OBJ-like
+					// smooth groups with this), so we can't have all vertices in a set just copy their normal from a "master vertex".
+					// For an example of why that is good, think of a cone or cylinder and why its good to have non-associative smoothing predicate.
+					vertexHashMap.forEachBroadphaseNeighborCandidates(processedVertex.getPosition(), [&](const VertexHashMap::vertex_data_t& candidate) -> bool
+						{
+							if (processedVertex.index != candidate.index && compareVertexPosition(processedVertex.position, candidate.position, epsilon))
+							{
+								const VertexData candidateData = { candidate.index, candidate.hash, corners.weightedNormals[candidate.index], candidate.position };
+								//TODO: better mean calculation algorithm
+								if (vxcmp(processedData, candidateData, polygon))
+									normal += candidateData.weightedNormal;
+							}
+							return true;
+						});
+
+					normal = normalize(normal);
+					memcpy(normalPtr + (normalStride * processedVertex.index), &normal, sizeof(normal));
+				}
+			});
+		}
 };
 
 }
-#endif
\ No newline at end of file
+#endif
@@ -278,6 +278,7 @@ SAssetBundle CMitsubaLoader::loadAsset(system::IFile* _file, const IAssetLoader:
 			{
 				// we can't batch because of how the parser works
 				const auto addedCount = ctx.getMaterialFrontend()->addMaterials({.rootNodes={&astRootH,1},.ir=ctx.scene->getMaterialPool(),.result=&rMaterialHandle,.logger=_params.logger});
+				ctx.loweredMaterials.push_back(astRootH);
 				// we could check `addedCount` but the function above does its own logging
 			}
 			else // TODO: make a special Error material
@@ -41,7 +41,8 @@ class CVulkanLogicalDevice final : public ILogicalDevice
 {
         struct PoolConfig
         {
-            using AddressAllocator = core::PoolAddressAllocator<uint32_t>;
+            // deferred operations get created and destroyed from any thread
+            using AddressAllocator = core::LockFreePoolAddressAllocator<uint32_t>;
             using HandleValue = void*;
             constexpr static inline bool ThreadSafe = true;
         };
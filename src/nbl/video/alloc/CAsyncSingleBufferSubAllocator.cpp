@@ -0,0 +1,18 @@
+// Copyright (C) 2018-2026 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+#include "nbl/video/alloc/CAsyncSingleBufferSubAllocator.h"
+#include "nbl/core/alloc/TLSFAddressAllocator.h"
+
+namespace nbl::video
+{
+
+// nothing uses these yet, they keep the TLSF allocator compiling as a drop-in for the General Purpose one in the sub-allocators
+template class CSingleBufferSubAllocator<core::TLSFAddressAllocatorST<uint32_t>>;
+template class impl::CAsyncSingleBufferSubAllocator<core::TLSFAddressAllocatorST<uint32_t>,core::allocator<uint8_t>>;
+template class CAsyncSingleBufferSubAllocatorST<core::TLSFAddressAllocatorST<uint32_t>>;
+// buffer range, max alignment and minimum block size
+template CAsyncSingleBufferSubAllocatorST<core::TLSFAddressAllocatorST<uint32_t>>::CAsyncSingleBufferSubAllocatorST(asset::SBufferRange<IGPUBuffer>&&, uint32_t&&, uint32_t&&);
+template uint32_t impl::CAsyncSingleBufferSubAllocator<core::TLSFAddressAllocatorST<uint32_t>,core::allocator<uint8_t>>::multi_allocate(uint32_t, uint32_t*&&, const uint32_t*&&, const uint32_t*&&);
+
+}
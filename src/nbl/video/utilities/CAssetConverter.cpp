@@ -2,6 +2,7 @@
 // This file is part of the "Nabla Engine".
 #include "nbl/video/utilities/CAssetConverter.h"
 
+#include <numeric>
 #include <type_traits>
 
 
@@ -1753,6 +1754,110 @@ void CAssetConverter::CHashCache::eraseStale(const IPatchOverride* patchOverride
 	rehash.template operator()<ICPUPolygonGeometry>();
 }
 
+template<typename F, typename... AssetTypes>
+static inline void forEachAssetType(F&& f, core::type_list<AssetTypes...>)
+{
+	(f.template operator()<AssetTypes>(),...);
+}
+struct SHashCacheFileHeader
+{
+	constexpr static inline uint32_t Magic = 0x4348424eu; // "NBHC"
+	constexpr static inline uint32_t Version = 1u;
+
+	uint32_t magic = Magic;
+	uint32_t version = Version;
+	// a count per asset type follows, then that many hashes per type, in the order of `supported_asset_types`
+	uint32_t assetTypeCount = core::type_list_size_v<CAssetConverter::supported_asset_types>;
+	uint32_t reserved = 0u;
+};
+bool CAssetConverter::CHashCache::save(system::IFile* file) const
+{
+	if (!file)
+		return false;
+
+	core::vector<uint64_t> counts;
+	core::vector<core::blake3_hash_t> hashes;
+	forEachAssetType([&]<typename AssetType>()->void
+	{
+		// previous runs' hashes stay known
+		core::unordered_set<core::blake3_hash_t> unique = std::get<persisted_t<AssetType>>(m_persisted).hashes;
+		for (const auto& [key,contentHash] : std::get<container_t<AssetType>>(m_containers))
+		if (contentHash!=NoContentHash)
+			unique.insert(contentHash);
+		counts.push_back(unique.size());
+		hashes.insert(hashes.end(),unique.begin(),unique.end());
+	},supported_asset_types{});
+
+	// one write, files are usually not mapped for writing
+	const SHashCacheFileHeader header = {};
+	core::vector<uint8_t> data(sizeof(header)+counts.size()*sizeof(uint64_t)+hashes.size()*sizeof(core::blake3_hash_t));
+	auto* out = data.data();
+	memcpy(out,&header,sizeof(header));
+	out += sizeof(header);
+	memcpy(out,counts.data(),counts.size()*sizeof(uint64_t));
+	out += counts.size()*sizeof(uint64_t);
+	memcpy(out,hashes.data(),hashes.size()*sizeof(core::blake3_hash_t));
+
+	system::IFile::success_t success;
+	file->write(success,data.data(),0,data.size());
+	return bool(success);
+}
+bool CAssetConverter::CHashCache::load(system::IFile* file)
+{
+	if (!file)
+		return false;
+	const size_t fileSize = file->getSize();
+
+	SHashCacheFileHeader header;
+	constexpr auto TypeCount = core::type_list_size_v<supported_asset_types>;
+	uint64_t counts[TypeCount];
+	if (fileSize<sizeof(header)+sizeof(counts))
+		return false;
+	{
+		system::IFile::success_t success;
+		file->read(success,&header,0,sizeof(header));
+		if (!success || header.magic!=SHashCacheFileHeader::Magic || header.version!=SHashCacheFileHeader::Version || header.assetTypeCount!=TypeCount)
+			return false;
+	}
+	{
+		system::IFile::success_t success;
+		file->read(success,counts,sizeof(header),sizeof(counts));
+		if (!success)
+			return false;
+	}
+	const size_t hashesOffset = sizeof(header)+sizeof(counts);
+	// the counts are untrusted, check each against what's left of the file so the sum can't wrap around
+	uint64_t totalCount = 0ull;
+	{
+		uint64_t remaining = (fileSize-hashesOffset)/sizeof(core::blake3_hash_t);
+		for (const auto count : counts)
+		{
+			if (count>remaining)
+				return false;
+			remaining -= count;
+			totalCount += count;
+		}
+	}
+
+	core::vector<core::blake3_hash_t> hashes(totalCount);
+	{
+		system::IFile::success_t success;
+		file->read(success,hashes.data(),hashesOffset,hashes.size()*sizeof(core::blake3_hash_t));
+		if (!success)
+			return false;
+	}
+	auto it = hashes.begin();
+	uint32_t typeIx = 0u;
+	forEachAssetType([&]<typename AssetType>()->void
+	{
+		auto& persisted = std::get<persisted_t<AssetType>>(m_persisted).hashes;
+		const auto end = it+counts[typeIx++];
+		persisted.insert(it,end);
+		it = end;
+	},supported_asset_types{});
+	return true;
+}
+
 
 //
 template<Asset AssetT>
@@ -1783,6 +1888,16 @@ class GetDependantVisitBase
 			// grab gpu object from the node of patch index
 			return dfsCache.nodes[patchIx.value].gpuObj.value;
 		}
+		// for when the visitor only needs to look at the dependant, the dfs cache keeps it alive
+		template<Asset DepType>
+		core::borrowed_refctd_ptr<typename asset_traits<DepType>::video_t> peekDependant(const instance_t<DepType>& dep, const CAssetConverter::patch_t<DepType>& soloPatch) const
+		{
+			const auto& dfsCache = std::get<dfs_cache<DepType>>(dfsCaches);
+			const auto patchIx = dfsCache.find(dep,soloPatch);
+			if (!patchIx)
+				return {};
+			return dfsCache.nodes[patchIx.value].gpuObj.value;
+		}
 
 		template<typename DepType>
 		void nullOptional() const {}
@@ -1915,7 +2030,7 @@ class GetDependantVisit<ICPUComputePipeline> : public GetDependantVisitBase<ICPU
 			const instance_t<ICPUPipelineLayout>& dep, const CAssetConverter::patch_t<ICPUPipelineLayout>& soloPatch
 		)
 		{
-			auto depObj = getDependant<ICPUPipelineLayout>(dep,soloPatch);
+			auto depObj = peekDependant<ICPUPipelineLayout>(dep,soloPatch);
 			if (!depObj)
 				return false;
 			layout = depObj.get();
@@ -1930,7 +2045,7 @@ class GetDependantVisit<ICPUComputePipeline> : public GetDependantVisitBase<ICPU
 			if (!depObj)
 				return false;
 			getSpecInfo() = ICPUPipelineBase::SShaderSpecInfo{
-				.shader = depObj,
+				.shader = std::move(depObj),
 				.entryPoint = inSpecInfo.entryPoint, // warning: its a `string_view` now!
 				.requiredSubgroupSize = inSpecInfo.requiredSubgroupSize,
 				.entries = inSpecInfo.entries
@@ -1963,7 +2078,7 @@ class GetDependantVisit<ICPUGraphicsPipeline> : public GetDependantVisitBase<ICP
 			const instance_t<ICPUPipelineLayout>& dep, const CAssetConverter::patch_t<ICPUPipelineLayout>& soloPatch
 		)
 		{
-			auto depObj = getDependant<ICPUPipelineLayout>(dep,soloPatch);
+			auto depObj = peekDependant<ICPUPipelineLayout>(dep,soloPatch);
 			if (!depObj)
 				return false;
 			layout = depObj.get();
@@ -1978,7 +2093,7 @@ class GetDependantVisit<ICPUGraphicsPipeline> : public GetDependantVisitBase<ICP
 			if (!depObj)
 				return false;
 			getSpecInfo(stage) = {
-				.shader = depObj,
+				.shader = std::move(depObj),
 				.entryPoint = inSpecInfo.entryPoint, // warning: its a `string_view` now!
 				.requiredSubgroupSize = inSpecInfo.requiredSubgroupSize,
 				.entries = inSpecInfo.entries
@@ -1990,7 +2105,7 @@ class GetDependantVisit<ICPUGraphicsPipeline> : public GetDependantVisitBase<ICP
 			const instance_t<ICPURenderpass>& dep, const CAssetConverter::patch_t<ICPURenderpass>& soloPatch
 		)
 		{
-			auto depObj = getDependant<ICPURenderpass>(dep,soloPatch);
+			auto depObj = peekDependant<ICPURenderpass>(dep,soloPatch);
 			if (!depObj)
 				return false;
 			renderpass = depObj.get();
@@ -2024,8 +2139,8 @@ class GetDependantVisit<ICPUDescriptorSet> : public GetDependantVisitBase<ICPUDe
 		// has to be public because of aggregate init, but its only for internal usage!
 		uint32_t lastBinding;
 		uint32_t lastElement;
-		// special state to pass around
-		IGPUSampler* lastCombinedSampler;
+		// special state to pass around, holds the reference `getDependant` took until the image takes it over
+		core::smart_refctd_ptr<IGPUSampler> lastCombinedSampler;
 
 	protected:
 		bool descend_impl(
@@ -2060,7 +2175,7 @@ class GetDependantVisit<ICPUDescriptorSet> : public GetDependantVisitBase<ICPUDe
 			if constexpr (std::is_same_v<DepType,ICPUSampler>)
 			if (type==IDescriptor::E_TYPE::ET_COMBINED_IMAGE_SAMPLER)
 			{
-				lastCombinedSampler = depObj.get();
+				lastCombinedSampler = std::move(depObj);
 				return true;
 			}
 			// a bit of RLE
@@ -2105,8 +2220,7 @@ class GetDependantVisit<ICPUDescriptorSet> : public GetDependantVisitBase<ICPUDe
 				if (type == IDescriptor::E_TYPE::ET_COMBINED_IMAGE_SAMPLER)
 				{
 					assert(lastCombinedSampler);
-					outInfo.info.combinedImageSampler.sampler = smart_refctd_ptr<IGPUSampler>(lastCombinedSampler);
-					lastCombinedSampler = nullptr;
+					outInfo.info.combinedImageSampler.sampler = std::move(lastCombinedSampler);
 				}
 			}
 			outInfo.desc = std::move(depObj);
@@ -2240,7 +2354,7 @@ protected:
 		const instance_t<ICPUPipelineLayout>& dep, const CAssetConverter::patch_t<ICPUPipelineLayout>& soloPatch
 	)
 	{
-		auto depObj = getDependant<ICPUPipelineLayout>(dep, soloPatch);
+		auto depObj = peekDependant<ICPUPipelineLayout>(dep, soloPatch);
 		if (!depObj)
 			return false;
 		layout = depObj.get();
@@ -2258,7 +2372,7 @@ protected:
 		{
 			assert(groupIndex == 0);
 			raygen = ICPUPipelineBase::SShaderSpecInfo{
-				.shader = depObj,
+				.shader = std::move(depObj),
 				.entryPoint = inSpecInfo.entryPoint,
 				.requiredSubgroupSize = inSpecInfo.requiredSubgroupSize,
         .entries = inSpecInfo.entries,
@@ -2268,7 +2382,7 @@ protected:
 			auto& shaderGroups = *getSpecInfoVector(stage);
 			assert(groupIndex < shaderGroups.size());
 			shaderGroups[groupIndex] = ICPUPipelineBase::SShaderSpecInfo{
-				.shader = depObj,
+				.shader = std::move(depObj),
 				.entryPoint = inSpecInfo.entryPoint,
 				.requiredSubgroupSize = inSpecInfo.requiredSubgroupSize,
 				.entries = inSpecInfo.entries,